@@ -18,9 +18,10 @@ provide external locking.
 """
 from __future__ import annotations
 
+import contextlib
 import ctypes
 import pathlib
-from typing import Dict, Iterable, List, Optional, Tuple
+from typing import Dict, Iterable, Iterator, List, Optional, Tuple
 
 # ── Library loading ────────────────────────────────────────────────────────────
 
@@ -49,6 +50,19 @@ STRING = 4
 
 _VALID_COL_TYPES = {UINT32, INT64, FLOAT, DOUBLE, STRING}
 
+# Durability levels (mirror MdbDurability)
+SYNC_OFF    = 0
+SYNC_NORMAL = 1
+SYNC_FULL   = 2
+
+ROW_DROPPED = 0xFFFFFFFF  # mirrors MDB_ROW_DROPPED
+_MDB_NOT_FOUND = -6       # mirrors MDB_NOT_FOUND
+_MDB_ERR_LOST  = -7       # mirrors MDB_ERR_LOST
+
+# Change-stream start positions (mirror MDB_CDC_START / MDB_CDC_END)
+CDC_START = 0
+CDC_END   = 0xFFFFFFFFFFFFFFFF
+
 # ── ctypes structure mirrors ───────────────────────────────────────────────────
 # Layout must match mdb.h exactly; verified by static_assert in mdb_c.cpp.
 
@@ -70,13 +84,14 @@ class _MdbValue(ctypes.Structure):
 
 class _MdbPredicate(ctypes.Structure):
     # C layout: col_idx(u16,2) + 2-byte pad + kind(int,4) + lo(u32,4)
-    #           + hi(u32,4) + needle*(8) = 24 bytes
+    #           + hi(u32,4) + needle*(8) + needle_hi*(8) = 32 bytes
     _fields_ = [
-        ("col_idx", ctypes.c_uint16),
-        ("kind",    ctypes.c_int),
-        ("lo",      ctypes.c_uint32),
-        ("hi",      ctypes.c_uint32),
-        ("needle",  ctypes.c_char_p),
+        ("col_idx",   ctypes.c_uint16),
+        ("kind",      ctypes.c_int),
+        ("lo",        ctypes.c_uint32),
+        ("hi",        ctypes.c_uint32),
+        ("needle",    ctypes.c_char_p),
+        ("needle_hi", ctypes.c_char_p),
     ]
 
 class _MdbRowSet(ctypes.Structure):
@@ -112,6 +127,15 @@ class _MdbJoinResult(ctypes.Structure):
         ("count", ctypes.c_uint32),
     ]
 
+class _MdbCdcEvent(ctypes.Structure):
+    _fields_ = [
+        ("lsn",        ctypes.c_uint64),
+        ("op",         ctypes.c_int),
+        ("row_id",     ctypes.c_uint32),
+        ("values",     ctypes.POINTER(_MdbValue)),
+        ("num_values", ctypes.c_uint32),
+    ]
+
 # ── C function signatures ──────────────────────────────────────────────────────
 
 _lib.mdb_open.restype  = ctypes.c_void_p
@@ -142,12 +166,54 @@ _lib.mdb_delete.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_uint32]
 _lib.mdb_flush.restype  = ctypes.c_int
 _lib.mdb_flush.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
 
+_lib.mdb_set_durability.restype  = ctypes.c_int
+_lib.mdb_set_durability.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int]
+
+for _fn in (_lib.mdb_begin, _lib.mdb_commit, _lib.mdb_rollback):
+    _fn.restype  = ctypes.c_int
+    _fn.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+
+_lib.mdb_compact.restype  = ctypes.c_int
+_lib.mdb_compact.argtypes = [
+    ctypes.c_void_p, ctypes.c_char_p, ctypes.POINTER(ctypes.POINTER(_MdbRowSet)),
+]
+
 _lib.mdb_fetch_row.restype  = ctypes.c_int
 _lib.mdb_fetch_row.argtypes = [
     ctypes.c_void_p, ctypes.c_char_p, ctypes.c_uint32,
     ctypes.POINTER(_MdbValue), ctypes.c_uint32,
 ]
 
+_lib.mdb_set_primary_key.restype  = ctypes.c_int
+_lib.mdb_set_primary_key.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_uint16]
+
+_lib.mdb_get_by_key.restype  = ctypes.c_int
+_lib.mdb_get_by_key.argtypes = [
+    ctypes.c_void_p, ctypes.c_char_p, ctypes.POINTER(_MdbValue),
+    ctypes.POINTER(_MdbValue), ctypes.c_uint32, ctypes.POINTER(ctypes.c_uint32),
+]
+
+_lib.mdb_upsert.restype  = ctypes.c_int
+_lib.mdb_upsert.argtypes = [
+    ctypes.c_void_p, ctypes.c_char_p,
+    ctypes.POINTER(_MdbValue), ctypes.c_uint32,
+    ctypes.POINTER(ctypes.c_uint32),
+]
+
+_lib.mdb_cdc_open.restype  = ctypes.c_int
+_lib.mdb_cdc_open.argtypes = [
+    ctypes.c_void_p, ctypes.c_char_p, ctypes.c_uint64, ctypes.POINTER(ctypes.c_void_p),
+]
+
+_lib.mdb_cdc_next.restype  = ctypes.c_int
+_lib.mdb_cdc_next.argtypes = [ctypes.c_void_p, ctypes.POINTER(_MdbCdcEvent)]
+
+_lib.mdb_cdc_position.restype  = ctypes.c_uint64
+_lib.mdb_cdc_position.argtypes = [ctypes.c_void_p]
+
+_lib.mdb_cdc_close.restype  = None
+_lib.mdb_cdc_close.argtypes = [ctypes.c_void_p]
+
 _lib.mdb_scan_eq.restype  = ctypes.POINTER(_MdbRowSet)
 _lib.mdb_scan_eq.argtypes = [
     ctypes.c_void_p, ctypes.c_char_p, ctypes.c_uint16, ctypes.c_uint32,
@@ -395,6 +461,8 @@ class Predicate:
         Predicate.eq(col, val)
         Predicate.between(col, lo, hi)
         Predicate.eq_string(col, needle)
+        Predicate.prefix_string(col, prefix)
+        Predicate.between_string(col, lo, hi)
     """
 
     def __init__(self, struct: _MdbPredicate, _str_ref: Optional[bytes] = None):
@@ -434,11 +502,33 @@ class Predicate:
         p.needle  = b            # pointer into b; b kept alive via _str_ref
         return cls(p, _str_ref=b)
 
+    @classmethod
+    def prefix_string(cls, col: int, prefix: str) -> "Predicate":
+        pred = cls.eq_string(col, prefix)
+        pred._struct.kind = 3     # MDB_PRED_PREFIX_STRING
+        return pred
+
+    @classmethod
+    def between_string(cls, col: int, lo: str, hi: str) -> "Predicate":
+        if not isinstance(hi, (str, bytes, bytearray)):
+            raise ValueError("string predicate bound must be str/bytes")
+        pred = cls.eq_string(col, lo)
+        hi_b = hi.encode("utf-8") if isinstance(hi, str) else bytes(hi)
+        pred._struct.kind      = 4  # MDB_PRED_BETWEEN_STRING
+        pred._struct.needle_hi = hi_b
+        pred._str_ref = (pred._str_ref, hi_b)
+        return pred
+
 # ── Exceptions ─────────────────────────────────────────────────────────────────
 
 class MdbError(RuntimeError):
     """Raised when a MetalDB operation fails."""
 
+class ChangesLost(MdbError):
+    """Raised by Engine.changes() when the WAL no longer holds the changes after
+    the requested position.  Take a CDC_END position, reread the table, then
+    read changes from that position."""
+
 # ── Engine class ───────────────────────────────────────────────────────────────
 
 class Engine:
@@ -458,6 +548,7 @@ class Engine:
             raise MdbError("mdb_open failed")
         self._h: int = handle
         self._schemas: Dict[str, List[int]] = {}
+        self._primary_keys: Dict[str, int] = {}
 
     def close(self) -> None:
         if self._h:
@@ -485,12 +576,31 @@ class Engine:
         _check(_lib.mdb_create_table(
             self._h, name_b, arr, ctypes.c_uint32(n)), self._h)
         self._schemas[name] = schema
+        self._primary_keys.pop(name, None)
 
-    def open_table(self, name: str, col_types: List[int]) -> None:
-        """Register schema for an on-disk table created in a previous session."""
+    def open_table(self, name: str, col_types: List[int],
+                   primary_key: Optional[int] = None) -> None:
+        """Register schema (and primary key column, if one was declared) for an
+        on-disk table created in a previous session."""
         _require_open_handle(self._h)
         _encode_name(name)
-        self._schemas[name] = _normalize_schema(col_types)
+        schema = _normalize_schema(col_types)
+        self._schemas[name] = schema
+        self._primary_keys.pop(name, None)
+        if primary_key is not None:
+            primary_key = _normalize_col_index(primary_key, "primary key column")
+            if primary_key >= len(schema):
+                raise ValueError("primary key column out of range")
+            self._primary_keys[name] = primary_key
+
+    def set_primary_key(self, table: str, col: int) -> None:
+        """Declare a unique primary key column; later inserts reject duplicates."""
+        _require_open_handle(self._h)
+        table_b = _encode_name(table)
+        _require_registered_schema(self._schemas, table)
+        col = _normalize_col_index(col)
+        _check(_lib.mdb_set_primary_key(self._h, table_b, ctypes.c_uint16(col)), self._h)
+        self._primary_keys[table] = col
 
     # ── DML ───────────────────────────────────────────────────────────────────
 
@@ -508,6 +618,38 @@ class Engine:
             ctypes.byref(rid)), self._h)
         return rid.value
 
+    def upsert(self, table: str, values: list) -> int:
+        """Insert a row, replacing any row with the same primary key.  Returns row ID."""
+        _require_open_handle(self._h)
+        table_b = _encode_name(table)
+        schema = _require_registered_schema(self._schemas, table)
+        if len(values) != len(schema):
+            raise ValueError(f"expected {len(schema)} values, got {len(values)}")
+        arr, str_refs = _make_value_array(values, schema)
+        rid = ctypes.c_uint32(0)
+        _check(_lib.mdb_upsert(
+            self._h, table_b, arr, len(values),
+            ctypes.byref(rid)), self._h)
+        return rid.value
+
+    def get_by_key(self, table: str, key) -> Optional[list]:
+        """Return the row whose primary key equals key, or None."""
+        _require_open_handle(self._h)
+        table_b = _encode_name(table)
+        schema = _require_registered_schema(self._schemas, table)
+        pk = self._primary_keys.get(table)
+        if pk is None:
+            raise MdbError(f"table '{table}' has no registered primary key")
+        key_arr, str_refs = _make_value_array([key], [schema[pk]])
+        n   = len(schema)
+        arr = (_MdbValue * n)()
+        rc = _lib.mdb_get_by_key(
+            self._h, table_b, key_arr, arr, ctypes.c_uint32(n), None)
+        if rc == _MDB_NOT_FOUND:
+            return None
+        _check(rc, self._h)
+        return [_mdb_value_to_py(arr[i]) for i in range(n)]
+
     def delete(self, table: str, row_id: int) -> None:
         _require_open_handle(self._h)
         table_b = _encode_name(table)
@@ -519,6 +661,50 @@ class Engine:
         table_b = _encode_name(table)
         _check(_lib.mdb_flush(self._h, table_b), self._h)
 
+    def set_durability(self, level: int, table: Optional[str] = None) -> None:
+        """SYNC_OFF / SYNC_NORMAL / SYNC_FULL for one table, or engine-wide if table is None."""
+        _require_open_handle(self._h)
+        if level not in (SYNC_OFF, SYNC_NORMAL, SYNC_FULL):
+            raise ValueError(f"unknown durability level {level!r}")
+        table_b = None if table is None else _encode_name(table)
+        _check(_lib.mdb_set_durability(self._h, table_b, level), self._h)
+
+    def begin(self, table: str) -> None:
+        """Buffer this table's writes until commit(); they are logged as one batch."""
+        _require_open_handle(self._h)
+        table_b = _encode_name(table)
+        _check(_lib.mdb_begin(self._h, table_b), self._h)
+
+    def commit(self, table: str) -> None:
+        _require_open_handle(self._h)
+        table_b = _encode_name(table)
+        _check(_lib.mdb_commit(self._h, table_b), self._h)
+
+    def rollback(self, table: str) -> None:
+        _require_open_handle(self._h)
+        table_b = _encode_name(table)
+        _check(_lib.mdb_rollback(self._h, table_b), self._h)
+
+    @contextlib.contextmanager
+    def transaction(self, table: str) -> Iterator[None]:
+        """``with e.transaction(t):`` commits on success, rolls back on an exception."""
+        self.begin(table)
+        try:
+            yield
+        except BaseException:
+            self.rollback(table)
+            raise
+        self.commit(table)
+
+    def compact(self, table: str) -> Dict[int, int]:
+        """Drop deleted rows; return {old_row_id: new_row_id} for surviving rows."""
+        _require_open_handle(self._h)
+        table_b = _encode_name(table)
+        rs = ctypes.POINTER(_MdbRowSet)()
+        _check(_lib.mdb_compact(self._h, table_b, ctypes.byref(rs)), self._h)
+        remap = _drain_rowset(rs) or []
+        return {old: new for old, new in enumerate(remap) if new != ROW_DROPPED}
+
     def fetch_row(self, table: str, row_id: int) -> list:
         """Return a list of Python values for the given row."""
         _require_open_handle(self._h)
@@ -531,6 +717,39 @@ class Engine:
             arr, ctypes.c_uint32(n)), self._h)
         return [_mdb_value_to_py(arr[i]) for i in range(n)]
 
+    # ── Change data capture ──────────────────────────────────────────────────
+
+    def changes(self, table: str, after: int = CDC_START,
+                limit: Optional[int] = None) -> Tuple[List[tuple], int]:
+        """Committed changes after position ``after``, oldest first, as
+        ``(lsn, "insert" | "delete", row_id, values or None)`` tuples, plus the
+        position to pass as ``after`` next time.  Raises ChangesLost if the WAL
+        has moved past ``after``."""
+        _require_open_handle(self._h)
+        table_b = _encode_name(table)
+        cursor = ctypes.c_void_p()
+        rc = _lib.mdb_cdc_open(self._h, table_b, ctypes.c_uint64(after), ctypes.byref(cursor))
+        if rc == _MDB_ERR_LOST:
+            raise ChangesLost(_last_error_msg(self._h))
+        _check(rc, self._h)
+        try:
+            out: List[tuple] = []
+            ev = _MdbCdcEvent()
+            while limit is None or len(out) < limit:
+                rc = _lib.mdb_cdc_next(cursor, ctypes.byref(ev))
+                if rc == _MDB_NOT_FOUND:
+                    break
+                if rc == _MDB_ERR_LOST:
+                    raise ChangesLost(_last_error_msg(self._h))
+                _check(rc, self._h)
+                values = None
+                if ev.values:
+                    values = [_mdb_value_to_py(ev.values[i]) for i in range(ev.num_values)]
+                out.append((ev.lsn, "insert" if ev.op == 1 else "delete", ev.row_id, values))
+            return out, _lib.mdb_cdc_position(cursor)
+        finally:
+            _lib.mdb_cdc_close(cursor)
+
     # ── Scans ──────────────────────────────────────────────────────────────────
 
     def scan_eq(self, table: str, col: int, val: int) -> List[int]:
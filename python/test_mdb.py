@@ -14,6 +14,8 @@ sys.path.insert(0, os.path.join(os.path.dirname(__file__)))
 
 from mdb import Engine, MdbError, Predicate
 from mdb import UINT32, INT64, FLOAT, DOUBLE, STRING
+from mdb import SYNC_OFF, SYNC_NORMAL, SYNC_FULL
+from mdb import CDC_START, CDC_END, ChangesLost
 
 _failed = 0
 
@@ -145,6 +147,11 @@ def test_where_string_predicate():
             Predicate.eq_string(1, "alice"),
         ])
         check_eq(len(rows), 2)
+        rows = e.where_or("/tmp/py_strpred", [
+            Predicate.prefix_string(1, "ca"),
+            Predicate.between_string(1, "b", "bz"),
+        ])
+        check_eq(rows, [1, 3, 4])
     print("PASS test_where_string_predicate")
 
 def test_delete():
@@ -169,6 +176,94 @@ def test_flush_reopen():
         check_eq(row[1], "durable")
     print("PASS test_flush_reopen")
 
+def test_compact():
+    with Engine() as e:
+        e.create_table("/tmp/py_compact", [UINT32])
+        for v in range(5):
+            e.insert("/tmp/py_compact", [v])
+        e.delete("/tmp/py_compact", 0)
+        e.delete("/tmp/py_compact", 3)
+        remap = e.compact("/tmp/py_compact")
+        check_eq(remap, {1: 0, 2: 1, 4: 2})
+        check_eq(e.fetch_row("/tmp/py_compact", 2), [4])
+    print("PASS test_compact")
+
+def test_primary_key():
+    with Engine() as e:
+        e.create_table("/tmp/py_pk", [STRING, UINT32])
+        e.insert("/tmp/py_pk", ["alice", 1])
+        e.set_primary_key("/tmp/py_pk", 0)
+        check_raises(MdbError, lambda: e.insert("/tmp/py_pk", ["alice", 2]))
+        e.upsert("/tmp/py_pk", ["alice", 3])
+        e.upsert("/tmp/py_pk", ["bob", 4])
+        check_eq(e.get_by_key("/tmp/py_pk", "alice"), ["alice", 3])
+        check_eq(e.get_by_key("/tmp/py_pk", "carol"), None)
+        e.flush("/tmp/py_pk")
+
+    with Engine() as e:
+        e.open_table("/tmp/py_pk", [STRING, UINT32], primary_key=0)
+        check_eq(e.get_by_key("/tmp/py_pk", "bob"), ["bob", 4])
+    print("PASS test_primary_key")
+
+def test_transactions():
+    with Engine() as e:
+        e.create_table("/tmp/py_txn", [UINT32, STRING])
+        e.set_primary_key("/tmp/py_txn", 0)
+        with e.transaction("/tmp/py_txn"):
+            e.insert("/tmp/py_txn", [1, "one"])
+            e.upsert("/tmp/py_txn", [1, "uno"])
+            e.insert("/tmp/py_txn", [2, "two"])
+            check_eq(e.scan_eq("/tmp/py_txn", 0, 1), [])
+        check_eq(e.get_by_key("/tmp/py_txn", 1), [1, "uno"])
+
+        def failing():
+            with e.transaction("/tmp/py_txn"):
+                e.insert("/tmp/py_txn", [3, "three"])
+                raise ValueError("abort")
+        check_raises(ValueError, failing)
+        check_eq(e.get_by_key("/tmp/py_txn", 3), None)
+        check_raises(MdbError, lambda: e.commit("/tmp/py_txn"))
+    print("PASS test_transactions")
+
+def test_durability():
+    with Engine() as e:
+        e.set_durability(SYNC_OFF)  # engine-wide, also for tables created later
+        e.create_table("/tmp/py_sync", [UINT32])
+        for v in range(10):
+            e.insert("/tmp/py_sync", [v])
+        e.set_durability(SYNC_FULL, "/tmp/py_sync")
+        e.insert("/tmp/py_sync", [10])
+        e.set_durability(SYNC_NORMAL, "/tmp/py_sync")
+        check_raises(ValueError, lambda: e.set_durability(7))
+        check_raises(MdbError, lambda: e.set_durability(SYNC_FULL, "/tmp/py_sync_missing"))
+
+    with Engine() as e:
+        e.open_table("/tmp/py_sync", [UINT32])
+        check_eq(e.scan_between("/tmp/py_sync", 0, 0, 10), list(range(11)))
+    print("PASS test_durability")
+
+def test_changes():
+    with Engine() as e:
+        e.create_table("/tmp/py_cdc", [UINT32, STRING])
+        e.insert("/tmp/py_cdc", [1, "one"])
+        e.insert("/tmp/py_cdc", [2, "two"])
+        e.delete("/tmp/py_cdc", 0)
+        changes, pos = e.changes("/tmp/py_cdc")
+        check_eq([c[1:] for c in changes],
+                 [("insert", 0, [1, "one"]), ("insert", 1, [2, "two"]), ("delete", 0, None)])
+        check_eq(pos, changes[-1][0])
+
+        first, _ = e.changes("/tmp/py_cdc", CDC_START, limit=1)
+        rest, _ = e.changes("/tmp/py_cdc", first[0][0])
+        check_eq(rest, changes[1:])
+        check_eq(e.changes("/tmp/py_cdc", CDC_END), ([], pos))
+
+        e.flush("/tmp/py_cdc")
+        e.insert("/tmp/py_cdc", [3, "three"])
+        check_eq([c[1:] for c in e.changes("/tmp/py_cdc", pos)[0]], [("insert", 2, [3, "three"])])
+        check_raises(ChangesLost, lambda: e.changes("/tmp/py_cdc", first[0][0]))
+    print("PASS test_changes")
+
 def test_aggregations():
     with Engine() as e:
         e.create_table("/tmp/py_agg", [UINT32])
@@ -279,6 +374,11 @@ if __name__ == "__main__":
     test_where_string_predicate()
     test_delete()
     test_flush_reopen()
+    test_compact()
+    test_primary_key()
+    test_transactions()
+    test_durability()
+    test_changes()
     test_aggregations()
     test_groupby()
     test_join()
@@ -0,0 +1,480 @@
+// BPlusTree.cpp
+#include "BPlusTree.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+static constexpr uint32_t BPT_MAGIC   = 0x42505449; // 'BPTI'
+static constexpr uint16_t BPT_VERSION = 1;
+static constexpr size_t   NODE_HEADER = 8;
+
+#pragma pack(push, 1)
+struct TreeHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t keyBytes;
+    uint32_t root;
+    uint32_t pageCount;
+    uint64_t entryCount;
+};
+#pragma pack(pop)
+static_assert(sizeof(TreeHeader) == 24, "TreeHeader must be 24 bytes");
+
+inline bool nodeIsLeaf(const uint8_t* node) { return node[0] != 0; }
+
+inline uint16_t nodeCount(const uint8_t* node) {
+    uint16_t n; std::memcpy(&n, node + 2, sizeof(n)); return n;
+}
+inline void setNodeCount(uint8_t* node, uint16_t n) { std::memcpy(node + 2, &n, sizeof(n)); }
+
+inline uint32_t nodeLink(const uint8_t* node) {
+    uint32_t v; std::memcpy(&v, node + 4, sizeof(v)); return v;
+}
+inline void setNodeLink(uint8_t* node, uint32_t v) { std::memcpy(node + 4, &v, sizeof(v)); }
+
+inline uint32_t loadU32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline void storeU32(uint8_t* p, uint32_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+[[noreturn]] void throwErrno(const char* what) {
+    throw std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+BPlusTree::BPlusTree(const std::string& path, uint16_t keyBytes)
+  : path_(path), keyBytes_(keyBytes) {}
+
+BPlusTree::~BPlusTree() {
+    if (fd_ >= 0) {
+        writeHeader();
+        ::close(fd_);
+    }
+}
+
+uint16_t BPlusTree::leafCapacity() const {
+    return static_cast<uint16_t>((kPageSize - NODE_HEADER) / leafEntryBytes());
+}
+
+uint16_t BPlusTree::innerCapacity() const {
+    return static_cast<uint16_t>((kPageSize - NODE_HEADER) / innerEntryBytes());
+}
+
+void BPlusTree::openOrCreate(bool create) {
+    if (fd_ >= 0) ::close(fd_);
+    cache_.clear();
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd_ < 0) throwErrno("open index failed");
+
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) throwErrno("stat index failed");
+    if (!create && st.st_size >= off_t(kPageSize)) {
+        readHeader();
+        // The header is only rewritten lazily; trust the file length for pages.
+        const uint32_t filePages = static_cast<uint32_t>(st.st_size / kPageSize);
+        if (filePages > pageCount_) pageCount_ = filePages;
+        return;
+    }
+
+    if (::ftruncate(fd_, 0) != 0) throwErrno("truncate index failed");
+    pageCount_ = 1;
+    entryCount_ = 0;
+    root_ = allocPage(/*leaf=*/true);
+    writePage(root_);
+    writeHeader();
+}
+
+void BPlusTree::readHeader() {
+    TreeHeader h{};
+    if (::pread(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h)))
+        throwErrno("read index header failed");
+    if (h.magic != BPT_MAGIC || h.version != BPT_VERSION)
+        throw std::runtime_error("invalid index header: " + path_);
+    if (h.keyBytes != keyBytes_)
+        throw std::runtime_error("index key width mismatch: " + path_);
+    root_ = h.root;
+    pageCount_ = h.pageCount;
+    entryCount_ = h.entryCount;
+}
+
+void BPlusTree::writeHeader() const {
+    if (fd_ < 0) return;
+    TreeHeader h{BPT_MAGIC, BPT_VERSION, keyBytes_, root_, pageCount_, entryCount_};
+    if (::pwrite(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h)))
+        throwErrno("write index header failed");
+}
+
+uint8_t* BPlusTree::page(uint32_t pid) const {
+    auto it = cache_.find(pid);
+    if (it != cache_.end()) return it->second.data();
+
+    std::vector<uint8_t> buf(kPageSize, 0);
+    const off_t off = off_t(pid) * off_t(kPageSize);
+    if (::pread(fd_, buf.data(), kPageSize, off) != ssize_t(kPageSize))
+        throwErrno("read index page failed");
+    return cache_.emplace(pid, std::move(buf)).first->second.data();
+}
+
+uint32_t BPlusTree::allocPage(bool leaf) {
+    const uint32_t pid = pageCount_++;
+    std::vector<uint8_t> buf(kPageSize, 0);
+    buf[0] = leaf ? 1 : 0;
+    cache_.insert_or_assign(pid, std::move(buf));
+    return pid;
+}
+
+void BPlusTree::writePage(uint32_t pid) const {
+    const uint8_t* node = page(pid);
+    const off_t off = off_t(pid) * off_t(kPageSize);
+    if (::pwrite(fd_, node, kPageSize, off) != ssize_t(kPageSize))
+        throwErrno("write index page failed");
+}
+
+int BPlusTree::compareEntry(const uint8_t* entry, const Key& key, uint32_t rowID) const {
+    const int c = std::memcmp(entry, key.data(), keyBytes_);
+    if (c != 0) return c;
+    const uint32_t r = loadU32(entry + keyBytes_);
+    return r < rowID ? -1 : (r > rowID ? 1 : 0);
+}
+
+uint16_t BPlusTree::leafLowerBound(const uint8_t* node, const Key& key, uint32_t rowID) const {
+    uint16_t lo = 0, hi = nodeCount(node);
+    const size_t e = leafEntryBytes();
+    while (lo < hi) {
+        const uint16_t mid = static_cast<uint16_t>((lo + hi) / 2);
+        if (compareEntry(node + NODE_HEADER + mid * e, key, rowID) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Index of the child to descend into: the number of separators <= probe.
+uint16_t BPlusTree::innerChildIndex(const uint8_t* node, const Key& key, uint32_t rowID) const {
+    uint16_t lo = 0, hi = nodeCount(node);
+    const size_t e = innerEntryBytes();
+    while (lo < hi) {
+        const uint16_t mid = static_cast<uint16_t>((lo + hi) / 2);
+        if (compareEntry(node + NODE_HEADER + mid * e, key, rowID) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+uint32_t BPlusTree::innerChild(const uint8_t* node, uint16_t idx) const {
+    if (idx == 0) return nodeLink(node);
+    return loadU32(node + NODE_HEADER + (idx - 1) * innerEntryBytes() + keyBytes_ + 4);
+}
+
+uint32_t BPlusTree::findLeaf(const Key& key, uint32_t rowID) const {
+    uint32_t pid = root_;
+    const uint8_t* node = page(pid);
+    while (!nodeIsLeaf(node)) {
+        pid = innerChild(node, innerChildIndex(node, key, rowID));
+        node = page(pid);
+    }
+    return pid;
+}
+
+BPlusTree::Split BPlusTree::insertRec(uint32_t pid, const Key& key, uint32_t rowID, bool& inserted) {
+    uint8_t* node = page(pid);
+    const uint16_t n = nodeCount(node);
+
+    if (nodeIsLeaf(node)) {
+        const size_t e = leafEntryBytes();
+        const uint16_t pos = leafLowerBound(node, key, rowID);
+        if (pos < n && compareEntry(node + NODE_HEADER + pos * e, key, rowID) == 0) {
+            inserted = false;
+            return {};
+        }
+        inserted = true;
+
+        std::vector<uint8_t> entry(e);
+        std::memcpy(entry.data(), key.data(), keyBytes_);
+        storeU32(entry.data() + keyBytes_, rowID);
+
+        if (n < leafCapacity()) {
+            uint8_t* at = node + NODE_HEADER + pos * e;
+            std::memmove(at + e, at, (n - pos) * e);
+            std::memcpy(at, entry.data(), e);
+            setNodeCount(node, n + 1);
+            writePage(pid);
+            return {};
+        }
+
+        // Split: left keeps the lower half, right takes the rest.
+        std::vector<uint8_t> tmp((n + 1) * e);
+        const uint8_t* src = node + NODE_HEADER;
+        std::memcpy(tmp.data(), src, pos * e);
+        std::memcpy(tmp.data() + pos * e, entry.data(), e);
+        std::memcpy(tmp.data() + (pos + 1) * e, src + pos * e, (n - pos) * e);
+
+        const uint16_t leftN  = static_cast<uint16_t>((n + 1) / 2);
+        const uint16_t rightN = static_cast<uint16_t>(n + 1 - leftN);
+        const uint32_t right = allocPage(/*leaf=*/true);
+        uint8_t* rnode = page(right);
+        node = page(pid);
+
+        std::memcpy(node + NODE_HEADER, tmp.data(), leftN * e);
+        setNodeCount(node, leftN);
+        std::memcpy(rnode + NODE_HEADER, tmp.data() + leftN * e, rightN * e);
+        setNodeCount(rnode, rightN);
+        setNodeLink(rnode, nodeLink(node));
+        setNodeLink(node, right);
+        writePage(right);
+        writePage(pid);
+
+        Split s;
+        s.happened = true;
+        s.key.assign(reinterpret_cast<const char*>(rnode + NODE_HEADER), keyBytes_);
+        s.rowID = loadU32(rnode + NODE_HEADER + keyBytes_);
+        s.right = right;
+        return s;
+    }
+
+    const uint16_t idx = innerChildIndex(node, key, rowID);
+    const Split child = insertRec(innerChild(node, idx), key, rowID, inserted);
+    if (!child.happened) return {};
+
+    // The new separator sits at entry position idx, pointing at the new right child.
+    node = page(pid);
+    const size_t e = innerEntryBytes();
+    std::vector<uint8_t> entry(e);
+    std::memcpy(entry.data(), child.key.data(), keyBytes_);
+    storeU32(entry.data() + keyBytes_, child.rowID);
+    storeU32(entry.data() + keyBytes_ + 4, child.right);
+
+    if (n < innerCapacity()) {
+        uint8_t* at = node + NODE_HEADER + idx * e;
+        std::memmove(at + e, at, (n - idx) * e);
+        std::memcpy(at, entry.data(), e);
+        setNodeCount(node, n + 1);
+        writePage(pid);
+        return {};
+    }
+
+    std::vector<uint8_t> tmp((n + 1) * e);
+    const uint8_t* src = node + NODE_HEADER;
+    std::memcpy(tmp.data(), src, idx * e);
+    std::memcpy(tmp.data() + idx * e, entry.data(), e);
+    std::memcpy(tmp.data() + (idx + 1) * e, src + idx * e, (n - idx) * e);
+
+    // The middle separator moves up; its child becomes the right node's child0.
+    const uint16_t mid = static_cast<uint16_t>((n + 1) / 2);
+    const uint8_t* up = tmp.data() + mid * e;
+    const uint32_t right = allocPage(/*leaf=*/false);
+    uint8_t* rnode = page(right);
+    node = page(pid);
+
+    std::memcpy(node + NODE_HEADER, tmp.data(), mid * e);
+    setNodeCount(node, mid);
+    setNodeLink(rnode, loadU32(up + keyBytes_ + 4));
+    const uint16_t rightN = static_cast<uint16_t>(n - mid);
+    std::memcpy(rnode + NODE_HEADER, up + e, rightN * e);
+    setNodeCount(rnode, rightN);
+    writePage(right);
+    writePage(pid);
+
+    Split s;
+    s.happened = true;
+    s.key.assign(reinterpret_cast<const char*>(up), keyBytes_);
+    s.rowID = loadU32(up + keyBytes_);
+    s.right = right;
+    return s;
+}
+
+bool BPlusTree::insert(const Key& key, uint32_t rowID) {
+    if (key.size() != keyBytes_) throw std::invalid_argument("index key has wrong width");
+    bool inserted = false;
+    const Split s = insertRec(root_, key, rowID, inserted);
+    if (s.happened) {
+        const uint32_t newRoot = allocPage(/*leaf=*/false);
+        uint8_t* node = page(newRoot);
+        setNodeLink(node, root_);
+        uint8_t* at = node + NODE_HEADER;
+        std::memcpy(at, s.key.data(), keyBytes_);
+        storeU32(at + keyBytes_, s.rowID);
+        storeU32(at + keyBytes_ + 4, s.right);
+        setNodeCount(node, 1);
+        writePage(newRoot);
+        root_ = newRoot;
+        writeHeader();
+    }
+    if (inserted) ++entryCount_;
+    return inserted;
+}
+
+bool BPlusTree::erase(const Key& key, uint32_t rowID) {
+    if (key.size() != keyBytes_) throw std::invalid_argument("index key has wrong width");
+    const uint32_t pid = findLeaf(key, rowID);
+    uint8_t* node = page(pid);
+    const uint16_t n = nodeCount(node);
+    const size_t e = leafEntryBytes();
+    const uint16_t pos = leafLowerBound(node, key, rowID);
+    if (pos >= n || compareEntry(node + NODE_HEADER + pos * e, key, rowID) != 0)
+        return false;
+
+    uint8_t* at = node + NODE_HEADER + pos * e;
+    std::memmove(at, at + e, (n - pos - 1) * e);
+    setNodeCount(node, n - 1);
+    writePage(pid);
+    --entryCount_;
+    return true;
+}
+
+bool BPlusTree::scanRange(const Key& lo, const Key& hi,
+                          const std::function<bool(const Key&, uint32_t)>& fn) const {
+    if (lo.size() != keyBytes_ || hi.size() != keyBytes_)
+        throw std::invalid_argument("index key has wrong width");
+    uint32_t pid = findLeaf(lo, 0);
+    const uint8_t* node = page(pid);
+    uint16_t pos = leafLowerBound(node, lo, 0);
+    const size_t e = leafEntryBytes();
+    Key key(keyBytes_, '\0');
+
+    while (true) {
+        const uint16_t n = nodeCount(node);
+        for (; pos < n; ++pos) {
+            const uint8_t* entry = node + NODE_HEADER + pos * e;
+            if (std::memcmp(entry, hi.data(), keyBytes_) > 0) return true;
+            key.assign(reinterpret_cast<const char*>(entry), keyBytes_);
+            if (!fn(key, loadU32(entry + keyBytes_))) return false;
+        }
+        pid = nodeLink(node);
+        if (pid == 0) return true;
+        node = page(pid);
+        pos = 0;
+    }
+}
+
+void BPlusTree::bulkLoad(const std::vector<std::pair<Key, uint32_t>>& sorted) {
+    if (::ftruncate(fd_, 0) != 0) throwErrno("truncate index failed");
+    cache_.clear();
+    pageCount_ = 1;
+    entryCount_ = sorted.size();
+
+    struct LevelEntry { const Key* key; uint32_t rowID; uint32_t pid; };
+    std::vector<LevelEntry> level;
+
+    // Leaves, packed full and linked left to right.
+    const uint16_t leafCap = leafCapacity();
+    const size_t le = leafEntryBytes();
+    uint32_t prevLeaf = 0;
+    for (size_t i = 0; i < sorted.size() || level.empty(); i += leafCap) {
+        const uint32_t pid = allocPage(/*leaf=*/true);
+        uint8_t* node = page(pid);
+        const size_t end = std::min(sorted.size(), i + leafCap);
+        for (size_t j = i; j < end; ++j) {
+            uint8_t* at = node + NODE_HEADER + (j - i) * le;
+            std::memcpy(at, sorted[j].first.data(), keyBytes_);
+            storeU32(at + keyBytes_, sorted[j].second);
+        }
+        setNodeCount(node, static_cast<uint16_t>(end - i));
+        if (prevLeaf) {
+            setNodeLink(page(prevLeaf), pid);
+            writePage(prevLeaf);
+        }
+        prevLeaf = pid;
+        if (i < sorted.size()) level.push_back({&sorted[i].first, sorted[i].second, pid});
+        else level.push_back({nullptr, 0, pid});
+    }
+    writePage(prevLeaf);
+
+    // Internal levels: each node takes up to innerCap + 1 children.
+    const uint16_t fanout = static_cast<uint16_t>(innerCapacity() + 1);
+    const size_t ie = innerEntryBytes();
+    while (level.size() > 1) {
+        std::vector<LevelEntry> next;
+        for (size_t i = 0; i < level.size(); i += fanout) {
+            const size_t end = std::min(level.size(), i + fanout);
+            const uint32_t pid = allocPage(/*leaf=*/false);
+            uint8_t* node = page(pid);
+            setNodeLink(node, level[i].pid);
+            for (size_t j = i + 1; j < end; ++j) {
+                uint8_t* at = node + NODE_HEADER + (j - i - 1) * ie;
+                std::memcpy(at, level[j].key->data(), keyBytes_);
+                storeU32(at + keyBytes_, level[j].rowID);
+                storeU32(at + keyBytes_ + 4, level[j].pid);
+            }
+            setNodeCount(node, static_cast<uint16_t>(end - i - 1));
+            writePage(pid);
+            next.push_back(level[i]);
+            next.back().pid = pid;
+        }
+        level = std::move(next);
+    }
+
+    root_ = level.front().pid;
+    writeHeader();
+}
+
+void BPlusTree::sync() {
+    if (fd_ < 0) return;
+    writeHeader();
+    ::fsync(fd_);
+}
+
+BPlusTree::Key BPlusTree::encodeString(const std::string& value) {
+    Key key(kStringKeyBytes, '\0');
+    std::memcpy(&key[0], value.data(), std::min<size_t>(value.size(), kStringKeyBytes));
+    return key;
+}
+
+std::pair<BPlusTree::Key, BPlusTree::Key> BPlusTree::prefixRange(const std::string& prefix) {
+    Key lo = encodeString(prefix);
+    Key hi = lo;
+    for (size_t i = prefix.size(); i < kStringKeyBytes; ++i)
+        hi[i] = '\xFF';
+    return {lo, hi};
+}
+
+uint16_t BPlusTree::keyBytesFor(ColType type) {
+    return type == ColType::STRING ? kStringKeyBytes : kNumericKeyBytes;
+}
+
+BPlusTree::Key BPlusTree::encodeKey(const ColValue& value, ColType type) {
+    return type == ColType::STRING ? encodeString(value.str) : encodeNumeric(value, type);
+}
+
+BPlusTree::Key BPlusTree::encodeNumeric(const ColValue& value, ColType type) {
+    // Map each type onto an unsigned 64-bit integer whose numeric order matches
+    // the value order, then store it big-endian so memcmp agrees.
+    uint64_t bits = 0;
+    switch (type) {
+        case ColType::UINT32:
+            bits = value.asU32();
+            break;
+        case ColType::INT64: {
+            const int64_t v = value.type == ColType::INT64 ? value.i64
+                                                           : static_cast<int64_t>(value.toDouble());
+            bits = static_cast<uint64_t>(v) ^ (uint64_t(1) << 63);
+            break;
+        }
+        case ColType::FLOAT:
+        case ColType::DOUBLE: {
+            double d = 0.0;
+            if (type == ColType::FLOAT)
+                d = value.type == ColType::FLOAT ? double(value.f32) : double(float(value.toDouble()));
+            else
+                d = value.type == ColType::DOUBLE ? value.f64 : value.toDouble();
+            if (d == 0.0) d = 0.0;  // fold -0.0 onto +0.0
+            std::memcpy(&bits, &d, sizeof(bits));
+            bits = (bits >> 63) ? ~bits : (bits | (uint64_t(1) << 63));
+            break;
+        }
+        case ColType::STRING:
+            throw std::invalid_argument("numeric index keys require a numeric column");
+    }
+
+    Key key(kNumericKeyBytes, '\0');
+    for (int i = 7; i >= 0; --i) {
+        key[i] = static_cast<char>(bits & 0xFF);
+        bits >>= 8;
+    }
+    return key;
+}
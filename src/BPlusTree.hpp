@@ -0,0 +1,109 @@
+// BPlusTree.hpp — disk-resident B+tree mapping fixed-width keys to rowIDs.
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ValueTypes.hpp"
+
+// Keys are fixed-width byte strings compared with memcmp, so any type with an
+// order-preserving big-endian encoding can be indexed (see encodeNumeric).
+// Each entry is the composite (key, rowID), which keeps entries unique even
+// when many rows share a value: duplicate keys are just adjacent entries.
+//
+// On-disk layout (one file per indexed column, 4 KiB pages):
+//   page 0   header: magic 'BPTI', version, keyBytes, root, pageCount, entryCount
+//   page 1+  nodes:  uint8 isLeaf, uint8 pad, uint16 count, uint32 link
+//            leaf:     link = next leaf (0 = none), entries [key | rowID]
+//            internal: link = child0,               entries [key | rowID | child]
+//
+// Deletes are lazy: entries are removed from their leaf but nodes are never
+// merged. Empty leaves stay linked and are skipped by range scans.
+class BPlusTree {
+public:
+    using Key = std::string;  // exactly keyBytes() bytes
+
+    static constexpr uint32_t kPageSize = 4096;
+
+    BPlusTree(const std::string& path, uint16_t keyBytes);
+    ~BPlusTree();
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Open an existing index file, or create (truncate) a fresh one.
+    void openOrCreate(bool create);
+
+    // Returns false if (key, rowID) was already present / absent.
+    bool insert(const Key& key, uint32_t rowID);
+    bool erase(const Key& key, uint32_t rowID);
+
+    // Visit entries with lo <= key <= hi in key order. fn returns false to stop
+    // early; scanRange then returns false as well.
+    bool scanRange(const Key& lo, const Key& hi,
+                   const std::function<bool(const Key&, uint32_t)>& fn) const;
+
+    // Replace the whole tree with `sorted` (ascending, unique), packing leaves
+    // full. Used when (re)building an index from existing rows.
+    void bulkLoad(const std::vector<std::pair<Key, uint32_t>>& sorted);
+
+    void sync();
+    uint64_t size() const { return entryCount_; }
+    uint16_t keyBytes() const { return keyBytes_; }
+    const std::string& path() const { return path_; }
+
+    // Order-preserving 8-byte encoding for UINT32 / INT64 / FLOAT / DOUBLE.
+    static constexpr uint16_t kNumericKeyBytes = 8;
+    static Key encodeNumeric(const ColValue& value, ColType type);
+
+    // STRING keys are the first 32 bytes of the value, zero-padded. The encoding
+    // is monotone but not injective (long strings share their prefix), so hits
+    // from a string index are candidates to re-check against the stored value.
+    static constexpr uint16_t kStringKeyBytes = 32;
+    static Key encodeString(const std::string& value);
+    // Smallest / largest keys of strings that start with `prefix`.
+    static std::pair<Key, Key> prefixRange(const std::string& prefix);
+
+    // Key width and encoding for an index on a column of `type`.
+    static uint16_t keyBytesFor(ColType type);
+    static Key encodeKey(const ColValue& value, ColType type);
+
+private:
+    struct Split {
+        bool     happened = false;
+        Key      key;
+        uint32_t rowID = 0;
+        uint32_t right = 0;
+    };
+
+    std::string path_;
+    uint16_t    keyBytes_;
+    int         fd_ = -1;
+    uint32_t    root_ = 1;
+    uint32_t    pageCount_ = 0;
+    uint64_t    entryCount_ = 0;
+
+    mutable std::unordered_map<uint32_t, std::vector<uint8_t>> cache_;
+
+    size_t leafEntryBytes() const { return size_t(keyBytes_) + 4; }
+    size_t innerEntryBytes() const { return size_t(keyBytes_) + 8; }
+    uint16_t leafCapacity() const;
+    uint16_t innerCapacity() const;
+
+    uint8_t* page(uint32_t pid) const;
+    uint32_t allocPage(bool leaf);
+    void writePage(uint32_t pid) const;
+    void writeHeader() const;
+    void readHeader();
+
+    int compareEntry(const uint8_t* entry, const Key& key, uint32_t rowID) const;
+    uint16_t leafLowerBound(const uint8_t* node, const Key& key, uint32_t rowID) const;
+    uint16_t innerChildIndex(const uint8_t* node, const Key& key, uint32_t rowID) const;
+    uint32_t innerChild(const uint8_t* node, uint16_t idx) const;
+    uint32_t findLeaf(const Key& key, uint32_t rowID) const;
+
+    Split insertRec(uint32_t pid, const Key& key, uint32_t rowID, bool& inserted);
+};
@@ -0,0 +1,392 @@
+// BitmapIndex.cpp
+#include "BitmapIndex.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+static constexpr uint32_t BMP_MAGIC   = 0x424D5058; // 'BMPX'
+static constexpr uint16_t BMP_VERSION = 1;
+static constexpr size_t   BITMAP_WORDS = 65536 / 64;
+
+template <typename T>
+void put(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+T get(const uint8_t*& p, const uint8_t* end) {
+    if (size_t(end - p) < sizeof(T)) throw std::runtime_error("truncated bitmap data");
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return v;
+}
+
+} // namespace
+
+// ── RoaringBitmap ────────────────────────────────────────────────────────────
+
+size_t RoaringBitmap::findContainer(uint16_t high) const {
+    return static_cast<size_t>(
+        std::lower_bound(containers_.begin(), containers_.end(), high,
+                         [](const Container& c, uint16_t h) { return c.high < h; }) -
+        containers_.begin());
+}
+
+void RoaringBitmap::toBitmap(Container& c) {
+    c.bits.assign(BITMAP_WORDS, 0);
+    for (uint16_t low : c.array) c.bits[low >> 6] |= uint64_t(1) << (low & 63);
+    c.array.clear();
+    c.array.shrink_to_fit();
+    c.isBitmap = true;
+}
+
+void RoaringBitmap::toArray(Container& c) {
+    c.array.clear();
+    c.array.reserve(c.card);
+    for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+        uint64_t word = c.bits[w];
+        while (word) {
+            c.array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+    c.bits.clear();
+    c.bits.shrink_to_fit();
+    c.isBitmap = false;
+}
+
+// Pick the cheaper representation for the container's current cardinality.
+void RoaringBitmap::normalize(Container& c) {
+    if (c.isBitmap && c.card <= kArrayMax) toArray(c);
+    else if (!c.isBitmap && c.card > kArrayMax) toBitmap(c);
+}
+
+void RoaringBitmap::add(uint32_t x) {
+    const uint16_t high = static_cast<uint16_t>(x >> 16);
+    const uint16_t low  = static_cast<uint16_t>(x & 0xFFFF);
+    size_t i = findContainer(high);
+    if (i == containers_.size() || containers_[i].high != high) {
+        Container c;
+        c.high = high;
+        containers_.insert(containers_.begin() + i, std::move(c));
+    }
+    Container& c = containers_[i];
+    if (c.isBitmap) {
+        uint64_t& word = c.bits[low >> 6];
+        const uint64_t mask = uint64_t(1) << (low & 63);
+        if (!(word & mask)) { word |= mask; ++c.card; }
+        return;
+    }
+    auto it = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (it != c.array.end() && *it == low) return;
+    c.array.insert(it, low);
+    ++c.card;
+    normalize(c);
+}
+
+bool RoaringBitmap::remove(uint32_t x) {
+    const uint16_t high = static_cast<uint16_t>(x >> 16);
+    const uint16_t low  = static_cast<uint16_t>(x & 0xFFFF);
+    const size_t i = findContainer(high);
+    if (i == containers_.size() || containers_[i].high != high) return false;
+    Container& c = containers_[i];
+    if (c.isBitmap) {
+        uint64_t& word = c.bits[low >> 6];
+        const uint64_t mask = uint64_t(1) << (low & 63);
+        if (!(word & mask)) return false;
+        word &= ~mask;
+    } else {
+        auto it = std::lower_bound(c.array.begin(), c.array.end(), low);
+        if (it == c.array.end() || *it != low) return false;
+        c.array.erase(it);
+    }
+    if (--c.card == 0) containers_.erase(containers_.begin() + i);
+    else normalize(c);
+    return true;
+}
+
+bool RoaringBitmap::contains(uint32_t x) const {
+    const uint16_t high = static_cast<uint16_t>(x >> 16);
+    const uint16_t low  = static_cast<uint16_t>(x & 0xFFFF);
+    const size_t i = findContainer(high);
+    if (i == containers_.size() || containers_[i].high != high) return false;
+    const Container& c = containers_[i];
+    if (c.isBitmap) return (c.bits[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(c.array.begin(), c.array.end(), low);
+}
+
+uint64_t RoaringBitmap::cardinality() const {
+    uint64_t n = 0;
+    for (const auto& c : containers_) n += c.card;
+    return n;
+}
+
+std::vector<uint32_t> RoaringBitmap::toVector() const {
+    std::vector<uint32_t> out;
+    out.reserve(cardinality());
+    for (const auto& c : containers_) {
+        const uint32_t base = uint32_t(c.high) << 16;
+        if (!c.isBitmap) {
+            for (uint16_t low : c.array) out.push_back(base | low);
+            continue;
+        }
+        for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+            uint64_t word = c.bits[w];
+            while (word) {
+                out.push_back(base | uint32_t(w * 64 + __builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+    }
+    return out;
+}
+
+RoaringBitmap RoaringBitmap::fromSorted(const std::vector<uint32_t>& sorted) {
+    RoaringBitmap bm;
+    size_t i = 0;
+    while (i < sorted.size()) {
+        Container c;
+        c.high = static_cast<uint16_t>(sorted[i] >> 16);
+        for (; i < sorted.size() && (sorted[i] >> 16) == c.high; ++i) {
+            const uint16_t low = static_cast<uint16_t>(sorted[i] & 0xFFFF);
+            if (c.array.empty() || c.array.back() != low) c.array.push_back(low);
+        }
+        c.card = static_cast<uint32_t>(c.array.size());
+        normalize(c);
+        bm.containers_.push_back(std::move(c));
+    }
+    return bm;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    if (&other == this) return *this;
+    std::vector<Container> out;
+    size_t i = 0, j = 0;
+    while (i < containers_.size() && j < other.containers_.size()) {
+        Container& a = containers_[i];
+        const Container& b = other.containers_[j];
+        if (a.high < b.high) { ++i; continue; }
+        if (b.high < a.high) { ++j; continue; }
+
+        Container r;
+        r.high = a.high;
+        if (a.isBitmap && b.isBitmap) {
+            r.isBitmap = true;
+            r.bits.resize(BITMAP_WORDS);
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+                r.bits[w] = a.bits[w] & b.bits[w];
+                r.card += static_cast<uint32_t>(__builtin_popcountll(r.bits[w]));
+            }
+        } else if (a.isBitmap || b.isBitmap) {
+            const Container& arr = a.isBitmap ? b : a;
+            const Container& bmp = a.isBitmap ? a : b;
+            for (uint16_t low : arr.array)
+                if ((bmp.bits[low >> 6] >> (low & 63)) & 1) r.array.push_back(low);
+            r.card = static_cast<uint32_t>(r.array.size());
+        } else {
+            std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                  std::back_inserter(r.array));
+            r.card = static_cast<uint32_t>(r.array.size());
+        }
+        if (r.card > 0) {
+            normalize(r);
+            out.push_back(std::move(r));
+        }
+        ++i;
+        ++j;
+    }
+    containers_ = std::move(out);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+    if (&other == this) return *this;
+    std::vector<Container> out;
+    out.reserve(containers_.size() + other.containers_.size());
+    size_t i = 0, j = 0;
+    while (i < containers_.size() || j < other.containers_.size()) {
+        if (j == other.containers_.size() ||
+            (i < containers_.size() && containers_[i].high < other.containers_[j].high)) {
+            out.push_back(std::move(containers_[i++]));
+            continue;
+        }
+        if (i == containers_.size() || other.containers_[j].high < containers_[i].high) {
+            out.push_back(other.containers_[j++]);
+            continue;
+        }
+
+        Container& a = containers_[i++];
+        const Container& b = other.containers_[j++];
+        Container r;
+        r.high = a.high;
+        if (a.isBitmap || b.isBitmap) {
+            r.isBitmap = true;
+            r.bits = a.isBitmap ? std::move(a.bits) : b.bits;
+            const Container& rest = a.isBitmap ? b : a;
+            if (rest.isBitmap) {
+                for (size_t w = 0; w < BITMAP_WORDS; ++w) r.bits[w] |= rest.bits[w];
+            } else {
+                for (uint16_t low : rest.array) r.bits[low >> 6] |= uint64_t(1) << (low & 63);
+            }
+            for (uint64_t word : r.bits) r.card += static_cast<uint32_t>(__builtin_popcountll(word));
+        } else {
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                           std::back_inserter(r.array));
+            r.card = static_cast<uint32_t>(r.array.size());
+        }
+        normalize(r);
+        out.push_back(std::move(r));
+    }
+    containers_ = std::move(out);
+    return *this;
+}
+
+void RoaringBitmap::serialize(std::string& out) const {
+    put<uint32_t>(out, static_cast<uint32_t>(containers_.size()));
+    for (const auto& c : containers_) {
+        put<uint16_t>(out, c.high);
+        put<uint8_t>(out, c.isBitmap ? 1 : 0);
+        put<uint8_t>(out, 0);
+        put<uint32_t>(out, c.card);
+        if (c.isBitmap)
+            out.append(reinterpret_cast<const char*>(c.bits.data()), BITMAP_WORDS * sizeof(uint64_t));
+        else
+            out.append(reinterpret_cast<const char*>(c.array.data()), c.array.size() * sizeof(uint16_t));
+    }
+}
+
+RoaringBitmap RoaringBitmap::deserialize(const uint8_t*& p, const uint8_t* end) {
+    RoaringBitmap bm;
+    const uint32_t n = get<uint32_t>(p, end);
+    bm.containers_.resize(n);
+    for (auto& c : bm.containers_) {
+        c.high = get<uint16_t>(p, end);
+        c.isBitmap = get<uint8_t>(p, end) != 0;
+        (void)get<uint8_t>(p, end);
+        c.card = get<uint32_t>(p, end);
+        const size_t bytes = c.isBitmap ? BITMAP_WORDS * sizeof(uint64_t) : c.card * sizeof(uint16_t);
+        if (size_t(end - p) < bytes) throw std::runtime_error("truncated bitmap data");
+        if (c.isBitmap) {
+            c.bits.resize(BITMAP_WORDS);
+            std::memcpy(c.bits.data(), p, bytes);
+        } else {
+            c.array.resize(c.card);
+            std::memcpy(c.array.data(), p, bytes);
+        }
+        p += bytes;
+    }
+    return bm;
+}
+
+// ── BitmapIndex ──────────────────────────────────────────────────────────────
+
+BitmapIndex::BitmapIndex(const std::string& path, ColType type)
+  : path_(path), type_(type) {}
+
+std::string BitmapIndex::keyOf(const ColValue& value) const {
+    if (type_ == ColType::STRING) return value.str;
+    const uint32_t v = value.asU32();
+    const char be[4] = {char(v >> 24), char(v >> 16), char(v >> 8), char(v)};
+    return std::string(be, 4);
+}
+
+bool BitmapIndex::load() {
+    const int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    std::vector<uint8_t> buf;
+    bool ok = ::fstat(fd, &st) == 0;
+    if (ok) {
+        buf.resize(size_t(st.st_size));
+        ok = ::pread(fd, buf.data(), buf.size(), 0) == ssize_t(buf.size());
+    }
+    ::close(fd);
+    if (!ok) return false;
+
+    try {
+        const uint8_t* p = buf.data();
+        const uint8_t* end = p + buf.size();
+        if (get<uint32_t>(p, end) != BMP_MAGIC || get<uint16_t>(p, end) != BMP_VERSION) return false;
+        if (static_cast<ColType>(get<uint8_t>(p, end)) != type_) return false;
+        (void)get<uint8_t>(p, end);
+        const uint32_t count = get<uint32_t>(p, end);
+        std::map<std::string, RoaringBitmap> values;
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t keyLen = get<uint32_t>(p, end);
+            if (size_t(end - p) < keyLen) return false;
+            std::string key(reinterpret_cast<const char*>(p), keyLen);
+            p += keyLen;
+            values.emplace(std::move(key), RoaringBitmap::deserialize(p, end));
+        }
+        values_ = std::move(values);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    dirty_ = false;
+    return true;
+}
+
+void BitmapIndex::save() const {
+    std::string out;
+    put<uint32_t>(out, BMP_MAGIC);
+    put<uint16_t>(out, BMP_VERSION);
+    put<uint8_t>(out, static_cast<uint8_t>(type_));
+    put<uint8_t>(out, 0);
+    put<uint32_t>(out, static_cast<uint32_t>(values_.size()));
+    for (const auto& [key, bm] : values_) {
+        put<uint32_t>(out, static_cast<uint32_t>(key.size()));
+        out += key;
+        bm.serialize(out);
+    }
+
+    const std::string tmpPath = path_ + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) throw std::runtime_error("BitmapIndex::save: open temp file failed");
+    if (::pwrite(fd, out.data(), out.size(), 0) != ssize_t(out.size()) || ::fsync(fd) != 0) {
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        throw std::runtime_error("BitmapIndex::save: write temp file failed");
+    }
+    ::close(fd);
+    if (::rename(tmpPath.c_str(), path_.c_str()) != 0) {
+        ::unlink(tmpPath.c_str());
+        throw std::runtime_error("BitmapIndex::save: rename temp file failed");
+    }
+    dirty_ = false;
+}
+
+void BitmapIndex::add(const ColValue& value, uint32_t rowID) {
+    values_[keyOf(value)].add(rowID);
+    dirty_ = true;
+}
+
+void BitmapIndex::remove(const ColValue& value, uint32_t rowID) {
+    auto it = values_.find(keyOf(value));
+    if (it == values_.end() || !it->second.remove(rowID)) return;
+    if (it->second.empty()) values_.erase(it);
+    dirty_ = true;
+}
+
+const RoaringBitmap* BitmapIndex::find(const ColValue& value) const {
+    auto it = values_.find(keyOf(value));
+    return it == values_.end() ? nullptr : &it->second;
+}
+
+RoaringBitmap BitmapIndex::range(uint32_t lo, uint32_t hi) const {
+    RoaringBitmap out;
+    if (lo > hi) return out;
+    auto it  = values_.lower_bound(keyOf(ColValue(lo)));
+    auto end = values_.upper_bound(keyOf(ColValue(hi)));
+    for (; it != end; ++it) out |= it->second;
+    return out;
+}
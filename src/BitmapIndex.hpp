@@ -0,0 +1,88 @@
+// BitmapIndex.hpp — compressed rowID bitmaps per distinct value of a column.
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ValueTypes.hpp"
+
+// Roaring-style bitmap over 32-bit rowIDs. The rowID space is cut into 64K
+// chunks keyed by the high 16 bits; each chunk is a sorted uint16 array while
+// sparse and a 8 KiB bitset once it holds more than kArrayMax values.
+class RoaringBitmap {
+public:
+    static constexpr uint32_t kArrayMax = 4096;
+
+    void add(uint32_t x);
+    bool remove(uint32_t x);
+    bool contains(uint32_t x) const;
+
+    uint64_t cardinality() const;
+    bool empty() const { return containers_.empty(); }
+    std::vector<uint32_t> toVector() const;  // ascending
+
+    static RoaringBitmap fromSorted(const std::vector<uint32_t>& sorted);
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+
+    void serialize(std::string& out) const;
+    // Parses one bitmap starting at p and advances p; throws on truncation.
+    static RoaringBitmap deserialize(const uint8_t*& p, const uint8_t* end);
+
+private:
+    struct Container {
+        uint16_t high = 0;
+        bool     isBitmap = false;
+        uint32_t card = 0;
+        std::vector<uint16_t> array;  // sorted, when !isBitmap
+        std::vector<uint64_t> bits;   // 1024 words, when isBitmap
+    };
+
+    std::vector<Container> containers_;  // sorted by high
+
+    size_t findContainer(uint16_t high) const;  // index of first container >= high
+    static void toBitmap(Container& c);
+    static void toArray(Container& c);
+    static void normalize(Container& c);
+};
+
+// One RoaringBitmap per distinct value of a UINT32 or STRING column, kept in
+// memory and written to <path>.<col>.bmp at checkpoint (temp file + rename).
+// Meant for enum-like columns: createBitmapIndex refuses columns with more than
+// kMaxDistinct values.
+//
+// File layout: magic 'BMPX', uint16 version, uint8 colType, uint8 pad,
+// uint32 valueCount, then per value: uint32 keyLen, key bytes, bitmap.
+class BitmapIndex {
+public:
+    static constexpr size_t kMaxDistinct = 4096;
+
+    BitmapIndex(const std::string& path, ColType type);
+
+    // Returns false when the file is missing or unreadable.
+    bool load();
+    void save() const;
+
+    void add(const ColValue& value, uint32_t rowID);
+    void remove(const ColValue& value, uint32_t rowID);
+
+    // nullptr when no live row holds `value`.
+    const RoaringBitmap* find(const ColValue& value) const;
+    // Union over UINT32 values in [lo, hi].
+    RoaringBitmap range(uint32_t lo, uint32_t hi) const;
+
+    size_t distinctValues() const { return values_.size(); }
+    bool dirty() const { return dirty_; }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string keyOf(const ColValue& value) const;
+
+    std::string path_;
+    ColType     type_;
+    std::map<std::string, RoaringBitmap> values_;  // UINT32 keys are big-endian, so map order = value order
+    mutable bool dirty_ = false;
+};
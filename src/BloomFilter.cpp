@@ -0,0 +1,152 @@
+// BloomFilter.cpp
+#include "BloomFilter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+static constexpr uint32_t BLM_MAGIC   = 0x424C4D46; // 'BLMF'
+static constexpr uint16_t BLM_VERSION = 1;
+
+#pragma pack(push, 1)
+struct BloomHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t bitsPerKey;
+    uint32_t wordsPerPage;
+    uint8_t  numHashes;
+    uint8_t  pad[3];
+};
+#pragma pack(pop)
+static_assert(sizeof(BloomHeader) == 16, "BloomHeader must be 16 bytes");
+
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+[[noreturn]] void throwErrno(const char* what) {
+    throw std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+BloomFilter::BloomFilter(const std::string& path) : path_(path) {}
+
+BloomFilter::~BloomFilter() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void BloomFilter::create(uint32_t slotsPerPage, uint16_t bitsPerKey) {
+    if (bitsPerKey == 0) throw std::invalid_argument("bloom filters need at least one bit per key");
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd_ < 0) throwErrno("open bloom filter failed");
+
+    bitsPerKey_ = bitsPerKey;
+    wordsPerPage_ = std::max<uint32_t>(1, (slotsPerPage * uint32_t(bitsPerKey) + 63) / 64);
+    // k = bits/key * ln 2 minimises the false-positive rate.
+    numHashes_ = static_cast<uint8_t>(std::clamp(std::lround(bitsPerKey * 0.693), 1L, 16L));
+    filters_.clear();
+    dirty_.clear();
+
+    BloomHeader h{BLM_MAGIC, BLM_VERSION, bitsPerKey_, wordsPerPage_, numHashes_, {0, 0, 0}};
+    if (::pwrite(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h)))
+        throwErrno("write bloom filter header failed");
+}
+
+bool BloomFilter::open() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = ::open(path_.c_str(), O_RDWR);
+    if (fd_ < 0) return false;
+    BloomHeader h{};
+    if (::pread(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h)) ||
+        h.magic != BLM_MAGIC || h.version != BLM_VERSION ||
+        h.wordsPerPage == 0 || h.numHashes == 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    bitsPerKey_ = h.bitsPerKey;
+    wordsPerPage_ = h.wordsPerPage;
+    numHashes_ = h.numHashes;
+    filters_.clear();
+    dirty_.clear();
+    return true;
+}
+
+std::vector<uint64_t>& BloomFilter::filter(uint16_t pid) const {
+    if (pid >= filters_.size()) filters_.resize(size_t(pid) + 1);
+    auto& f = filters_[pid];
+    if (f.empty()) {
+        f.assign(wordsPerPage_, 0);
+        const size_t bytes = size_t(wordsPerPage_) * sizeof(uint64_t);
+        const off_t off = off_t(sizeof(BloomHeader)) + off_t(pid) * off_t(bytes);
+        // Short reads past EOF leave zeros: that page has no values yet.
+        if (::pread(fd_, f.data(), bytes, off) < 0) throwErrno("read bloom filter failed");
+    }
+    return f;
+}
+
+void BloomFilter::add(uint16_t pid, uint64_t hash) {
+    auto& f = filter(pid);
+    const uint64_t bits = uint64_t(wordsPerPage_) * 64;
+    const uint64_t h1 = hash, h2 = (hash >> 32) | 1;  // double hashing
+    for (uint8_t i = 0; i < numHashes_; ++i) {
+        const uint64_t bit = (h1 + i * h2) % bits;
+        f[bit >> 6] |= uint64_t(1) << (bit & 63);
+    }
+    dirty_.insert(pid);
+}
+
+bool BloomFilter::mayContain(uint16_t pid, uint64_t hash) const {
+    const auto& f = filter(pid);
+    const uint64_t bits = uint64_t(wordsPerPage_) * 64;
+    const uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+    for (uint8_t i = 0; i < numHashes_; ++i) {
+        const uint64_t bit = (h1 + i * h2) % bits;
+        if (!((f[bit >> 6] >> (bit & 63)) & 1)) return false;
+    }
+    return true;
+}
+
+void BloomFilter::flush() {
+    const size_t bytes = size_t(wordsPerPage_) * sizeof(uint64_t);
+    for (uint16_t pid : dirty_) {
+        const off_t off = off_t(sizeof(BloomHeader)) + off_t(pid) * off_t(bytes);
+        if (::pwrite(fd_, filters_[pid].data(), bytes, off) != ssize_t(bytes))
+            throwErrno("write bloom filter failed");
+    }
+    dirty_.clear();
+}
+
+void BloomFilter::sync() {
+    if (fd_ < 0) return;
+    flush();
+    ::fsync(fd_);
+}
+
+uint64_t BloomFilter::hashOf(const ColValue& value, ColType type) {
+    switch (type) {
+        case ColType::UINT32:
+            return mix(value.asU32());
+        case ColType::STRING: {
+            uint64_t h = 1469598103934665603ULL;  // FNV-1a 64
+            for (unsigned char ch : value.str) {
+                h ^= ch;
+                h *= 1099511628211ULL;
+            }
+            return mix(h);
+        }
+        default:
+            throw std::invalid_argument("bloom filters require a UINT32 or STRING column");
+    }
+}
@@ -0,0 +1,58 @@
+// BloomFilter.hpp — per-page Bloom filters for one column (.blm sidecar).
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ValueTypes.hpp"
+
+// One fixed-size filter per column page, sized from the page's slot count and
+// a bits-per-key budget. Filters only ever gain bits: a slot that is deleted
+// and reused leaves its old value behind, which costs false positives but
+// never a false negative. Rebuilding (Table::createBloomFilter, recovery)
+// starts from empty filters.
+//
+// File layout: header { magic 'BLMF', uint16 version, uint16 bitsPerKey,
+// uint32 wordsPerPage, uint8 numHashes, pad } followed by filter[pid] =
+// wordsPerPage little-endian uint64 words at 16 + pid * wordsPerPage * 8.
+class BloomFilter {
+public:
+    static constexpr uint16_t kDefaultBitsPerKey = 10;
+
+    explicit BloomFilter(const std::string& path);
+    ~BloomFilter();
+    BloomFilter(const BloomFilter&) = delete;
+    BloomFilter& operator=(const BloomFilter&) = delete;
+
+    // Truncate and size filters for pages holding `slotsPerPage` values.
+    void create(uint32_t slotsPerPage, uint16_t bitsPerKey);
+    // Open an existing file; returns false if missing or malformed.
+    bool open();
+
+    // Set the bits for `hash` in page pid's filter (in memory until flush()).
+    void add(uint16_t pid, uint64_t hash);
+    bool mayContain(uint16_t pid, uint64_t hash) const;
+
+    void flush();  // write filters touched since the last flush
+    void sync();   // flush + fsync
+
+    uint16_t bitsPerKey() const { return bitsPerKey_; }
+    const std::string& path() const { return path_; }
+
+    // Filter hash for a UINT32 or STRING value.
+    static uint64_t hashOf(const ColValue& value, ColType type);
+
+private:
+    std::string path_;
+    int         fd_ = -1;
+    uint16_t    bitsPerKey_ = 0;
+    uint32_t    wordsPerPage_ = 0;
+    uint8_t     numHashes_ = 0;
+
+    mutable std::vector<std::vector<uint64_t>> filters_;  // by pid; empty = not loaded
+    std::unordered_set<uint16_t> dirty_;
+
+    std::vector<uint64_t>& filter(uint16_t pid) const;
+};
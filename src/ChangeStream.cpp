@@ -0,0 +1,81 @@
+#include "ChangeStream.hpp"
+#include "MasterPage.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Reading from the end may race a checkpoint; it starts over this many times.
+constexpr int kFromEndAttempts = 8;
+
+std::vector<ColType> loadSchema(const std::string& tablePath) {
+    const int fd = ::open(tablePath.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("open table failed: " + std::string(std::strerror(errno)));
+    try {
+        auto colTypes = MasterPage::load(fd).colTypes;
+        ::close(fd);
+        return colTypes;
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+} // namespace
+
+ChangeStream::ChangeStream(const std::string& tablePath, uint64_t after)
+    : tail_(tablePath, loadSchema(tablePath)) {
+    if (after == kFromStart) {
+        tail_.rewind();
+    } else if (after == kFromEnd) {
+        // Read the log through once, keeping only what awaits a commit.
+        bool caughtUp = false;
+        for (int attempt = 0; attempt < kFromEndAttempts && !caughtUp; ++attempt) {
+            tail_.rewind();
+            caughtUp = tail_.poll([](const Wal::Operation&) {});
+        }
+        if (!caughtUp) throw Lost("WAL keeps moving past the stream; try again");
+    } else {
+        lastOpID_ = after & ((uint64_t(1) << kPositionOpIDBits) - 1);
+        const auto generation = uint16_t(after >> kPositionOpIDBits);
+        if (!tail_.resume(generation, lastOpID_ + 1))
+            throw Lost("changes after position " + std::to_string(after) + " are no longer in the WAL");
+        position_ = after;
+        return;
+    }
+    lastOpID_ = tail_.settledOpID() - 1;
+    position_ = makePosition(tail_.generation(), lastOpID_);
+}
+
+bool ChangeStream::next(Wal::Operation& change) {
+    if (ready_.empty()) {
+        const bool followed = tail_.poll([&](const Wal::Operation& op) {
+            // A batch is read whole; a resumed stream skips what it returned.
+            if (op.opID > lastOpID_) ready_.push_back(op);
+        });
+        if (!followed) {
+            ready_.clear();
+            throw Lost("WAL moved past position " + std::to_string(position_));
+        }
+        if (ready_.empty()) {
+            settle();
+            return false;
+        }
+    }
+    change = std::move(ready_.front());
+    ready_.pop_front();
+    lastOpID_ = change.opID;
+    position_ = makePosition(tail_.generation(), lastOpID_);
+    return true;
+}
+
+// Caught up: move past opIDs that will never be changes (a transaction a crash
+// cut off before its commit record), so resuming does not need them.
+void ChangeStream::settle() {
+    lastOpID_ = std::max(lastOpID_, tail_.settledOpID() - 1);
+    position_ = makePosition(tail_.generation(), lastOpID_);
+}
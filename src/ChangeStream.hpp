@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+
+#include "Wal.hpp"
+
+// Change data capture: the committed inserts and deletes of a table, read from
+// its WAL in commit order, so a consumer (a cache, a materialized aggregate)
+// can process only what changed instead of rescanning. The table may be open
+// in this process or another one, with a durability level other than Off.
+//
+// Each change has a position: the log's generation (see Wal::rebase) above
+// kPositionOpIDBits, its opID below. Positions only grow within a generation,
+// and a stream opened at one resumes right after it. Only the live log can be
+// read, so a position older than the last checkpoint, or from before
+// compaction, DDL or unlogged writes renumbered the table, is Lost; the
+// consumer then starts over from the table itself.
+class ChangeStream {
+public:
+    static constexpr unsigned kPositionOpIDBits = 48;
+    // Positions to open at, besides one returned by position().
+    static constexpr uint64_t kFromStart = 0;          // the oldest change in the log
+    static constexpr uint64_t kFromEnd = UINT64_MAX;   // only changes committed from now on
+
+    // The changes after `after` can no longer be read from the log.
+    struct Lost : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    // `tablePath` is the table's file (<name>.mdb). Throws Lost if `after`
+    // cannot be resumed.
+    explicit ChangeStream(const std::string& tablePath, uint64_t after = kFromStart);
+
+    // The next committed change, or false when there are none yet. Throws Lost
+    // once the log has moved past the stream.
+    bool next(Wal::Operation& change);
+    // Of the last change returned, or later once caught up; open a stream here
+    // to resume.
+    uint64_t position() const { return position_; }
+    const std::vector<ColType>& schema() const { return tail_.schema(); }
+
+    static uint64_t makePosition(uint16_t generation, uint64_t opID) {
+        return (uint64_t(generation) << kPositionOpIDBits) | opID;
+    }
+
+private:
+    WalTail tail_;
+    std::deque<Wal::Operation> ready_;
+    uint64_t position_ = 0;
+    uint64_t lastOpID_ = 0;  // position_'s opID
+
+    void settle();
+};
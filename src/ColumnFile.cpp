@@ -1,6 +1,7 @@
 // ColumnFile.cpp
 #include "ColumnFile.hpp"
 #include "ValueTypes.hpp"
+#include "Crc32c.hpp"
 #include <fcntl.h>
 #include <unistd.h>
 #include <cassert>
@@ -8,7 +9,10 @@
 #include <cstdio>
 #include <vector>
 #include <cstring>
+#include <functional>
 #include <limits>
+#include <mutex>
+#include <stdexcept>
 
 // On-disk layout (little-endian):
 //   [0..1]   uint16_t pageID
@@ -19,8 +23,13 @@
 //   [12..15] uint32_t maxValue (low 32 bits of zone-map max, legacy compat)
 //   [16 .. 16 + cap*valueBytes - 1]                values[] (typed)
 //   [16 + cap*valueBytes .. + cap - 1]              tombstone bytes (1 per slot)
+//   [pageSize - 4 .. pageSize - 1]  uint32_t CRC32C of bytes [0, pageSize - 4),
+//                                   only when MasterPage::kFlagPageChecksums is set
 //
 // valueBytes is derived from the column's ColType stored in MasterPage.
+// Pages are read and written whole, in one pread/pwrite. Writes are deferred:
+// a changed page stays in pageCache_ and is marked dirty until a checkpoint
+// captures its image.
 
 #pragma pack(push, 1)
 struct DiskPageHeader {
@@ -34,14 +43,24 @@ struct DiskPageHeader {
 #pragma pack(pop)
 static_assert(sizeof(DiskPageHeader) == 16, "DiskPageHeader must be 16 bytes");
 
-static uint16_t computeCapacity(uint16_t pageSize, uint16_t vbytes) {
-    if (pageSize < sizeof(DiskPageHeader)) return 0;
-    const uint32_t usable = pageSize - uint32_t(sizeof(DiskPageHeader));
+static constexpr uint16_t kChecksumBytes = sizeof(uint32_t);
+
+static uint16_t computeCapacity(uint16_t pageSize, uint16_t vbytes, uint16_t trailerBytes) {
+    if (pageSize < sizeof(DiskPageHeader) + trailerBytes) return 0;
+    const uint32_t usable = pageSize - uint32_t(sizeof(DiskPageHeader)) - trailerBytes;
     const uint32_t per    = uint32_t(vbytes) + 1u; // value bytes + 1 tombstone byte
     const uint32_t cap    = per ? (usable / per) : 0u;
     return static_cast<uint16_t>(cap > 0xFFFF ? 0xFFFF : cap);
 }
 
+uint16_t ColumnFile::slotsPerPage() const {
+    return computeCapacity(pageSize_, valueBytes_, pageChecksums() ? kChecksumBytes : 0);
+}
+
+bool ColumnFile::pageChecksums() const {
+    return (mp_.flags & MasterPage::kFlagPageChecksums) != 0;
+}
+
 uint16_t ColumnFile::pageCount() const {
     struct stat st{};
     if (fstat(fd_, &st) != 0) return 0;
@@ -50,6 +69,13 @@ uint16_t ColumnFile::pageCount() const {
 }
 
 std::pair<ValueType, ValueType> ColumnFile::zoneMap(uint16_t pageID) const {
+    // A cached page may be newer than its on-disk header.
+    {
+        std::shared_lock<std::shared_mutex> lock(cacheLock_.mu);
+        auto it = pageCache_.find(pageID);
+        if (it != pageCache_.end()) return { it->second.minValue, it->second.maxValue };
+    }
+
     DiskPageHeader hdr{};
     const off_t base = off_t(pageID) * off_t(pageSize_);
     if (pread(fd_, &hdr, sizeof(hdr), base) != ssize_t(sizeof(hdr))) {
@@ -88,19 +114,24 @@ ColumnFile::~ColumnFile() {
 uint16_t ColumnFile::allocateOrFetchPage() {
     uint16_t pid = headPageID();
     if (pid == UINT16_MAX) {
-        off_t end = lseek(fd_, 0, SEEK_END);
-        assert(end >= 0);
+        off_t end;
+        {
+            // Columns share the file, and recovery fills them from several
+            // threads. They share the MasterPage too, which picks the lock.
+            static std::mutex extendMu[16];
+            std::lock_guard<std::mutex> lock(extendMu[std::hash<const MasterPage*>{}(&mp_) % 16]);
+            end = lseek(fd_, 0, SEEK_END);
+            assert(end >= 0);
+            if (ftruncate(fd_, end + pageSize_) == -1) perror("ftruncate");
+        }
         pid = static_cast<uint16_t>(end / pageSize_);
 
-        if (ftruncate(fd_, end + pageSize_) == -1) perror("ftruncate");
-
-        const uint16_t cap = computeCapacity(pageSize_, valueBytes_);
+        const uint16_t cap = slotsPerPage();
         ColumnPage page(pid, cap, valueBytes_);
         page.nextFreePage = UINT16_MAX;
-        flushPage(page);
+        storePage(std::move(page));
 
         setHeadPageID(pid);
-        flushMaster();
     }
     return pid;
 }
@@ -109,22 +140,37 @@ ColumnPage ColumnFile::loadPage(uint16_t pageID) const {
     // Cache hit — return a copy of the cached page
     auto it = pageCache_.find(pageID);
     if (it != pageCache_.end()) return it->second;
+    return pageCache_.emplace(pageID, readPage(pageID)).first->second;
+}
 
-    // Cache miss — read from disk
+ColumnPage ColumnFile::readPage(uint16_t pageID) const {
     const off_t base = off_t(pageID) * off_t(pageSize_);
+    std::vector<uint8_t> image(pageSize_, 0);
+    const ssize_t got = pread(fd_, image.data(), image.size(), base);
 
     DiskPageHeader hdr{};
-    if (pread(fd_, &hdr, sizeof(hdr), base) != ssize_t(sizeof(hdr))) {
+    if (got < ssize_t(sizeof(hdr))) {
         std::perror("ColumnFile::loadPage pread(header)");
-        const uint16_t cap = computeCapacity(pageSize_, valueBytes_);
+        const uint16_t cap = slotsPerPage();
         ColumnPage page(pageID, cap, valueBytes_);
         page.count = 0;
         page.nextFreePage = UINT16_MAX;
-        pageCache_.emplace(pageID, page);
         return page;
     }
+    if (got != ssize_t(image.size()))
+        std::perror("ColumnFile::loadPage pread(page)");
+    std::memcpy(&hdr, image.data(), sizeof(hdr));
+
+    if (pageChecksums()) {
+        uint32_t stored = 0;
+        std::memcpy(&stored, image.data() + pageSize_ - kChecksumBytes, sizeof(stored));
+        const bool blank = stored == 0 && hdr.capacity == 0 && hdr.count == 0;  // never flushed
+        if (!blank && Crc32c::value(image.data(), pageSize_ - kChecksumBytes) != stored)
+            throw std::runtime_error("column page " + std::to_string(pageID) +
+                                     " failed checksum (torn or corrupt write)");
+    }
 
-    const uint16_t maxCap = computeCapacity(pageSize_, valueBytes_);
+    const uint16_t maxCap = slotsPerPage();
     const uint16_t cap    = (hdr.capacity > maxCap) ? maxCap : hdr.capacity;
 
     ColumnPage page(pageID, cap, valueBytes_);
@@ -132,22 +178,13 @@ ColumnPage ColumnFile::loadPage(uint16_t pageID) const {
     page.nextFreePage = hdr.nextFreePage;
 
     const size_t valuesBytes = size_t(cap) * valueBytes_;
-    const off_t  valuesOff   = base + sizeof(DiskPageHeader);
-    if (valuesBytes) {
-        if (pread(fd_, page.rawValues.data(), valuesBytes, valuesOff)
-                != ssize_t(valuesBytes))
-            std::perror("ColumnFile::loadPage pread(values)");
-    }
+    const size_t valuesOff   = sizeof(DiskPageHeader);
+    if (valuesBytes)
+        std::memcpy(page.rawValues.data(), image.data() + valuesOff, valuesBytes);
 
-    const size_t tombBytes = size_t(cap);
-    const off_t  tombOff   = valuesOff + off_t(valuesBytes);
-    if (tombBytes) {
-        std::vector<uint8_t> tmp(tombBytes, 0);
-        if (pread(fd_, tmp.data(), tombBytes, tombOff) != ssize_t(tombBytes))
-            std::perror("ColumnFile::loadPage pread(tombstone)");
-        for (size_t i = 0; i < cap; ++i)
-            page.tombstone[i] = (tmp[i] != 0);
-    }
+    const uint8_t* tomb = image.data() + valuesOff + valuesBytes;
+    for (size_t i = 0; i < cap; ++i)
+        page.tombstone[i] = (tomb[i] != 0);
 
     page.minValue   = static_cast<ValueType>(hdr.minValue);
     page.maxValue   = static_cast<ValueType>(hdr.maxValue);
@@ -156,50 +193,48 @@ ColumnPage ColumnFile::loadPage(uint16_t pageID) const {
 
     if (page.count == 0 || page.minValue > page.maxValue)
         page.recomputeMinMax();
-
-    pageCache_.emplace(pageID, page);
     return page;
 }
 
-void ColumnFile::flushPage(const ColumnPage &page) {
-    const off_t base = off_t(page.pageID) * off_t(pageSize_);
-
-    ColumnPage copy = page;
-    copy.recomputeMinMax();
+void ColumnFile::storePage(ColumnPage &&page) {
+    page.recomputeMinMax();
+    const uint16_t pid = page.pageID;
+    auto it = pageCache_.insert_or_assign(pid, std::move(page)).first;
+    dirty_[pid] = &it->second;
+}
 
+std::vector<uint8_t> ColumnFile::pageImage(const ColumnPage &page) const {
     DiskPageHeader hdr{};
-    hdr.pageID       = copy.pageID;
-    hdr.capacity     = copy.capacity;
-    hdr.count        = copy.count;
-    hdr.nextFreePage = copy.nextFreePage;
-    hdr.minValue     = static_cast<uint32_t>(copy.minValue);
-    hdr.maxValue     = static_cast<uint32_t>(copy.maxValue);
-
-    if (pwrite(fd_, &hdr, sizeof(hdr), base) != ssize_t(sizeof(hdr))) {
-        std::perror("ColumnFile::flushPage pwrite(header)"); return;
-    }
-
-    const size_t valuesBytes = size_t(copy.capacity) * valueBytes_;
-    const off_t  valuesOff   = base + sizeof(DiskPageHeader);
-    if (valuesBytes) {
-        if (pwrite(fd_, copy.rawValues.data(), valuesBytes, valuesOff)
-                != ssize_t(valuesBytes)) {
-            std::perror("ColumnFile::flushPage pwrite(values)"); return;
-        }
-    }
-
-    const size_t tombBytes = size_t(copy.capacity);
-    const off_t  tombOff   = valuesOff + off_t(valuesBytes);
-    if (tombBytes) {
-        std::vector<uint8_t> tmp(tombBytes, 0);
-        for (size_t i = 0; i < copy.capacity; ++i)
-            tmp[i] = copy.tombstone[i] ? 1u : 0u;
-        if (pwrite(fd_, tmp.data(), tombBytes, tombOff) != ssize_t(tombBytes))
-            std::perror("ColumnFile::flushPage pwrite(tombstone)");
+    hdr.pageID       = page.pageID;
+    hdr.capacity     = page.capacity;
+    hdr.count        = page.count;
+    hdr.nextFreePage = page.nextFreePage;
+    hdr.minValue     = static_cast<uint32_t>(page.minValue);
+    hdr.maxValue     = static_cast<uint32_t>(page.maxValue);
+
+    std::vector<uint8_t> image(pageSize_, 0);
+    std::memcpy(image.data(), &hdr, sizeof(hdr));
+    const size_t valuesBytes = size_t(page.capacity) * valueBytes_;
+    const size_t valuesOff   = sizeof(DiskPageHeader);
+    if (valuesBytes)
+        std::memcpy(image.data() + valuesOff, page.rawValues.data(), valuesBytes);
+    uint8_t* tomb = image.data() + valuesOff + valuesBytes;
+    for (size_t i = 0; i < page.capacity; ++i)
+        tomb[i] = page.tombstone[i] ? 1u : 0u;
+    if (pageChecksums()) {
+        const uint32_t crc = Crc32c::value(image.data(), pageSize_ - kChecksumBytes);
+        std::memcpy(image.data() + pageSize_ - kChecksumBytes, &crc, sizeof(crc));
     }
+    return image;
+}
 
-    // Keep the in-memory cache in sync with what was just written
-    pageCache_.insert_or_assign(page.pageID, page);
+size_t ColumnFile::captureDirty(std::vector<Extent>& out) {
+    const size_t n = dirty_.size();
+    out.reserve(out.size() + n);
+    for (const auto& [pid, page] : dirty_)
+        out.push_back({ off_t(pid) * off_t(pageSize_), pageImage(*page) });
+    dirty_.clear();
+    return n;
 }
 
 // ── Legacy UINT32 API ────────────────────────────────────────────────────────
@@ -217,13 +252,8 @@ std::optional<ValueType> ColumnFile::fetchSlot(uint32_t id) {
 
 // ── Typed API ────────────────────────────────────────────────────────────────
 
-uint32_t ColumnFile::allocTypedSlot(const ColValue& val) {
-    const uint16_t pid = allocateOrFetchPage();
-
-    ColumnPage page = loadPage(pid);
-    int16_t slot = page.findFreeSlot();
-    assert(slot >= 0);
-
+void ColumnFile::writeSlot(ColumnPage &page, uint16_t slot, const ColValue &val,
+                           std::string &heap, off_t heapEnd) {
     // Write the right number of bytes based on colType_
     switch (colType_) {
         case ColType::UINT32: { uint32_t v = val.asU32();        page.writeRaw(slot, &v, 4); break; }
@@ -231,26 +261,71 @@ uint32_t ColumnFile::allocTypedSlot(const ColValue& val) {
         case ColType::FLOAT:  { float    v = val.f32;            page.writeRaw(slot, &v, 4); break; }
         case ColType::DOUBLE: { double   v = val.f64;            page.writeRaw(slot, &v, 8); break; }
         case ColType::STRING: {
-            off_t end = lseek(heapFd_, 0, SEEK_END);
-            uint32_t heapOff = static_cast<uint32_t>(end);
-            uint32_t len     = static_cast<uint32_t>(val.str.size());
-            if (len > 0)
-                pwrite(heapFd_, val.str.data(), len, end);
-            uint32_t pair[2] = { heapOff, len };
+            // The bytes are staged in `heap`, which the caller appends at heapEnd.
+            uint32_t pair[2] = { static_cast<uint32_t>(heapEnd + off_t(heap.size())),
+                                 static_cast<uint32_t>(val.str.size()) };
+            heap += val.str;
             page.writeRaw(slot, pair, 8);
             break;
         }
     }
     page.markUsed(slot);
+}
+
+void ColumnFile::appendHeap(const std::string &heap, off_t heapEnd) {
+    if (heap.empty()) return;
+    writeExtents(heapFd_, { Extent{ heapEnd, std::vector<uint8_t>(heap.begin(), heap.end()) } },
+                 "string heap");
+}
+
+uint32_t ColumnFile::allocTypedSlot(const ColValue& val) {
+    uint16_t pid = allocateOrFetchPage();
 
-    if (page.count == page.capacity) {
+    ColumnPage page = loadPage(pid);
+    int16_t slot = page.findFreeSlot();
+    if (slot < 0) {
+        // A crash between a checkpoint's page writes and its master page write
+        // can leave the head naming a page that filled up since; move on.
         setHeadPageID(UINT16_MAX);
-        flushMaster();
+        pid  = allocateOrFetchPage();
+        page = loadPage(pid);
+        slot = page.findFreeSlot();
     }
-    flushPage(page);
+    assert(slot >= 0);
+
+    std::string heap;
+    const off_t heapEnd = heapFd_ >= 0 ? lseek(heapFd_, 0, SEEK_END) : 0;
+    writeSlot(page, uint16_t(slot), val, heap, heapEnd);
+    appendHeap(heap, heapEnd);
+
+    if (page.count == page.capacity)
+        setHeadPageID(UINT16_MAX);
+    storePage(std::move(page));
     return (uint32_t(pid) << 16) | uint32_t(slot);
 }
 
+void ColumnFile::allocTypedSlots(const std::vector<const ColValue*>& values, std::vector<uint32_t>& out) {
+    out.clear();
+    out.reserve(values.size());
+    std::string heap;
+    const off_t heapEnd = heapFd_ >= 0 ? lseek(heapFd_, 0, SEEK_END) : 0;
+    size_t i = 0;
+    while (i < values.size()) {
+        const uint16_t pid = allocateOrFetchPage();
+        ColumnPage page = loadPage(pid);
+        for (uint16_t slot = 0; slot < page.capacity && i < values.size(); ++slot) {
+            if (page.tombstone[slot]) continue;
+            writeSlot(page, slot, *values[i++], heap, heapEnd);
+            out.push_back((uint32_t(pid) << 16) | uint32_t(slot));
+        }
+        // Full now, or already full (see allocTypedSlot): the next page takes over.
+        if (page.count == page.capacity)
+            setHeadPageID(UINT16_MAX);
+        storePage(std::move(page));
+    }
+    appendHeap(heap, heapEnd);
+}
+
 const ColumnPage& ColumnFile::pageRef(uint16_t pid) const {
     auto it = pageCache_.find(pid);
     if (it != pageCache_.end()) return it->second;
@@ -258,10 +333,25 @@ const ColumnPage& ColumnFile::pageRef(uint16_t pid) const {
     return pageCache_.at(pid);
 }
 
+// Cache nodes never move, so the reference outlives the lock.
+const ColumnPage& ColumnFile::sharedPageRef(uint16_t pid) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(cacheLock_.mu);
+        auto it = pageCache_.find(pid);
+        if (it != pageCache_.end()) return it->second;
+    }
+    // Misses read in parallel; a page another thread cached meanwhile wins.
+    ColumnPage page = readPage(pid);
+    std::unique_lock<std::shared_mutex> lock(cacheLock_.mu);
+    return pageCache_.emplace(pid, std::move(page)).first->second;
+}
+
 std::optional<ColValue> ColumnFile::fetchTypedSlot(uint32_t id) const {
-    const uint16_t pid  = pageIdFromSlotId(id);
-    const uint16_t slot = slotIdxFromSlotId(id);
-    const ColumnPage& page = pageRef(pid);  // no copy — reference into cache
+    // No copy — reference into cache.
+    return readSlot(pageRef(pageIdFromSlotId(id)), slotIdxFromSlotId(id));
+}
+
+std::optional<ColValue> ColumnFile::readSlot(const ColumnPage& page, uint16_t slot) const {
     if (slot >= page.capacity) return std::nullopt;
     if (!page.tombstone[slot]) return std::nullopt;
 
@@ -293,20 +383,13 @@ void ColumnFile::deleteSlot(uint32_t id) {
     const bool wasFull = (page.count == page.capacity);
     if (page.tombstone[slot]) page.markDeleted(slot);
 
-    if (wasFull) {
+    if (wasFull)
         setHeadPageID(pid);
-        flushMaster();
-    }
-    flushPage(page);
-}
-
-void ColumnFile::flushMaster() {
-    mp_.flush(fd_);
+    storePage(std::move(page));
 }
 
-void ColumnFile::syncData() const {
-    if (fd_ >= 0) fsync(fd_);
-    if (heapFd_ >= 0) fsync(heapFd_);
+void ColumnFile::syncHeap() const {
+    syncFile(heapFd_, "string heap");
 }
 
 void ColumnFile::packStringsForGPU(const std::vector<uint32_t>& slotIDs,
@@ -4,8 +4,11 @@
 #include <string>
 #include <optional>
 #include <cstdint>
+#include <shared_mutex>
 #include <utility>
 #include <unordered_map>
+#include <vector>
+#include "Extent.hpp"
 #include "MasterPage.hpp"
 #include "ValueTypes.hpp"
 #include "Column.hpp"
@@ -28,23 +31,41 @@ public:
 
     // ── Typed API ────────────────────────────────────────────────────────────
     uint32_t             allocTypedSlot(const ColValue& val);
+    // Bulk form for recovery: fills each page once and appends the batch's
+    // string bytes in one write. out[i] is the slotID of *values[i]. Different
+    // columns of one table may run this concurrently.
+    void                 allocTypedSlots(const std::vector<const ColValue*>& values,
+                                         std::vector<uint32_t>& out);
     std::optional<ColValue> fetchTypedSlot(uint32_t id) const;
+    // The value in `slot` of a page of this column; nullopt if it is not live.
+    std::optional<ColValue> readSlot(const ColumnPage& page, uint16_t slot) const;
 
     // Delete (tombstone) a slot, returning its space to the free-page list
     void deleteSlot(uint32_t id);
 
-    // Persist any changes to the MasterPage (e.g. updated head-pointer)
-    void flushMaster();
-    void syncData() const;
+    // Pages are write-back: changes stay in the page cache until a checkpoint
+    // captures them. Appends one image per page dirtied since the last capture
+    // (offsets into the table file) and marks them clean; returns how many.
+    // Head-pointer changes live in the MasterPage, which the checkpoint writes.
+    size_t captureDirty(std::vector<Extent>& out);
+    size_t dirtyPages() const { return dirty_.size(); }
+    // String heaps are appended in place; this makes them durable.
+    void syncHeap() const;
 
     // Number of pages = file_size / pageSize_
     uint16_t pageCount() const;
 
-    // Cheap zone-map read (header-only): returns {minValue, maxValue} as uint32_t
+    // Cheap zone-map read: from the cached page, else its on-disk header.
+    // Returns {minValue, maxValue} as uint32_t
     std::pair<ValueType, ValueType> zoneMap(uint16_t pageID) const;
 
     ColType colType() const { return colType_; }
 
+    // Slots per page for this column's value width (less the checksum trailer).
+    uint16_t slotsPerPage() const;
+    // Pages carry a CRC32C trailer verified on every load (MasterPage flag).
+    bool pageChecksums() const;
+
     // For STRING columns: pack live-row strings into Arrow-style GPU layout.
     // slotIDs: one slotID per live row for this column (in rowIndex iteration order).
     // outChars: concatenated UTF-8 bytes of all strings.
@@ -60,6 +81,10 @@ public:
     // Ensure a page is in the cache and return a const reference (no copy).
     // Only safe while no mutation of pageCache_ occurs.
     const ColumnPage& pageRef(uint16_t pageID) const;
+    // pageRef for parallel scans: several threads may call it (and zoneMap)
+    // at once, as long as no other cache access runs meanwhile. Hits share
+    // this column's cache lock; a miss reads the page before taking it.
+    const ColumnPage& sharedPageRef(uint16_t pageID) const;
 
 private:
     int fd_;            // OS file descriptor for this column file
@@ -73,13 +98,32 @@ private:
 
     // In-memory page cache: avoids re-reading pages from disk on every fetchSlot
     mutable std::unordered_map<uint16_t, ColumnPage> pageCache_;
+    // Pages changed since the last capture, pointing into pageCache_ (its
+    // nodes never move), so a capture does not search the cache.
+    std::unordered_map<uint16_t, const ColumnPage*> dirty_;
+
+    // Guards pageCache_ among the threads of a parallel scan (sharedPageRef,
+    // zoneMap). A copied ColumnFile gets a lock of its own.
+    struct CacheLock {
+        std::shared_mutex mu;
+        CacheLock() = default;
+        CacheLock(const CacheLock&) {}
+    };
+    mutable CacheLock cacheLock_;
 
     // Load or create a page with free slots; returns its pageID
     uint16_t allocateOrFetchPage();
 
-    // Read / write a typed page (loadPage populates pageCache_)
+    // Read / write a typed page (loadPage populates pageCache_; readPage
+    // only decodes it from the file)
     ColumnPage loadPage(uint16_t pageID) const;
-    void flushPage(const ColumnPage &page);
+    ColumnPage readPage(uint16_t pageID) const;
+    void storePage(ColumnPage &&page);
+    std::vector<uint8_t> pageImage(const ColumnPage &page) const;
+    // Store val in a free slot; STRING bytes are staged in `heap` for appendHeap.
+    void writeSlot(ColumnPage &page, uint16_t slot, const ColValue &val,
+                   std::string &heap, off_t heapEnd);
+    void appendHeap(const std::string &heap, off_t heapEnd);
 
 
     // Helpers to get/set the head of our free-page list
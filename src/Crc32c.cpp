@@ -0,0 +1,111 @@
+// Crc32c.cpp
+#include "Crc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define MDB_CRC32C_SSE42 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define MDB_CRC32C_ARM 1
+#endif
+
+namespace {
+
+constexpr uint32_t kPolyReflected = 0x82F63B78u;
+
+using SliceTables = std::array<std::array<uint32_t, 256>, 8>;
+
+constexpr SliceTables makeTables() {
+    SliceTables t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+            c = (c & 1) ? (c >> 1) ^ kPolyReflected : c >> 1;
+        t[0][i] = c;
+    }
+    for (size_t s = 1; s < 8; ++s)
+        for (uint32_t i = 0; i < 256; ++i)
+            t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+    return t;
+}
+
+constexpr SliceTables kTables = makeTables();
+
+// Operates on the inverted register; callers handle pre/post inversion.
+uint32_t sliceBy8(uint32_t crc, const uint8_t* p, size_t n) {
+    while (n && (reinterpret_cast<uintptr_t>(p) & 7)) {
+        crc = kTables[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        --n;
+    }
+    while (n >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);  // little-endian hosts only, as is the file format
+        w ^= crc;
+        crc = kTables[7][w & 0xFF] ^ kTables[6][(w >> 8) & 0xFF] ^
+              kTables[5][(w >> 16) & 0xFF] ^ kTables[4][(w >> 24) & 0xFF] ^
+              kTables[3][(w >> 32) & 0xFF] ^ kTables[2][(w >> 40) & 0xFF] ^
+              kTables[1][(w >> 48) & 0xFF] ^ kTables[0][w >> 56];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = kTables[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#if defined(MDB_CRC32C_SSE42)
+__attribute__((target("sse4.2")))
+uint32_t hardware(uint32_t crc, const uint8_t* p, size_t n) {
+    uint64_t c = crc;
+    while (n >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        c = _mm_crc32_u64(c, w);
+        p += 8;
+        n -= 8;
+    }
+    uint32_t c32 = static_cast<uint32_t>(c);
+    while (n--) c32 = _mm_crc32_u8(c32, *p++);
+    return c32;
+}
+
+bool detectHardware() { return __builtin_cpu_supports("sse4.2"); }
+#elif defined(MDB_CRC32C_ARM)
+uint32_t hardware(uint32_t crc, const uint8_t* p, size_t n) {
+    while (n >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        crc = __crc32cd(crc, w);
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+bool detectHardware() { return true; }
+#else
+uint32_t hardware(uint32_t crc, const uint8_t* p, size_t n) { return sliceBy8(crc, p, n); }
+bool detectHardware() { return false; }
+#endif
+
+const bool kHardware = detectHardware();
+
+} // namespace
+
+namespace Crc32c {
+
+uint32_t extend(uint32_t crc, const void* data, size_t n) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    return ~(kHardware ? hardware(~crc, p, n) : sliceBy8(~crc, p, n));
+}
+
+uint32_t extendPortable(uint32_t crc, const void* data, size_t n) {
+    return ~sliceBy8(~crc, static_cast<const uint8_t*>(data), n);
+}
+
+bool hardwareAccelerated() { return kHardware; }
+
+}
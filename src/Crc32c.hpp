@@ -0,0 +1,20 @@
+// Crc32c.hpp — CRC-32C (Castagnoli) for WAL records and column pages.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Uses the SSE4.2 crc32 instruction (x86-64, detected at runtime) or the ARMv8
+// CRC32 extension (when the compiler targets it), and a slicing-by-8 table
+// walk elsewhere. `extend` chains: extend(extend(0, a), b) == value(a ++ b),
+// so headers and payloads can be checksummed in place without a joined copy.
+namespace Crc32c {
+
+uint32_t extend(uint32_t crc, const void* data, size_t n);
+inline uint32_t value(const void* data, size_t n) { return extend(0, data, n); }
+
+// Table-driven path, always available; exposed so tests can cross-check.
+uint32_t extendPortable(uint32_t crc, const void* data, size_t n);
+bool hardwareAccelerated();
+
+}
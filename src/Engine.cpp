@@ -2,43 +2,164 @@
 #include "GroupBy.hpp"
 #include "Join.hpp"
 #include <cassert>
+#include <stdexcept>
 
 std::string Engine::tablePath(const std::string& name) const {
     return name + ".mdb"; 
 }
 
+ThreadPool& Engine::pool() {
+    if (!pool_) pool_ = std::make_shared<ThreadPool>(parallelism_);
+    return *pool_;
+}
+
+Table& Engine::track(const std::string& name, std::shared_ptr<Table> table) {
+    table->setDurability(durability_);
+    pool();
+    table->setThreadPool(pool_);
+    tables_[name] = table;
+    return *table;
+}
+
+void Engine::requireWritable() const {
+    if (readOnly_) throw std::invalid_argument("engine is read-only");
+}
+
 Table& Engine::createTable(const std::string& name, uint16_t numCols, uint16_t pageSize) {
-    auto p = std::make_shared<Table>(tablePath(name), pageSize, numCols);
-    tables_[name] = p;
-    return *p;
+    requireWritable();
+    return track(name, std::make_shared<Table>(tablePath(name), pageSize, numCols));
 }
 
 Table& Engine::createTypedTable(const std::string& name,
                                 const std::vector<ColType>& colTypes,
                                 uint16_t pageSize) {
-    auto p = std::make_shared<Table>(tablePath(name), pageSize, colTypes);
-    tables_[name] = p;
-    return *p;
+    requireWritable();
+    return track(name, std::make_shared<Table>(tablePath(name), pageSize, colTypes));
 }
 
 Table& Engine::openTable(const std::string& name) {
     auto it = tables_.find(name);
     if (it != tables_.end()) return *(it->second);
-    auto p = std::make_shared<Table>(tablePath(name));
-    tables_[name] = p;
-    return *p;
+    if (readOnly_) throw std::invalid_argument("table is not attached to this read-only engine");
+    return track(name, std::make_shared<Table>(tablePath(name)));
+}
+
+Table& Engine::writableTable(const std::string& name) {
+    requireWritable();
+    return openTable(name);
+}
+
+void Engine::attachTable(const std::string& name, std::shared_ptr<Table> table) {
+    pool();
+    table->setThreadPool(pool_);
+    tables_[name] = std::move(table);
 }
 
 void Engine::flush(const std::string& name) {
-    openTable(name).flushDurable();
+    writableTable(name).flushDurable();
+}
+
+void Engine::setGroupCommit(const std::string& name, bool on) {
+    writableTable(name).setGroupCommit(on);
+}
+
+void Engine::setDurability(const std::string& name, Table::Durability level) {
+    writableTable(name).setDurability(level);
+}
+
+void Engine::setDurability(Table::Durability level) {
+    requireWritable();
+    durability_ = level;
+    for (auto& entry : tables_)
+        entry.second->setDurability(level);
+}
+
+void Engine::setParallelism(size_t threads) {
+    parallelism_ = threads;
+    pool_.reset();
+    pool();
+    for (auto& entry : tables_)
+        entry.second->setThreadPool(pool_);
+}
+
+size_t Engine::parallelism() {
+    return pool().size();
+}
+
+void Engine::setCheckpointPolicy(const std::string& name, const Table::CheckpointPolicy& policy) {
+    writableTable(name).setCheckpointPolicy(policy);
+}
+
+Table::CheckpointStats Engine::checkpointStats(const std::string& name) {
+    return openTable(name).checkpointStats();
+}
+
+void Engine::begin(const std::string& name) {
+    writableTable(name).begin();
+}
+
+void Engine::commit(const std::string& name) {
+    writableTable(name).commit();
+}
+
+void Engine::rollback(const std::string& name) {
+    writableTable(name).rollback();
+}
+
+std::vector<uint32_t> Engine::compact(const std::string& name) {
+    return writableTable(name).compact();
+}
+
+void Engine::createIndex(const std::string& name, uint16_t col) {
+    writableTable(name).createIndex(col);
+}
+
+void Engine::dropIndex(const std::string& name, uint16_t col) {
+    writableTable(name).dropIndex(col);
+}
+
+void Engine::createHashIndex(const std::string& name, uint16_t col) {
+    writableTable(name).createHashIndex(col);
+}
+
+void Engine::dropHashIndex(const std::string& name, uint16_t col) {
+    writableTable(name).dropHashIndex(col);
+}
+
+void Engine::createBitmapIndex(const std::string& name, uint16_t col) {
+    writableTable(name).createBitmapIndex(col);
+}
+
+void Engine::dropBitmapIndex(const std::string& name, uint16_t col) {
+    writableTable(name).dropBitmapIndex(col);
+}
+
+void Engine::createBloomFilter(const std::string& name, uint16_t col) {
+    writableTable(name).createBloomFilter(col);
+}
+
+void Engine::dropBloomFilter(const std::string& name, uint16_t col) {
+    writableTable(name).dropBloomFilter(col);
 }
 
 uint32_t Engine::insert(const std::string& name, const std::vector<ValueType>& row) {
-    return openTable(name).insertRow(row);
+    return writableTable(name).insertRow(row);
 }
 
 uint32_t Engine::insertTyped(const std::string& name, const std::vector<ColValue>& row) {
-    return openTable(name).insertTypedRow(row);
+    return writableTable(name).insertTypedRow(row);
+}
+
+void Engine::setPrimaryKey(const std::string& name, uint16_t col) {
+    writableTable(name).setPrimaryKey(col);
+}
+
+std::optional<uint32_t> Engine::getByKey(const std::string& name, const ColValue& key) {
+    return openTable(name).findByKey(key);
+}
+
+uint32_t Engine::upsert(const std::string& name, const std::vector<ColValue>& row) {
+    return writableTable(name).upsertTypedRow(row);
 }
 
 std::vector<uint32_t> Engine::whereEq(const std::string& name, uint16_t col, ValueType v) {
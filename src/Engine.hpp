@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -15,10 +16,54 @@ public:
                             const std::vector<ColType>& colTypes,
                             uint16_t pageSize = 4096);
     Table& openTable(const std::string& name);
+    // Serve an already open table as `name`, e.g. a Replica's copy; the engine
+    // shares it rather than opening the file again.
+    void attachTable(const std::string& name, std::shared_ptr<Table> table);
+    // A read-only engine serves only tables already open or attached, and
+    // refuses writes, DDL and transactions with std::invalid_argument.
+    void setReadOnly(bool on) { readOnly_ = on; }
+    bool readOnly() const { return readOnly_; }
     void flush(const std::string& name);
+    // Make each insert/delete wait for a (batched) WAL sync before returning.
+    void setGroupCommit(const std::string& name, bool on);
+    // Per-table durability level (see Table::Durability).
+    void setDurability(const std::string& name, Table::Durability level);
+    // Engine-wide: applies to every open table and to tables opened later.
+    void setDurability(Table::Durability level);
+    Table::Durability durability() const { return durability_; }
+    // Threads for morsel-driven scans, counting the caller, shared by every
+    // table of this engine (see ThreadPool); 0 = hardware concurrency, the
+    // default, and 1 keeps scans on the calling thread.
+    void setParallelism(size_t threads);
+    size_t parallelism();
+    // Background checkpoints by WAL size and/or age (see Table::CheckpointPolicy).
+    void setCheckpointPolicy(const std::string& name, const Table::CheckpointPolicy& policy);
+    Table::CheckpointStats checkpointStats(const std::string& name);
+    // Group the table's writes until commit into one WAL batch (see Table::begin).
+    void begin(const std::string& name);
+    void commit(const std::string& name);
+    void rollback(const std::string& name);
+    // Drop deleted rows from the row index; returns old rowID -> new rowID.
+    std::vector<uint32_t> compact(const std::string& name);
+    // Build / remove a B+tree index on a numeric column.
+    void createIndex(const std::string& name, uint16_t col);
+    void dropIndex(const std::string& name, uint16_t col);
+    // Build / remove a hash index on a UINT32 or STRING column.
+    void createHashIndex(const std::string& name, uint16_t col);
+    void dropHashIndex(const std::string& name, uint16_t col);
+    // Build / remove a bitmap index on a low-cardinality UINT32 or STRING column.
+    void createBitmapIndex(const std::string& name, uint16_t col);
+    void dropBitmapIndex(const std::string& name, uint16_t col);
+    // Build / remove per-page Bloom filters on a UINT32 or STRING column.
+    void createBloomFilter(const std::string& name, uint16_t col);
+    void dropBloomFilter(const std::string& name, uint16_t col);
 
     uint32_t insert(const std::string& name, const std::vector<ValueType>& row);
     uint32_t insertTyped(const std::string& name, const std::vector<ColValue>& row);
+    // Primary key: declare once per table, then point-read and upsert by key.
+    void setPrimaryKey(const std::string& name, uint16_t col);
+    std::optional<uint32_t> getByKey(const std::string& name, const ColValue& key);
+    uint32_t upsert(const std::string& name, const std::vector<ColValue>& row);
     std::vector<uint32_t> whereEq(const std::string& name, uint16_t col, ValueType v);
     std::vector<uint32_t> whereEqString(const std::string& name, uint16_t col, const std::string& needle);
     std::vector<uint32_t> whereBetween(const std::string& name, uint16_t col, ValueType lo, ValueType hi);
@@ -42,5 +87,14 @@ public:
 
 private:
     std::unordered_map<std::string, std::shared_ptr<Table>> tables_;
+    Table::Durability durability_ = Table::Durability::Normal;
+    bool readOnly_ = false;
+    size_t parallelism_ = 0;
+    std::shared_ptr<ThreadPool> pool_;  // started with the first table
+    ThreadPool& pool();
+    Table& track(const std::string& name, std::shared_ptr<Table> table);
+    void requireWritable() const;
+    // openTable for the calls that write.
+    Table& writableTable(const std::string& name);
     std::string tablePath(const std::string& name) const;
 };
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/types.h>
+#include <unistd.h>
+#include <vector>
+
+// A byte range captured for a later pwrite. Checkpoints serialize dirty pages
+// and index entries into these under the write lock and write them after
+// releasing it.
+struct Extent {
+    off_t offset = 0;
+    std::vector<uint8_t> bytes;
+};
+
+inline void writeExtents(int fd, const std::vector<Extent>& extents, const char* what) {
+    for (const auto& extent : extents) {
+        size_t done = 0;
+        while (done < extent.bytes.size()) {
+            const ssize_t n = ::pwrite(fd, extent.bytes.data() + done, extent.bytes.size() - done,
+                                       extent.offset + off_t(done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0)
+                throw std::runtime_error(std::string(what) + " write failed: " + std::strerror(errno));
+            done += size_t(n);
+        }
+    }
+}
+
+inline void syncFile(int fd, const char* what) {
+    if (fd >= 0 && ::fsync(fd) != 0)
+        throw std::runtime_error(std::string(what) + " fsync failed: " + std::strerror(errno));
+}
+
+// Makes a rename of `path` durable: fsyncs the directory that holds it.
+inline void syncParentDir(const std::string& path, const char* what) {
+    const size_t slash = path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    const int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string(what) + " open directory failed: " + std::strerror(errno));
+    const int rc = ::fsync(fd);
+    const int err = errno;
+    ::close(fd);
+    if (rc != 0)
+        throw std::runtime_error(std::string(what) + " directory fsync failed: " + std::strerror(err));
+}
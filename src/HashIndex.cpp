@@ -0,0 +1,356 @@
+// HashIndex.cpp
+#include "HashIndex.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+static constexpr uint32_t HIDX_MAGIC      = 0x48494458; // 'HIDX'
+static constexpr uint16_t HIDX_VERSION    = 1;
+static constexpr uint32_t INITIAL_BUCKETS = 4;
+static constexpr size_t   BUCKET_HEADER   = 8;
+static constexpr size_t   ENTRY_BYTES     = 12;
+static constexpr uint16_t BUCKET_CAPACITY =
+    static_cast<uint16_t>((HashIndex::kPageSize - BUCKET_HEADER) / ENTRY_BYTES);
+static constexpr uint32_t DIR_SLOTS       = HashIndex::kPageSize / 4 - 1;
+
+#pragma pack(push, 1)
+struct HashHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t level;
+    uint32_t next;
+    uint32_t bucketCount;
+    uint32_t dirHead;
+    uint32_t freeHead;
+    uint32_t pageCount;
+    uint64_t entryCount;
+};
+#pragma pack(pop)
+static_assert(sizeof(HashHeader) == 40, "HashHeader must be 40 bytes");
+
+struct Entry {
+    uint64_t key;
+    uint32_t rowID;
+};
+
+inline uint16_t entryCountOf(const uint8_t* p) { uint16_t n; std::memcpy(&n, p, 2); return n; }
+inline void setEntryCountOf(uint8_t* p, uint16_t n) { std::memcpy(p, &n, 2); }
+inline uint32_t overflowLink(const uint8_t* p) { uint32_t v; std::memcpy(&v, p + 4, 4); return v; }
+inline void setOverflowLink(uint8_t* p, uint32_t v) { std::memcpy(p + 4, &v, 4); }
+
+inline Entry readEntry(const uint8_t* p, uint16_t i) {
+    Entry e;
+    const uint8_t* at = p + BUCKET_HEADER + i * ENTRY_BYTES;
+    std::memcpy(&e.key, at, 8);
+    std::memcpy(&e.rowID, at + 8, 4);
+    return e;
+}
+
+inline void writeEntry(uint8_t* p, uint16_t i, const Entry& e) {
+    uint8_t* at = p + BUCKET_HEADER + i * ENTRY_BYTES;
+    std::memcpy(at, &e.key, 8);
+    std::memcpy(at + 8, &e.rowID, 4);
+}
+
+// splitmix64 finalizer: UINT32 keys are often dense, so spread them before
+// taking the bucket modulus.
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+[[noreturn]] void throwErrno(const char* what) {
+    throw std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+HashIndex::HashIndex(const std::string& path) : path_(path) {}
+
+HashIndex::~HashIndex() {
+    if (fd_ >= 0) {
+        writeHeader();
+        ::close(fd_);
+    }
+}
+
+void HashIndex::openOrCreate(bool create) {
+    if (fd_ >= 0) ::close(fd_);
+    cache_.clear();
+    dir_.clear();
+    dirPages_.clear();
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd_ < 0) throwErrno("open hash index failed");
+
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) throwErrno("stat hash index failed");
+    if (!create && st.st_size >= off_t(kPageSize)) {
+        readHeader();
+        const uint32_t filePages = static_cast<uint32_t>(st.st_size / kPageSize);
+        if (filePages > pageCount_) pageCount_ = filePages;
+        loadDirectory();
+        return;
+    }
+
+    if (::ftruncate(fd_, 0) != 0) throwErrno("truncate hash index failed");
+    level_ = 0;
+    next_ = 0;
+    bucketCount_ = 0;
+    dirHead_ = 0;
+    freeHead_ = 0;
+    pageCount_ = 1;
+    entryCount_ = 0;
+    for (uint32_t b = 0; b < INITIAL_BUCKETS; ++b) {
+        const uint32_t pid = allocPage();
+        writePage(pid);
+        appendBucket(pid);
+    }
+    writeHeader();
+}
+
+void HashIndex::readHeader() {
+    HashHeader h{};
+    if (::pread(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h)))
+        throwErrno("read hash index header failed");
+    if (h.magic != HIDX_MAGIC || h.version != HIDX_VERSION)
+        throw std::runtime_error("invalid hash index header: " + path_);
+    level_ = h.level;
+    next_ = h.next;
+    bucketCount_ = h.bucketCount;
+    dirHead_ = h.dirHead;
+    freeHead_ = h.freeHead;
+    pageCount_ = h.pageCount;
+    entryCount_ = h.entryCount;
+}
+
+void HashIndex::writeHeader() const {
+    if (fd_ < 0) return;
+    HashHeader h{HIDX_MAGIC, HIDX_VERSION, 0, level_, next_, bucketCount_,
+                 dirHead_, freeHead_, pageCount_, entryCount_};
+    if (::pwrite(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h)))
+        throwErrno("write hash index header failed");
+}
+
+void HashIndex::loadDirectory() {
+    dir_.reserve(bucketCount_);
+    uint32_t dp = dirHead_;
+    while (dir_.size() < bucketCount_) {
+        if (dp == 0) throw std::runtime_error("truncated hash index directory: " + path_);
+        dirPages_.push_back(dp);
+        const uint8_t* p = page(dp);
+        for (uint32_t i = 0; i < DIR_SLOTS && dir_.size() < bucketCount_; ++i) {
+            uint32_t pid;
+            std::memcpy(&pid, p + 4 + i * 4, 4);
+            dir_.push_back(pid);
+        }
+        std::memcpy(&dp, p, 4);
+    }
+}
+
+void HashIndex::appendBucket(uint32_t firstPage) {
+    const uint32_t b = bucketCount_++;
+    dir_.push_back(firstPage);
+    const uint32_t dirIdx = b / DIR_SLOTS;
+    if (dirIdx == dirPages_.size()) {
+        const uint32_t dp = allocPage();
+        if (dirPages_.empty()) {
+            dirHead_ = dp;
+        } else {
+            std::memcpy(page(dirPages_.back()), &dp, 4);
+            writePage(dirPages_.back());
+        }
+        dirPages_.push_back(dp);
+    }
+    uint8_t* p = page(dirPages_[dirIdx]);
+    std::memcpy(p + 4 + (b % DIR_SLOTS) * 4, &firstPage, 4);
+    writePage(dirPages_[dirIdx]);
+}
+
+uint8_t* HashIndex::page(uint32_t pid) const {
+    auto it = cache_.find(pid);
+    if (it != cache_.end()) return it->second.data();
+
+    std::vector<uint8_t> buf(kPageSize, 0);
+    const off_t off = off_t(pid) * off_t(kPageSize);
+    if (::pread(fd_, buf.data(), kPageSize, off) != ssize_t(kPageSize))
+        throwErrno("read hash index page failed");
+    return cache_.emplace(pid, std::move(buf)).first->second.data();
+}
+
+uint32_t HashIndex::allocPage() {
+    if (freeHead_ != 0) {
+        const uint32_t pid = freeHead_;
+        uint8_t* p = page(pid);
+        freeHead_ = overflowLink(p);
+        std::memset(p, 0, kPageSize);
+        return pid;
+    }
+    const uint32_t pid = pageCount_++;
+    cache_.insert_or_assign(pid, std::vector<uint8_t>(kPageSize, 0));
+    return pid;
+}
+
+void HashIndex::freePage(uint32_t pid) {
+    uint8_t* p = page(pid);
+    std::memset(p, 0, kPageSize);
+    setOverflowLink(p, freeHead_);
+    freeHead_ = pid;
+    writePage(pid);
+}
+
+void HashIndex::writePage(uint32_t pid) const {
+    const off_t off = off_t(pid) * off_t(kPageSize);
+    if (::pwrite(fd_, page(pid), kPageSize, off) != ssize_t(kPageSize))
+        throwErrno("write hash index page failed");
+}
+
+uint32_t HashIndex::bucketFor(uint64_t key) const {
+    const uint64_t h = mix(key);
+    uint64_t b = h % (uint64_t(INITIAL_BUCKETS) << level_);
+    if (b < next_) b = h % (uint64_t(INITIAL_BUCKETS) << (level_ + 1));
+    return static_cast<uint32_t>(b);
+}
+
+bool HashIndex::insert(uint64_t key, uint32_t rowID) {
+    uint32_t pid = dir_[bucketFor(key)];
+    uint32_t target = 0, last = 0;
+    while (pid != 0) {
+        const uint8_t* p = page(pid);
+        const uint16_t n = entryCountOf(p);
+        for (uint16_t i = 0; i < n; ++i) {
+            const Entry e = readEntry(p, i);
+            if (e.key == key && e.rowID == rowID) return false;
+        }
+        if (target == 0 && n < BUCKET_CAPACITY) target = pid;
+        last = pid;
+        pid = overflowLink(p);
+    }
+    if (target == 0) {
+        target = allocPage();
+        setOverflowLink(page(last), target);
+        writePage(last);
+    }
+
+    uint8_t* p = page(target);
+    const uint16_t n = entryCountOf(p);
+    writeEntry(p, n, {key, rowID});
+    setEntryCountOf(p, n + 1);
+    writePage(target);
+    ++entryCount_;
+
+    // Split one bucket whenever the average fill passes 3/4 of a page.
+    if (entryCount_ * 4 > uint64_t(bucketCount_) * BUCKET_CAPACITY * 3) split();
+    return true;
+}
+
+void HashIndex::split() {
+    const uint32_t oldB = next_;
+    std::vector<uint32_t> oldPages;
+    std::vector<Entry> entries;
+    for (uint32_t pid = dir_[oldB]; pid != 0; pid = overflowLink(page(pid))) {
+        oldPages.push_back(pid);
+        const uint8_t* p = page(pid);
+        for (uint16_t i = 0; i < entryCountOf(p); ++i)
+            entries.push_back(readEntry(p, i));
+    }
+
+    const uint32_t newFirst = allocPage();
+    appendBucket(newFirst);
+    if (++next_ == (INITIAL_BUCKETS << level_)) {
+        ++level_;
+        next_ = 0;
+    }
+
+    std::vector<Entry> stay, move;
+    for (const Entry& e : entries)
+        (bucketFor(e.key) == oldB ? stay : move).push_back(e);
+
+    // Refill a chain from `entries`, reusing `pages` first and allocating beyond
+    // them; unused reused pages go back on the free list.
+    auto rewrite = [&](std::vector<uint32_t> pages, const std::vector<Entry>& src) {
+        size_t used = 0, i = 0;
+        do {
+            const uint32_t pid = used < pages.size() ? pages[used] : allocPage();
+            if (used >= pages.size()) {
+                setOverflowLink(page(pages[used - 1]), pid);
+                writePage(pages[used - 1]);
+                pages.push_back(pid);
+            }
+            ++used;
+            uint8_t* p = page(pid);
+            const uint16_t take = static_cast<uint16_t>(std::min<size_t>(BUCKET_CAPACITY, src.size() - i));
+            for (uint16_t k = 0; k < take; ++k) writeEntry(p, k, src[i + k]);
+            setEntryCountOf(p, take);
+            setOverflowLink(p, 0);
+            i += take;
+            writePage(pid);
+        } while (i < src.size());
+        for (size_t k = used; k < pages.size(); ++k) freePage(pages[k]);
+    };
+    rewrite(oldPages, stay);
+    rewrite({newFirst}, move);
+    writeHeader();
+}
+
+bool HashIndex::erase(uint64_t key, uint32_t rowID) {
+    for (uint32_t pid = dir_[bucketFor(key)]; pid != 0; pid = overflowLink(page(pid))) {
+        uint8_t* p = page(pid);
+        const uint16_t n = entryCountOf(p);
+        for (uint16_t i = 0; i < n; ++i) {
+            const Entry e = readEntry(p, i);
+            if (e.key != key || e.rowID != rowID) continue;
+            writeEntry(p, i, readEntry(p, n - 1));
+            setEntryCountOf(p, n - 1);
+            writePage(pid);
+            --entryCount_;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint32_t> HashIndex::lookup(uint64_t key) const {
+    std::vector<uint32_t> out;
+    for (uint32_t pid = dir_[bucketFor(key)]; pid != 0; pid = overflowLink(page(pid))) {
+        const uint8_t* p = page(pid);
+        const uint16_t n = entryCountOf(p);
+        for (uint16_t i = 0; i < n; ++i) {
+            const Entry e = readEntry(p, i);
+            if (e.key == key) out.push_back(e.rowID);
+        }
+    }
+    return out;
+}
+
+void HashIndex::sync() {
+    if (fd_ < 0) return;
+    writeHeader();
+    ::fsync(fd_);
+}
+
+uint64_t HashIndex::keyFor(const ColValue& value, ColType type) {
+    switch (type) {
+        case ColType::UINT32:
+            return value.asU32();
+        case ColType::STRING: {
+            uint64_t h = 1469598103934665603ULL;  // FNV-1a 64
+            for (unsigned char ch : value.str) {
+                h ^= ch;
+                h *= 1099511628211ULL;
+            }
+            return h;
+        }
+        default:
+            throw std::invalid_argument("hash indexes require a UINT32 or STRING column");
+    }
+}
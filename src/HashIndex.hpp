@@ -0,0 +1,76 @@
+// HashIndex.hpp — disk-resident linear-hash index mapping 64-bit keys to rowIDs.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ValueTypes.hpp"
+
+// Equality-only companion to BPlusTree. Keys are 64-bit: a UINT32 value is
+// stored as itself (exact), a STRING is stored as its FNV-1a hash, so STRING
+// hits are candidates the caller must verify against the heap (see keyFor).
+//
+// Linear hashing grows one bucket at a time: once the load factor passes the
+// threshold, bucket `next_` is split into itself and `next_ + (N0 << level_)`.
+//
+// On-disk layout (4 KiB pages):
+//   page 0   header: magic 'HIDX', version, level, next, bucketCount, dirHead,
+//            freeHead, pageCount, entryCount
+//   dir      uint32 nextDirPage, uint32 bucketPage[1023]   (bucket -> first page)
+//   bucket   uint16 count, uint16 pad, uint32 overflow, entries [key:u64 | rowID:u32]
+//
+// Pages freed by splits go on a free list threaded through their overflow link.
+class HashIndex {
+public:
+    static constexpr uint32_t kPageSize = 4096;
+
+    explicit HashIndex(const std::string& path);
+    ~HashIndex();
+    HashIndex(const HashIndex&) = delete;
+    HashIndex& operator=(const HashIndex&) = delete;
+
+    // Open an existing index file, or create (truncate) a fresh one.
+    void openOrCreate(bool create);
+
+    // Returns false if (key, rowID) was already present / absent.
+    bool insert(uint64_t key, uint32_t rowID);
+    bool erase(uint64_t key, uint32_t rowID);
+    // rowIDs stored under `key`, in no particular order.
+    std::vector<uint32_t> lookup(uint64_t key) const;
+
+    void sync();
+    uint64_t size() const { return entryCount_; }
+    uint32_t bucketCount() const { return bucketCount_; }
+    const std::string& path() const { return path_; }
+
+    // Index key for a column value: UINT32 values verbatim, STRING via FNV-1a.
+    static uint64_t keyFor(const ColValue& value, ColType type);
+
+private:
+    std::string path_;
+    int         fd_ = -1;
+    uint32_t    level_ = 0;
+    uint32_t    next_ = 0;
+    uint32_t    bucketCount_ = 0;
+    uint32_t    dirHead_ = 0;
+    uint32_t    freeHead_ = 0;
+    uint32_t    pageCount_ = 0;
+    uint64_t    entryCount_ = 0;
+
+    std::vector<uint32_t> dir_;       // bucket -> first page (mirror of dir pages)
+    std::vector<uint32_t> dirPages_;  // directory page chain
+    mutable std::unordered_map<uint32_t, std::vector<uint8_t>> cache_;
+
+    uint32_t bucketFor(uint64_t key) const;
+    uint8_t* page(uint32_t pid) const;
+    uint32_t allocPage();
+    void freePage(uint32_t pid);
+    void writePage(uint32_t pid) const;
+    void writeHeader() const;
+    void readHeader();
+    void loadDirectory();
+    void appendBucket(uint32_t firstPage);
+    void split();
+};
@@ -9,8 +9,25 @@ Join::hashJoinEq(Table& left, uint16_t leftCol, Table& right, uint16_t rightCol)
         if (v) ht[*v].push_back(rRow);
     });
 
+    // With a small build side, a probe page whose Bloom filter rules out every
+    // build key can be skipped without reading it.
+    const bool prune = left.hasBloomFilter(leftCol) && ht.size() <= 64 &&
+                       left.columnFile(leftCol).colType() == ColType::UINT32;
+    std::unordered_map<uint16_t, bool> pageMayMatch;
+
     std::vector<std::pair<uint32_t,uint32_t>> out;
     left.rowIndexForEachLive([&](uint32_t lRow, const std::vector<uint32_t>& lSlots){
+        if (prune) {
+            const uint16_t pid = ColumnFile::pageIdFromSlotId(lSlots[leftCol]);
+            auto pit = pageMayMatch.find(pid);
+            if (pit == pageMayMatch.end()) {
+                bool any = false;
+                for (const auto& kv : ht)
+                    if ((any = left.pageMayContain(leftCol, pid, ColValue(kv.first)))) break;
+                pit = pageMayMatch.emplace(pid, any).first;
+            }
+            if (!pit->second) return;
+        }
         auto v = left.columnFile(leftCol).fetchSlot(lSlots[leftCol]);
         if (!v) return;
         auto it = ht.find(*v);
@@ -11,6 +11,8 @@
 //   uint16_t numColumns
 //   uint16_t headPageIDs[numColumns]
 //   uint8_t  colTypes[numColumns]        (ColType enum, 1 byte each)
+//   uint16_t primaryKey + 1              (0 = none; older files read as 0)
+//   uint16_t flags                       (older files read as 0)
 
 static void writeAll(int fd, const void* buf, size_t n) {
     if (write(fd, buf, n) != ssize_t(n)) std::perror("MasterPage write");
@@ -43,6 +45,9 @@ MasterPage MasterPage::initnew(int fd, uint16_t pageSize,
         uint8_t b = static_cast<uint8_t>(t);
         writeAll(fd, &b, 1);
     }
+    const uint16_t pk = 0;
+    writeAll(fd, &pk, sizeof(pk));
+    writeAll(fd, &mp.flags, sizeof(mp.flags));
     fsync(fd);
     return mp;
 }
@@ -60,6 +65,9 @@ void MasterPage::flush(int fd) const {
         uint8_t b = static_cast<uint8_t>(t);
         writeAll(fd, &b, 1);
     }
+    const uint16_t pk = primaryKey == kNoPrimaryKey ? 0 : uint16_t(primaryKey + 1);
+    writeAll(fd, &pk, sizeof(pk));
+    writeAll(fd, &flags, sizeof(flags));
 }
 
 void MasterPage::sync(int fd) const {
@@ -88,5 +96,11 @@ MasterPage MasterPage::load(int fd) {
         if (read(fd, &b, 1) == 1)
             mp.colTypes[i] = static_cast<ColType>(b);
     }
+    uint16_t pk = 0;
+    if (read(fd, &pk, sizeof(pk)) == sizeof(pk) && pk != 0 && pk <= mp.numColumns)
+        mp.primaryKey = uint16_t(pk - 1);
+    uint16_t flags = 0;
+    if (read(fd, &flags, sizeof(flags)) == sizeof(flags))
+        mp.flags = flags;
     return mp;
 }
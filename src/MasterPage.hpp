@@ -9,6 +9,14 @@ struct MasterPage {
     uint16_t              numColumns;   // how many columns in this file
     std::vector<uint16_t> headPageIDs;  // free-page head per column
     std::vector<ColType>  colTypes;     // per-column type tag (defaults UINT32)
+    uint16_t              primaryKey = kNoPrimaryKey;  // declared key column
+    uint16_t              flags = 0;                   // kFlag* bits
+
+    static constexpr uint16_t kNoPrimaryKey = UINT16_MAX;
+    // Column pages end in a CRC32C trailer (see ColumnFile).
+    static constexpr uint16_t kFlagPageChecksums = 0x0001;
+    // Index files may hold rowIDs from before a compaction; rebuilt on open.
+    static constexpr uint16_t kFlagRebuildIndexes = 0x0002;
 
     // Create a brand-new MasterPage (all-UINT32 columns):
     static MasterPage initnew(int fd, uint16_t pageSize, int numColumns);
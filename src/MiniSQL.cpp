@@ -15,6 +15,9 @@
 #include "Predicate.hpp"
 #include "Table.hpp"
 #include "ValueTypes.hpp"
+#include "Vectorized.hpp"
+
+extern "C" bool metalIsAvailable();
 
 namespace {
 
@@ -74,6 +77,16 @@ struct ParsedQuery {
     ParsedWhere where;
     bool hasGroupBy = false;
     ColumnRef groupBy;
+    enum class IndexKind {
+        BTree,
+        Hash,
+        Bitmap,
+        Bloom,
+    };
+
+    bool isCreateIndex = false;  // CREATE INDEX ON '<table>' (cN) [USING BTREE|HASH|BITMAP|BLOOM]
+    ColumnRef indexColumn;
+    IndexKind indexKind = IndexKind::BTree;
 };
 
 struct AggregateState {
@@ -185,6 +198,7 @@ public:
 
     ParsedQuery parse() {
         ParsedQuery query;
+        if (matchKeyword("CREATE")) return parseCreateIndex();
         expectKeyword("SELECT");
         query.selectItems = parseSelectList();
         expectKeyword("FROM");
@@ -207,6 +221,26 @@ public:
     }
 
 private:
+    ParsedQuery parseCreateIndex() {
+        ParsedQuery query;
+        query.isCreateIndex = true;
+        expectKeyword("INDEX");
+        expectKeyword("ON");
+        query.tableName = expect(TokenKind::String, "table path string literal").text;
+        expect(TokenKind::LParen, "(");
+        query.indexColumn = parseColumnRef(expect(TokenKind::Identifier, "index column"));
+        expect(TokenKind::RParen, ")");
+        if (matchKeyword("USING")) {
+            if (matchKeyword("HASH")) query.indexKind = ParsedQuery::IndexKind::Hash;
+            else if (matchKeyword("BITMAP")) query.indexKind = ParsedQuery::IndexKind::Bitmap;
+            else if (matchKeyword("BLOOM")) query.indexKind = ParsedQuery::IndexKind::Bloom;
+            else expectKeyword("BTREE");
+        }
+        if (peek().kind == TokenKind::Semicolon) ++pos_;
+        expect(TokenKind::End, "end of query");
+        return query;
+    }
+
     std::vector<SelectItem> parseSelectList() {
         std::vector<SelectItem> items;
         do {
@@ -286,7 +320,24 @@ private:
             predicate.hi = predicate.lo;
             return predicate;
         }
+        if (matchKeyword("LIKE")) {
+            // Only prefix patterns: 'abc%' with no other wildcards.
+            const std::string pattern = expect(TokenKind::String, "LIKE pattern").text;
+            if (pattern.empty() || pattern.back() != '%' ||
+                pattern.find_first_of("%_") != pattern.size() - 1)
+                throw std::invalid_argument("only prefix LIKE patterns ('abc%') are supported");
+            predicate.kind = Predicate::Kind::PREFIX_STRING;
+            predicate.needle = pattern.substr(0, pattern.size() - 1);
+            return predicate;
+        }
         expectKeyword("BETWEEN");
+        if (peek().kind == TokenKind::String) {
+            predicate.kind = Predicate::Kind::BETWEEN_STRING;
+            predicate.needle = expect(TokenKind::String, "string lower bound").text;
+            expectKeyword("AND");
+            predicate.needleHi = expect(TokenKind::String, "string upper bound").text;
+            return predicate;
+        }
         predicate.kind = Predicate::Kind::BETWEEN;
         predicate.lo = parseNumber(expect(TokenKind::Number, "numeric lower bound"));
         expectKeyword("AND");
@@ -462,6 +513,34 @@ std::vector<uint32_t> executeWhere(Table& table, const ParsedQuery& query) {
     return table.whereOr(query.where.predicates);
 }
 
+// Full scans run batch at a time through the vectorized pipeline. Queries
+// with a predicate an index or filter can answer, and WHERE scans big enough
+// for the GPU, keep the row-ID path through Table.
+bool runsVectorized(const Table& table, const ParsedQuery& query) {
+    if (!query.hasWhere) return true;
+    if (table.useGPU() && table.liveRows() >= table.gpuThreshold() && metalIsAvailable()) return false;
+    for (const auto& predicate : query.where.predicates) {
+        const uint16_t c = predicate.colIdx;
+        if (table.hasIndex(c) || table.hasHashIndex(c) || table.hasBitmapIndex(c) || table.hasBloomFilter(c))
+            return false;
+    }
+    return true;
+}
+
+// scan -> [filter] -> next, scanning `columns` plus whatever the WHERE reads.
+void runPipeline(Table& table, const ParsedQuery& query, Vectorized::Operator& next,
+                 std::vector<uint16_t> columns) {
+    if (!query.hasWhere) {
+        Vectorized::Scan(table, std::move(columns)).run(next);
+        return;
+    }
+    Vectorized::Filter filter(table, query.where.predicates,
+                              query.where.connective == ParsedWhere::Connective::Or, next);
+    for (uint16_t c : filter.columns())
+        if (std::find(columns.begin(), columns.end(), c) == columns.end()) columns.push_back(c);
+    Vectorized::Scan(table, std::move(columns)).run(filter);
+}
+
 MiniSQLResult executeProjectionQuery(Table& table, const ParsedQuery& query) {
     std::vector<uint16_t> cols;
     MiniSQLResult result;
@@ -482,6 +561,20 @@ MiniSQLResult executeProjectionQuery(Table& table, const ParsedQuery& query) {
         }
     }
 
+    if (runsVectorized(table, query)) {
+        Vectorized::Sink sink([&](Vectorized::Batch& batch) {
+            for (size_t i = 0; i < batch.sel.size(); ++i) {
+                std::vector<std::string> outRow;
+                outRow.reserve(cols.size());
+                for (const auto& column : batch.columns) outRow.push_back(formatColValue(column.at(i)));
+                result.rows.push_back(std::move(outRow));
+            }
+        });
+        Vectorized::Project project(table, cols, sink);
+        runPipeline(table, query, project, cols);
+        return result;
+    }
+
     const auto rowIDs = executeWhere(table, query);
     result.rows.reserve(rowIDs.size());
     for (uint32_t rowID : rowIDs) {
@@ -527,10 +620,26 @@ AggregateState computeAggregate(Table& table, const std::vector<uint32_t>& rowID
     return state;
 }
 
+AggregateState computeAggregateVectorized(Table& table, const ParsedQuery& query, const SelectItem& item) {
+    const bool countStar = item.kind == SelectItem::Kind::CountStar;
+    Vectorized::Aggregate aggregate(table, countStar ? Vectorized::Aggregate::kCountStar : item.column.index);
+    runPipeline(table, query, aggregate, countStar ? std::vector<uint16_t>{} : std::vector<uint16_t>{item.column.index});
+
+    AggregateState state;
+    state.count = aggregate.count();
+    state.sum = aggregate.sum();
+    state.hasValue = !countStar && aggregate.count() > 0;
+    if (state.hasValue) {
+        state.min = aggregate.min();
+        state.max = aggregate.max();
+    }
+    return state;
+}
+
 MiniSQLResult executeScalarAggregateQuery(Table& table, const ParsedQuery& query) {
     const auto& item = query.selectItems.front();
-    const auto rowIDs = executeWhere(table, query);
-    const auto state = computeAggregate(table, rowIDs, item);
+    const auto state = runsVectorized(table, query) ? computeAggregateVectorized(table, query, item)
+                                                    : computeAggregate(table, executeWhere(table, query), item);
 
     MiniSQLResult result;
     switch (item.kind) {
@@ -630,6 +739,29 @@ MiniSQLResult executeMiniSQL(Engine& engine, const std::string& sql) {
     if (access(tablePath.c_str(), F_OK) != 0)
         throw std::invalid_argument("table does not exist");
     Table& table = engine.openTable(query.tableName);
+
+    if (query.isCreateIndex) {
+        validateColumnRef(table, query.indexColumn.index);
+        switch (query.indexKind) {
+            case ParsedQuery::IndexKind::BTree:
+                engine.createIndex(query.tableName, query.indexColumn.index);
+                break;
+            case ParsedQuery::IndexKind::Hash:
+                engine.createHashIndex(query.tableName, query.indexColumn.index);
+                break;
+            case ParsedQuery::IndexKind::Bitmap:
+                engine.createBitmapIndex(query.tableName, query.indexColumn.index);
+                break;
+            case ParsedQuery::IndexKind::Bloom:
+                engine.createBloomFilter(query.tableName, query.indexColumn.index);
+                break;
+        }
+        MiniSQLResult result;
+        result.headers = {"index"};
+        result.rows.push_back({query.tableName + "(" + query.indexColumn.text + ")"});
+        return result;
+    }
+
     validateQueryShape(table, query);
 
     if (query.hasGroupBy) return executeGroupByQuery(engine, query);
@@ -9,12 +9,19 @@ struct Predicate {
     enum class Kind {
         EQ,
         BETWEEN,
-        EQ_STRING
+        EQ_STRING,
+        PREFIX_STRING,   // needle is the prefix
+        BETWEEN_STRING   // needle..needleHi inclusive, byte-wise order
     };
 
     uint16_t    colIdx = 0;
     Kind        kind = Kind::EQ;
     ValueType   lo = 0;
     ValueType   hi = 0;
+    // EQ/BETWEEN bounds on INT64, FLOAT and DOUBLE columns, of the column's
+    // type (typedHi unused for EQ); lo/hi serve UINT32 columns.
+    ColValue    typedLo;
+    ColValue    typedHi;
     std::string needle;
+    std::string needleHi;
 };
@@ -1,8 +1,10 @@
 #include "QuerySession.hpp"
 
 #include <cstdio>
+#include <sstream>
 #include <string>
 
+#include "ChangeStream.hpp"
 #include "Engine.hpp"
 #include "MiniSQL.hpp"
 
@@ -33,3 +35,44 @@ bool executeMiniSQLToStream(Engine& engine, const std::string& sql, const char*
         return false;
     }
 }
+
+namespace {
+
+// Rendered as query results render them.
+std::string formatChangeValue(const ColValue& value) {
+    std::ostringstream out;
+    switch (value.type) {
+        case ColType::UINT32: return std::to_string(value.u32);
+        case ColType::INT64: return std::to_string(value.i64);
+        case ColType::FLOAT:
+            out << value.f32;
+            return out.str();
+        case ColType::DOUBLE:
+            out << value.f64;
+            return out.str();
+        case ColType::STRING:
+            return value.str;
+    }
+    return "";
+}
+
+} // namespace
+
+MiniSQLResult readChanges(const std::string& tableName, uint64_t after, size_t limit) {
+    ChangeStream stream(tableName + ".mdb", after);
+    MiniSQLResult result;
+    result.headers = {"lsn", "op", "row"};
+    for (size_t c = 0; c < stream.schema().size(); ++c) result.headers.push_back("c" + std::to_string(c));
+    Wal::Operation change;
+    while (result.rows.size() < limit && stream.next(change)) {
+        std::vector<std::string> row = {
+            std::to_string(stream.position()),
+            change.kind == Wal::Operation::Kind::Insert ? "insert" : "delete",
+            std::to_string(change.rowID),
+        };
+        for (const auto& value : change.values) row.push_back(formatChangeValue(value));
+        row.resize(result.headers.size());
+        result.rows.push_back(std::move(row));
+    }
+    return result;
+}
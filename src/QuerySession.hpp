@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 class Engine;
@@ -7,3 +9,7 @@ struct MiniSQLResult;
 
 std::string formatMiniSQLResult(const MiniSQLResult& result);
 bool executeMiniSQLToStream(Engine& engine, const std::string& sql, const char* errorPrefix);
+// Up to `limit` committed changes of `tableName` after position `after` (see
+// ChangeStream), one row each: lsn, op (insert/delete), row, then the
+// inserted values.
+MiniSQLResult readChanges(const std::string& tableName, uint64_t after, size_t limit);
@@ -0,0 +1,180 @@
+#include "Replica.hpp"
+#include "MasterPage.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/file.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+bool isWalFile(const std::string& suffix) {
+    return suffix == ".wal" || suffix.rfind(".wal.", 0) == 0;
+}
+
+// `path` and its sidecars (<path>.idx, <path>.<col>.str, index files, ...),
+// as suffixes after `path`; WAL segments only if `withWal`.
+std::vector<std::string> tableFileSuffixes(const std::string& path, bool withWal) {
+    const size_t slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    const std::string prefix = (slash == std::string::npos ? path : path.substr(slash + 1)) + ".";
+    std::vector<std::string> suffixes;
+    if (::access(path.c_str(), F_OK) == 0) suffixes.emplace_back();
+    DIR* d = ::opendir(dir.c_str());
+    if (!d) throw std::runtime_error("open table directory failed: " + std::string(std::strerror(errno)));
+    while (const dirent* entry = ::readdir(d)) {
+        const std::string name = entry->d_name;
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) continue;
+        const std::string suffix = name.substr(prefix.size() - 1);
+        if (withWal || !isWalFile(suffix)) suffixes.push_back(suffix);
+    }
+    ::closedir(d);
+    return suffixes;
+}
+
+// False if `from` is gone (an index dropped since the listing).
+bool copyFile(const std::string& from, const std::string& to) {
+    const int in = ::open(from.c_str(), O_RDONLY);
+    if (in < 0 && errno == ENOENT) return false;
+    if (in < 0) throw std::runtime_error("open " + from + " failed: " + std::strerror(errno));
+    const int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (out < 0) {
+        const int err = errno;
+        ::close(in);
+        throw std::runtime_error("create " + to + " failed: " + std::strerror(err));
+    }
+    std::vector<char> buf(1 << 20);
+    int err = 0;
+    while (!err) {
+        const ssize_t n = ::read(in, buf.data(), buf.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) err = errno;
+        if (n <= 0) break;
+        size_t done = 0;
+        while (!err && done < size_t(n)) {
+            const ssize_t w = ::write(out, buf.data() + done, size_t(n) - done);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) err = w < 0 ? errno : EIO;
+            else done += size_t(w);
+        }
+    }
+    ::close(in);
+    ::close(out);
+    if (err) throw std::runtime_error("copy " + from + " failed: " + std::strerror(err));
+    return true;
+}
+
+} // namespace
+
+Replica::Replica(const std::string& primaryPath, const std::string& copyPath)
+    : primary_(primaryPath), copy_(copyPath) {
+    // Either one's sidecars would be taken for the other's.
+    if (primary_ == copy_ || copy_.rfind(primary_ + ".", 0) == 0 || primary_.rfind(copy_ + ".", 0) == 0)
+        throw std::invalid_argument("replica copy must not overlap the primary table's files");
+    std::lock_guard<std::mutex> lock(mu_);
+    resync();
+}
+
+Replica::~Replica() {
+    stopFollowing();
+}
+
+void Replica::resync() {
+    // Closed first: with durability off its destructor writes the old copy.
+    table_.reset();
+    tail_.reset();
+
+    const int fd = ::open(primary_.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("open primary table failed: " + std::string(std::strerror(errno)));
+    try {
+        // The primary writes its files in place only under LOCK_EX (checkpoints
+        // and compaction), so under LOCK_SH they are as a crash would leave them,
+        // and the WAL's live segments hold everything after.
+        if (::flock(fd, LOCK_SH) != 0)
+            throw std::runtime_error("lock primary table failed: " + std::string(std::strerror(errno)));
+        tail_.emplace(primary_, MasterPage::load(fd).colTypes);
+        tail_->rewind();
+        for (const auto& suffix : tableFileSuffixes(copy_, /*withWal=*/true))
+            std::remove((copy_ + suffix).c_str());
+        for (const auto& suffix : tableFileSuffixes(primary_, /*withWal=*/false))
+            copyFile(primary_ + suffix, copy_ + suffix);
+    } catch (...) {
+        ::close(fd);
+        tail_.reset();
+        throw;
+    }
+    ::close(fd);  // and the lock with it
+
+    auto table = std::make_shared<Table>(copy_);
+    // Nothing replays the copy's own log; it is taken again instead.
+    table->setDurability(Table::Durability::Off);
+    table->rebuildIndexes();
+    table_ = std::move(table);
+    catchUp();  // if the log has already moved on, the next poll copies again
+}
+
+bool Replica::catchUp() {
+    bool behind = false;
+    const bool followed = tail_->poll([&](const Wal::Operation& op) {
+        if (!behind && !table_->applyReplicated(op)) behind = true;
+    });
+    return followed && !behind;
+}
+
+bool Replica::poll() {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (table_ && catchUp()) return true;
+    resync();
+    ++resyncs_;
+    return false;
+}
+
+void Replica::follow(std::chrono::milliseconds interval) {
+    stopFollowing();
+    if (interval.count() <= 0) return;
+    {
+        std::lock_guard<std::mutex> lock(followMu_);
+        interval_ = interval;
+        stopFollowing_ = false;
+    }
+    follower_ = std::thread(&Replica::followLoop, this);
+}
+
+void Replica::followLoop() {
+    std::unique_lock<std::mutex> lock(followMu_);
+    while (!followCv_.wait_for(lock, interval_, [&] { return stopFollowing_; })) {
+        lock.unlock();
+        std::string error;
+        try {
+            poll();
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        lock.lock();
+        lastError_ = error;
+    }
+}
+
+void Replica::stopFollowing() {
+    {
+        std::lock_guard<std::mutex> lock(followMu_);
+        stopFollowing_ = true;
+    }
+    followCv_.notify_all();
+    if (follower_.joinable()) follower_.join();
+}
+
+std::string Replica::lastError() const {
+    std::lock_guard<std::mutex> lock(followMu_);
+    return lastError_;
+}
+
+uint64_t Replica::resyncs() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return resyncs_;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "Table.hpp"
+#include "Wal.hpp"
+
+// A read-only follower of a table written elsewhere, usually by another
+// process. It copies the table's files, then tails the primary's WAL segments
+// and applies each committed operation to the copy, so scans can run there
+// without taking the primary's locks or cores. The copy is scratch: it is
+// taken again when the replica starts, and whenever the log has moved past it
+// (a checkpoint retired records not yet read, or the primary rebased the log
+// after compaction, DDL or unlogged writes). Indexes the primary had are
+// rebuilt on each copy; ones it creates later are not picked up until then.
+class Replica {
+public:
+    // Table file paths (<name>.mdb). The copy's files are replaced, and it is
+    // current as of construction.
+    Replica(const std::string& primaryPath, const std::string& copyPath);
+    ~Replica();
+
+    // Applies what the primary committed since the last poll. Returns false
+    // if the copy had to be taken again first.
+    bool poll();
+    // Poll from a background thread every `interval`; zero stops it. Errors
+    // are kept in lastError() and the next interval tries again.
+    void follow(std::chrono::milliseconds interval);
+    std::string lastError() const;
+    // Copies taken since the first.
+    uint64_t resyncs() const;
+
+    // Reads of the copy hold lock(), which keeps polls out. A resync replaces
+    // the table, so fetch it under each lock and let go of it before unlocking.
+    std::unique_lock<std::mutex> lock() const { return std::unique_lock<std::mutex>(mu_); }
+    std::shared_ptr<Table> table() const { return table_; }
+
+private:
+    std::string primary_;
+    std::string copy_;
+    mutable std::mutex mu_;  // guards the copy and the tail
+    std::shared_ptr<Table> table_;
+    std::optional<WalTail> tail_;
+    uint64_t resyncs_ = 0;
+
+    std::thread follower_;
+    mutable std::mutex followMu_;  // guards the fields below
+    std::condition_variable followCv_;
+    std::chrono::milliseconds interval_{0};
+    bool stopFollowing_ = false;
+    std::string lastError_;
+
+    // Copies the table and applies the log so far.
+    void resync();
+    // False if the copy must be taken again.
+    bool catchUp();
+    void followLoop();
+    void stopFollowing();
+};
@@ -3,9 +3,11 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <stdexcept>
 
 static constexpr uint32_t RIDX_MAGIC = 0x52494458; // 'RIDX'
 
@@ -74,6 +76,8 @@ void RowIndex::loadAll() {
         entries_.push_back(e);
         if (e.status == 0) ++deletedCount_;
     }
+    persisted_ = static_cast<uint32_t>(entries_.size());
+    dirtyRows_.clear();
 }
 
 uint32_t RowIndex::appendRow(const std::vector<uint32_t>& slotIDs) {
@@ -81,14 +85,18 @@ uint32_t RowIndex::appendRow(const std::vector<uint32_t>& slotIDs) {
     Entry e; e.status = 1; e.slots = slotIDs;
 
     uint32_t rowID = static_cast<uint32_t>(entries_.size());
-    entries_.push_back(e);
-
-    writeEntry(rowID, e);
+    entries_.push_back(std::move(e));
     return rowID;
 }
 
 void RowIndex::forEachLive(const std::function<void(uint32_t, const std::vector<uint32_t>&)>& fn) const {
-    for (uint32_t i = 0; i < entries_.size(); ++i) {
+    forEachLive(0, rowsRecorded(), fn);
+}
+
+void RowIndex::forEachLive(uint32_t first, uint32_t end,
+                           const std::function<void(uint32_t, const std::vector<uint32_t>&)>& fn) const {
+    end = std::min(end, rowsRecorded());
+    for (uint32_t i = first; i < end; ++i) {
         const Entry& e = entries_[i];
         if (e.status == 1) fn(i, e.slots);
     }
@@ -105,19 +113,40 @@ void RowIndex::markDeleted(uint32_t rowID) {
     if (entries_[rowID].status == 0) return;
     entries_[rowID].status = 0;
     ++deletedCount_;
-    writeEntry(rowID, entries_[rowID]);
+    if (rowID < persisted_) dirtyRows_.push_back(rowID);
 }
 
-void RowIndex::writeEntry(uint32_t rowID, const Entry& e) {
-    const off_t base = 4 /*magic*/ + 2 /*ncols*/ + 2 /*res*/;
-    const size_t entrySize = 1 + 3 + sizeof(uint32_t) * numColumns_;
-    off_t pos = base + off_t(rowID) * off_t(entrySize);
+void RowIndex::serializeEntries(uint32_t first, uint32_t end, std::vector<Extent>& out) const {
+    const size_t size = entrySize();
+    Extent extent;
+    extent.offset = entryOffset(first);
+    extent.bytes.assign(size_t(end - first) * size, 0);
+    uint8_t* p = extent.bytes.data();
+    for (uint32_t rowID = first; rowID < end; ++rowID, p += size) {
+        p[0] = entries_[rowID].status;
+        std::memcpy(p + 4, entries_[rowID].slots.data(), sizeof(uint32_t) * numColumns_);
+    }
+    out.push_back(std::move(extent));
+}
 
-    if (lseek(fd_, pos, SEEK_SET) == (off_t)-1) perror("lseek(writeEntry)");
-    uint8_t pad[3] = {0,0,0};
-    if (write(fd_, &e.status, 1) != 1) perror("write(status)");
-    if (write(fd_, pad, 3) != 3) perror("write(pad)");
-    if (write(fd_, e.slots.data(), sizeof(uint32_t) * numColumns_) != (ssize_t)(sizeof(uint32_t) * numColumns_)) perror("write(slots)");
+size_t RowIndex::captureDirty(std::vector<Extent>& out) {
+    const uint32_t rows = static_cast<uint32_t>(entries_.size());
+    const size_t n = dirtyRows_.size() + (rows - persisted_);
+    std::sort(dirtyRows_.begin(), dirtyRows_.end());
+    for (size_t i = 0; i < dirtyRows_.size();) {
+        size_t j = i + 1;
+        while (j < dirtyRows_.size() && dirtyRows_[j] == dirtyRows_[j - 1] + 1) ++j;
+        serializeEntries(dirtyRows_[i], dirtyRows_[j - 1] + 1, out);
+        i = j;
+    }
+    if (persisted_ < rows) serializeEntries(persisted_, rows, out);
+    dirtyRows_.clear();
+    persisted_ = rows;
+    return n;
+}
+
+void RowIndex::writeExtents(const std::vector<Extent>& extents) const {
+    ::writeExtents(fd_, extents, "row index");
 }
 
 std::optional<std::vector<uint32_t>> RowIndex::fetch(uint32_t rowID) const {
@@ -131,5 +160,54 @@ bool RowIndex::isLive(uint32_t rowID) const {
 }
 
 void RowIndex::sync() const {
-    if (fd_ >= 0) fsync(fd_);
+    syncFile(fd_, "row index");
+}
+
+std::vector<uint32_t> RowIndex::compact() {
+    std::vector<uint32_t> remap(entries_.size(), kDroppedRow);
+    std::vector<Entry> live;
+    live.reserve(liveRows());
+    for (uint32_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].status != 1) continue;
+        remap[i] = static_cast<uint32_t>(live.size());
+        live.push_back(std::move(entries_[i]));
+    }
+
+    // Serialize the whole file into one buffer: header + dense live entries.
+    const size_t entrySize = 1 + 3 + sizeof(uint32_t) * numColumns_;
+    std::vector<uint8_t> buf(8 + live.size() * entrySize, 0);
+    const uint32_t magic = RIDX_MAGIC;
+    std::memcpy(buf.data(), &magic, sizeof(magic));
+    std::memcpy(buf.data() + 4, &numColumns_, sizeof(numColumns_));
+    uint8_t* p = buf.data() + 8;
+    for (const Entry& e : live) {
+        p[0] = e.status;
+        std::memcpy(p + 4, e.slots.data(), sizeof(uint32_t) * numColumns_);
+        p += entrySize;
+    }
+
+    const std::string tmpPath = idxPath_ + ".compact";
+    const int tmpFd = open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (tmpFd < 0) throw std::runtime_error("RowIndex::compact: open temp index failed");
+    if (pwrite(tmpFd, buf.data(), buf.size(), 0) != (ssize_t)buf.size() || fsync(tmpFd) != 0) {
+        close(tmpFd);
+        unlink(tmpPath.c_str());
+        throw std::runtime_error("RowIndex::compact: write temp index failed");
+    }
+    if (rename(tmpPath.c_str(), idxPath_.c_str()) != 0) {
+        close(tmpFd);
+        unlink(tmpPath.c_str());
+        throw std::runtime_error("RowIndex::compact: rename temp index failed");
+    }
+
+    if (fd_ >= 0) close(fd_);
+    fd_ = tmpFd;
+    entries_ = std::move(live);
+    deletedCount_ = 0;
+    persisted_ = static_cast<uint32_t>(entries_.size());
+    dirtyRows_.clear();
+    // The new file is already in place; this only makes the rename itself
+    // survive a crash.
+    syncParentDir(idxPath_, "RowIndex::compact:");
+    return remap;
 }
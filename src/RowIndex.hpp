@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <optional>
 #include <functional>
+#include <limits>
+#include "Extent.hpp"
 
 class RowIndex {
 public:
@@ -30,13 +32,28 @@ public:
     // Number of live rows (cheap estimate: rowsRecorded - deletedCount)
     uint32_t liveRows() const { return rowsRecorded() - deletedCount_; }
     void forEachLive(const std::function<void(uint32_t, const std::vector<uint32_t>&)>& fn) const;
+    // Same, for the rowIDs in [first, end) only.
+    void forEachLive(uint32_t first, uint32_t end,
+                     const std::function<void(uint32_t, const std::vector<uint32_t>&)>& fn) const;
     void forEachLiveID(const std::function<void(uint32_t)>& fn) const;
     bool isLive(uint32_t rowID) const;
+    // Entries are write-back like column pages. captureDirty appends the
+    // entries appended or deleted since the last capture (adjacent ones in one
+    // extent) and marks them clean; writeExtents writes them out, off the lock.
+    size_t captureDirty(std::vector<Extent>& out);
+    void writeExtents(const std::vector<Extent>& extents) const;
     void sync() const;
 
     // Load all rows from disk (called by openOrCreate)
     void loadAll();
 
+    // Drop deleted entries and renumber the survivors densely (0..liveRows-1).
+    // The .idx file is rewritten through a temp file + rename, so a crash leaves
+    // either the old or the new index intact. Returns a map indexed by old rowID
+    // holding the new rowID, or kDroppedRow for entries that were removed.
+    static constexpr uint32_t kDroppedRow = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> compact();
+
 private:
     struct Entry {
         uint8_t status;                  // 1=live, 0=deleted
@@ -50,6 +67,8 @@ private:
     // In-memory cache of all entries for simplicity
     std::vector<Entry> entries_;
     uint32_t           deletedCount_ = 0;
+    uint32_t           persisted_ = 0;   // entries below this have been captured
+    std::vector<uint32_t> dirtyRows_;    // captured entries deleted since
 
     // On-disk format:
     // Header:
@@ -65,6 +84,8 @@ private:
     // RowID = entry index (0-based) in this file.
 
     void ensureHeaderOnCreate();
-    void writeEntry(uint32_t rowID, const Entry& e);
+    size_t entrySize() const { return 1 + 3 + sizeof(uint32_t) * numColumns_; }
+    off_t entryOffset(uint32_t rowID) const { return 8 + off_t(rowID) * off_t(entrySize()); }
+    void serializeEntries(uint32_t first, uint32_t end, std::vector<Extent>& out) const;
     void readEntryAt(uint32_t rowID, Entry& out);
 };
@@ -3,6 +3,8 @@
 #include <cstdio>
 #include <cerrno>
 #include <cstring>
+#include <functional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -13,12 +15,17 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "ChangeStream.hpp"
 #include "Engine.hpp"
 #include "MiniSQL.hpp"
 #include "QuerySession.hpp"
+#include "Replica.hpp"
 
 namespace {
 
+// Rows per `.changes` response unless the request asks for fewer or more.
+constexpr size_t kChangesLimit = 10000;
+
 std::string trimLine(const std::string& input) {
     size_t start = 0;
     while (start < input.size() && (input[start] == ' ' || input[start] == '\t' ||
@@ -46,10 +53,43 @@ bool sendAll(int fd, const std::string& payload) {
     return true;
 }
 
+uint64_t parseChangesNumber(const std::string& text, const char* what) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+        throw std::invalid_argument(std::string("invalid .changes ") + what);
+    try {
+        return std::stoull(text);
+    } catch (const std::out_of_range&) {
+        throw std::invalid_argument(std::string("invalid .changes ") + what);
+    }
+}
+
+// `.changes <table> [<lsn>|end] [<limit>]`: see readChanges.
+MiniSQLResult executeChanges(const std::string& request) {
+    std::istringstream in(request);
+    std::string command, table, after, limit, extra;
+    in >> command >> table >> after >> limit >> extra;
+    if (table.size() >= 2 && table.front() == '\'' && table.back() == '\'') table = table.substr(1, table.size() - 2);
+    if (command != ".changes" || table.empty() || !extra.empty())
+        throw std::invalid_argument("usage: .changes <table> [<lsn>|end] [<limit>]");
+    const uint64_t maxRows = limit.empty() ? kChangesLimit : parseChangesNumber(limit, "limit");
+    if (maxRows == 0) throw std::invalid_argument("invalid .changes limit");
+    const uint64_t lsn = after.empty()    ? ChangeStream::kFromStart
+                       : after == "end"   ? ChangeStream::kFromEnd
+                                          : parseChangesNumber(after, "lsn");
+    return readChanges(table, lsn, size_t(maxRows));
+}
+
 std::string executeRequest(Engine& engine, const std::string& request) {
     const std::string sql = trimLine(request);
     if (sql.empty()) return "ERR\tempty request\nEND\n";
     if (sql == ".quit") return "BYE\nEND\n";
+    if (sql.rfind(".changes", 0) == 0) {
+        try {
+            return "OK\n" + formatMiniSQLResult(executeChanges(sql)) + "END\n";
+        } catch (const std::exception& ex) {
+            return std::string("ERR\t") + ex.what() + "\nEND\n";
+        }
+    }
 
     try {
         const std::string body = formatMiniSQLResult(executeMiniSQL(engine, sql));
@@ -59,8 +99,8 @@ std::string executeRequest(Engine& engine, const std::string& request) {
     }
 }
 
-bool handleClient(int clientFd) {
-    Engine engine;
+// Answers each request line with `execute` until the client quits or hangs up.
+bool serveClient(int clientFd, const std::function<std::string(const std::string&)>& execute) {
     std::string buffered;
     char chunk[4096];
 
@@ -77,16 +117,32 @@ bool handleClient(int clientFd) {
         while ((newlinePos = buffered.find('\n')) != std::string::npos) {
             std::string line = buffered.substr(0, newlinePos);
             buffered.erase(0, newlinePos + 1);
-            const std::string response = executeRequest(engine, line);
+            const std::string response = execute(line);
             if (!sendAll(clientFd, response)) return false;
             if (trimLine(line) == ".quit") return true;
         }
     }
 }
 
-} // namespace
+bool handleClient(int clientFd, Table::Durability durability) {
+    Engine engine;
+    engine.setDurability(durability);
+    return serveClient(clientFd, [&](const std::string& line) { return executeRequest(engine, line); });
+}
 
-int runServer(unsigned short port) {
+// Each request runs on a read-only engine holding the replica's current copy,
+// with polls kept out until it is answered.
+bool handleReplicaClient(int clientFd, Replica& replica, const std::string& name) {
+    return serveClient(clientFd, [&](const std::string& line) {
+        const auto lock = replica.lock();
+        Engine engine;
+        engine.attachTable(name, replica.table());
+        engine.setReadOnly(true);
+        return executeRequest(engine, line);
+    });
+}
+
+int listenAndServe(unsigned short port, const std::function<bool(int)>& serve) {
     const int listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
     if (listenFd < 0) {
         std::fprintf(stderr, "server error: socket failed: %s\n", std::strerror(errno));
@@ -128,7 +184,17 @@ int runServer(unsigned short port) {
             ::close(listenFd);
             return 1;
         }
-        (void)handleClient(clientFd);
+        (void)serve(clientFd);
         ::close(clientFd);
     }
 }
+
+} // namespace
+
+int runServer(unsigned short port, Table::Durability durability) {
+    return listenAndServe(port, [&](int clientFd) { return handleClient(clientFd, durability); });
+}
+
+int runReplicaServer(unsigned short port, Replica& replica, const std::string& name) {
+    return listenAndServe(port, [&](int clientFd) { return handleReplicaClient(clientFd, replica, name); });
+}
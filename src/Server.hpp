@@ -1,3 +1,14 @@
 #pragma once
 
-int runServer(unsigned short port);
+#include <string>
+
+#include "Table.hpp"
+
+class Replica;
+
+// Each client session gets its own Engine with `durability` as its default.
+int runServer(unsigned short port, Table::Durability durability = Table::Durability::Normal);
+// Serves read-only queries against `replica`'s copy, under the table name
+// `name`; writes and DDL are refused. Polling is left to the caller (see
+// Replica::follow).
+int runReplicaServer(unsigned short port, Replica& replica, const std::string& name);
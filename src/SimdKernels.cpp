@@ -0,0 +1,759 @@
+// SimdKernels.cpp
+#include "SimdKernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MDB_SIMD_X86 1
+#endif
+
+namespace {
+
+using Simd::Isa;
+
+// Range kernels test one 64-value block at a time, so each block's matches
+// are a single bitmap word. A range always has lo <= hi (neither NaN): the
+// drivers answer empty ones themselves.
+//
+// Integer ranges use one unsigned compare: v is in [lo, hi] exactly when
+// v - lo <= hi - lo in wrapping arithmetic.
+constexpr size_t kBlock = 64;
+
+template <typename T> struct SumOf;
+template <> struct SumOf<uint32_t> { using type = uint64_t; };
+template <> struct SumOf<int64_t>  { using type = int64_t; };
+template <> struct SumOf<float>    { using type = double; };
+template <> struct SumOf<double>   { using type = double; };
+
+template <typename T>
+struct Ops {
+    uint64_t (*range)(const T* block, T lo, T hi);
+    typename SumOf<T>::type (*sum)(const T* v, size_t n);
+    T (*min)(const T* v, size_t n);
+    T (*max)(const T* v, size_t n);
+};
+
+struct Kernels {
+    Ops<uint32_t> u32;
+    Ops<int64_t> i64;
+    Ops<float> f32;
+    Ops<double> f64;
+};
+
+template <typename T>
+constexpr T highest() {
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::max();
+}
+
+template <typename T>
+constexpr T lowest() {
+    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::lowest();
+}
+
+// ── Scalar ────────────────────────────────────────────────────────────────────
+
+template <typename T>
+uint64_t rangeScalar(const T* v, size_t n, T lo, T hi) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < n; ++i) bits |= uint64_t(v[i] >= lo && v[i] <= hi) << i;
+    return bits;
+}
+
+template <typename T>
+uint64_t rangeBlockScalar(const T* v, T lo, T hi) { return rangeScalar(v, kBlock, lo, hi); }
+
+template <typename T>
+typename SumOf<T>::type sumScalar(const T* v, size_t n) {
+    typename SumOf<T>::type acc = 0;
+    for (size_t i = 0; i < n; ++i) acc += v[i];
+    return acc;
+}
+
+// Wrapping, without signed overflow.
+template <>
+int64_t sumScalar<int64_t>(const int64_t* v, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; ++i) acc += uint64_t(v[i]);
+    return int64_t(acc);
+}
+
+template <typename T>
+T minScalar(const T* v, size_t n) {
+    T r = highest<T>();
+    for (size_t i = 0; i < n; ++i)
+        if (v[i] < r) r = v[i];
+    return r;
+}
+
+template <typename T>
+T maxScalar(const T* v, size_t n) {
+    T r = lowest<T>();
+    for (size_t i = 0; i < n; ++i)
+        if (v[i] > r) r = v[i];
+    return r;
+}
+
+template <typename T>
+constexpr Ops<T> scalarOps() {
+    return {rangeBlockScalar<T>, sumScalar<T>, minScalar<T>, maxScalar<T>};
+}
+
+constexpr Kernels kScalar = {scalarOps<uint32_t>(), scalarOps<int64_t>(), scalarOps<float>(), scalarOps<double>()};
+
+// Folds vector lanes spilled to memory, then the tail, with the scalar rule.
+template <typename T>
+T foldMin(const T* lanes, size_t nLanes, const T* tail, size_t nTail) {
+    return std::min(minScalar(lanes, nLanes), minScalar(tail, nTail));
+}
+
+template <typename T>
+T foldMax(const T* lanes, size_t nLanes, const T* tail, size_t nTail) {
+    return std::max(maxScalar(lanes, nLanes), maxScalar(tail, nTail));
+}
+
+#if defined(MDB_SIMD_X86)
+
+// ── SSE4.2 (16 bytes) ─────────────────────────────────────────────────────────
+
+#define MDB_SSE42 __attribute__((target("sse4.2")))
+
+MDB_SSE42 uint64_t rangeU32Sse42(const uint32_t* v, uint32_t lo, uint32_t hi) {
+    const __m128i vlo = _mm_set1_epi32(int(lo));
+    const __m128i span = _mm_set1_epi32(int(hi - lo));
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 4) {
+        const __m128i x = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)), vlo);
+        const __m128i in = _mm_cmpeq_epi32(_mm_min_epu32(x, span), x);
+        bits |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(in))) << i;
+    }
+    return bits;
+}
+
+MDB_SSE42 uint64_t rangeI64Sse42(const int64_t* v, int64_t lo, int64_t hi) {
+    // Unsigned 64-bit compare: flip the sign bits, then compare signed.
+    const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+    const __m128i vlo = _mm_set1_epi64x(lo);
+    const __m128i span = _mm_xor_si128(_mm_set1_epi64x(int64_t(uint64_t(hi) - uint64_t(lo))), sign);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 2) {
+        const __m128i x = _mm_sub_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)), vlo);
+        const __m128i out = _mm_cmpgt_epi64(_mm_xor_si128(x, sign), span);
+        bits |= uint64_t(~_mm_movemask_pd(_mm_castsi128_pd(out)) & 0x3) << i;
+    }
+    return bits;
+}
+
+MDB_SSE42 uint64_t rangeF32Sse42(const float* v, float lo, float hi) {
+    const __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 4) {
+        const __m128 x = _mm_loadu_ps(v + i);
+        bits |= uint64_t(_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(x, vlo), _mm_cmple_ps(x, vhi)))) << i;
+    }
+    return bits;
+}
+
+MDB_SSE42 uint64_t rangeF64Sse42(const double* v, double lo, double hi) {
+    const __m128d vlo = _mm_set1_pd(lo), vhi = _mm_set1_pd(hi);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 2) {
+        const __m128d x = _mm_loadu_pd(v + i);
+        bits |= uint64_t(_mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(x, vlo), _mm_cmple_pd(x, vhi)))) << i;
+    }
+    return bits;
+}
+
+MDB_SSE42 uint64_t sumU32Sse42(const uint32_t* v, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+        acc = _mm_add_epi64(acc, _mm_add_epi64(_mm_unpacklo_epi32(x, zero), _mm_unpackhi_epi32(x, zero)));
+    }
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + sumScalar(v + i, n - i);
+}
+
+MDB_SSE42 int64_t sumI64Sse42(const int64_t* v, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) acc = _mm_add_epi64(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)));
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return int64_t(lanes[0] + lanes[1] + uint64_t(sumScalar(v + i, n - i)));
+}
+
+MDB_SSE42 double sumF32Sse42(const float* v, size_t n) {
+    __m128d acc = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 x = _mm_loadu_ps(v + i);
+        acc = _mm_add_pd(acc, _mm_add_pd(_mm_cvtps_pd(x), _mm_cvtps_pd(_mm_movehl_ps(x, x))));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, acc);
+    return lanes[0] + lanes[1] + sumScalar(v + i, n - i);
+}
+
+MDB_SSE42 double sumF64Sse42(const double* v, size_t n) {
+    __m128d acc = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) acc = _mm_add_pd(acc, _mm_loadu_pd(v + i));
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, acc);
+    return lanes[0] + lanes[1] + sumScalar(v + i, n - i);
+}
+
+template <bool Max>
+MDB_SSE42 uint32_t extremeU32Sse42(const uint32_t* v, size_t n) {
+    __m128i acc = _mm_set1_epi32(int(Max ? 0u : UINT32_MAX));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+        acc = Max ? _mm_max_epu32(acc, x) : _mm_min_epu32(acc, x);
+    }
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return Max ? foldMax(lanes, 4, v + i, n - i) : foldMin(lanes, 4, v + i, n - i);
+}
+
+template <bool Max>
+MDB_SSE42 int64_t extremeI64Sse42(const int64_t* v, size_t n) {
+    __m128i acc = _mm_set1_epi64x(Max ? INT64_MIN : INT64_MAX);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+        const __m128i take = Max ? _mm_cmpgt_epi64(x, acc) : _mm_cmpgt_epi64(acc, x);
+        acc = _mm_blendv_epi8(acc, x, take);
+    }
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return Max ? foldMax(lanes, 2, v + i, n - i) : foldMin(lanes, 2, v + i, n - i);
+}
+
+// min/max return the second operand when either is NaN, so a NaN value
+// leaves the accumulator as it was.
+template <bool Max>
+MDB_SSE42 float extremeF32Sse42(const float* v, size_t n) {
+    __m128 acc = _mm_set1_ps(Max ? lowest<float>() : highest<float>());
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 x = _mm_loadu_ps(v + i);
+        acc = Max ? _mm_max_ps(x, acc) : _mm_min_ps(x, acc);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    return Max ? foldMax(lanes, 4, v + i, n - i) : foldMin(lanes, 4, v + i, n - i);
+}
+
+template <bool Max>
+MDB_SSE42 double extremeF64Sse42(const double* v, size_t n) {
+    __m128d acc = _mm_set1_pd(Max ? lowest<double>() : highest<double>());
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m128d x = _mm_loadu_pd(v + i);
+        acc = Max ? _mm_max_pd(x, acc) : _mm_min_pd(x, acc);
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, acc);
+    return Max ? foldMax(lanes, 2, v + i, n - i) : foldMin(lanes, 2, v + i, n - i);
+}
+
+constexpr Kernels kSse42 = {
+    {rangeU32Sse42, sumU32Sse42, extremeU32Sse42<false>, extremeU32Sse42<true>},
+    {rangeI64Sse42, sumI64Sse42, extremeI64Sse42<false>, extremeI64Sse42<true>},
+    {rangeF32Sse42, sumF32Sse42, extremeF32Sse42<false>, extremeF32Sse42<true>},
+    {rangeF64Sse42, sumF64Sse42, extremeF64Sse42<false>, extremeF64Sse42<true>},
+};
+
+// ── AVX2 (32 bytes) ───────────────────────────────────────────────────────────
+
+#define MDB_AVX2 __attribute__((target("avx2")))
+
+MDB_AVX2 uint64_t rangeU32Avx2(const uint32_t* v, uint32_t lo, uint32_t hi) {
+    const __m256i vlo = _mm256_set1_epi32(int(lo));
+    const __m256i span = _mm256_set1_epi32(int(hi - lo));
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 8) {
+        const __m256i x = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i)), vlo);
+        const __m256i in = _mm256_cmpeq_epi32(_mm256_min_epu32(x, span), x);
+        bits |= uint64_t(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(in)))) << i;
+    }
+    return bits;
+}
+
+MDB_AVX2 uint64_t rangeI64Avx2(const int64_t* v, int64_t lo, int64_t hi) {
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i vlo = _mm256_set1_epi64x(lo);
+    const __m256i span = _mm256_xor_si256(_mm256_set1_epi64x(int64_t(uint64_t(hi) - uint64_t(lo))), sign);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 4) {
+        const __m256i x = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i)), vlo);
+        const __m256i out = _mm256_cmpgt_epi64(_mm256_xor_si256(x, sign), span);
+        bits |= uint64_t(~_mm256_movemask_pd(_mm256_castsi256_pd(out)) & 0xF) << i;
+    }
+    return bits;
+}
+
+MDB_AVX2 uint64_t rangeF32Avx2(const float* v, float lo, float hi) {
+    const __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 8) {
+        const __m256 x = _mm256_loadu_ps(v + i);
+        const __m256 in = _mm256_and_ps(_mm256_cmp_ps(x, vlo, _CMP_GE_OQ), _mm256_cmp_ps(x, vhi, _CMP_LE_OQ));
+        bits |= uint64_t(uint32_t(_mm256_movemask_ps(in))) << i;
+    }
+    return bits;
+}
+
+MDB_AVX2 uint64_t rangeF64Avx2(const double* v, double lo, double hi) {
+    const __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 4) {
+        const __m256d x = _mm256_loadu_pd(v + i);
+        const __m256d in = _mm256_and_pd(_mm256_cmp_pd(x, vlo, _CMP_GE_OQ), _mm256_cmp_pd(x, vhi, _CMP_LE_OQ));
+        bits |= uint64_t(uint32_t(_mm256_movemask_pd(in))) << i;
+    }
+    return bits;
+}
+
+MDB_AVX2 uint64_t sumU32Avx2(const uint32_t* v, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(x)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumScalar(v + i, n - i);
+}
+
+MDB_AVX2 int64_t sumI64Avx2(const int64_t* v, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i)));
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return int64_t(lanes[0] + lanes[1] + lanes[2] + lanes[3] + uint64_t(sumScalar(v + i, n - i)));
+}
+
+MDB_AVX2 double sumF32Avx2(const float* v, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm_loadu_ps(v + i)));
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumScalar(v + i, n - i);
+}
+
+MDB_AVX2 double sumF64Avx2(const double* v, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) acc = _mm256_add_pd(acc, _mm256_loadu_pd(v + i));
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumScalar(v + i, n - i);
+}
+
+template <bool Max>
+MDB_AVX2 uint32_t extremeU32Avx2(const uint32_t* v, size_t n) {
+    __m256i acc = _mm256_set1_epi32(int(Max ? 0u : UINT32_MAX));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+        acc = Max ? _mm256_max_epu32(acc, x) : _mm256_min_epu32(acc, x);
+    }
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return Max ? foldMax(lanes, 8, v + i, n - i) : foldMin(lanes, 8, v + i, n - i);
+}
+
+template <bool Max>
+MDB_AVX2 int64_t extremeI64Avx2(const int64_t* v, size_t n) {
+    __m256i acc = _mm256_set1_epi64x(Max ? INT64_MIN : INT64_MAX);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+        const __m256i take = Max ? _mm256_cmpgt_epi64(x, acc) : _mm256_cmpgt_epi64(acc, x);
+        acc = _mm256_blendv_epi8(acc, x, take);
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return Max ? foldMax(lanes, 4, v + i, n - i) : foldMin(lanes, 4, v + i, n - i);
+}
+
+template <bool Max>
+MDB_AVX2 float extremeF32Avx2(const float* v, size_t n) {
+    __m256 acc = _mm256_set1_ps(Max ? lowest<float>() : highest<float>());
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 x = _mm256_loadu_ps(v + i);
+        acc = Max ? _mm256_max_ps(x, acc) : _mm256_min_ps(x, acc);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    return Max ? foldMax(lanes, 8, v + i, n - i) : foldMin(lanes, 8, v + i, n - i);
+}
+
+template <bool Max>
+MDB_AVX2 double extremeF64Avx2(const double* v, size_t n) {
+    __m256d acc = _mm256_set1_pd(Max ? lowest<double>() : highest<double>());
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d x = _mm256_loadu_pd(v + i);
+        acc = Max ? _mm256_max_pd(x, acc) : _mm256_min_pd(x, acc);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    return Max ? foldMax(lanes, 4, v + i, n - i) : foldMin(lanes, 4, v + i, n - i);
+}
+
+constexpr Kernels kAvx2 = {
+    {rangeU32Avx2, sumU32Avx2, extremeU32Avx2<false>, extremeU32Avx2<true>},
+    {rangeI64Avx2, sumI64Avx2, extremeI64Avx2<false>, extremeI64Avx2<true>},
+    {rangeF32Avx2, sumF32Avx2, extremeF32Avx2<false>, extremeF32Avx2<true>},
+    {rangeF64Avx2, sumF64Avx2, extremeF64Avx2<false>, extremeF64Avx2<true>},
+};
+
+// ── AVX-512 (64 bytes; compares yield bit masks directly) ─────────────────────
+
+// GCC's AVX-512 headers seed masked conversions with a self-initialized
+// "undefined" vector, which -Wmaybe-uninitialized flags once inlined here.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+#define MDB_AVX512 __attribute__((target("avx512f")))
+
+MDB_AVX512 uint64_t rangeU32Avx512(const uint32_t* v, uint32_t lo, uint32_t hi) {
+    const __m512i vlo = _mm512_set1_epi32(int(lo));
+    const __m512i span = _mm512_set1_epi32(int(hi - lo));
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 16) {
+        const __m512i x = _mm512_sub_epi32(_mm512_loadu_si512(v + i), vlo);
+        bits |= uint64_t(_mm512_cmple_epu32_mask(x, span)) << i;
+    }
+    return bits;
+}
+
+MDB_AVX512 uint64_t rangeI64Avx512(const int64_t* v, int64_t lo, int64_t hi) {
+    const __m512i vlo = _mm512_set1_epi64(lo);
+    const __m512i span = _mm512_set1_epi64(int64_t(uint64_t(hi) - uint64_t(lo)));
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 8) {
+        const __m512i x = _mm512_sub_epi64(_mm512_loadu_si512(v + i), vlo);
+        bits |= uint64_t(_mm512_cmple_epu64_mask(x, span)) << i;
+    }
+    return bits;
+}
+
+MDB_AVX512 uint64_t rangeF32Avx512(const float* v, float lo, float hi) {
+    const __m512 vlo = _mm512_set1_ps(lo), vhi = _mm512_set1_ps(hi);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 16) {
+        const __m512 x = _mm512_loadu_ps(v + i);
+        const __mmask16 in = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(x, vlo, _CMP_GE_OQ), x, vhi, _CMP_LE_OQ);
+        bits |= uint64_t(in) << i;
+    }
+    return bits;
+}
+
+MDB_AVX512 uint64_t rangeF64Avx512(const double* v, double lo, double hi) {
+    const __m512d vlo = _mm512_set1_pd(lo), vhi = _mm512_set1_pd(hi);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kBlock; i += 8) {
+        const __m512d x = _mm512_loadu_pd(v + i);
+        const __mmask8 in = _mm512_mask_cmp_pd_mask(_mm512_cmp_pd_mask(x, vlo, _CMP_GE_OQ), x, vhi, _CMP_LE_OQ);
+        bits |= uint64_t(in) << i;
+    }
+    return bits;
+}
+
+MDB_AVX512 uint64_t sumU32Avx512(const uint32_t* v, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        acc = _mm512_add_epi64(acc, _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i))));
+    alignas(64) int64_t lanes[8];
+    _mm512_store_si512(lanes, acc);
+    return uint64_t(sumScalar(lanes, 8)) + sumScalar(v + i, n - i);
+}
+
+MDB_AVX512 int64_t sumI64Avx512(const int64_t* v, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) acc = _mm512_add_epi64(acc, _mm512_loadu_si512(v + i));
+    alignas(64) int64_t lanes[8];
+    _mm512_store_si512(lanes, acc);
+    return int64_t(uint64_t(sumScalar(lanes, 8)) + uint64_t(sumScalar(v + i, n - i)));
+}
+
+MDB_AVX512 double sumF32Avx512(const float* v, size_t n) {
+    __m512d acc = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) acc = _mm512_add_pd(acc, _mm512_cvtps_pd(_mm256_loadu_ps(v + i)));
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, acc);
+    return sumScalar(lanes, 8) + sumScalar(v + i, n - i);
+}
+
+MDB_AVX512 double sumF64Avx512(const double* v, size_t n) {
+    __m512d acc = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) acc = _mm512_add_pd(acc, _mm512_loadu_pd(v + i));
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, acc);
+    return sumScalar(lanes, 8) + sumScalar(v + i, n - i);
+}
+
+template <bool Max>
+MDB_AVX512 uint32_t extremeU32Avx512(const uint32_t* v, size_t n) {
+    __m512i acc = _mm512_set1_epi32(int(Max ? 0u : UINT32_MAX));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i x = _mm512_loadu_si512(v + i);
+        acc = Max ? _mm512_max_epu32(acc, x) : _mm512_min_epu32(acc, x);
+    }
+    alignas(64) uint32_t lanes[16];
+    _mm512_store_si512(lanes, acc);
+    return Max ? foldMax(lanes, 16, v + i, n - i) : foldMin(lanes, 16, v + i, n - i);
+}
+
+template <bool Max>
+MDB_AVX512 int64_t extremeI64Avx512(const int64_t* v, size_t n) {
+    __m512i acc = _mm512_set1_epi64(Max ? INT64_MIN : INT64_MAX);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m512i x = _mm512_loadu_si512(v + i);
+        acc = Max ? _mm512_max_epi64(acc, x) : _mm512_min_epi64(acc, x);
+    }
+    alignas(64) int64_t lanes[8];
+    _mm512_store_si512(lanes, acc);
+    return Max ? foldMax(lanes, 8, v + i, n - i) : foldMin(lanes, 8, v + i, n - i);
+}
+
+template <bool Max>
+MDB_AVX512 float extremeF32Avx512(const float* v, size_t n) {
+    __m512 acc = _mm512_set1_ps(Max ? lowest<float>() : highest<float>());
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512 x = _mm512_loadu_ps(v + i);
+        acc = Max ? _mm512_max_ps(x, acc) : _mm512_min_ps(x, acc);
+    }
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, acc);
+    return Max ? foldMax(lanes, 16, v + i, n - i) : foldMin(lanes, 16, v + i, n - i);
+}
+
+template <bool Max>
+MDB_AVX512 double extremeF64Avx512(const double* v, size_t n) {
+    __m512d acc = _mm512_set1_pd(Max ? lowest<double>() : highest<double>());
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m512d x = _mm512_loadu_pd(v + i);
+        acc = Max ? _mm512_max_pd(x, acc) : _mm512_min_pd(x, acc);
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, acc);
+    return Max ? foldMax(lanes, 8, v + i, n - i) : foldMin(lanes, 8, v + i, n - i);
+}
+
+constexpr Kernels kAvx512 = {
+    {rangeU32Avx512, sumU32Avx512, extremeU32Avx512<false>, extremeU32Avx512<true>},
+    {rangeI64Avx512, sumI64Avx512, extremeI64Avx512<false>, extremeI64Avx512<true>},
+    {rangeF32Avx512, sumF32Avx512, extremeF32Avx512<false>, extremeF32Avx512<true>},
+    {rangeF64Avx512, sumF64Avx512, extremeF64Avx512<false>, extremeF64Avx512<true>},
+};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+Isa detectIsa() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::Avx512;
+    if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+    if (__builtin_cpu_supports("sse4.2")) return Isa::Sse42;
+    return Isa::Scalar;
+}
+
+#else
+
+Isa detectIsa() { return Isa::Scalar; }
+
+#endif
+
+const Kernels* kernelsFor(Isa isa) {
+    switch (isa) {
+#if defined(MDB_SIMD_X86)
+        case Isa::Sse42:  return &kSse42;
+        case Isa::Avx2:   return &kAvx2;
+        case Isa::Avx512: return &kAvx512;
+#endif
+        default:          return &kScalar;
+    }
+}
+
+const Isa kBestIsa = detectIsa();
+std::atomic<Isa> activeIsa_{kBestIsa};
+std::atomic<const Kernels*> active_{kernelsFor(kBestIsa)};
+
+template <typename T> const Ops<T>& ops();
+template <> const Ops<uint32_t>& ops() { return active_.load(std::memory_order_relaxed)->u32; }
+template <> const Ops<int64_t>& ops()  { return active_.load(std::memory_order_relaxed)->i64; }
+template <> const Ops<float>& ops()    { return active_.load(std::memory_order_relaxed)->f32; }
+template <> const Ops<double>& ops()   { return active_.load(std::memory_order_relaxed)->f64; }
+
+// A compare as an inclusive range, and whether to take its complement (Ne).
+// Nothing matches an empty range (lo > hi, or a NaN bound).
+template <typename T>
+bool compareRange(Simd::CmpOp op, T key, T& lo, T& hi) {
+    using Simd::CmpOp;
+    lo = lowest<T>();
+    hi = highest<T>();
+    switch (op) {
+        case CmpOp::Eq:
+        case CmpOp::Ne:
+            lo = hi = key;
+            break;
+        case CmpOp::Le: hi = key; break;
+        case CmpOp::Ge: lo = key; break;
+        case CmpOp::Lt:
+            if (key == lowest<T>()) std::swap(lo, hi);
+            else if constexpr (std::is_floating_point<T>::value) hi = std::nextafter(key, lo);
+            else hi = key - 1;
+            break;
+        case CmpOp::Gt:
+            if (key == highest<T>()) std::swap(lo, hi);
+            else if constexpr (std::is_floating_point<T>::value) lo = std::nextafter(key, hi);
+            else lo = key + 1;
+            break;
+    }
+    return op == CmpOp::Ne;
+}
+
+inline uint64_t lowBits(size_t n) { return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1; }
+
+template <typename T>
+uint64_t rangeWord(const Ops<T>& k, const T* v, size_t n, T lo, T hi, bool empty, bool invert) {
+    uint64_t bits = empty ? 0 : n == kBlock ? k.range(v, lo, hi) : rangeScalar(v, n, lo, hi);
+    return invert ? ~bits & lowBits(n) : bits;
+}
+
+template <typename T>
+void maskRange(const T* values, size_t n, T lo, T hi, bool invert, uint64_t* bits) {
+    const Ops<T>& k = ops<T>();
+    const bool empty = !(lo <= hi);
+    for (size_t i = 0; i < n; i += kBlock)
+        bits[i / kBlock] = rangeWord(k, values + i, std::min(kBlock, n - i), lo, hi, empty, invert);
+}
+
+template <typename T>
+size_t selectRange(const T* values, size_t n, T lo, T hi, bool invert, const uint32_t* ids, uint32_t* out) {
+    const Ops<T>& k = ops<T>();
+    const bool empty = !(lo <= hi);
+    if (empty && !invert) return 0;
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += kBlock) {
+        uint64_t bits = rangeWord(k, values + i, std::min(kBlock, n - i), lo, hi, empty, invert);
+        while (bits) {
+            const size_t at = i + size_t(__builtin_ctzll(bits));
+            out[count++] = ids ? ids[at] : uint32_t(at);
+            bits &= bits - 1;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+namespace Simd {
+
+Isa bestIsa() { return kBestIsa; }
+
+Isa activeIsa() { return activeIsa_.load(std::memory_order_relaxed); }
+
+void setIsa(Isa isa) {
+    // The x86 levels nest: a CPU with AVX2 also runs the SSE4.2 kernels.
+    if (isa > kBestIsa) throw std::invalid_argument(std::string("ISA not supported by this CPU: ") + isaName(isa));
+    activeIsa_.store(isa, std::memory_order_relaxed);
+    active_.store(kernelsFor(isa), std::memory_order_relaxed);
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::Sse42:  return "sse4.2";
+        case Isa::Avx2:   return "avx2";
+        case Isa::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+template <typename T>
+void maskBetween(const T* values, size_t n, T lo, T hi, uint64_t* bits) {
+    maskRange(values, n, lo, hi, false, bits);
+}
+
+template <typename T>
+void maskCompare(const T* values, size_t n, CmpOp op, T key, uint64_t* bits) {
+    T lo, hi;
+    const bool invert = compareRange(op, key, lo, hi);
+    maskRange(values, n, lo, hi, invert, bits);
+}
+
+template <typename T>
+size_t selectBetween(const T* values, size_t n, T lo, T hi, const uint32_t* ids, uint32_t* out) {
+    return selectRange(values, n, lo, hi, false, ids, out);
+}
+
+template <typename T>
+size_t selectCompare(const T* values, size_t n, CmpOp op, T key, const uint32_t* ids, uint32_t* out) {
+    T lo, hi;
+    const bool invert = compareRange(op, key, lo, hi);
+    return selectRange(values, n, lo, hi, invert, ids, out);
+}
+
+uint64_t sum(const uint32_t* values, size_t n) { return ops<uint32_t>().sum(values, n); }
+int64_t sum(const int64_t* values, size_t n) { return ops<int64_t>().sum(values, n); }
+double sum(const float* values, size_t n) { return ops<float>().sum(values, n); }
+double sum(const double* values, size_t n) { return ops<double>().sum(values, n); }
+
+template <typename T>
+T min(const T* values, size_t n) { return ops<T>().min(values, n); }
+
+template <typename T>
+T max(const T* values, size_t n) { return ops<T>().max(values, n); }
+
+#define MDB_SIMD_INSTANTIATE(T)                                                                        \
+    template void maskBetween<T>(const T*, size_t, T, T, uint64_t*);                                   \
+    template void maskCompare<T>(const T*, size_t, CmpOp, T, uint64_t*);                              \
+    template size_t selectBetween<T>(const T*, size_t, T, T, const uint32_t*, uint32_t*);              \
+    template size_t selectCompare<T>(const T*, size_t, CmpOp, T, const uint32_t*, uint32_t*);          \
+    template T min<T>(const T*, size_t);                                                               \
+    template T max<T>(const T*, size_t);
+
+MDB_SIMD_INSTANTIATE(uint32_t)
+MDB_SIMD_INSTANTIATE(int64_t)
+MDB_SIMD_INSTANTIATE(float)
+MDB_SIMD_INSTANTIATE(double)
+
+#undef MDB_SIMD_INSTANTIATE
+
+}
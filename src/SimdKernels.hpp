@@ -0,0 +1,58 @@
+// SimdKernels.hpp — vectorized predicates and reductions over column values.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Kernels over contiguous UINT32, INT64, FLOAT and DOUBLE values for the CPU
+// scan paths. Each runs on the widest vector unit available: AVX-512, AVX2 or
+// SSE4.2 on x86-64 (detected at runtime), with plain loops elsewhere. Every
+// ISA gives the scalar results, except that floating-point sums may round
+// differently (the additions are reordered). NaN values never match a
+// predicate other than Ne and are skipped by min/max.
+namespace Simd {
+
+enum class Isa : uint8_t { Scalar, Sse42, Avx2, Avx512 };
+
+// The best ISA this CPU supports, and the one the kernels use (the best, by
+// default). setIsa() is for tests and benchmarks: it throws
+// std::invalid_argument for an ISA the CPU lacks and must not race kernels.
+Isa bestIsa();
+Isa activeIsa();
+void setIsa(Isa isa);
+const char* isaName(Isa isa);
+
+enum class CmpOp : uint8_t { Eq, Ne, Lt, Le, Gt, Ge };
+
+// Words in a selection bitmap over n values.
+inline size_t maskWords(size_t n) { return (n + 63) / 64; }
+
+// Selection bitmaps: bit i of `bits` (maskWords(n) words) is set when
+// values[i] matches; bits past n are clear. Between is inclusive.
+template <typename T>
+void maskBetween(const T* values, size_t n, T lo, T hi, uint64_t* bits);
+template <typename T>
+void maskCompare(const T* values, size_t n, CmpOp op, T key, uint64_t* bits);
+
+// Compacted selections: for each match, in order, writes ids[i] (or i when
+// `ids` is null) to `out`, which has room for n and may be `ids` itself.
+// Returns the match count.
+template <typename T>
+size_t selectBetween(const T* values, size_t n, T lo, T hi, const uint32_t* ids, uint32_t* out);
+template <typename T>
+size_t selectCompare(const T* values, size_t n, CmpOp op, T key, const uint32_t* ids, uint32_t* out);
+
+// Sums widen (UINT32 into 64 bits, FLOAT into double); INT64 wraps.
+uint64_t sum(const uint32_t* values, size_t n);
+int64_t sum(const int64_t* values, size_t n);
+double sum(const float* values, size_t n);
+double sum(const double* values, size_t n);
+
+// Of no values: the type's largest value (+inf) for min, its lowest (-inf)
+// for max.
+template <typename T>
+T min(const T* values, size_t n);
+template <typename T>
+T max(const T* values, size_t n);
+
+}
@@ -1,13 +1,20 @@
 // Table.cpp
 #include "Table.hpp"
 #include "ColumnFile.hpp"
+#include "SimdKernels.hpp"
+#include "Vectorized.hpp"
 #include "gpu_string_scan.h"
 #include <algorithm>
 #include <fcntl.h>
+#include <sys/file.h>
 #include <unistd.h>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <exception>
 #include <stdexcept>
 #include <unordered_map>
+#include <unordered_set>
 // GPU hooks (implemented in gpu_scan_equals.mm)
 extern "C" bool metalIsAvailable();
 std::vector<uint32_t>
@@ -15,6 +22,25 @@ gpuScanEquals(const std::vector<uint32_t>& values,
               const std::vector<uint32_t>& rowIDs,
               uint32_t needle);
 
+class Table::FileLock {
+public:
+    explicit FileLock(Table& table) : table_(table) {
+        std::lock_guard<std::mutex> lock(table_.fileLockMu_);
+        if (table_.fileLockHolders_ == 0 && ::flock(table_.fd_, LOCK_EX) != 0)
+            throw std::runtime_error(std::string("lock table file failed: ") + std::strerror(errno));
+        ++table_.fileLockHolders_;
+    }
+    ~FileLock() {
+        std::lock_guard<std::mutex> lock(table_.fileLockMu_);
+        if (--table_.fileLockHolders_ == 0) ::flock(table_.fd_, LOCK_UN);
+    }
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+    Table& table_;
+};
+
 void Table::openOrCreate(uint16_t pageSize, uint16_t numColumns, bool create) {
     fd_ = open(path_.c_str(), O_RDWR | O_CREAT, 0666);
     assert(fd_ >= 0);
@@ -35,8 +61,11 @@ void Table::openOrCreate(uint16_t pageSize, uint16_t numColumns, bool create) {
     // Initialize/open RowIndex sidecar now that numColumns is known
     rowIndex_ = RowIndex(path_, numColumns);
     rowIndex_.openOrCreate(create);
+    wal_.setSchema(mp_.colTypes);
     wal_.openOrCreate(create);
+    openIndexes(create);
     if (!create) recoverFromWal();
+    wal_.setSyncInterval(kNormalSyncInterval);
 }
 
 extern "C" std::vector<uint32_t>
@@ -45,8 +74,126 @@ gpuScanBetween(const std::vector<uint32_t>& values,
                uint32_t lo, uint32_t hi);
 
 
+namespace {
+
+// v in [lo, hi] on a numeric column of `type`, all three of that type.
+bool numericInRange(ColType type, const ColValue& v, const ColValue& lo, const ColValue& hi) {
+    switch (type) {
+        case ColType::UINT32: return lo.u32 <= v.u32 && v.u32 <= hi.u32;
+        case ColType::INT64:  return lo.i64 <= v.i64 && v.i64 <= hi.i64;
+        case ColType::FLOAT:  return lo.f32 <= v.f32 && v.f32 <= hi.f32;
+        case ColType::DOUBLE: return lo.f64 <= v.f64 && v.f64 <= hi.f64;
+        default:              return false;
+    }
+}
+
+template <typename T>
+std::vector<T> concat(std::vector<std::vector<T>>&& parts) {
+    if (parts.size() == 1) return std::move(parts.front());
+    size_t n = 0;
+    for (const auto& part : parts) n += part.size();
+    std::vector<T> out;
+    out.reserve(n);
+    for (const auto& part : parts) out.insert(out.end(), part.begin(), part.end());
+    return out;
+}
+
+} // namespace
+
+template <typename Result, typename Scan>
+std::vector<Result> Table::scanMorsels(uint16_t colIdx, Scan scan) {
+    const uint32_t rows = rowIndex_.rowsRecorded();
+    if (!pool_ || pool_->size() == 1 || rowIndex_.liveRows() < kParallelRows) {
+        std::vector<Result> out(1);
+        scan(0, rows, out.front());
+        return out;
+    }
+    // Rows appended together share pages, so a morsel covers a run of pages.
+    const size_t morselRows = std::max<size_t>(1, size_t(cols_[colIdx].slotsPerPage()) * kMorselPages);
+    std::vector<Result> out((rows + morselRows - 1) / morselRows);
+    pool_->run(out.size(), [&](size_t m, size_t /*worker*/) {
+        const size_t first = m * morselRows;
+        scan(uint32_t(first), uint32_t(std::min<size_t>(rows, first + morselRows)), out[m]);
+    });
+    return out;
+}
+
+template <typename Fn>
+void Table::forEachLiveSlot(uint16_t colIdx, uint32_t first, uint32_t end, Fn fn) {
+    const ColumnFile& col = cols_[colIdx];
+    const ColumnPage* page = nullptr;
+    uint16_t pid = 0;
+    rowIndex_.forEachLive(first, end, [&](uint32_t rowID, const std::vector<uint32_t>& slots) {
+        const uint16_t p = ColumnFile::pageIdFromSlotId(slots[colIdx]);
+        const uint16_t idx = ColumnFile::slotIdxFromSlotId(slots[colIdx]);
+        if (!page || p != pid) {
+            page = &col.sharedPageRef(p);
+            pid = p;
+        }
+        if (idx < page->capacity && page->tombstone[idx]) fn(rowID, *page, idx);
+    });
+}
+
+template <typename KeepPage, typename Fn>
+void Table::scanPages(uint16_t colIdx, uint32_t first, uint32_t end, KeepPage keepPage, Fn fn) {
+    const ColumnFile& col = cols_[colIdx];
+    const ColumnPage* page = nullptr;  // null while the current page is skipped
+    bool started = false;
+    uint16_t pid = 0;
+    std::vector<uint32_t> rowIDs;
+    std::vector<ValueType> values;     // the run's values once its slots stop being consecutive
+    uint16_t runStart = 0;
+    bool inPlace = true;
+
+    auto flush = [&] {
+        if (rowIDs.empty()) return;
+        const ValueType* v = inPlace ? reinterpret_cast<const ValueType*>(page->rawValues.data()) + runStart
+                                     : values.data();
+        fn(v, rowIDs.data(), rowIDs.size());
+        rowIDs.clear();
+        values.clear();
+        inPlace = true;
+    };
+    rowIndex_.forEachLive(first, end, [&](uint32_t rowID, const std::vector<uint32_t>& slots) {
+        const uint16_t p = ColumnFile::pageIdFromSlotId(slots[colIdx]);
+        const uint16_t idx = ColumnFile::slotIdxFromSlotId(slots[colIdx]);
+        if (!started || p != pid) {
+            flush();
+            started = true;
+            pid = p;
+            const auto [pmin, pmax] = col.zoneMap(p);  // header peek; the page is read only if kept
+            page = keepPage(pmin, pmax) ? &col.sharedPageRef(p) : nullptr;
+        }
+        if (!page || idx >= page->capacity || !page->tombstone[idx]) return;
+        if (rowIDs.empty()) {
+            runStart = idx;
+        } else if (inPlace && idx != runStart + rowIDs.size()) {
+            for (size_t i = 0; i < rowIDs.size(); ++i) values.push_back(page->readValue(runStart + int(i)));
+            inPlace = false;
+        }
+        if (!inPlace) values.push_back(page->readValue(idx));
+        rowIDs.push_back(rowID);
+    });
+    flush();
+}
+
 std::vector<uint32_t> Table::whereBetween(uint16_t colIdx, ValueType lo, ValueType hi) {
     assert(colIdx < cols_.size());
+    if (auto hits = indexLookup(colIdx, lo, hi)) return std::move(*hits);
+
+    // CPU: evaluate inside the page walk, keeping only the matches.
+    if (!useGPU_ || rowIndex_.liveRows() < gpuThreshold_ || !metalIsAvailable()) {
+        if (lo > hi) return {};
+        return concat(scanMorsels<std::vector<uint32_t>>(colIdx, [&](uint32_t first, uint32_t end,
+                                                                      std::vector<uint32_t>& out) {
+            scanPages(colIdx, first, end, [&](ValueType pmin, ValueType pmax) { return pmax >= lo && pmin <= hi; },
+                      [&](const ValueType* values, const uint32_t* rowIDs, size_t n) {
+                          const size_t at = out.size();
+                          out.resize(at + n);
+                          out.resize(at + Simd::selectBetween(values, n, lo, hi, rowIDs, out.data() + at));
+                      });
+        }));
+    }
 
     std::vector<ValueType> values; values.reserve(1024);
     std::vector<uint32_t>  rowIDs; rowIDs.reserve(1024);
@@ -76,12 +223,11 @@ std::vector<uint32_t> Table::whereBetween(uint16_t colIdx, ValueType lo, ValueTy
         }
     });
 
-    // CPU small path
+    // Few candidates left after pruning: not worth a GPU dispatch.
     const size_t n = values.size();
-    if (!useGPU_ || n < gpuThreshold_ || !metalIsAvailable()) {
-        std::vector<uint32_t> out; out.reserve(n);
-        for (size_t i = 0; i < n; ++i)
-            if (values[i] >= lo && values[i] <= hi) out.push_back(rowIDs[i]);
+    if (n < gpuThreshold_) {
+        std::vector<uint32_t> out(n);
+        out.resize(Simd::selectBetween(values.data(), n, lo, hi, rowIDs.data(), out.data()));
         return out;
     }
 
@@ -96,19 +242,33 @@ void Table::validatePredicate(const Predicate& predicate) const {
     const ColType type = cols_[predicate.colIdx].colType();
     switch (predicate.kind) {
         case Predicate::Kind::EQ:
-            if (type != ColType::UINT32)
-                throw std::invalid_argument("numeric predicates require UINT32 columns");
-            return;
-        case Predicate::Kind::BETWEEN:
-            if (type != ColType::UINT32)
-                throw std::invalid_argument("numeric predicates require UINT32 columns");
-            if (predicate.lo > predicate.hi)
+        case Predicate::Kind::BETWEEN: {
+            if (type == ColType::STRING)
+                throw std::invalid_argument("numeric predicates require numeric columns");
+            const bool between = predicate.kind == Predicate::Kind::BETWEEN;
+            if (type == ColType::UINT32) {
+                if (between && predicate.lo > predicate.hi)
+                    throw std::invalid_argument("BETWEEN predicates require lo <= hi");
+                return;
+            }
+            if (predicate.typedLo.type != type || (between && predicate.typedHi.type != type))
+                throw std::invalid_argument("predicate bounds must match the column type");
+            if (between && BPlusTree::encodeNumeric(predicate.typedHi, type) <
+                               BPlusTree::encodeNumeric(predicate.typedLo, type))
                 throw std::invalid_argument("BETWEEN predicates require lo <= hi");
             return;
+        }
         case Predicate::Kind::EQ_STRING:
+        case Predicate::Kind::PREFIX_STRING:
             if (type != ColType::STRING)
                 throw std::invalid_argument("string predicates require STRING columns");
             return;
+        case Predicate::Kind::BETWEEN_STRING:
+            if (type != ColType::STRING)
+                throw std::invalid_argument("string predicates require STRING columns");
+            if (predicate.needle > predicate.needleHi)
+                throw std::invalid_argument("BETWEEN predicates require lo <= hi");
+            return;
         default:
             throw std::invalid_argument("unknown predicate kind");
     }
@@ -129,6 +289,12 @@ std::vector<uint32_t> Table::allLiveRowIDs() const {
 std::vector<uint32_t> Table::scanPredicate(const Predicate& predicate) {
     validatePredicate(predicate);
 
+    if (cols_[predicate.colIdx].colType() != ColType::UINT32) {
+        if (predicate.kind == Predicate::Kind::EQ)
+            return scanNumericBetween(predicate.colIdx, predicate.typedLo, predicate.typedLo);
+        if (predicate.kind == Predicate::Kind::BETWEEN)
+            return scanNumericBetween(predicate.colIdx, predicate.typedLo, predicate.typedHi);
+    }
     switch (predicate.kind) {
         case Predicate::Kind::EQ:
             return scanEquals(predicate.colIdx, predicate.lo);
@@ -136,6 +302,10 @@ std::vector<uint32_t> Table::scanPredicate(const Predicate& predicate) {
             return whereBetween(predicate.colIdx, predicate.lo, predicate.hi);
         case Predicate::Kind::EQ_STRING:
             return scanEqualsString(predicate.colIdx, predicate.needle);
+        case Predicate::Kind::PREFIX_STRING:
+            return scanPrefixString(predicate.colIdx, predicate.needle);
+        case Predicate::Kind::BETWEEN_STRING:
+            return scanBetweenString(predicate.colIdx, predicate.needle, predicate.needleHi);
         default:
             throw std::invalid_argument("unknown predicate kind");
     }
@@ -189,20 +359,69 @@ std::vector<uint32_t> Table::unionRowIDs(const std::vector<uint32_t>& lhs,
     return out;
 }
 
+// A predicate with no index, bitmap or Bloom filter on its column, on a table
+// the CPU scans: whereAnd / whereOr evaluate all of these in a single pass.
+bool Table::scannedInPass(const Predicate& predicate) const {
+    const uint16_t c = predicate.colIdx;
+    if (hasIndex(c) || hasHashIndex(c) || hasBitmapIndex(c) || hasBloomFilter(c)) return false;
+    // The pass compares UINT32 values only.
+    const ColType type = cols_[c].colType();
+    if (type != ColType::UINT32 && type != ColType::STRING) return false;
+    return !useGPU_ || rowIndex_.liveRows() < gpuThreshold_ || !metalIsAvailable();
+}
+
+std::vector<uint32_t> Table::filterRows(const std::vector<Predicate>& predicates, bool anyOf) {
+    std::vector<uint32_t> rowIDs;
+    Vectorized::Sink sink([&](Vectorized::Batch& batch) {
+        for (uint32_t i : batch.sel) rowIDs.push_back(batch.rowIDs[i]);
+    });
+    Vectorized::Filter filter(*this, predicates, anyOf, sink);
+    Vectorized::Scan(*this, filter.columns()).run(filter);
+    return rowIDs;
+}
+
 std::vector<uint32_t> Table::whereAnd(const std::vector<Predicate>& predicates) {
     validatePredicates(predicates);
     if (predicates.empty()) return allLiveRowIDs();
 
-    std::vector<uint32_t> result = scanPredicate(predicates.front());
-    for (size_t i = 1; i < predicates.size(); ++i) {
-        if (result.empty()) return result;
-        // GPU scans may return unsorted IDs; sort both operands for merge.
-        std::sort(result.begin(), result.end());
-        auto rhs = scanPredicate(predicates[i]);
+    // Bitmap-backed predicates are ANDed first without touching column pages,
+    // then index probes; whatever is left is evaluated in one fused pass, and
+    // only while the running result is non-empty.
+    std::optional<RoaringBitmap> acc;
+    std::vector<const Predicate*> probed;
+    std::vector<Predicate> scanned;
+    for (const auto& predicate : predicates) {
+        if (auto bm = bitmapFor(predicate)) {
+            if (acc) *acc &= *bm;
+            else acc = std::move(bm);
+        } else if (scannedInPass(predicate)) {
+            scanned.push_back(predicate);
+        } else {
+            probed.push_back(&predicate);
+        }
+    }
+    if (acc) {
+        for (const Predicate* predicate : probed) {
+            if (acc->empty()) break;
+            auto rhs = scanPredicate(*predicate);
+            std::sort(rhs.begin(), rhs.end());
+            *acc &= RoaringBitmap::fromSorted(rhs);
+        }
+        if (!scanned.empty() && !acc->empty()) *acc &= RoaringBitmap::fromSorted(filterRows(scanned, false));
+        return acc->toVector();
+    }
+
+    std::optional<std::vector<uint32_t>> result;
+    for (const Predicate* predicate : probed) {
+        // GPU scans may return unsorted IDs; sort before the merge.
+        auto rhs = scanPredicate(*predicate);
         std::sort(rhs.begin(), rhs.end());
-        result = intersectRowIDs(result, rhs);
+        result = result ? intersectRowIDs(*result, rhs) : std::move(rhs);
+        if (result->empty()) return std::move(*result);
     }
-    return result;
+    if (scanned.empty()) return std::move(*result);
+    auto rhs = filterRows(scanned, false);
+    return result ? intersectRowIDs(*result, rhs) : rhs;
 }
 
 std::vector<uint32_t> Table::whereOr(const std::vector<Predicate>& predicates) {
@@ -211,9 +430,34 @@ std::vector<uint32_t> Table::whereOr(const std::vector<Predicate>& predicates) {
     // Single predicate: return raw scan result (same as whereEq / whereBetween).
     if (predicates.size() == 1) return scanPredicate(predicates[0]);
 
-    std::vector<uint32_t> result; // starts empty (trivially sorted)
+    // The scanned predicates share one fused pass; the rest are probed one by one.
+    std::vector<const Predicate*> probed;
+    std::vector<Predicate> scanned;
+    bool anyBitmap = false;
     for (const auto& predicate : predicates) {
-        auto rhs = scanPredicate(predicate);
+        anyBitmap = anyBitmap || hasBitmapIndex(predicate.colIdx);
+        if (scannedInPass(predicate)) scanned.push_back(predicate);
+        else probed.push_back(&predicate);
+    }
+    std::vector<uint32_t> result; // sorted: pass output is in rowID order
+    if (!scanned.empty()) result = filterRows(scanned, true);
+
+    if (anyBitmap) {
+        RoaringBitmap acc = RoaringBitmap::fromSorted(result);
+        for (const Predicate* predicate : probed) {
+            if (auto bm = bitmapFor(*predicate)) {
+                acc |= *bm;
+                continue;
+            }
+            auto rhs = scanPredicate(*predicate);
+            std::sort(rhs.begin(), rhs.end());
+            acc |= RoaringBitmap::fromSorted(rhs);
+        }
+        return acc.toVector();
+    }
+
+    for (const Predicate* predicate : probed) {
+        auto rhs = scanPredicate(*predicate);
         std::sort(rhs.begin(), rhs.end());
         result = unionRowIDs(result, rhs); // result is sorted after each union
     }
@@ -238,7 +482,10 @@ Table::Table(const std::string& path, uint16_t pageSize,
         cols_.emplace_back(path_, mp_, c);
     rowIndex_ = RowIndex(path_, numCols);
     rowIndex_.openOrCreate(/*create=*/true);
+    wal_.setSchema(mp_.colTypes);
     wal_.openOrCreate(/*create=*/true);
+    openIndexes(/*create=*/true);
+    wal_.setSyncInterval(kNormalSyncInterval);
 }
 
 Table::Table(const std::string& path)
@@ -246,6 +493,23 @@ Table::Table(const std::string& path)
     openOrCreate(/*pageSize*/0, /*numColumns*/0, /*create=*/false);
 }
 
+Table::~Table() {
+    stopCheckpointer();
+    // An open transaction is rolled back; nothing of it was logged or applied.
+    // Its hold on the write lock can only be released by the thread that took it.
+    if (txn_) {
+        assert(txn_->owner == std::this_thread::get_id());
+        txn_.reset();
+    }
+    // Nothing would replay unlogged writes, so they are made durable here.
+    if (durability_ == Durability::Off) {
+        try {
+            std::lock_guard<std::recursive_mutex> lock(writeMu_);
+            checkpointLocked();
+        } catch (const std::exception&) {}
+    }
+}
+
 std::vector<std::vector<ValueType>>
 Table::projectRows(const std::vector<uint32_t>& rowIDs, const std::vector<uint16_t>& cols) {
     std::vector<std::vector<ValueType>> out;
@@ -276,11 +540,27 @@ uint32_t Table::insertRow(const std::vector<ValueType>& values) {
 }
 
 uint32_t Table::insertTypedRow(const std::vector<ColValue>& values) {
+    uint32_t rowID;
+    uint64_t epoch;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMu_);
+        if (txn_) return txnInsert(values);
+        epoch = logInsert(values, rowID);
+    }
+    // Wait outside the lock so other writers can join the same sync.
+    if (epoch) wal_.awaitDurable(epoch);
+    noteWalGrowth();
+    return rowID;
+}
+
+uint64_t Table::logInsert(const std::vector<ColValue>& values, uint32_t& rowID) {
     assert(values.size() == cols_.size());
-    const uint32_t rowID = rowIndex_.rowsRecorded();
-    const uint64_t opID = wal_.appendInsert(rowID, values);
-    wal_.appendCommit(opID);
-    return insertTypedRowInternal(values, rowID);
+    if (mp_.primaryKey != MasterPage::kNoPrimaryKey && findByKey(values[mp_.primaryKey]))
+        throw std::invalid_argument("duplicate primary key");
+    rowID = rowIndex_.rowsRecorded();
+    const uint64_t epoch = durability_ == Durability::Off ? 0 : wal_.commitInsert(rowID, values);
+    insertTypedRowInternal(values, rowID);
+    return epoch;
 }
 
 std::vector<std::optional<ValueType>> Table::fetchRow(uint32_t rowID) {
@@ -304,11 +584,48 @@ std::vector<std::optional<ColValue>> Table::fetchTypedRow(uint32_t rowID) {
 }
 
 void Table::deleteRow(uint32_t rowID) {
+    uint64_t epoch;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMu_);
+        if (txn_) return txnDelete(rowID);
+        epoch = logDelete(rowID);
+    }
+    if (epoch) wal_.awaitDurable(epoch);
+    noteWalGrowth();
+}
+
+uint64_t Table::logDelete(uint32_t rowID) {
     auto slotsOpt = rowIndex_.fetch(rowID);
-    if (!slotsOpt) return;
-    const uint64_t opID = wal_.appendDelete(rowID);
-    wal_.appendCommit(opID);
+    if (!slotsOpt) return 0;
+    const uint64_t epoch = durability_ == Durability::Off ? 0 : wal_.commitDelete(rowID);
     deleteRowInternal(rowID);
+    return epoch;
+}
+
+bool Table::applyReplicated(const Wal::Operation& op) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (op.kind == Wal::Operation::Kind::Delete) {
+        logDelete(op.rowID);  // no-op for a dead row
+        return true;
+    }
+    const uint32_t next = rowIndex_.rowsRecorded();
+    if (op.rowID < next) return true;
+    if (op.rowID != next) return false;
+    if (op.values.size() != cols_.size())
+        throw std::runtime_error("WAL row width does not match table schema");
+    if (durability_ != Durability::Off) wal_.commitInsert(op.rowID, op.values);
+    insertTypedRowInternal(op.values, op.rowID);
+    return true;
+}
+
+void Table::rebuildIndexes() {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    for (uint16_t c = 0; c < cols_.size(); ++c) {
+        if (btrees_[c]) buildIndex(c);
+        if (hashes_[c]) buildHashIndex(c);
+        if (bitmaps_[c]) buildBitmapIndex(c);
+        if (blooms_[c]) buildBloomFilter(c, blooms_[c]->bitsPerKey());
+    }
 }
 
 uint32_t Table::insertTypedRowInternal(const std::vector<ColValue>& values, uint32_t expectedRowID) {
@@ -317,6 +634,50 @@ uint32_t Table::insertTypedRowInternal(const std::vector<ColValue>& values, uint
         slots[c] = cols_[c].allocTypedSlot(values[c]);
     const uint32_t rowID = rowIndex_.appendRow(slots);
     assert(rowID == expectedRowID);
+    for (size_t c = 0; c < cols_.size(); ++c) {
+        if (btrees_[c])
+            btrees_[c]->insert(BPlusTree::encodeKey(values[c], cols_[c].colType()), rowID);
+        if (hashes_[c])
+            hashes_[c]->insert(HashIndex::keyFor(values[c], cols_[c].colType()), rowID);
+        if (bitmaps_[c])
+            bitmaps_[c]->add(values[c], rowID);
+        if (blooms_[c])  // written at the next checkpoint (syncIndexes)
+            blooms_[c]->add(ColumnFile::pageIdFromSlotId(slots[c]),
+                            BloomFilter::hashOf(values[c], cols_[c].colType()));
+    }
+    return rowID;
+}
+
+uint32_t Table::upsertTypedRow(const std::vector<ColValue>& values) {
+    const uint16_t pk = requirePrimaryKey();
+    if (values.size() != cols_.size())
+        throw std::invalid_argument("row width does not match table schema");
+    uint32_t rowID;
+    uint64_t epoch;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMu_);
+        if (txn_) {
+            if (auto existing = txnFindByKey(values[pk])) txnDelete(*existing);
+            return txnInsert(values);
+        }
+        const auto existing = findByKey(values[pk]);
+        if (!existing) {
+            epoch = logInsert(values, rowID);
+        } else {
+            // The delete and the insert share one WAL commit, so after a crash
+            // either both are replayed or neither is.
+            std::vector<Wal::Operation> ops(2);
+            ops[0].kind = Wal::Operation::Kind::Delete;
+            ops[0].rowID = *existing;
+            ops[1].rowID = rowID = rowIndex_.rowsRecorded();
+            ops[1].values = values;
+            epoch = durability_ == Durability::Off ? 0 : wal_.commitBatch(ops);
+            deleteRowInternal(*existing);
+            insertTypedRowInternal(values, rowID);
+        }
+    }
+    if (epoch) wal_.awaitDurable(epoch);
+    noteWalGrowth();
     return rowID;
 }
 
@@ -324,60 +685,921 @@ void Table::deleteRowInternal(uint32_t rowID) {
     auto slotsOpt = rowIndex_.fetch(rowID);
     if (!slotsOpt) return;
     auto& slots = *slotsOpt;
+    // Index keys come from the stored values, so read them before the slots go.
+    for (size_t c = 0; c < cols_.size(); ++c) {
+        if (!btrees_[c] && !hashes_[c] && !bitmaps_[c]) continue;
+        auto cv = cols_[c].fetchTypedSlot(slots[c]);
+        if (!cv) continue;
+        if (btrees_[c]) btrees_[c]->erase(BPlusTree::encodeKey(*cv, cols_[c].colType()), rowID);
+        if (hashes_[c]) hashes_[c]->erase(HashIndex::keyFor(*cv, cols_[c].colType()), rowID);
+        if (bitmaps_[c]) bitmaps_[c]->remove(*cv, rowID);
+    }
     for (size_t c = 0; c < cols_.size(); ++c)
         cols_[c].deleteSlot(slots[c]);
     rowIndex_.markDeleted(rowID);
 }
 
+void Table::begin() {
+    std::unique_lock<std::recursive_mutex> hold(writeMu_);  // kept until commit() / rollback()
+    if (txn_) throw std::invalid_argument("transaction already open");
+    txn_ = std::make_unique<Transaction>();
+    txn_->firstRowID = rowIndex_.rowsRecorded();
+    txn_->hold = std::move(hold);
+    txn_->owner = std::this_thread::get_id();
+}
+
+void Table::commit() {
+    uint64_t epoch = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMu_);
+        if (!txn_) throw std::invalid_argument("no open transaction");
+        // Logged before any of it is applied. The pages it dirties reach disk
+        // only at a checkpoint, after the log, so replay restores the whole
+        // batch after a crash. A failed write leaves the transaction open
+        // with nothing applied.
+        if (!txn_->ops.empty() && durability_ != Durability::Off) epoch = wal_.commitBatch(txn_->ops);
+        // Destroyed before the guard, releasing begin()'s hold first.
+        const std::unique_ptr<Transaction> txn = std::move(txn_);
+        for (const auto& op : txn->ops) {
+            if (op.kind == Wal::Operation::Kind::Insert)
+                insertTypedRowInternal(op.values, op.rowID);
+            else
+                deleteRowInternal(op.rowID);
+        }
+    }
+    if (epoch) wal_.awaitDurable(epoch);
+    noteWalGrowth();
+}
+
+void Table::rollback() {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (!txn_) throw std::invalid_argument("no open transaction");
+    txn_.reset();
+}
+
+uint32_t Table::txnInsert(const std::vector<ColValue>& values) {
+    if (values.size() != cols_.size())
+        throw std::invalid_argument("row width does not match table schema");
+    const uint16_t pk = mp_.primaryKey;
+    if (pk != MasterPage::kNoPrimaryKey && txnFindByKey(values[pk]))
+        throw std::invalid_argument("duplicate primary key");
+    Wal::Operation op;
+    op.kind = Wal::Operation::Kind::Insert;
+    op.rowID = txn_->firstRowID + uint32_t(txn_->insertOps.size());
+    op.values = values;
+    if (pk != MasterPage::kNoPrimaryKey) txn_->keys[txnKeyOf(values[pk])] = op.rowID;
+    txn_->insertOps.push_back(txn_->ops.size());
+    txn_->ops.push_back(std::move(op));
+    return txn_->ops.back().rowID;
+}
+
+void Table::txnDelete(uint32_t rowID) {
+    if (txn_->deleted.count(rowID)) return;
+    const uint16_t pk = mp_.primaryKey;
+    if (rowID >= txn_->firstRowID) {
+        const size_t pending = rowID - txn_->firstRowID;
+        if (pending >= txn_->insertOps.size()) return;
+        if (pk != MasterPage::kNoPrimaryKey)
+            txn_->keys.erase(txnKeyOf(txn_->ops[txn_->insertOps[pending]].values[pk]));
+    } else if (!rowIndex_.fetch(rowID)) {
+        return;
+    }
+    txn_->deleted.insert(rowID);
+    Wal::Operation op;
+    op.kind = Wal::Operation::Kind::Delete;
+    op.rowID = rowID;
+    txn_->ops.push_back(std::move(op));
+}
+
+std::optional<uint32_t> Table::txnFindByKey(const ColValue& key) {
+    if (auto rowID = findByKey(key); rowID && !txn_->deleted.count(*rowID)) return rowID;
+    auto it = txn_->keys.find(txnKeyOf(key));
+    if (it == txn_->keys.end()) return std::nullopt;
+    return it->second;
+}
+
+std::string Table::txnKeyOf(const ColValue& key) const {
+    return key.type == ColType::STRING ? key.str : BPlusTree::encodeNumeric(key, key.type);
+}
+
+void Table::setDurability(Durability level) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    const Durability current = durability_;
+    if (level == current) return;
+    if (level == Durability::Off || current == Durability::Off) checkpointLocked();
+    wal_.setGroupCommit(level == Durability::Full);
+    wal_.setSyncInterval(level == Durability::Normal ? kNormalSyncInterval : std::chrono::milliseconds(0));
+    durability_ = level;
+}
+
 void Table::flushDurable() {
+    checkpoint();
+}
+
+void Table::checkpoint() {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Extent> pages, rows;
+    MasterPage master;
+    uint64_t lsn, walLsn, ticket;
+    size_t rowCount;
+    std::unique_lock<std::mutex> io(checkpointIoMu_, std::defer_lock);
+    {
+        // Capture, under the write lock: the WAL moves on to a fresh segment
+        // and every page and entry dirtied so far is serialized, so the images
+        // and the log before walLsn describe the same state.
+        std::lock_guard<std::recursive_mutex> lock(writeMu_);
+        io.lock();
+        lsn = wal_.lastOpID();
+        walLsn = wal_.beginCheckpoint();
+        rowCount = captureCheckpoint(pages, rows);
+        master = mp_;
+        ticket = ++checkpointsStarted_;
+    }
+    // Unlocked: writers keep appending, dirtying pages for the next checkpoint.
+    {
+        FileLock file(*this);
+        writeCheckpoint(pages, rows);
+    }
+    io.unlock();
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMu_);
+        // A checkpoint that started later and already finished wrote a newer
+        // master page and retired at least as much of the WAL.
+        if (ticket > checkpointsDone_) {
+            FileLock file(*this);
+            syncIndexes();
+            master.flush(fd_);
+            syncFile(fd_, "table");
+            // Unlogged writes reached the file; WAL followers must copy it again.
+            if (durability_ == Durability::Off) wal_.rebase();
+            else wal_.endCheckpoint(walLsn);
+            checkpointsDone_ = ticket;
+        }
+    }
+    recordCheckpoint(lsn, walLsn, pages.size(), rowCount, start);
+}
+
+// Everything in one pass under the write lock, then the whole WAL goes: for
+// DDL, compaction and durability changes, which need the table file current.
+// These change the table outside the log, so the WAL is rebased.
+void Table::checkpointLocked() {
+    std::lock_guard<std::mutex> io(checkpointIoMu_);
+    FileLock file(*this);
     wal_.sync();
+    std::vector<Extent> pages, rows;
+    captureCheckpoint(pages, rows);
+    writeCheckpoint(pages, rows);
+    syncIndexes();
+    mp_.flush(fd_);
+    syncFile(fd_, "table");
+    wal_.rebase();
+    checkpointsDone_ = ++checkpointsStarted_;
+}
+
+size_t Table::captureCheckpoint(std::vector<Extent>& pages, std::vector<Extent>& rows) {
     for (auto& col : cols_)
-        col.syncData();
+        col.captureDirty(pages);
+    for (auto& bitmap : bitmaps_)
+        if (bitmap && bitmap->dirty()) bitmap->save();
+    return rowIndex_.captureDirty(rows);
+}
+
+// Data pages, then the string heaps and RowIndex entries that point into them;
+// the master page goes last, naming only pages already on disk.
+void Table::writeCheckpoint(const std::vector<Extent>& pages, const std::vector<Extent>& rows) {
+    writeExtents(fd_, pages, "column page");
+    syncFile(fd_, "table");
+    for (const auto& col : cols_)
+        col.syncHeap();
+    rowIndex_.writeExtents(rows);
     rowIndex_.sync();
-    if (fd_ >= 0) mp_.sync(fd_);
-    wal_.truncate();
+}
+
+void Table::syncIndexes() {
+    for (auto& tree : btrees_)
+        if (tree) tree->sync();
+    for (auto& hash : hashes_)
+        if (hash) hash->sync();
+    for (auto& bloom : blooms_)
+        if (bloom) bloom->sync();
+}
+
+void Table::markIndexesStale(bool stale) {
+    if (stale) mp_.flags |= MasterPage::kFlagRebuildIndexes;
+    else mp_.flags &= uint16_t(~MasterPage::kFlagRebuildIndexes);
+    mp_.flush(fd_);
+    syncFile(fd_, "table");
+}
+
+void Table::recordCheckpoint(uint64_t lsn, uint64_t walLsn, size_t pages, size_t rows,
+                             std::chrono::steady_clock::time_point start) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::lock_guard<std::mutex> lock(checkpointMu_);
+    checkpointStats_.lsn = lsn;
+    checkpointStats_.walLsn = walLsn;
+    checkpointStats_.pages = pages;
+    checkpointStats_.rows = rows;
+    checkpointStats_.duration = elapsed;
+    ++checkpointStats_.count;
+}
+
+void Table::setCheckpointPolicy(const CheckpointPolicy& policy) {
+    stopCheckpointer();
+    {
+        std::lock_guard<std::mutex> lock(checkpointMu_);
+        checkpointPolicy_ = policy;
+        checkpointRequested_ = false;
+        stopCheckpointer_ = false;
+    }
+    checkpointWalBytes_ = policy.walBytes;
+    if (policy.walBytes || policy.interval.count() > 0)
+        checkpointer_ = std::thread(&Table::checkpointLoop, this);
+}
+
+Table::CheckpointStats Table::checkpointStats() const {
+    std::lock_guard<std::mutex> lock(checkpointMu_);
+    return checkpointStats_;
+}
+
+uint64_t Table::walBytes() {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    return wal_.sizeBytes();
+}
+
+void Table::noteWalGrowth() {
+    const uint64_t limit = checkpointWalBytes_.load(std::memory_order_relaxed);
+    if (!limit) return;
+    bool full;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMu_);
+        full = wal_.sizeBytes() >= limit;
+    }
+    if (full) requestCheckpoint();
+}
+
+void Table::requestCheckpoint() {
+    std::lock_guard<std::mutex> lock(checkpointMu_);
+    if (checkpointRequested_) return;
+    checkpointRequested_ = true;
+    checkpointCv_.notify_all();
+}
+
+void Table::checkpointLoop() {
+    std::unique_lock<std::mutex> lock(checkpointMu_);
+    while (!stopCheckpointer_) {
+        const auto wake = [&] { return stopCheckpointer_ || checkpointRequested_; };
+        if (checkpointPolicy_.interval.count() > 0)
+            checkpointCv_.wait_for(lock, checkpointPolicy_.interval, wake);
+        else
+            checkpointCv_.wait(lock, wake);
+        if (stopCheckpointer_) break;
+        checkpointRequested_ = false;
+        lock.unlock();
+        try {
+            bool due;
+            {
+                std::lock_guard<std::recursive_mutex> write(writeMu_);
+                due = wal_.hasEntries();
+            }
+            if (due) checkpoint();
+            lock.lock();
+            checkpointStats_.lastError.clear();
+        } catch (const std::exception& e) {
+            if (!lock.owns_lock()) lock.lock();
+            checkpointStats_.lastError = e.what();
+        }
+    }
+}
+
+void Table::stopCheckpointer() {
+    if (!checkpointer_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(checkpointMu_);
+        stopCheckpointer_ = true;
+    }
+    checkpointCv_.notify_all();
+    checkpointer_.join();
+    checkpointWalBytes_ = 0;
+}
+
+std::vector<uint32_t> Table::compact() {
+    // The WAL addresses rows by rowID; checkpoint and truncate it so replay can
+    // never apply an old rowID against the renumbered index.
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (txn_) throw std::invalid_argument("cannot compact inside a transaction");
+    FileLock file(*this);
+    checkpointLocked();
+    // The index files still hold the old rowIDs once the new row index is in
+    // place; the flag has the next open rebuild them if we die before that.
+    markIndexesStale(true);
+    std::vector<uint32_t> remap;
+    try {
+        remap = rowIndex_.compact();
+    } catch (...) {
+        // A failed directory fsync comes after the rows were renumbered.
+        rebuildIndexes();
+        throw;
+    }
+    rebuildIndexes();
+    syncIndexes();
+    markIndexesStale(false);
+    return remap;
+}
+
+std::string Table::indexPath(uint16_t colIdx) const {
+    return path_ + "." + std::to_string(colIdx) + ".bpt";
+}
+
+std::string Table::hashIndexPath(uint16_t colIdx) const {
+    return path_ + "." + std::to_string(colIdx) + ".hidx";
+}
+
+void Table::openIndexes(bool create) {
+    btrees_.clear();
+    btrees_.resize(cols_.size());
+    hashes_.clear();
+    hashes_.resize(cols_.size());
+    bitmaps_.clear();
+    bitmaps_.resize(cols_.size());
+    blooms_.clear();
+    blooms_.resize(cols_.size());
+    for (uint16_t c = 0; c < cols_.size(); ++c) {
+        const std::string tp = indexPath(c);
+        const std::string hp = hashIndexPath(c);
+        const std::string bp = bitmapIndexPath(c);
+        const std::string fp = bloomFilterPath(c);
+        if (create) {
+            // Stale indexes from a previous table at this path.
+            ::unlink(tp.c_str());
+            ::unlink(hp.c_str());
+            ::unlink(bp.c_str());
+            ::unlink(fp.c_str());
+            continue;
+        }
+        if (::access(fp.c_str(), F_OK) == 0) {
+            blooms_[c] = std::make_unique<BloomFilter>(fp);
+            if (!blooms_[c]->open()) buildBloomFilter(c, BloomFilter::kDefaultBitsPerKey);
+        }
+        if (::access(bp.c_str(), F_OK) == 0) {
+            bitmaps_[c] = std::make_unique<BitmapIndex>(bp, cols_[c].colType());
+            if (!bitmaps_[c]->load()) buildBitmapIndex(c);
+        }
+        if (::access(tp.c_str(), F_OK) == 0) {
+            btrees_[c] = std::make_unique<BPlusTree>(tp, BPlusTree::keyBytesFor(cols_[c].colType()));
+            btrees_[c]->openOrCreate(/*create=*/false);
+        }
+        if (::access(hp.c_str(), F_OK) == 0) {
+            hashes_[c] = std::make_unique<HashIndex>(hp);
+            hashes_[c]->openOrCreate(/*create=*/false);
+        }
+    }
+    // The primary key's index is mandatory; rebuild it if the file went missing.
+    if (!create && mp_.primaryKey < cols_.size()) {
+        const uint16_t pk = mp_.primaryKey;
+        const ColType type = cols_[pk].colType();
+        if ((type == ColType::UINT32 || type == ColType::STRING) ? !hashes_[pk] : !btrees_[pk]) {
+            if (type == ColType::UINT32 || type == ColType::STRING) buildHashIndex(pk);
+            else buildIndex(pk);
+        }
+    }
+    // A compaction stopped between renumbering the rows and rebuilding these.
+    if (!create && (mp_.flags & MasterPage::kFlagRebuildIndexes)) {
+        rebuildIndexes();
+        syncIndexes();
+        markIndexesStale(false);
+    }
+}
+
+uint16_t Table::requirePrimaryKey() const {
+    if (mp_.primaryKey == MasterPage::kNoPrimaryKey)
+        throw std::invalid_argument("table has no primary key");
+    return mp_.primaryKey;
+}
+
+std::optional<uint16_t> Table::primaryKey() const {
+    if (mp_.primaryKey == MasterPage::kNoPrimaryKey) return std::nullopt;
+    return mp_.primaryKey;
+}
+
+void Table::setPrimaryKey(uint16_t colIdx) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("primary key column out of bounds");
+    if (mp_.primaryKey == colIdx) return;
+    if (mp_.primaryKey != MasterPage::kNoPrimaryKey)
+        throw std::invalid_argument("table already has a primary key");
+
+    const ColType type = cols_[colIdx].colType();
+    std::unordered_set<std::string> seen;
+    rowIndex_.forEachLive([&](uint32_t, const std::vector<uint32_t>& slots) {
+        auto cv = cols_[colIdx].fetchTypedSlot(slots[colIdx]);
+        if (!cv) return;
+        const std::string key = type == ColType::STRING ? cv->str : BPlusTree::encodeNumeric(*cv, type);
+        if (!seen.insert(key).second)
+            throw std::invalid_argument("primary key column has duplicate values");
+    });
+
+    if (type == ColType::UINT32 || type == ColType::STRING) createHashIndex(colIdx);
+    else createIndex(colIdx);
+    mp_.primaryKey = colIdx;
+    checkpointLocked();
+}
+
+void Table::enablePageChecksums() {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (pageChecksums()) return;
+    // The trailer changes the slot capacity, so only pages not yet written qualify.
+    if (!cols_.empty() && cols_[0].pageCount() > 1)
+        throw std::invalid_argument("page checksums must be enabled before the first insert");
+    mp_.flags |= MasterPage::kFlagPageChecksums;
+    checkpointLocked();
+}
+
+bool Table::pageChecksums() const {
+    return (mp_.flags & MasterPage::kFlagPageChecksums) != 0;
+}
+
+std::optional<uint32_t> Table::findByKey(const ColValue& key) {
+    const uint16_t pk = requirePrimaryKey();
+    const ColType type = cols_[pk].colType();
+    if (key.type != type)
+        throw std::invalid_argument("key type does not match the primary key column");
+    if (hashes_[pk]) {
+        // Hash hits are candidates: STRING keys are hashed, so compare the stored value.
+        for (uint32_t rowID : hashes_[pk]->lookup(HashIndex::keyFor(key, type))) {
+            auto slots = rowIndex_.fetch(rowID);
+            if (!slots) continue;
+            auto cv = cols_[pk].fetchTypedSlot((*slots)[pk]);
+            if (cv && *cv == key) return rowID;
+        }
+        return std::nullopt;
+    }
+    std::optional<uint32_t> hit;
+    const BPlusTree::Key k = BPlusTree::encodeNumeric(key, type);
+    btrees_[pk]->scanRange(k, k, [&](const BPlusTree::Key&, uint32_t rowID) {
+        // Checked like a hash hit: the tree may be ahead of the recovered log.
+        auto slots = rowIndex_.fetch(rowID);
+        auto cv = slots ? cols_[pk].fetchTypedSlot((*slots)[pk]) : std::nullopt;
+        if (cv && *cv == key) hit = rowID;
+        return !hit;
+    });
+    return hit;
+}
+
+void Table::buildIndex(uint16_t colIdx) {
+    const ColType type = cols_[colIdx].colType();
+    std::vector<std::pair<BPlusTree::Key, uint32_t>> entries;
+    entries.reserve(rowIndex_.liveRows());
+    rowIndex_.forEachLive([&](uint32_t rowID, const std::vector<uint32_t>& slots) {
+        if (auto cv = cols_[colIdx].fetchTypedSlot(slots[colIdx]))
+            entries.emplace_back(BPlusTree::encodeKey(*cv, type), rowID);
+    });
+    std::sort(entries.begin(), entries.end());
+
+    auto tree = std::make_unique<BPlusTree>(indexPath(colIdx), BPlusTree::keyBytesFor(type));
+    tree->openOrCreate(/*create=*/true);
+    tree->bulkLoad(entries);
+    tree->sync();
+    btrees_[colIdx] = std::move(tree);
+}
+
+void Table::buildHashIndex(uint16_t colIdx) {
+    const ColType type = cols_[colIdx].colType();
+    auto hash = std::make_unique<HashIndex>(hashIndexPath(colIdx));
+    hash->openOrCreate(/*create=*/true);
+    rowIndex_.forEachLive([&](uint32_t rowID, const std::vector<uint32_t>& slots) {
+        if (auto cv = cols_[colIdx].fetchTypedSlot(slots[colIdx]))
+            hash->insert(HashIndex::keyFor(*cv, type), rowID);
+    });
+    hash->sync();
+    hashes_[colIdx] = std::move(hash);
+}
+
+void Table::createHashIndex(uint16_t colIdx) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("index column out of bounds");
+    const ColType type = cols_[colIdx].colType();
+    if (type != ColType::UINT32 && type != ColType::STRING)
+        throw std::invalid_argument("hash indexes require a UINT32 or STRING column");
+    if (hashes_[colIdx]) return;
+    buildHashIndex(colIdx);
+}
+
+void Table::dropHashIndex(uint16_t colIdx) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("index column out of bounds");
+    if (colIdx == mp_.primaryKey && hashes_[colIdx])
+        throw std::invalid_argument("index backs the primary key");
+    if (!hashes_[colIdx]) return;
+    hashes_[colIdx].reset();
+    ::unlink(hashIndexPath(colIdx).c_str());
+}
+
+std::string Table::bitmapIndexPath(uint16_t colIdx) const {
+    return path_ + "." + std::to_string(colIdx) + ".bmp";
+}
+
+void Table::buildBitmapIndex(uint16_t colIdx) {
+    auto bitmap = std::make_unique<BitmapIndex>(bitmapIndexPath(colIdx), cols_[colIdx].colType());
+    rowIndex_.forEachLive([&](uint32_t rowID, const std::vector<uint32_t>& slots) {
+        if (auto cv = cols_[colIdx].fetchTypedSlot(slots[colIdx]))
+            bitmap->add(*cv, rowID);
+    });
+    bitmap->save();
+    bitmaps_[colIdx] = std::move(bitmap);
+}
+
+void Table::createBitmapIndex(uint16_t colIdx) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("index column out of bounds");
+    const ColType type = cols_[colIdx].colType();
+    if (type != ColType::UINT32 && type != ColType::STRING)
+        throw std::invalid_argument("bitmap indexes require a UINT32 or STRING column");
+    if (bitmaps_[colIdx]) return;
+
+    // Count distinct values up front so a high-cardinality column is refused
+    // before any bitmap is built.
+    BitmapIndex probe(bitmapIndexPath(colIdx), type);
+    rowIndex_.forEachLive([&](uint32_t rowID, const std::vector<uint32_t>& slots) {
+        if (probe.distinctValues() > BitmapIndex::kMaxDistinct) return;
+        if (auto cv = cols_[colIdx].fetchTypedSlot(slots[colIdx]))
+            probe.add(*cv, rowID);
+    });
+    if (probe.distinctValues() > BitmapIndex::kMaxDistinct)
+        throw std::invalid_argument("column has too many distinct values for a bitmap index");
+    buildBitmapIndex(colIdx);
+}
+
+void Table::dropBitmapIndex(uint16_t colIdx) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("index column out of bounds");
+    if (!bitmaps_[colIdx]) return;
+    bitmaps_[colIdx].reset();
+    ::unlink(bitmapIndexPath(colIdx).c_str());
+}
+
+// Bitmap answer for a single predicate, or nullopt if its column has no bitmap.
+std::optional<RoaringBitmap> Table::bitmapFor(const Predicate& predicate) const {
+    if (!hasBitmapIndex(predicate.colIdx)) return std::nullopt;
+    const BitmapIndex& bitmap = *bitmaps_[predicate.colIdx];
+    switch (predicate.kind) {
+        case Predicate::Kind::EQ: {
+            const RoaringBitmap* bm = bitmap.find(ColValue(predicate.lo));
+            return bm ? *bm : RoaringBitmap{};
+        }
+        case Predicate::Kind::BETWEEN:
+            return bitmap.range(predicate.lo, predicate.hi);
+        case Predicate::Kind::EQ_STRING: {
+            const RoaringBitmap* bm = bitmap.find(ColValue(predicate.needle));
+            return bm ? *bm : RoaringBitmap{};
+        }
+        case Predicate::Kind::PREFIX_STRING:
+        case Predicate::Kind::BETWEEN_STRING:
+            break;
+    }
+    return std::nullopt;
+}
+
+std::string Table::bloomFilterPath(uint16_t colIdx) const {
+    return path_ + "." + std::to_string(colIdx) + ".blm";
+}
+
+void Table::buildBloomFilter(uint16_t colIdx, uint16_t bitsPerKey) {
+    const ColType type = cols_[colIdx].colType();
+    auto bloom = std::make_unique<BloomFilter>(bloomFilterPath(colIdx));
+    bloom->create(cols_[colIdx].slotsPerPage(), bitsPerKey);
+    rowIndex_.forEachLive([&](uint32_t, const std::vector<uint32_t>& slots) {
+        if (auto cv = cols_[colIdx].fetchTypedSlot(slots[colIdx]))
+            bloom->add(ColumnFile::pageIdFromSlotId(slots[colIdx]), BloomFilter::hashOf(*cv, type));
+    });
+    bloom->sync();
+    blooms_[colIdx] = std::move(bloom);
+}
+
+void Table::createBloomFilter(uint16_t colIdx, uint16_t bitsPerKey) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("bloom filter column out of bounds");
+    const ColType type = cols_[colIdx].colType();
+    if (type != ColType::UINT32 && type != ColType::STRING)
+        throw std::invalid_argument("bloom filters require a UINT32 or STRING column");
+    if (bitsPerKey == 0)
+        throw std::invalid_argument("bloom filters need at least one bit per key");
+    buildBloomFilter(colIdx, bitsPerKey);
+}
+
+void Table::dropBloomFilter(uint16_t colIdx) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("bloom filter column out of bounds");
+    if (!blooms_[colIdx]) return;
+    blooms_[colIdx].reset();
+    ::unlink(bloomFilterPath(colIdx).c_str());
+}
+
+bool Table::pageMayContain(uint16_t colIdx, uint16_t pageID, const ColValue& value) const {
+    if (!hasBloomFilter(colIdx)) return true;
+    return blooms_[colIdx]->mayContain(pageID, BloomFilter::hashOf(value, cols_[colIdx].colType()));
+}
+
+// Equality walk that asks the page's Bloom filter before reading any slot on
+// it; the verdict is cached per page for the rest of the walk.
+std::vector<uint32_t> Table::bloomScanEquals(uint16_t colIdx, const ColValue& needle) {
+    const BloomFilter& bloom = *blooms_[colIdx];
+    const uint64_t hash = BloomFilter::hashOf(needle, cols_[colIdx].colType());
+    std::unordered_map<uint16_t, bool> mayContain;
+    std::vector<uint32_t> out;
+    rowIndex_.forEachLive([&](uint32_t rowID, const std::vector<uint32_t>& slots) {
+        const uint16_t pid = ColumnFile::pageIdFromSlotId(slots[colIdx]);
+        auto it = mayContain.find(pid);
+        if (it == mayContain.end()) it = mayContain.emplace(pid, bloom.mayContain(pid, hash)).first;
+        if (!it->second) return;
+        auto cv = cols_[colIdx].fetchTypedSlot(slots[colIdx]);
+        if (cv && *cv == needle) out.push_back(rowID);
+    });
+    return out;
+}
+
+void Table::createIndex(uint16_t colIdx) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("index column out of bounds");
+    if (btrees_[colIdx]) return;
+    buildIndex(colIdx);
+}
+
+void Table::dropIndex(uint16_t colIdx) {
+    std::lock_guard<std::recursive_mutex> lock(writeMu_);
+    if (colIdx >= cols_.size())
+        throw std::invalid_argument("index column out of bounds");
+    if (colIdx == mp_.primaryKey && btrees_[colIdx] && !hashes_[colIdx])
+        throw std::invalid_argument("index backs the primary key");
+    if (!btrees_[colIdx]) return;
+    btrees_[colIdx].reset();
+    ::unlink(indexPath(colIdx).c_str());
+}
+
+std::vector<uint32_t> Table::indexRange(uint16_t colIdx, const ColValue& lo, const ColValue& hi) {
+    if (!hasIndex(colIdx))
+        throw std::invalid_argument("column has no index");
+    const ColType type = cols_[colIdx].colType();
+    if (type == ColType::STRING)
+        return scanBetweenString(colIdx, lo.str, hi.str);
+    std::vector<uint32_t> out;
+    btrees_[colIdx]->scanRange(BPlusTree::encodeNumeric(lo, type), BPlusTree::encodeNumeric(hi, type),
+                               [&](const BPlusTree::Key&, uint32_t rowID) {
+                                   out.push_back(rowID);
+                                   return true;
+                               });
+    dropStaleHits(colIdx, out, lo, hi);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Rows whose STRING index key lies in [lo, hi], sorted. Keys are 32-byte
+// prefixes, so unless the caller knows the key decides the predicate, each hit
+// is re-checked with `match` against the stored string.
+std::vector<uint32_t> Table::stringIndexScan(uint16_t colIdx, const BPlusTree::Key& lo, const BPlusTree::Key& hi,
+                                             const std::function<bool(const std::string&)>& match) {
+    std::vector<uint32_t> out;
+    btrees_[colIdx]->scanRange(lo, hi, [&](const BPlusTree::Key&, uint32_t rowID) {
+        out.push_back(rowID);
+        return true;
+    });
+    if (match) {
+        out.erase(std::remove_if(out.begin(), out.end(), [&](uint32_t rowID) {
+            auto slots = rowIndex_.fetch(rowID);
+            if (!slots) return true;
+            auto cv = cols_[colIdx].fetchTypedSlot((*slots)[colIdx]);
+            return !cv || !match(cv->str);
+        }), out.end());
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// `match` may run on several threads at once.
+std::vector<uint32_t> Table::scanStringWhere(uint16_t colIdx, const std::function<bool(const std::string&)>& match) {
+    const ColumnFile& col = cols_[colIdx];
+    return concat(scanMorsels<std::vector<uint32_t>>(colIdx, [&](uint32_t first, uint32_t end,
+                                                                  std::vector<uint32_t>& rowIDs) {
+        forEachLiveSlot(colIdx, first, end, [&](uint32_t rowID, const ColumnPage& page, uint16_t slot) {
+            auto cv = col.readSlot(page, slot);
+            if (cv && cv->type == ColType::STRING && match(cv->str))
+                rowIDs.push_back(rowID);
+        });
+    }));
+}
+
+std::vector<uint32_t> Table::scanPrefixString(uint16_t colIdx, const std::string& prefix) {
+    assert(colIdx < cols_.size());
+    auto startsWith = [&](const std::string& s) { return s.compare(0, prefix.size(), prefix) == 0; };
+    if (!hasIndex(colIdx)) return scanStringWhere(colIdx, startsWith);
+
+    const auto [lo, hi] = BPlusTree::prefixRange(prefix);
+    // A key in [lo, hi] starts with the prefix, and so does its string unless
+    // the prefix is cut off by the key width or has NULs that padding mimics.
+    const bool keyDecides = prefix.size() <= BPlusTree::kStringKeyBytes &&
+                            prefix.find('\0') == std::string::npos;
+    return stringIndexScan(colIdx, lo, hi, keyDecides ? nullptr : std::function<bool(const std::string&)>(startsWith));
+}
+
+std::vector<uint32_t> Table::scanBetweenString(uint16_t colIdx, const std::string& lo, const std::string& hi) {
+    assert(colIdx < cols_.size());
+    auto inRange = [&](const std::string& s) { return lo <= s && s <= hi; };
+    if (lo > hi) return {};
+    if (!hasIndex(colIdx)) return scanStringWhere(colIdx, inRange);
+    return stringIndexScan(colIdx, BPlusTree::encodeString(lo), BPlusTree::encodeString(hi), inRange);
+}
+
+// Index probe for the legacy UINT32 scans. Equality goes to the hash index when
+// there is one, anything else to the B+tree.
+std::optional<std::vector<uint32_t>> Table::indexLookup(uint16_t colIdx, ValueType lo, ValueType hi) {
+    if (cols_[colIdx].colType() != ColType::UINT32) return std::nullopt;
+    if (lo == hi && hasHashIndex(colIdx)) {
+        auto out = hashes_[colIdx]->lookup(lo);
+        dropStaleHits(colIdx, out, ColValue(lo), ColValue(hi));
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+    if (!hasIndex(colIdx)) return std::nullopt;
+    if (lo > hi) return std::vector<uint32_t>{};
+    return indexLookup(colIdx, ColValue(lo), ColValue(hi));
+}
+
+// B+tree probe on a numeric column of any type, with bounds of that type.
+// Gives up (nullopt) once the range matches more than a quarter of the table:
+// past that, random slot fetches lose to a sequential column walk and the
+// caller should scan instead.
+std::optional<std::vector<uint32_t>> Table::indexLookup(uint16_t colIdx, const ColValue& lo, const ColValue& hi) {
+    if (!hasIndex(colIdx)) return std::nullopt;
+    const ColType type = cols_[colIdx].colType();
+    const size_t limit = std::max<size_t>(rowIndex_.liveRows() / 4, 64);
+    std::vector<uint32_t> out;
+    const bool complete = btrees_[colIdx]->scanRange(
+        BPlusTree::encodeNumeric(lo, type), BPlusTree::encodeNumeric(hi, type),
+        [&](const BPlusTree::Key&, uint32_t rowID) {
+            if (out.size() >= limit) return false;
+            out.push_back(rowID);
+            return true;
+        });
+    if (!complete) return std::nullopt;
+    dropStaleHits(colIdx, out, lo, hi);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Index files are written through, so after an OS crash they can be ahead of
+// the recovered log: a hit may name a row that was never recovered, or whose
+// rowID went to a different row since.
+void Table::dropStaleHits(uint16_t colIdx, std::vector<uint32_t>& rowIDs, const ColValue& lo, const ColValue& hi) {
+    const ColType type = cols_[colIdx].colType();
+    rowIDs.erase(std::remove_if(rowIDs.begin(), rowIDs.end(), [&](uint32_t rowID) {
+        auto slots = rowIndex_.fetch(rowID);
+        if (!slots) return true;
+        auto cv = cols_[colIdx].fetchTypedSlot((*slots)[colIdx]);
+        return !cv || !numericInRange(type, *cv, lo, hi);
+    }), rowIDs.end());
+}
+
+// EQ/BETWEEN on an INT64, FLOAT or DOUBLE column: its index when the range is
+// selective, else a scan of the column.
+std::vector<uint32_t> Table::scanNumericBetween(uint16_t colIdx, const ColValue& lo, const ColValue& hi) {
+    if (auto hits = indexLookup(colIdx, lo, hi)) return std::move(*hits);
+    const ColumnFile& col = cols_[colIdx];
+    const ColType type = col.colType();
+    return concat(scanMorsels<std::vector<uint32_t>>(colIdx, [&](uint32_t first, uint32_t end,
+                                                                  std::vector<uint32_t>& rowIDs) {
+        forEachLiveSlot(colIdx, first, end, [&](uint32_t rowID, const ColumnPage& page, uint16_t slot) {
+            auto cv = col.readSlot(page, slot);
+            if (cv && numericInRange(type, *cv, lo, hi)) rowIDs.push_back(rowID);
+        });
+    }));
+}
+
+// Recovery runs before anything else can reach the table and with every index
+// detached, so each column takes its share of the batch on its own thread.
+void Table::replayInserts(std::vector<std::vector<ColValue>>& rows) {
+    if (rows.empty()) return;
+    const size_t numCols = cols_.size();
+    std::vector<std::vector<uint32_t>> slots(numCols);
+    auto fill = [&](size_t c) {
+        std::vector<const ColValue*> values;
+        values.reserve(rows.size());
+        for (const auto& row : rows) values.push_back(&row[c]);
+        cols_[c].allocTypedSlots(values, slots[c]);
+    };
+    const size_t workers = std::min<size_t>(numCols, std::max(1u, std::thread::hardware_concurrency()));
+    if (workers <= 1) {
+        for (size_t c = 0; c < numCols; ++c) fill(c);
+    } else {
+        std::vector<std::exception_ptr> errors(workers);
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for (size_t w = 0; w < workers; ++w)
+            threads.emplace_back([&, w] {
+                try {
+                    for (size_t c = w; c < numCols; c += workers) fill(c);
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                }
+            });
+        for (auto& th : threads) th.join();
+        for (auto& error : errors)
+            if (error) std::rethrow_exception(error);
+    }
+    std::vector<uint32_t> rowSlots(numCols);
+    for (size_t r = 0; r < rows.size(); ++r) {
+        for (size_t c = 0; c < numCols; ++c) rowSlots[c] = slots[c][r];
+        rowIndex_.appendRow(rowSlots);
+    }
+    rows.clear();
 }
 
 void Table::recoverFromWal() {
     if (!wal_.hasEntries()) return;
-    const auto ops = wal_.committedOperations();
-    for (const auto& op : ops) {
+    // Index files are written through but not synced with the data, so after an
+    // unclean shutdown they are rebuilt from the recovered rows instead of replayed.
+    std::vector<uint16_t> treeCols, hashCols, bitmapCols;
+    std::vector<std::pair<uint16_t, uint16_t>> bloomCols;  // (col, bitsPerKey)
+    for (uint16_t c = 0; c < cols_.size(); ++c) {
+        if (btrees_[c]) treeCols.push_back(c);
+        if (hashes_[c]) hashCols.push_back(c);
+        if (bitmaps_[c]) bitmapCols.push_back(c);
+        if (blooms_[c]) bloomCols.emplace_back(c, blooms_[c]->bitsPerKey());
+        btrees_[c].reset();
+        hashes_[c].reset();
+        bitmaps_[c].reset();
+        blooms_[c].reset();
+    }
+
+    // Runs of inserts are applied in batches of kReplayBatchPages pages of the
+    // narrowest column; a delete applies the pending batch first.
+    uint16_t pageRows = UINT16_MAX;
+    for (const auto& col : cols_)
+        pageRows = std::min(pageRows, std::max<uint16_t>(col.slotsPerPage(), 1));
+    const size_t batchRows = size_t(pageRows) * kReplayBatchPages;
+    std::vector<std::vector<ColValue>> batch;
+    batch.reserve(batchRows);
+    wal_.replay([&](const Wal::Operation& op) {
+        const uint32_t next = rowIndex_.rowsRecorded() + static_cast<uint32_t>(batch.size());
         switch (op.kind) {
             case Wal::Operation::Kind::Insert:
-                if (op.rowID < rowIndex_.rowsRecorded()) break;
-                if (op.rowID != rowIndex_.rowsRecorded())
+                if (op.rowID < next) break;
+                if (op.rowID != next)
                     throw std::runtime_error("WAL rowID gap during recovery");
-                insertTypedRowInternal(op.values, op.rowID);
+                if (op.values.size() != cols_.size())
+                    throw std::runtime_error("WAL row width does not match table schema");
+                batch.push_back(op.values);
+                if (batch.size() == batchRows) replayInserts(batch);
                 break;
             case Wal::Operation::Kind::Delete:
+                replayInserts(batch);
                 if (!rowIndex_.isLive(op.rowID)) break;
                 deleteRowInternal(op.rowID);
                 break;
         }
-    }
+    });
+    replayInserts(batch);
+    for (uint16_t c : treeCols)
+        buildIndex(c);
+    for (uint16_t c : hashCols)
+        buildHashIndex(c);
+    for (uint16_t c : bitmapCols)
+        buildBitmapIndex(c);
+    for (const auto& [c, bitsPerKey] : bloomCols)
+        buildBloomFilter(c, bitsPerKey);
     flushDurable();
 }
 
 std::vector<ValueType> Table::materializeColumn(uint16_t colIdx) {
     assert(colIdx < cols_.size());
-    std::vector<ValueType> out;
-    out.reserve(1024); // heuristic; will grow as needed
-
-    rowIndex_.forEachLive([&](uint32_t /*rowID*/, const std::vector<uint32_t>& slots){
-        auto v = cols_[colIdx].fetchSlot(slots[colIdx]);
-        if (v.has_value()) out.push_back(*v);
-        // if tombstoned mid-flight, skip
-    });
-    return out;
+    const ColumnFile& col = cols_[colIdx];
+    const bool u32 = col.colType() == ColType::UINT32;
+    return concat(scanMorsels<std::vector<ValueType>>(colIdx, [&](uint32_t first, uint32_t end,
+                                                                   std::vector<ValueType>& out) {
+        forEachLiveSlot(colIdx, first, end, [&](uint32_t /*rowID*/, const ColumnPage& page, uint16_t slot) {
+            out.push_back(u32 ? page.readValue(slot) : col.readSlot(page, slot)->asU32());
+        });
+    }));
 }
 
 ValueType Table::sumColumn(uint16_t colIdx) {
     assert(colIdx < cols_.size());
+    const ColumnFile& col = cols_[colIdx];
+    const bool u32 = col.colType() == ColType::UINT32;
     uint64_t acc = 0; // avoid overflow for many values
-    rowIndex_.forEachLive([&](uint32_t /*rowID*/, const std::vector<uint32_t>& slots){
-        auto v = cols_[colIdx].fetchSlot(slots[colIdx]);
-        if (v) acc += *v;
-    });
+    for (uint64_t part : scanMorsels<uint64_t>(colIdx, [&](uint32_t first, uint32_t end, uint64_t& sum) {
+             forEachLiveSlot(colIdx, first, end, [&](uint32_t /*rowID*/, const ColumnPage& page, uint16_t slot) {
+                 sum += u32 ? page.readValue(slot) : col.readSlot(page, slot)->asU32();
+             });
+         }))
+        acc += part;
     return static_cast<ValueType>(acc);
 }
 
@@ -410,32 +1632,34 @@ Table::Materialized Table::materializeColumnWithRowIDs(uint16_t colIdx) {
 // CPU helper over a materialized view (used when GPU is off/unavailable/small)
 std::vector<uint32_t> Table::scanEqualsCPUFromMaterialized(uint16_t colIdx, ValueType val) {
     auto m = materializeColumnWithRowIDs(colIdx);
-    std::vector<uint32_t> out;
-    out.reserve(m.values.size());
-    for (size_t i = 0; i < m.values.size(); ++i) {
-        if (m.values[i] == val) out.push_back(m.rowIDs[i]);
-    }
+    std::vector<uint32_t> out(m.values.size());
+    out.resize(Simd::selectCompare(m.values.data(), m.values.size(), Simd::CmpOp::Eq, val,
+                                   m.rowIDs.data(), out.data()));
     return out;
 }
 
 // Hybrid scanEquals: CPU for small inputs, GPU for large
 std::vector<uint32_t> Table::scanEquals(uint16_t colIdx, ValueType val) {
     assert(colIdx < cols_.size());
-
-    // Materialize once. If small or GPU is unavailable, use CPU on the vectors.
-    auto m = materializeColumnWithRowIDs(colIdx);
-    const size_t n = m.values.size();
-
-    if (!useGPU_ || n < gpuThreshold_ || !metalIsAvailable()) {
-        std::vector<uint32_t> out;
-        out.reserve(n);
-        for (size_t i = 0; i < n; ++i) {
-            if (m.values[i] == val) out.push_back(m.rowIDs[i]);
-        }
-        return out;
+    if (auto hits = indexLookup(colIdx, val, val)) return std::move(*hits);
+    if (hasBloomFilter(colIdx)) return bloomScanEquals(colIdx, ColValue(val));
+
+    // CPU: evaluate inside the page walk, keeping only the matches.
+    if (!useGPU_ || rowIndex_.liveRows() < gpuThreshold_ || !metalIsAvailable()) {
+        return concat(scanMorsels<std::vector<uint32_t>>(colIdx, [&](uint32_t first, uint32_t end,
+                                                                      std::vector<uint32_t>& out) {
+            scanPages(colIdx, first, end, [&](ValueType pmin, ValueType pmax) { return pmin <= val && val <= pmax; },
+                      [&](const ValueType* values, const uint32_t* rowIDs, size_t n) {
+                          const size_t at = out.size();
+                          out.resize(at + n);
+                          out.resize(at + Simd::selectCompare(values, n, Simd::CmpOp::Eq, val, rowIDs,
+                                                              out.data() + at));
+                      });
+        }));
     }
 
-    // GPU path
+    // GPU path: materialize once for the dispatch.
+    auto m = materializeColumnWithRowIDs(colIdx);
     return gpuScanEquals(m.values, m.rowIDs, static_cast<uint32_t>(val));
 }
 
@@ -471,6 +1695,25 @@ ValueType Table::maxColumn(uint16_t colIdx) {
 std::vector<uint32_t> Table::scanEqualsString(uint16_t colIdx, const std::string& needle) {
     assert(colIdx < cols_.size());
 
+    // Hash index: only the candidate rows touch the heap (hash collisions are
+    // filtered by comparing the stored string).
+    if (hasHashIndex(colIdx)) {
+        std::vector<uint32_t> rowIDs;
+        for (uint32_t rowID : hashes_[colIdx]->lookup(HashIndex::keyFor(ColValue(needle), ColType::STRING))) {
+            auto slots = rowIndex_.fetch(rowID);
+            if (!slots) continue;
+            auto cv = cols_[colIdx].fetchTypedSlot((*slots)[colIdx]);
+            if (cv && cv->str == needle) rowIDs.push_back(rowID);
+        }
+        std::sort(rowIDs.begin(), rowIDs.end());
+        return rowIDs;
+    }
+    if (hasIndex(colIdx)) {
+        const BPlusTree::Key key = BPlusTree::encodeString(needle);
+        return stringIndexScan(colIdx, key, key, [&](const std::string& s) { return s == needle; });
+    }
+    if (hasBloomFilter(colIdx)) return bloomScanEquals(colIdx, ColValue(needle));
+
     const size_t n = rowIndex_.liveRows();
 
     // GPU path: pack strings into Arrow layout and dispatch kernel.
@@ -493,13 +1736,7 @@ std::vector<uint32_t> Table::scanEqualsString(uint16_t colIdx, const std::string
     }
 
     // CPU fallback
-    std::vector<uint32_t> rowIDs;
-    rowIndex_.forEachLive([&](uint32_t rowID, const std::vector<uint32_t>& slots) {
-        auto cv = cols_[colIdx].fetchTypedSlot(slots[colIdx]);
-        if (cv && cv->type == ColType::STRING && cv->str == needle)
-            rowIDs.push_back(rowID);
-    });
-    return rowIDs;
+    return scanStringWhere(colIdx, [&](const std::string& s) { return s == needle; });
 }
 
 // gpu_sum host entry
@@ -512,11 +1749,8 @@ ValueType Table::sumColumnHybrid(uint16_t colIdx) {
 
     auto vals = materializeColumn(colIdx);
     const size_t n = vals.size();
-    if (!useGPU_ || n < gpuThreshold_ || !metalIsAvailable()) {
-        uint64_t acc = 0;
-        for (auto v : vals) acc += v;
-        return static_cast<ValueType>(acc);
-    }
+    if (!useGPU_ || n < gpuThreshold_ || !metalIsAvailable())
+        return static_cast<ValueType>(Simd::sum(vals.data(), n));
 
     uint64_t s = gpuSumU32(vals);
     return static_cast<ValueType>(s);
@@ -1,6 +1,15 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <optional>
 
@@ -10,6 +19,11 @@
 #include "ColumnFile.hpp"
 #include "RowIndex.hpp"
 #include "Wal.hpp"
+#include "BPlusTree.hpp"
+#include "HashIndex.hpp"
+#include "BitmapIndex.hpp"
+#include "BloomFilter.hpp"
+#include "ThreadPool.hpp"
 
 class Table
 {
@@ -20,19 +34,79 @@ public:
         std::vector<uint32_t> rowIDs;
     };
 
+    // Background checkpoint triggers; a zero field disables that trigger.
+    struct CheckpointPolicy
+    {
+        uint64_t walBytes = 0;                  // WAL size that requests a checkpoint
+        std::chrono::milliseconds interval{0};  // checkpoint this often while the WAL has records
+    };
+
+    struct CheckpointStats
+    {
+        uint64_t lsn = 0;                       // last WAL opID covered by the latest checkpoint
+        uint64_t walLsn = 0;                    // where the WAL began after it (Wal::beginCheckpoint)
+        uint64_t pages = 0;                     // dirty column pages it wrote
+        uint64_t rows = 0;                      // dirty RowIndex entries it wrote
+        std::chrono::microseconds duration{0};  // wall time of the latest checkpoint
+        uint64_t count = 0;                     // checkpoints completed (manual + background)
+        std::string lastError;                  // from the background thread; empty if none
+    };
+
     // Constructors
     Table(const std::string &path, uint16_t pageSize, uint16_t numColumns);  // all UINT32
     Table(const std::string &path, uint16_t pageSize,                        // typed columns
           const std::vector<ColType>& colTypes);
     Table(const std::string &path);  // open existing
+    ~Table();
     std::vector<uint32_t> whereBetween(uint16_t colIdx, ValueType lo, ValueType hi);
     std::vector<uint32_t> scanPredicate(const Predicate& predicate);
+    // Throws std::invalid_argument for a predicate the table cannot evaluate.
+    void validatePredicate(const Predicate& predicate) const;
     std::vector<uint32_t> whereAnd(const std::vector<Predicate>& predicates);
     std::vector<uint32_t> whereOr(const std::vector<Predicate>& predicates);
 
     // Knobs
     void setUseGPU(bool on) { useGPU_ = on; }
     void setGPUThreshold(size_t n) { gpuThreshold_ = n; }
+    bool useGPU() const { return useGPU_; }
+    size_t gpuThreshold() const { return gpuThreshold_; }
+    // Workers for the morsel-driven CPU scans (scanEquals, whereBetween, the
+    // string scans, sumColumn, materializeColumn); without a pool they run on
+    // the calling thread. Engine gives its tables a shared pool.
+    void setThreadPool(std::shared_ptr<ThreadPool> pool) { pool_ = std::move(pool); }
+    // How far a write has got when insert/delete/commit returns:
+    //   Off    - not logged at all, for bulk loads and rebuilds; a crash loses
+    //            everything since the last checkpoint.
+    //   Normal - logged, and the WAL is fdatasynced in the background every
+    //            kNormalSyncInterval; a crash loses at most that window.
+    //   Full   - logged and synced: group commit, so writers in several threads
+    //            share one fdatasync per batch.
+    // Switching into or out of Off checkpoints first, so the WAL never has
+    // unlogged writes between its records.
+    enum class Durability : uint8_t { Off, Normal, Full };
+    static constexpr std::chrono::milliseconds kNormalSyncInterval{200};
+    void setDurability(Durability level);
+    Durability durability() const { return durability_; }
+    // Group commit: inserts/deletes return only once their WAL commit is on
+    // disk, with a background thread batching concurrent commits into a single
+    // fdatasync. Writers may then call in from several threads (they are
+    // serialized internally); reads must still not overlap writes.
+    // Shorthand for setDurability(Full) / setDurability(Normal).
+    void setGroupCommit(bool on) { setDurability(on ? Durability::Full : Durability::Normal); }
+    bool groupCommit() const { return durability_ == Durability::Full; }
+    // CRC32C trailer on every column page, verified when the page is read; a
+    // torn or corrupt page throws std::runtime_error. Only on an empty table.
+    void enablePageChecksums();
+    bool pageChecksums() const;
+    // Run checkpoints from a background thread per `policy`. Checkpoints are
+    // fuzzy: column pages and RowIndex entries are write-back, and a checkpoint
+    // captures only those dirtied since the last one, under the write lock,
+    // then writes and fsyncs them with appends running again. Writers wait once
+    // more for the master page and the WAL segments that can be retired.
+    void setCheckpointPolicy(const CheckpointPolicy& policy);
+    CheckpointStats checkpointStats() const;
+    // Bytes in the live WAL segments; back to one segment header after a checkpoint.
+    uint64_t walBytes();
 
     // Core ops (legacy ValueType / new typed)
     uint32_t insertRow(const std::vector<ValueType> &values);
@@ -41,6 +115,78 @@ public:
     std::vector<std::optional<ColValue>>  fetchTypedRow(uint32_t rowID);
     void deleteRow(uint32_t rowID);
     void flushDurable();
+    // Applies an operation read from another table's WAL (see Replica). As in
+    // recovery, an insert below rowsRecorded() or a delete of a dead row is
+    // already here and skipped. False for an insert past the end: this table
+    // is missing rows the operation follows.
+    bool applyReplicated(const Wal::Operation& op);
+    // Rebuilds every index from the rows, for a copy whose index files were
+    // taken while the table was being written.
+    void rebuildIndexes();
+
+    // Multi-row transactions. begin() holds the write lock for the calling
+    // thread until commit() or rollback(), so other writers wait. Inserts,
+    // deletes and upserts in between are buffered (returned rowIDs are final)
+    // and commit() logs them with a single WAL commit record, so after a crash
+    // either all of them or none are replayed. Reads do not see a transaction's
+    // own writes until it commits; compact() is refused while one is open.
+    // If commit() throws because the log could not be written, nothing was
+    // applied and the transaction stays open, to be committed again or rolled
+    // back. A table destroyed with a transaction open rolls it back, which
+    // must happen on the thread that began it.
+    void begin();
+    void commit();
+    void rollback();
+    bool inTransaction() const { return txn_ != nullptr; }
+
+    // Reclaim deleted RowIndex entries. Checkpoints first so the WAL never refers
+    // to pre-compaction rowIDs, then renumbers live rows densely. The returned
+    // vector maps old rowID -> new rowID (RowIndex::kDroppedRow if deleted);
+    // callers holding rowIDs must translate them through it.
+    std::vector<uint32_t> compact();
+
+    // Secondary B+tree indexes, stored at <path>.<col>.bpt and maintained on every
+    // insert/delete. scanEquals/whereBetween consult them automatically when the
+    // matching range is small enough to beat a scan. STRING columns are keyed on
+    // a 32-byte prefix and serve equality, prefix and range string scans.
+    void createIndex(uint16_t colIdx);
+    void dropIndex(uint16_t colIdx);
+    bool hasIndex(uint16_t colIdx) const { return colIdx < btrees_.size() && btrees_[colIdx]; }
+    // Typed range lookup through an existing index (any column type).
+    std::vector<uint32_t> indexRange(uint16_t colIdx, const ColValue& lo, const ColValue& hi);
+
+    // Linear-hash equality indexes on UINT32 / STRING columns (<path>.<col>.hidx).
+    // Preferred over a B+tree for scanEquals; scanEqualsString verifies hash hits
+    // against the heap instead of reading every row.
+    void createHashIndex(uint16_t colIdx);
+    void dropHashIndex(uint16_t colIdx);
+    bool hasHashIndex(uint16_t colIdx) const { return colIdx < hashes_.size() && hashes_[colIdx]; }
+
+    // Roaring bitmap per distinct value of a low-cardinality UINT32 / STRING
+    // column (<path>.<col>.bmp, rewritten at checkpoint). whereAnd / whereOr
+    // combine bitmap-backed predicates bitwise instead of scanning and merging.
+    void createBitmapIndex(uint16_t colIdx);
+    void dropBitmapIndex(uint16_t colIdx);
+    bool hasBitmapIndex(uint16_t colIdx) const { return colIdx < bitmaps_.size() && bitmaps_[colIdx]; }
+
+    // Per-page Bloom filters on a UINT32 / STRING column (<path>.<col>.blm).
+    // Equality scans and join probes skip pages whose filter rules the value out.
+    void createBloomFilter(uint16_t colIdx, uint16_t bitsPerKey = BloomFilter::kDefaultBitsPerKey);
+    void dropBloomFilter(uint16_t colIdx);
+    bool hasBloomFilter(uint16_t colIdx) const { return colIdx < blooms_.size() && blooms_[colIdx]; }
+    // False only if no value equal to `value` was ever stored on page pid.
+    bool pageMayContain(uint16_t colIdx, uint16_t pageID, const ColValue& value) const;
+
+    // Declared primary key, recorded in the master page. Key values must be
+    // unique; uniqueness and lookups go through the column's hash index (UINT32 /
+    // STRING) or B+tree (other types), which is built here and cannot be dropped
+    // while the key is declared.
+    void setPrimaryKey(uint16_t colIdx);
+    std::optional<uint16_t> primaryKey() const;
+    // Live row holding `key`, or nullopt.
+    std::optional<uint32_t> findByKey(const ColValue& key);
+    // Insert, or replace the row with the same key; returns the row's (new) rowID.
+    uint32_t upsertTypedRow(const std::vector<ColValue>& values);
 
     // Scans / Aggregates
     std::vector<ValueType> materializeColumn(uint16_t colIdx);
@@ -51,6 +197,10 @@ public:
 
     // CPU-only string equality scan (STRING columns only)
     std::vector<uint32_t> scanEqualsString(uint16_t colIdx, const std::string& needle);
+    // Prefix (LIKE 'abc%') and inclusive byte-wise range scans on STRING columns;
+    // answered from the column's B+tree when it has one. Results are sorted.
+    std::vector<uint32_t> scanPrefixString(uint16_t colIdx, const std::string& prefix);
+    std::vector<uint32_t> scanBetweenString(uint16_t colIdx, const std::string& lo, const std::string& hi);
 
     // CPU-only sum (you already had this)
     ValueType sumColumn(uint16_t colIdx);
@@ -71,6 +221,8 @@ public:
     template <typename Fn>
     void rowIndexForEachLive(Fn fn) { rowIndex_.forEachLive(fn); }
     size_t numColumns() const { return cols_.size(); }
+    uint32_t rowsRecorded() const { return rowIndex_.rowsRecorded(); }
+    uint32_t liveRows() const { return rowIndex_.liveRows(); }
 
     static std::vector<uint32_t> intersectRowIDs(const std::vector<uint32_t>& lhs,
                                                  const std::vector<uint32_t>& rhs);
@@ -80,11 +232,79 @@ public:
 private:
     void openOrCreate(uint16_t pageSize, uint16_t numColumns, bool create);
     std::vector<uint32_t> allLiveRowIDs() const;
-    void validatePredicate(const Predicate& predicate) const;
+    // Live rows in [first, end) of UINT32 column colIdx in rowID order, a page
+    // at a time. Pages whose zone map fails keepPage(min, max) are skipped
+    // unread; for each run of rows on one page, fn(values, rowIDs, n) gets
+    // their values, pointing into the page itself when the run's slots are
+    // consecutive.
+    template <typename KeepPage, typename Fn>
+    void scanPages(uint16_t colIdx, uint32_t first, uint32_t end, KeepPage keepPage, Fn fn);
+    // fn(rowID, page, slot) for each live row in [first, end) whose slot in
+    // column colIdx is live.
+    template <typename Fn>
+    void forEachLiveSlot(uint16_t colIdx, uint32_t first, uint32_t end, Fn fn);
+    // Morsel-driven scan of column colIdx: the rowIDs are cut into morsels of
+    // kMorselPages pages' worth of rows, which pool_'s workers claim, and
+    // scan(first, end, out) fills one Result per morsel, in rowID order.
+    // Tables under kParallelRows live rows run as one morsel, inline.
+    static constexpr uint32_t kMorselPages = 16;
+    static constexpr uint32_t kParallelRows = 1u << 16;
+    template <typename Result, typename Scan>
+    std::vector<Result> scanMorsels(uint16_t colIdx, Scan scan);
     void validatePredicates(const std::vector<Predicate>& predicates) const;
+    bool scannedInPass(const Predicate& predicate) const;
+    // Rows matching all (anyOf: any) of the predicates, from one vectorized
+    // pass over the live rows; in rowID order.
+    std::vector<uint32_t> filterRows(const std::vector<Predicate>& predicates, bool anyOf);
     void recoverFromWal();
+    // Applies a run of replayed inserts column by column, in parallel, and
+    // clears it.
+    void replayInserts(std::vector<std::vector<ColValue>>& rows);
+    static constexpr size_t kReplayBatchPages = 16;
     uint32_t insertTypedRowInternal(const std::vector<ColValue>& values, uint32_t expectedRowID);
     void deleteRowInternal(uint32_t rowID);
+    // Log + apply under writeMu_; return the WAL commit epoch (0 = nothing logged).
+    uint64_t logInsert(const std::vector<ColValue>& values, uint32_t& rowID);
+    uint64_t logDelete(uint32_t rowID);
+    // Buffered transaction writes; run under writeMu_ with txn_ set.
+    uint32_t txnInsert(const std::vector<ColValue>& values);
+    void txnDelete(uint32_t rowID);
+    std::optional<uint32_t> txnFindByKey(const ColValue& key);
+    std::string txnKeyOf(const ColValue& key) const;
+    void checkpoint();
+    void checkpointLocked();
+    // Returns the number of RowIndex entries captured.
+    size_t captureCheckpoint(std::vector<Extent>& pages, std::vector<Extent>& rows);
+    void writeCheckpoint(const std::vector<Extent>& pages, const std::vector<Extent>& rows);
+    void syncIndexes();
+    // Sets or clears MasterPage::kFlagRebuildIndexes on disk.
+    void markIndexesStale(bool stale);
+    void recordCheckpoint(uint64_t lsn, uint64_t walLsn, size_t pages, size_t rows,
+                          std::chrono::steady_clock::time_point start);
+    void noteWalGrowth();
+    void requestCheckpoint();
+    void checkpointLoop();
+    void stopCheckpointer();
+    std::string indexPath(uint16_t colIdx) const;
+    std::string hashIndexPath(uint16_t colIdx) const;
+    void openIndexes(bool create);
+    uint16_t requirePrimaryKey() const;
+    void buildIndex(uint16_t colIdx);
+    void buildHashIndex(uint16_t colIdx);
+    std::string bitmapIndexPath(uint16_t colIdx) const;
+    void buildBitmapIndex(uint16_t colIdx);
+    std::optional<RoaringBitmap> bitmapFor(const Predicate& predicate) const;
+    std::string bloomFilterPath(uint16_t colIdx) const;
+    void buildBloomFilter(uint16_t colIdx, uint16_t bitsPerKey);
+    std::vector<uint32_t> bloomScanEquals(uint16_t colIdx, const ColValue& needle);
+    std::vector<uint32_t> stringIndexScan(uint16_t colIdx, const BPlusTree::Key& lo, const BPlusTree::Key& hi,
+                                          const std::function<bool(const std::string&)>& match);
+    std::vector<uint32_t> scanStringWhere(uint16_t colIdx, const std::function<bool(const std::string&)>& match);
+    std::optional<std::vector<uint32_t>> indexLookup(uint16_t colIdx, ValueType lo, ValueType hi);
+    std::optional<std::vector<uint32_t>> indexLookup(uint16_t colIdx, const ColValue& lo, const ColValue& hi);
+    // Keeps the index hits whose row is live and holds a value in [lo, hi].
+    void dropStaleHits(uint16_t colIdx, std::vector<uint32_t>& rowIDs, const ColValue& lo, const ColValue& hi);
+    std::vector<uint32_t> scanNumericBetween(uint16_t colIdx, const ColValue& lo, const ColValue& hi);
 
     // CPU helper (over materialized vectors)
     std::vector<uint32_t> scanEqualsCPUFromMaterialized(uint16_t colIdx, ValueType val);
@@ -95,8 +315,49 @@ private:
     std::vector<ColumnFile> cols_;
     RowIndex rowIndex_;
     Wal wal_;
+    // Serializes WAL append + apply, index DDL and checkpoints across threads.
+    // Recursive so DDL that builds on other DDL (setPrimaryKey) can nest.
+    std::recursive_mutex writeMu_;
+    std::atomic<uint64_t> checkpointWalBytes_{0};
+    std::atomic<Durability> durability_{Durability::Normal};  // changed under writeMu_
+    // Held, after writeMu_, while captured pages are written, so no checkpoint
+    // starts writing older images over newer ones.
+    std::mutex checkpointIoMu_;
+    uint64_t checkpointsStarted_ = 0;  // under writeMu_
+    uint64_t checkpointsDone_ = 0;     // newest whose master page is written; under writeMu_
+    // flock(LOCK_EX) on the table file while a checkpoint or compaction writes
+    // it in place, so a Replica copying the files under LOCK_SH sees all of
+    // such a write or none. Counted, as checkpoint phases may overlap.
+    class FileLock;
+    std::mutex fileLockMu_;
+    unsigned fileLockHolders_ = 0;
+
+    struct Transaction
+    {
+        std::vector<Wal::Operation> ops;                // logged and applied in order at commit
+        uint32_t firstRowID = 0;                        // rowsRecorded() at begin
+        std::vector<size_t> insertOps;                  // pending rowID - firstRowID -> index in ops
+        std::unordered_map<std::string, uint32_t> keys; // primary key -> pending rowID
+        std::unordered_set<uint32_t> deleted;           // rowIDs deleted in this transaction
+        std::unique_lock<std::recursive_mutex> hold;    // begin()'s hold on writeMu_
+        std::thread::id owner;                          // the thread that called begin()
+    };
+    std::unique_ptr<Transaction> txn_;  // null outside a transaction
+
+    std::thread checkpointer_;
+    mutable std::mutex checkpointMu_;  // guards the fields below
+    std::condition_variable checkpointCv_;
+    CheckpointPolicy checkpointPolicy_;
+    CheckpointStats checkpointStats_;
+    bool checkpointRequested_ = false;
+    bool stopCheckpointer_ = false;
+    std::vector<std::unique_ptr<BPlusTree>> btrees_;  // per column; null = no index
+    std::vector<std::unique_ptr<HashIndex>> hashes_;  // per column; null = no index
+    std::vector<std::unique_ptr<BitmapIndex>> bitmaps_;  // per column; null = no index
+    std::vector<std::unique_ptr<BloomFilter>> blooms_;   // per column; null = no filter
 
     // GPU usage knobs (single definition!)
     bool useGPU_ = true;
     size_t gpuThreshold_ = 4096;
+    std::shared_ptr<ThreadPool> pool_;  // null: scans run inline
 };
@@ -0,0 +1,118 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Set on pool threads and on a caller while its job runs: nested jobs run inline.
+thread_local bool tInJob = false;
+
+uint64_t pack(uint32_t begin, uint32_t end) { return (uint64_t(begin) << 32) | end; }
+uint32_t beginOf(uint64_t range) { return uint32_t(range >> 32); }
+uint32_t endOf(uint64_t range) { return uint32_t(range); }
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    blocks_.reset(new Block[threads]);
+    threads_.reserve(threads - 1);
+    for (size_t w = 1; w < threads; ++w) threads_.emplace_back(&ThreadPool::loop, this, w);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& th : threads_) th.join();
+}
+
+bool ThreadPool::claim(size_t worker, size_t& morsel) {
+    if (failed_.load(std::memory_order_relaxed)) return false;
+    // Own block first, from the front.
+    std::atomic<uint64_t>& own = blocks_[worker].range;
+    uint64_t range = own.load(std::memory_order_relaxed);
+    while (beginOf(range) < endOf(range)) {
+        if (own.compare_exchange_weak(range, pack(beginOf(range) + 1, endOf(range)))) {
+            morsel = beginOf(range);
+            return true;
+        }
+    }
+    // Then the others', from the back.
+    const size_t n = size();
+    for (size_t i = 1; i < n; ++i) {
+        std::atomic<uint64_t>& victim = blocks_[(worker + i) % n].range;
+        range = victim.load(std::memory_order_relaxed);
+        while (beginOf(range) < endOf(range)) {
+            if (victim.compare_exchange_weak(range, pack(beginOf(range), endOf(range) - 1))) {
+                morsel = endOf(range) - 1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(size_t worker) {
+    size_t morsel = 0;
+    while (claim(worker, morsel)) {
+        try {
+            (*job_)(morsel, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (!error_) error_ = std::current_exception();
+            failed_.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ThreadPool::loop(size_t worker) {
+    tInJob = true;
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+        work(worker);
+        std::lock_guard<std::mutex> lock(mu_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
+
+void ThreadPool::run(size_t morsels, const std::function<void(size_t, size_t)>& fn) {
+    if (morsels == 0) return;
+    if (tInJob || threads_.empty() || morsels == 1) {
+        for (size_t m = 0; m < morsels; ++m) fn(m, 0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> running(runMu_);
+    const size_t n = size();
+    for (size_t w = 0; w < n; ++w)
+        blocks_[w].range.store(pack(uint32_t(morsels * w / n), uint32_t(morsels * (w + 1) / n)),
+                               std::memory_order_relaxed);
+    failed_.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        job_ = &fn;
+        error_ = nullptr;
+        busy_ = threads_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    tInJob = true;
+    work(0);
+    tInJob = false;
+
+    std::unique_lock<std::mutex> lock(mu_);
+    done_.wait(lock, [&] { return busy_ == 0; });
+    job_ = nullptr;
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+}
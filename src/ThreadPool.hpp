@@ -0,0 +1,64 @@
+// ThreadPool.hpp — work-stealing workers for morsel-driven scans.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads that run one job at a time. A job is a count of
+// morsels (small, independent pieces of a scan) and a function to run on
+// each. Every worker starts on its own contiguous block of morsels, taking
+// them from the front; a worker whose block runs dry steals from the back of
+// another's, so neighbouring morsels (and their pages) tend to stay on one
+// thread while the load still evens out.
+//
+// The calling thread works as worker 0, so a pool of size 1 has no threads
+// and runs jobs inline. Jobs from several threads queue up one after
+// another; a job started from inside a job runs inline on that worker.
+class ThreadPool {
+public:
+    // threads == 0 means std::thread::hardware_concurrency().
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Workers, counting the caller.
+    size_t size() const { return threads_.size() + 1; }
+
+    // Calls fn(morsel, worker) for every morsel in [0, morsels), with worker
+    // in [0, size()), and returns once all have run. If fn throws, morsels
+    // not yet claimed are skipped and the first exception is rethrown here.
+    void run(size_t morsels, const std::function<void(size_t morsel, size_t worker)>& fn);
+
+private:
+    // A worker's block of morsels, [begin, end) packed into one word so the
+    // owner (popping the front) and thieves (popping the back) race on a CAS.
+    struct alignas(64) Block {
+        std::atomic<uint64_t> range{0};
+    };
+
+    bool claim(size_t worker, size_t& morsel);
+    void work(size_t worker);
+    void loop(size_t worker);
+
+    std::vector<std::thread> threads_;
+    std::unique_ptr<Block[]> blocks_;
+    std::mutex runMu_;  // one job at a time
+
+    std::mutex mu_;  // guards the fields below
+    std::condition_variable wake_, done_;
+    const std::function<void(size_t, size_t)>* job_ = nullptr;
+    uint64_t generation_ = 0;
+    size_t busy_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_{false};
+};
@@ -0,0 +1,373 @@
+#include "Vectorized.hpp"
+#include "SimdKernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+using Vectorized::Batch;
+using Vectorized::Vector;
+
+// Fixed-width values: rows appended together sit in consecutive slots of a
+// page, so each such run is copied out of the page with one memcpy.
+template <typename T>
+void gather(const ColumnFile& col, const std::vector<uint32_t>& slots, std::vector<uint32_t>& sel,
+            std::vector<T>& out) {
+    out.resize(sel.size());
+    size_t kept = 0;
+    uint16_t lastPid = UINT16_MAX;
+    const ColumnPage* page = nullptr;
+    for (size_t j = 0; j < sel.size();) {
+        const uint32_t slotID = slots[sel[j]];
+        const uint16_t pid = ColumnFile::pageIdFromSlotId(slotID);
+        const uint16_t idx = ColumnFile::slotIdxFromSlotId(slotID);
+        if (pid != lastPid) { page = &col.pageRef(pid); lastPid = pid; }
+        if (idx >= page->capacity) { ++j; continue; }
+
+        size_t run = 1;
+        while (j + run < sel.size() && slots[sel[j + run]] == slotID + run && idx + run < page->capacity) ++run;
+        size_t live = 0;
+        while (live < run && page->tombstone[idx + live]) ++live;
+        if (live == run) {
+            std::memcpy(&out[kept], page->rawValues.data() + size_t(idx) * sizeof(T), run * sizeof(T));
+            if (kept != j) std::copy(sel.begin() + j, sel.begin() + j + run, sel.begin() + kept);
+            kept += run;
+        } else {
+            for (size_t r = 0; r < run; ++r) {
+                if (!page->tombstone[idx + r]) continue;
+                page->readRaw(idx + r, &out[kept], sizeof(T));
+                sel[kept++] = sel[j + r];
+            }
+        }
+        j += run;
+    }
+    sel.resize(kept);
+    out.resize(kept);
+}
+
+void gatherStrings(const ColumnFile& col, const std::vector<uint32_t>& slots, std::vector<uint32_t>& sel,
+                   std::vector<std::string>& out) {
+    out.resize(sel.size());
+    size_t kept = 0;
+    for (size_t j = 0; j < sel.size(); ++j) {
+        auto value = col.fetchTypedSlot(slots[sel[j]]);
+        if (!value) continue;
+        out[kept] = std::move(value->str);
+        sel[kept++] = sel[j];
+    }
+    sel.resize(kept);
+    out.resize(kept);
+}
+
+const std::vector<uint32_t>& scannedSlots(const Batch& batch, uint16_t colIdx) {
+    if (colIdx >= batch.slots.size() || batch.slots[colIdx].empty())
+        throw std::logic_error("column " + std::to_string(colIdx) + " was not scanned");
+    return batch.slots[colIdx];
+}
+
+void loadInto(Table& table, uint16_t colIdx, const Batch& batch, std::vector<uint32_t>& sel, Vector& out) {
+    const auto& slots = scannedSlots(batch, colIdx);
+    const ColumnFile& col = table.columnFile(colIdx);
+    out.type = col.colType();
+    switch (out.type) {
+        case ColType::UINT32: gather(col, slots, sel, out.u32); break;
+        case ColType::INT64:  gather(col, slots, sel, out.i64); break;
+        case ColType::FLOAT:  gather(col, slots, sel, out.f32); break;
+        case ColType::DOUBLE: gather(col, slots, sel, out.f64); break;
+        case ColType::STRING: gatherStrings(col, slots, sel, out.str); break;
+    }
+}
+
+// Drops from `sel` the rows whose slot in `col` is not live, reading only
+// the pages' tombstones.
+void keepLive(const ColumnFile& col, const std::vector<uint32_t>& slots, std::vector<uint32_t>& sel) {
+    size_t kept = 0;
+    uint16_t lastPid = UINT16_MAX;
+    const ColumnPage* page = nullptr;
+    for (uint32_t i : sel) {
+        const uint16_t pid = ColumnFile::pageIdFromSlotId(slots[i]);
+        const uint16_t idx = ColumnFile::slotIdxFromSlotId(slots[i]);
+        if (pid != lastPid) { page = &col.pageRef(pid); lastPid = pid; }
+        if (idx < page->capacity && page->tombstone[idx]) sel[kept++] = i;
+    }
+    sel.resize(kept);
+}
+
+bool numeric(const Predicate& predicate) {
+    return predicate.kind == Predicate::Kind::EQ || predicate.kind == Predicate::Kind::BETWEEN;
+}
+
+// Relative cost of testing one row: a string is read from the heap on its own,
+// a number comes out of its page in a run with its neighbours.
+double costPerRow(const Predicate& predicate) { return numeric(predicate) ? 1.0 : 8.0; }
+
+// Pass rate assumed before a predicate has seen any rows; equality is taken to
+// be the more selective.
+double priorPassRate(const Predicate& predicate) {
+    return predicate.kind == Predicate::Kind::EQ || predicate.kind == Predicate::Kind::EQ_STRING ? 0.1 : 0.5;
+}
+
+template <typename T>
+void fold(ColValue& min, ColValue& max, bool first, T lo, T hi) {
+    if (first || ColValue(lo) < min) min = ColValue(lo);
+    if (first || ColValue(hi) > max) max = ColValue(hi);
+}
+
+} // namespace
+
+namespace Vectorized {
+
+size_t Vector::size() const {
+    switch (type) {
+        case ColType::UINT32: return u32.size();
+        case ColType::INT64:  return i64.size();
+        case ColType::FLOAT:  return f32.size();
+        case ColType::DOUBLE: return f64.size();
+        case ColType::STRING: return str.size();
+    }
+    return 0;
+}
+
+ColValue Vector::at(size_t i) const {
+    switch (type) {
+        case ColType::UINT32: return ColValue(u32[i]);
+        case ColType::INT64:  return ColValue(i64[i]);
+        case ColType::FLOAT:  return ColValue(f32[i]);
+        case ColType::DOUBLE: return ColValue(f64[i]);
+        case ColType::STRING: return ColValue(str[i]);
+    }
+    return ColValue();
+}
+
+void load(Table& table, uint16_t colIdx, Batch& batch, Vector& out) {
+    loadInto(table, colIdx, batch, batch.sel, out);
+}
+
+// ── Scan ──────────────────────────────────────────────────────────────────────
+
+Scan::Scan(Table& table, std::vector<uint16_t> columns) : table_(table), columns_(std::move(columns)) {
+    for (uint16_t c : columns_)
+        if (c >= table_.numColumns()) throw std::invalid_argument("column index out of bounds");
+}
+
+void Scan::run(Operator& next) {
+    Batch batch;
+    batch.rowIDs.resize(kBatchSize);
+    batch.slots.resize(table_.numColumns());
+    for (uint16_t c : columns_) batch.slots[c].resize(kBatchSize);
+
+    size_t n = 0;
+    auto flush = [&] {
+        batch.size = n;
+        batch.sel.resize(n);
+        std::iota(batch.sel.begin(), batch.sel.end(), 0u);
+        next.consume(batch);
+        n = 0;
+    };
+    table_.rowIndexForEachLive([&](uint32_t rowID, const std::vector<uint32_t>& slots) {
+        batch.rowIDs[n] = rowID;
+        for (uint16_t c : columns_) batch.slots[c][n] = slots[c];
+        if (++n == kBatchSize) flush();
+    });
+    if (n > 0) flush();
+}
+
+// ── Filter ────────────────────────────────────────────────────────────────────
+
+Filter::Filter(Table& table, std::vector<Predicate> predicates, bool anyOf, Operator& next)
+    : table_(table), predicates_(std::move(predicates)), anyOf_(anyOf), next_(next),
+      order_(predicates_.size()), tested_(predicates_.size()), passed_(predicates_.size()) {
+    for (const auto& predicate : predicates_) {
+        table_.validatePredicate(predicate);
+        if (numeric(predicate) && table_.columnFile(predicate.colIdx).colType() != ColType::UINT32)
+            throw std::invalid_argument("vectorized filters compare UINT32 columns only");
+    }
+    std::iota(order_.begin(), order_.end(), size_t(0));
+}
+
+std::vector<uint16_t> Filter::columns() const {
+    std::vector<uint16_t> cols;
+    for (const auto& predicate : predicates_)
+        if (std::find(cols.begin(), cols.end(), predicate.colIdx) == cols.end()) cols.push_back(predicate.colIdx);
+    return cols;
+}
+
+void Filter::prune(const Predicate& predicate, const Batch& batch, std::vector<uint32_t>& sel) {
+    if (!numeric(predicate)) return;
+    const auto& slots = scannedSlots(batch, predicate.colIdx);
+    const ColumnFile& col = table_.columnFile(predicate.colIdx);
+    const ValueType lo = predicate.lo;
+    const ValueType hi = predicate.kind == Predicate::Kind::EQ ? predicate.lo : predicate.hi;
+    size_t kept = 0;
+    bool havePage = false, keep = true;
+    uint16_t lastPid = 0;
+    for (size_t j = 0; j < sel.size(); ++j) {
+        const uint16_t pid = ColumnFile::pageIdFromSlotId(slots[sel[j]]);
+        if (!havePage || pid != lastPid) {
+            const auto [pmin, pmax] = col.zoneMap(pid);  // header peek, no page read
+            keep = pmax >= lo && pmin <= hi;
+            lastPid = pid;
+            havePage = true;
+        }
+        if (keep) sel[kept++] = sel[j];
+    }
+    sel.resize(kept);
+}
+
+void Filter::apply(size_t i, const Batch& batch, std::vector<uint32_t>& sel) {
+    const Predicate& predicate = predicates_[i];
+    tested_[i] += sel.size();
+    loadInto(table_, predicate.colIdx, batch, sel, values_);
+    const size_t n = sel.size();
+    size_t kept = 0;
+    switch (predicate.kind) {
+        case Predicate::Kind::EQ:
+            kept = Simd::selectCompare(values_.u32.data(), n, Simd::CmpOp::Eq, predicate.lo, sel.data(), sel.data());
+            break;
+        case Predicate::Kind::BETWEEN:
+            kept = Simd::selectBetween(values_.u32.data(), n, predicate.lo, predicate.hi, sel.data(), sel.data());
+            break;
+        case Predicate::Kind::EQ_STRING:
+            for (size_t j = 0; j < n; ++j)
+                if (values_.str[j] == predicate.needle) sel[kept++] = sel[j];
+            break;
+        case Predicate::Kind::PREFIX_STRING:
+            for (size_t j = 0; j < n; ++j)
+                if (values_.str[j].compare(0, predicate.needle.size(), predicate.needle) == 0) sel[kept++] = sel[j];
+            break;
+        case Predicate::Kind::BETWEEN_STRING:
+            for (size_t j = 0; j < n; ++j)
+                if (predicate.needle <= values_.str[j] && values_.str[j] <= predicate.needleHi) sel[kept++] = sel[j];
+            break;
+    }
+    sel.resize(kept);
+    passed_[i] += kept;
+}
+
+// AND wants the predicate that drops the most rows per unit of cost first,
+// OR the one that accepts the most.
+void Filter::reorder() {
+    auto rank = [&](size_t i) {
+        const double pass = (double(passed_[i]) + priorPassRate(predicates_[i])) / (double(tested_[i]) + 1.0);
+        return costPerRow(predicates_[i]) / (anyOf_ ? pass : 1.0 - pass);
+    };
+    std::stable_sort(order_.begin(), order_.end(), [&](size_t a, size_t b) { return rank(a) < rank(b); });
+}
+
+void Filter::consume(Batch& batch) {
+    reorder();
+    if (!anyOf_) {
+        for (const auto& predicate : predicates_) {
+            prune(predicate, batch, batch.sel);
+            if (batch.sel.empty()) return;
+        }
+        for (size_t i : order_) {
+            apply(i, batch, batch.sel);
+            if (batch.sel.empty()) return;
+        }
+        next_.consume(batch);
+        return;
+    }
+
+    candidates_ = batch.sel;
+    merged_.clear();
+    for (size_t i : order_) {
+        matched_ = candidates_;
+        prune(predicates_[i], batch, matched_);
+        if (!matched_.empty()) apply(i, batch, matched_);
+        if (matched_.empty()) continue;
+        batch.sel.clear();
+        std::set_union(merged_.begin(), merged_.end(), matched_.begin(), matched_.end(), std::back_inserter(batch.sel));
+        merged_.swap(batch.sel);
+        batch.sel.clear();
+        std::set_difference(candidates_.begin(), candidates_.end(), matched_.begin(), matched_.end(),
+                            std::back_inserter(batch.sel));
+        candidates_.swap(batch.sel);
+        if (candidates_.empty()) break;
+    }
+    batch.sel.swap(merged_);
+    if (!batch.sel.empty()) next_.consume(batch);
+}
+
+// ── Project ───────────────────────────────────────────────────────────────────
+
+Project::Project(Table& table, std::vector<uint16_t> columns, Operator& next)
+    : table_(table), columns_(std::move(columns)), next_(next) {}
+
+void Project::consume(Batch& batch) {
+    batch.columns.resize(columns_.size());
+    // Rows not live in every column leave the selection before any value is
+    // read, so each column is loaded once and all of them cover the same rows.
+    for (uint16_t c : columns_) keepLive(table_.columnFile(c), scannedSlots(batch, c), batch.sel);
+    if (batch.sel.empty()) return;
+    for (size_t i = 0; i < columns_.size(); ++i) load(table_, columns_[i], batch, batch.columns[i]);
+    next_.consume(batch);
+}
+
+// ── Aggregate ─────────────────────────────────────────────────────────────────
+
+Aggregate::Aggregate(Table& table, uint16_t column) : table_(table), column_(column) {
+    if (column_ != kCountStar && column_ >= table_.numColumns())
+        throw std::invalid_argument("column index out of bounds");
+}
+
+void Aggregate::consume(Batch& batch) {
+    if (column_ == kCountStar) {
+        count_ += batch.sel.size();
+        return;
+    }
+    load(table_, column_, batch, values_);
+    const size_t n = values_.size();
+    if (n == 0) return;
+    const bool first = count_ == 0;
+    switch (values_.type) {
+        case ColType::UINT32: {
+            const uint32_t* v = values_.u32.data();
+            sum_ += static_cast<long double>(Simd::sum(v, n));
+            fold(min_, max_, first, Simd::min(v, n), Simd::max(v, n));
+            break;
+        }
+        case ColType::INT64: {
+            // Exact in int64 while the running total fits; a total that would
+            // overflow moves into sum_ and the count starts again. A batch
+            // whose own sum could wrap is added value by value instead.
+            const int64_t* v = values_.i64.data();
+            const int64_t lo = Simd::min(v, n), hi = Simd::max(v, n);
+            const int64_t bound = INT64_MAX / int64_t(n);
+            if (hi <= bound && lo >= -bound) {
+                const int64_t batchSum = Simd::sum(v, n);
+                int64_t total = 0;
+                if (__builtin_add_overflow(sumInt_, batchSum, &total)) {
+                    sum_ += static_cast<long double>(sumInt_);
+                    total = batchSum;
+                }
+                sumInt_ = total;
+            } else {
+                for (size_t i = 0; i < n; ++i) sum_ += static_cast<long double>(v[i]);
+            }
+            fold(min_, max_, first, lo, hi);
+            break;
+        }
+        case ColType::FLOAT: {
+            const float* v = values_.f32.data();
+            sum_ += Simd::sum(v, n);
+            fold(min_, max_, first, Simd::min(v, n), Simd::max(v, n));
+            break;
+        }
+        case ColType::DOUBLE: {
+            const double* v = values_.f64.data();
+            sum_ += Simd::sum(v, n);
+            fold(min_, max_, first, Simd::min(v, n), Simd::max(v, n));
+            break;
+        }
+        case ColType::STRING:
+            throw std::invalid_argument("aggregate functions require numeric columns");
+    }
+    count_ += n;
+}
+
+}
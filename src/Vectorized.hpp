@@ -0,0 +1,152 @@
+// Vectorized.hpp — batch-at-a-time query operators with selection vectors.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Predicate.hpp"
+#include "Table.hpp"
+#include "ValueTypes.hpp"
+
+// A push pipeline over live rows: Scan cuts them into batches of up to
+// kBatchSize and hands each batch down a chain of operators (Filter, then
+// Project or Aggregate). Operators narrow a batch's selection vector instead
+// of copying rows, and read a column only for the rows still selected, so the
+// per-row work is a page lookup plus a SIMD kernel over dense values.
+//
+// Like the scans in Table, a pipeline reads pages in place: it must not run
+// alongside writes to the table.
+namespace Vectorized {
+
+constexpr size_t kBatchSize = 2048;
+
+// One column's values for a batch's selected rows, in selection order.
+struct Vector {
+    ColType type = ColType::UINT32;
+    std::vector<uint32_t> u32;
+    std::vector<int64_t> i64;
+    std::vector<float> f32;
+    std::vector<double> f64;
+    std::vector<std::string> str;
+
+    size_t size() const;
+    ColValue at(size_t i) const;
+};
+
+struct Batch {
+    size_t size = 0;                          // rows scanned into the batch
+    std::vector<uint32_t> rowIDs;             // first `size` entries used
+    std::vector<std::vector<uint32_t>> slots; // per table column, like rowIDs; empty if not scanned
+    std::vector<uint32_t> sel;                // selected positions in [0, size), ascending
+    std::vector<Vector> columns;              // filled by Project
+};
+
+// Reads column colIdx for the selected rows into `out` (out[i] is the value
+// of row sel[i]). A row whose slot is not live leaves the selection.
+void load(Table& table, uint16_t colIdx, Batch& batch, Vector& out);
+
+class Operator {
+public:
+    virtual ~Operator() = default;
+    // Called once per batch that still has selected rows.
+    virtual void consume(Batch& batch) = 0;
+};
+
+class Scan {
+public:
+    // `columns` are the ones downstream operators read.
+    Scan(Table& table, std::vector<uint16_t> columns);
+    // Pushes every live row, in rowID order.
+    void run(Operator& next);
+
+private:
+    Table& table_;
+    std::vector<uint16_t> columns_;
+};
+
+// Keeps the rows matching all (or, with anyOf, any) of the predicates, which
+// Table::validatePredicate must accept. AND stops at the first predicate
+// that leaves nothing selected; OR tests each predicate only on the rows no
+// earlier one matched.
+//
+// Rows on a page whose zone map rules a numeric predicate out are dropped
+// before that page is read; under AND every predicate's zone map is checked
+// before any value is. Predicates then run cheapest-and-most-decisive first:
+// each batch reorders them by a per-row cost (strings cost more than
+// numbers) and the pass rate seen so far.
+class Filter : public Operator {
+public:
+    Filter(Table& table, std::vector<Predicate> predicates, bool anyOf, Operator& next);
+    void consume(Batch& batch) override;
+    // Columns the predicates read.
+    std::vector<uint16_t> columns() const;
+
+private:
+    // Narrows `sel` to the positions whose page may hold a matching value.
+    void prune(const Predicate& predicate, const Batch& batch, std::vector<uint32_t>& sel);
+    // Narrows `sel` to the positions whose value satisfies predicates_[i].
+    void apply(size_t i, const Batch& batch, std::vector<uint32_t>& sel);
+    void reorder();
+
+    Table& table_;
+    std::vector<Predicate> predicates_;
+    bool anyOf_;
+    Operator& next_;
+    Vector values_;
+    std::vector<uint32_t> candidates_, matched_, merged_;
+    std::vector<size_t> order_;              // evaluation order, indexes into predicates_
+    std::vector<uint64_t> tested_, passed_;  // rows each predicate saw and kept
+};
+
+// Fills batch.columns with the given columns, then passes the batch on.
+class Project : public Operator {
+public:
+    Project(Table& table, std::vector<uint16_t> columns, Operator& next);
+    void consume(Batch& batch) override;
+
+private:
+    Table& table_;
+    std::vector<uint16_t> columns_;
+    Operator& next_;
+};
+
+// COUNT(*) for kCountStar, else COUNT/SUM/MIN/MAX over a numeric column
+// (std::invalid_argument for a STRING one that has rows to read).
+class Aggregate : public Operator {
+public:
+    static constexpr uint16_t kCountStar = UINT16_MAX;
+    Aggregate(Table& table, uint16_t column = kCountStar);
+    void consume(Batch& batch) override;
+
+    uint64_t count() const { return count_; }
+    // Sum of the values widened to double (FLOAT batches sum in double first,
+    // INT64 ones in int64).
+    long double sum() const { return sum_ + static_cast<long double>(sumInt_); }
+    // Only meaningful when count() > 0.
+    const ColValue& min() const { return min_; }
+    const ColValue& max() const { return max_; }
+
+private:
+    Table& table_;
+    uint16_t column_;
+    Vector values_;
+    uint64_t count_ = 0;
+    long double sum_ = 0;
+    int64_t sumInt_ = 0;  // INT64 columns, converted once in sum()
+    ColValue min_, max_;
+};
+
+// Adapts a callable to the end of a pipeline.
+class Sink : public Operator {
+public:
+    explicit Sink(std::function<void(Batch&)> fn) : fn_(std::move(fn)) {}
+    void consume(Batch& batch) override { fn_(batch); }
+
+private:
+    std::function<void(Batch&)> fn_;
+};
+
+}
@@ -1,46 +1,76 @@
 #include "Wal.hpp"
+#include "Crc32c.hpp"
+#include "MasterPage.hpp"
 
+#include <algorithm>
 #include <cerrno>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <fcntl.h>
 #include <stdexcept>
-#include <sys/stat.h>
 #include <unistd.h>
 #include <unordered_map>
+#include <zlib.h>
 
 namespace {
 
 static constexpr uint32_t WAL_MAGIC   = 0x4D57414C; // MWAL
-static constexpr uint16_t WAL_VERSION = 1;
+// v2: flags checksummed; v3: CRC32C; v4: 16-byte header carrying nextOpID;
+// v5: preallocated, recycled segments with a 32-byte header;
+// v6: packed inserts and column-wise batch records
+static constexpr uint16_t WAL_VERSION = 6;
+static constexpr uint16_t kPackedVersion = 6;      // first version with packed records
+static constexpr uint8_t  kFlagAutoCommit = 0x01;  // record commits its own op
+static constexpr size_t   kCompressMinBytes = 256; // smaller batch bodies stay raw
+static constexpr uint64_t kMaxBatchBodyBytes = 1u << 30;
+static constexpr size_t   kLogBufferBytes = 64 * 1024;
+static constexpr size_t   kReadChunkBytes = 1 << 20;  // replay window
 
 enum class RecordType : uint8_t {
     Insert = 1,
     Delete = 2,
     Commit = 3,
+    PackedInsert = 4,  // v6: varint rowID + values in schema order, no type tags
+    Batch = 5,         // v6: a whole transaction, column-wise; commits itself
+};
+
+enum class BatchCodec : uint8_t {
+    Raw = 0,
+    Zlib = 1,  // varint raw size, then a zlib stream
 };
 
 #pragma pack(push, 1)
 struct WalHeader {
     uint32_t magic;
     uint16_t version;
-    uint16_t reserved;
+    uint16_t generation;   // v5: bumped when the table is rewritten outside the log
+    uint64_t nextOpID;     // v4: opIDs restart here; v5: first opID in this segment
+    uint64_t seq;          // v5: position of the segment in the log
+    uint64_t firstSeq;     // v5: oldest live segment when this one was started
 };
 
 struct RecordHeader {
     uint32_t payloadSize;
     uint8_t  type;
-    uint8_t  reserved[3];
+    uint8_t  flags;        // v1: always 0
+    uint8_t  reserved[2];
     uint64_t opID;
     uint32_t checksum;
 };
 #pragma pack(pop)
 
-static_assert(sizeof(WalHeader) == 8, "WalHeader must be 8 bytes");
+static_assert(sizeof(WalHeader) == 32, "WalHeader must be 32 bytes");
+static constexpr off_t kLegacyHeaderBytes = 8;  // v1-v3: magic, version, reserved
+static constexpr off_t kV4HeaderBytes = 16;     // v4: + nextOpID
+
+off_t headerBytes(uint16_t version) {
+    if (version >= 5) return off_t(sizeof(WalHeader));
+    return version == 4 ? kV4HeaderBytes : kLegacyHeaderBytes;
+}
 static_assert(sizeof(RecordHeader) == 20, "RecordHeader must be 20 bytes");
 
-uint32_t fnv1a32(const uint8_t* data, size_t n) {
-    uint32_t hash = 2166136261u;
+uint32_t fnv1a32(const uint8_t* data, size_t n, uint32_t hash = 2166136261u) {
     for (size_t i = 0; i < n; ++i) {
         hash ^= data[i];
         hash *= 16777619u;
@@ -48,6 +78,19 @@ uint32_t fnv1a32(const uint8_t* data, size_t n) {
     return hash;
 }
 
+// v3: CRC32C over the header bytes ahead of the checksum, then the payload.
+// Older logs used FNV-1a over type, opID, payload (v2 adds flags after type).
+uint32_t recordChecksum(uint16_t version, const RecordHeader& header, const uint8_t* payload) {
+    if (version >= 3) {
+        const uint32_t crc = Crc32c::value(&header, offsetof(RecordHeader, checksum));
+        return Crc32c::extend(crc, payload, header.payloadSize);
+    }
+    uint32_t hash = fnv1a32(&header.type, 1);
+    if (version >= 2) hash = fnv1a32(&header.flags, 1, hash);
+    hash = fnv1a32(reinterpret_cast<const uint8_t*>(&header.opID), sizeof(header.opID), hash);
+    return fnv1a32(payload, header.payloadSize, hash);
+}
+
 void appendBytes(std::vector<uint8_t>& out, const void* data, size_t n) {
     const auto* p = static_cast<const uint8_t*>(data);
     out.insert(out.end(), p, p + n);
@@ -58,18 +101,22 @@ void appendScalar(std::vector<uint8_t>& out, const T& value) {
     appendBytes(out, &value, sizeof(T));
 }
 
+struct PayloadView {
+    const uint8_t* data;
+    size_t size;
+};
+
 template <typename T>
-T readScalar(const std::vector<uint8_t>& in, size_t& pos) {
-    if (pos + sizeof(T) > in.size())
+T readScalar(PayloadView in, size_t& pos) {
+    if (pos + sizeof(T) > in.size)
         throw std::runtime_error("short WAL payload");
     T value{};
-    std::memcpy(&value, in.data() + pos, sizeof(T));
+    std::memcpy(&value, in.data + pos, sizeof(T));
     pos += sizeof(T);
     return value;
 }
 
-std::vector<uint8_t> encodeInsertPayload(uint32_t rowID, const std::vector<ColValue>& values) {
-    std::vector<uint8_t> payload;
+void encodeInsertPayload(std::vector<uint8_t>& payload, uint32_t rowID, const std::vector<ColValue>& values) {
     appendScalar(payload, rowID);
     const uint16_t ncols = static_cast<uint16_t>(values.size());
     appendScalar(payload, ncols);
@@ -100,20 +147,108 @@ std::vector<uint8_t> encodeInsertPayload(uint32_t rowID, const std::vector<ColVa
                 break;
         }
     }
-    return payload;
 }
 
-std::vector<uint8_t> encodeDeletePayload(uint32_t rowID) {
-    std::vector<uint8_t> payload;
-    appendScalar(payload, rowID);
-    return payload;
+void appendVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+uint64_t readVarint(PayloadView in, size_t& pos) {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size) throw std::runtime_error("short WAL payload");
+        const uint8_t byte = in.data[pos++];
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::runtime_error("bad WAL varint");
+}
+
+uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+int64_t unzigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+bool matchesSchema(const std::vector<ColValue>& values, const std::vector<ColType>& schema) {
+    if (values.size() != schema.size()) return false;
+    for (size_t c = 0; c < values.size(); ++c)
+        if (values[c].type != schema[c]) return false;
+    return true;
+}
+
+// Packed values: integers as varints (INT64 zig-zagged), floats raw, strings
+// as a varint length and the bytes. The column type comes from the schema.
+void appendPackedValue(std::vector<uint8_t>& out, const ColValue& value) {
+    switch (value.type) {
+        case ColType::UINT32: appendVarint(out, value.u32); break;
+        case ColType::INT64:  appendVarint(out, zigzag(value.i64)); break;
+        case ColType::FLOAT:  appendScalar(out, value.f32); break;
+        case ColType::DOUBLE: appendScalar(out, value.f64); break;
+        case ColType::STRING:
+            appendVarint(out, value.str.size());
+            appendBytes(out, value.str.data(), value.str.size());
+            break;
+    }
+}
+
+ColValue readPackedValue(PayloadView in, size_t& pos, ColType type) {
+    switch (type) {
+        case ColType::UINT32: {
+            const uint64_t v = readVarint(in, pos);
+            if (v > UINT32_MAX) throw std::runtime_error("bad WAL uint32");
+            return ColValue(uint32_t(v));
+        }
+        case ColType::INT64:  return ColValue(unzigzag(readVarint(in, pos)));
+        case ColType::FLOAT:  return ColValue(readScalar<float>(in, pos));
+        case ColType::DOUBLE: return ColValue(readScalar<double>(in, pos));
+        case ColType::STRING: {
+            const uint64_t len = readVarint(in, pos);
+            if (len > in.size - pos) throw std::runtime_error("short WAL payload");
+            ColValue value(std::string(reinterpret_cast<const char*>(in.data + pos), size_t(len)));
+            pos += size_t(len);
+            return value;
+        }
+    }
+    throw std::runtime_error("bad WAL column type");
+}
+
+void encodePackedInsert(std::vector<uint8_t>& payload, uint32_t rowID, const std::vector<ColValue>& values) {
+    appendVarint(payload, rowID);
+    for (const auto& value : values) appendPackedValue(payload, value);
+}
+
+// Batch body: op count, a delete bitmap, zig-zag rowID deltas, then each
+// column's insert values in op order. Returns false if an insert does not
+// match the schema (the caller falls back to per-op records).
+bool encodeBatchBody(std::vector<uint8_t>& body, const std::vector<Wal::Operation>& ops,
+                     const std::vector<ColType>& schema) {
+    body.clear();
+    appendVarint(body, ops.size());
+    const size_t bitmap = body.size();
+    body.resize(bitmap + (ops.size() + 7) / 8, 0);
+    int64_t prev = 0;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        if (ops[i].kind == Wal::Operation::Kind::Delete)
+            body[bitmap + i / 8] |= uint8_t(1u << (i % 8));
+        else if (!matchesSchema(ops[i].values, schema))
+            return false;
+        appendVarint(body, zigzag(int64_t(ops[i].rowID) - prev));
+        prev = ops[i].rowID;
+    }
+    for (size_t c = 0; c < schema.size(); ++c)
+        for (const auto& op : ops)
+            if (op.kind == Wal::Operation::Kind::Insert) appendPackedValue(body, op.values[c]);
+    return true;
 }
 
-Wal::Operation decodeInsert(uint64_t opID, const std::vector<uint8_t>& payload) {
+// Decoders fill a caller-owned Operation so replay can reuse its storage.
+void decodeInsert(uint64_t opID, PayloadView payload, Wal::Operation& op) {
     size_t pos = 0;
-    Wal::Operation op;
     op.kind = Wal::Operation::Kind::Insert;
     op.opID = opID;
+    op.values.clear();
     op.rowID = readScalar<uint32_t>(payload, pos);
     const uint16_t ncols = readScalar<uint16_t>(payload, pos);
     (void)readScalar<uint16_t>(payload, pos);
@@ -122,7 +257,7 @@ Wal::Operation decodeInsert(uint64_t opID, const std::vector<uint8_t>& payload)
         const auto type = static_cast<ColType>(readScalar<uint8_t>(payload, pos));
         pos += 3; // reserved
         const uint32_t byteLen = readScalar<uint32_t>(payload, pos);
-        if (pos + byteLen > payload.size())
+        if (pos + byteLen > payload.size)
             throw std::runtime_error("short WAL payload");
         switch (type) {
             case ColType::UINT32: {
@@ -146,181 +281,1108 @@ Wal::Operation decodeInsert(uint64_t opID, const std::vector<uint8_t>& payload)
                 break;
             }
             case ColType::STRING: {
-                std::string value(reinterpret_cast<const char*>(payload.data() + pos), byteLen);
+                std::string value(reinterpret_cast<const char*>(payload.data + pos), byteLen);
                 pos += byteLen;
                 op.values.emplace_back(std::move(value));
                 break;
             }
         }
     }
-    return op;
 }
 
-Wal::Operation decodeDelete(uint64_t opID, const std::vector<uint8_t>& payload) {
+void decodePackedInsert(uint64_t opID, PayloadView payload, const std::vector<ColType>& schema,
+                        Wal::Operation& op) {
+    size_t pos = 0;
+    op.kind = Wal::Operation::Kind::Insert;
+    op.opID = opID;
+    op.values.clear();
+    const uint64_t rowID = readVarint(payload, pos);
+    if (rowID > UINT32_MAX) throw std::runtime_error("bad WAL rowID");
+    op.rowID = uint32_t(rowID);
+    op.values.reserve(schema.size());
+    for (ColType type : schema) op.values.push_back(readPackedValue(payload, pos, type));
+}
+
+// `lastOpID` is the record's opID; the batch's ops end there.
+void decodeBatch(uint64_t lastOpID, PayloadView payload, const std::vector<ColType>& schema,
+                 std::vector<uint8_t>& scratch, std::vector<Wal::Operation>& ops) {
+    size_t pos = 0;
+    const auto codec = static_cast<BatchCodec>(readScalar<uint8_t>(payload, pos));
+    PayloadView body{payload.data + pos, payload.size - pos};
+    if (codec == BatchCodec::Zlib) {
+        const uint64_t rawSize = readVarint(payload, pos);
+        if (rawSize > kMaxBatchBodyBytes) throw std::runtime_error("bad WAL batch size");
+        scratch.resize(size_t(rawSize));
+        uLongf outLen = uLongf(rawSize);
+        if (::uncompress(scratch.data(), &outLen, payload.data + pos, uLong(payload.size - pos)) != Z_OK ||
+            outLen != rawSize)
+            throw std::runtime_error("corrupt WAL batch");
+        body = PayloadView{scratch.data(), scratch.size()};
+    } else if (codec != BatchCodec::Raw) {
+        throw std::runtime_error("unknown WAL batch codec");
+    }
+
+    pos = 0;
+    const uint64_t n = readVarint(body, pos);
+    if (n == 0 || n > body.size || n > lastOpID) throw std::runtime_error("bad WAL batch");
+    const size_t bitmap = pos;
+    pos += size_t((n + 7) / 8);
+    if (pos > body.size) throw std::runtime_error("short WAL payload");
+    ops.resize(size_t(n));
+    int64_t prev = 0;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        Wal::Operation& op = ops[i];
+        op.kind = (body.data[bitmap + i / 8] >> (i % 8)) & 1 ? Wal::Operation::Kind::Delete
+                                                           : Wal::Operation::Kind::Insert;
+        op.opID = lastOpID - n + 1 + i;
+        op.values.clear();
+        const int64_t rowID = prev + unzigzag(readVarint(body, pos));
+        if (rowID < 0 || rowID > int64_t(UINT32_MAX)) throw std::runtime_error("bad WAL rowID");
+        op.rowID = uint32_t(rowID);
+        prev = rowID;
+    }
+    for (ColType type : schema)
+        for (auto& op : ops)
+            if (op.kind == Wal::Operation::Kind::Insert) op.values.push_back(readPackedValue(body, pos, type));
+}
+
+void decodeDelete(uint64_t opID, PayloadView payload, Wal::Operation& op) {
     size_t pos = 0;
-    Wal::Operation op;
     op.kind = Wal::Operation::Kind::Delete;
     op.opID = opID;
+    op.values.clear();
     op.rowID = readScalar<uint32_t>(payload, pos);
-    return op;
 }
 
+// Walks records front to back through a fixed window, so replay memory is
+// bounded by the larger of the window and the biggest single record rather
+// than by the log size.
+class RecordReader {
+public:
+    // Why next() returned false. A recycled segment ends at zeroed space or at
+    // a record left from its previous use (opID below the segment's first);
+    // anything else is a torn or corrupt record.
+    enum class Stop { End, Fenced, Corrupt };
+
+    RecordReader(int fd, uint16_t version, off_t start, off_t end, uint64_t firstOpID = 0)
+        : fd_(fd), version_(version), pos_(start), end_(end), firstOpID_(firstOpID) {}
+
+    // Next intact record; false at the end of the segment or at the first torn
+    // or corrupt record. `at` is the record's offset, for recordAt.
+    bool next(RecordHeader& header, PayloadView& payload, off_t& at) {
+        if (pos_ + off_t(sizeof(RecordHeader)) > end_ || !fill(pos_, sizeof(RecordHeader))) {
+            stop_ = Stop::End;  // no room for another record
+            return false;
+        }
+        static const uint8_t kZero[sizeof(RecordHeader)] = {};
+        if (std::memcmp(window_.data() + (pos_ - windowStart_), kZero, sizeof(kZero)) == 0) {
+            stop_ = Stop::End;
+            return false;
+        }
+        if (!recordAt(pos_, header, payload)) {
+            stop_ = Stop::Corrupt;
+            return false;
+        }
+        if (header.opID < firstOpID_) {
+            stop_ = Stop::Fenced;
+            return false;
+        }
+        at = pos_;
+        pos_ += off_t(sizeof(RecordHeader)) + off_t(header.payloadSize);
+        return true;
+    }
+
+    bool recordAt(off_t at, RecordHeader& header, PayloadView& payload) {
+        if (at + off_t(sizeof(RecordHeader)) > end_ || !fill(at, sizeof(RecordHeader)))
+            return false;
+        std::memcpy(&header, window_.data() + (at - windowStart_), sizeof(header));
+        const off_t payloadAt = at + off_t(sizeof(RecordHeader));
+        if (payloadAt + off_t(header.payloadSize) > end_ || !fill(payloadAt, header.payloadSize))
+            return false;
+        payload = {window_.data() + (payloadAt - windowStart_), header.payloadSize};
+        return recordChecksum(version_, header, payload.data) == header.checksum;
+    }
+
+    // Offset just past the last record returned by next().
+    off_t position() const { return pos_; }
+    Stop stop() const { return stop_; }
+    // Drop the window once the segment has been read; recordAt refills it.
+    void release() {
+        std::vector<uint8_t>().swap(window_);
+        windowLen_ = 0;
+    }
+
+private:
+    int fd_;
+    uint16_t version_;
+    off_t pos_;
+    off_t end_;
+    uint64_t firstOpID_;
+    Stop stop_ = Stop::End;
+    std::vector<uint8_t> window_;
+    off_t windowStart_ = 0;
+    size_t windowLen_ = 0;
+
+    bool fill(off_t at, size_t n) {
+        if (at >= windowStart_ && at + off_t(n) <= windowStart_ + off_t(windowLen_)) return true;
+        const size_t want = std::min<size_t>(std::max(n, kReadChunkBytes), size_t(end_ - at));
+        if (window_.size() < want) window_.resize(want);
+        size_t got = 0;
+        while (got < want) {
+            const ssize_t r = ::pread(fd_, window_.data() + got, want - got, at + off_t(got));
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) break;
+            got += size_t(r);
+        }
+        windowStart_ = at;
+        windowLen_ = got;
+        return got >= n;
+    }
+};
+
+off_t fileEnd(int fd) {
+    const off_t end = ::lseek(fd, 0, SEEK_END);
+    if (end < 0)
+        throw std::runtime_error(std::string("seek WAL failed: ") + std::strerror(errno));
+    return end;
+}
+
+// Reserve a segment's blocks up front so appends never extend the file.
+void preallocate(int fd, off_t bytes) {
+    const off_t have = fileEnd(fd);
+    if (have >= bytes) return;
+#if defined(__APPLE__)
+    fstore_t store{F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, bytes - have, 0};
+    if (::fcntl(fd, F_PREALLOCATE, &store) == -1) {
+        store.fst_flags = F_ALLOCATEALL;
+        ::fcntl(fd, F_PREALLOCATE, &store);  // best effort; the ftruncate still sizes the file
+    }
+    if (::ftruncate(fd, bytes) != 0)
+        throw std::runtime_error(std::string("preallocate WAL segment failed: ") + std::strerror(errno));
+#else
+    const int rc = ::posix_fallocate(fd, have, bytes - have);
+    if (rc != 0 && ::ftruncate(fd, bytes) != 0)
+        throw std::runtime_error(std::string("preallocate WAL segment failed: ") + std::strerror(rc));
+#endif
+}
+
+void writeFully(int fd, const uint8_t* data, size_t n, off_t at) {
+    size_t written = 0;
+    while (written < n) {
+        const ssize_t w = ::pwrite(fd, data + written, n - written, at + off_t(written));
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("write WAL records failed: ") + std::strerror(errno));
+        }
+        written += size_t(w);
+    }
+}
+
+void syncFd(int fd, bool dataOnly) {
+#if defined(__APPLE__)
+    (void)dataOnly;
+    const int rc = ::fsync(fd);
+#else
+    const int rc = dataOnly ? ::fdatasync(fd) : ::fsync(fd);
+#endif
+    if (rc != 0)
+        throw std::runtime_error(std::string("sync WAL failed: ") + std::strerror(errno));
+}
+
+// False unless `fd` starts with a segment header (v5+).
+bool readSegmentHeader(int fd, WalHeader& header) {
+    return ::pread(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header)) && header.magic == WAL_MAGIC &&
+           header.version >= 5 && header.version <= WAL_VERSION;
+}
+
+// The segment files of a log followed by WalTail, opened read-only with their
+// headers as of load(). The writer may recycle a slot at any moment, so a
+// header is only trusted again after rereading it.
+class TailSegments {
+public:
+    struct Segment {
+        int fd = -1;
+        WalHeader header{};  // version 0 if the slot holds no segment
+    };
+
+    explicit TailSegments(std::string path) : path_(std::move(path)) { load(); }
+    ~TailSegments() { close(); }
+    TailSegments(const TailSegments&) = delete;
+    TailSegments& operator=(const TailSegments&) = delete;
+
+    void load() {
+        close();
+        for (size_t slot = 0;; ++slot) {
+            const std::string file = slot == 0 ? path_ : path_ + "." + std::to_string(slot);
+            const int fd = ::open(file.c_str(), O_RDONLY);
+            if (fd < 0 && errno == ENOENT && slot > 0) break;
+            if (fd < 0)
+                throw std::runtime_error(std::string("open WAL failed: ") + std::strerror(errno));
+            segs_.push_back({fd, {}});
+            if (!readSegmentHeader(fd, segs_.back().header)) segs_.back().header.version = 0;
+        }
+    }
+
+    const Segment* find(uint64_t seq) const {
+        for (const auto& seg : segs_)
+            if (seg.header.version && seg.header.seq == seq) return &seg;
+        return nullptr;
+    }
+
+    const Segment* newest() const {
+        const Segment* best = nullptr;
+        for (const auto& seg : segs_)
+            if (seg.header.version && (!best || seg.header.seq > best->header.seq)) best = &seg;
+        return best;
+    }
+
+    // Where the log begins, going by the newest segment's firstSeq.
+    const Segment* oldestLive() const {
+        const Segment* head = newest();
+        if (!head) return nullptr;
+        const Segment* best = nullptr;
+        for (const auto& seg : segs_)
+            if (seg.header.version && seg.header.seq >= head->header.firstSeq &&
+                (!best || seg.header.seq < best->header.seq))
+                best = &seg;
+        return best;
+    }
+
+private:
+    std::string path_;
+    std::vector<Segment> segs_;
+
+    void close() {
+        for (const auto& seg : segs_) ::close(seg.fd);
+        segs_.clear();
+    }
+};
+
 } // namespace
 
-Wal::Wal(const std::string& tablePath) : path_(tablePath + ".wal") {}
+Wal::Wal(const std::string& tablePath, uint64_t segmentBytes)
+    : path_(tablePath + ".wal"), segmentBytes_(segmentBytes) {}
 
 Wal::~Wal() {
-    if (fd_ >= 0) ::close(fd_);
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        groupCommit_ = false;
+        syncInterval_ = std::chrono::milliseconds(0);
+    }
+    updateSyncer();
+    if (fd_ >= 0) {
+        try { writeBuffered(); } catch (const std::exception&) {}
+    }
+    closeSegments();
+}
+
+std::string Wal::segmentPath(size_t slot) const {
+    return slot == 0 ? path_ : path_ + "." + std::to_string(slot);
+}
+
+void Wal::closeSegments() {
+    for (auto& seg : segs_)
+        if (seg.fd >= 0) ::close(seg.fd);
+    segs_.clear();
+    fd_ = -1;
 }
 
 void Wal::openOrCreate(bool create) {
-    if (fd_ >= 0) ::close(fd_);
-    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT, 0666);
-    if (fd_ < 0)
-        throw std::runtime_error(std::string("open WAL failed: ") + std::strerror(errno));
-    if (create) {
-        if (::ftruncate(fd_, 0) != 0)
-            throw std::runtime_error(std::string("truncate WAL failed: ") + std::strerror(errno));
+    closeSegments();
+    buf_.clear();
+    sealedBytes_ = 0;
+    for (size_t slot = 0;; ++slot) {
+        const std::string path = segmentPath(slot);
+        if (slot > 0 && ::access(path.c_str(), F_OK) != 0) break;
+        if (slot > 0 && create) {
+            std::remove(path.c_str());
+            continue;
+        }
+        Segment seg;
+        seg.fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0666);
+        if (seg.fd < 0)
+            throw std::runtime_error(std::string("open WAL failed: ") + std::strerror(errno));
+        segs_.push_back(seg);
+    }
+    if (create && ::ftruncate(segs_[0].fd, 0) != 0)
+        throw std::runtime_error(std::string("truncate WAL failed: ") + std::strerror(errno));
+    // No scan here: nextOpID comes from the headers, and records past them are
+    // only read by replay(), which must run before anything is appended.
+    loadSegments();
+}
+
+void Wal::loadSegments() {
+    uint64_t newest = 0;
+    bool any = false;
+    for (size_t slot = 0; slot < segs_.size(); ++slot) {
+        Segment& seg = segs_[slot];
+        WalHeader header{};
+        const off_t end = fileEnd(seg.fd);
+        if (end == 0) continue;
+        if (end < kLegacyHeaderBytes || ::pread(seg.fd, &header, kLegacyHeaderBytes, 0) != ssize_t(kLegacyHeaderBytes))
+            throw std::runtime_error(std::string("read WAL header failed: ") + std::strerror(errno));
+        if (header.magic != WAL_MAGIC || header.version < 1 || header.version > WAL_VERSION) {
+            if (slot == 0) throw std::runtime_error("invalid WAL header");
+            continue;  // a retired segment; free for reuse
+        }
+        if (header.version >= 4 &&
+            ::pread(seg.fd, &header, size_t(headerBytes(header.version)), 0) != ssize_t(headerBytes(header.version)))
+            throw std::runtime_error("invalid WAL header");
+        if (header.version < 5) {
+            // A single-file log from before segments: slot 0, sequence 0.
+            if (slot != 0) continue;
+            header.seq = 0;
+            header.firstSeq = 0;
+            if (header.version < 4) header.nextOpID = 1;
+        }
+        seg.version = header.version;
+        seg.seq = header.seq;
+        seg.firstOpID = header.nextOpID;
+        if (!any || seg.seq >= segs_[newest].seq) newest = slot;
+        any = true;
     }
-    ensureHeader();
 
     nextOpID_ = 1;
-    const auto ops = committedOperations();
-    for (const auto& op : ops)
-        if (op.opID >= nextOpID_) nextOpID_ = op.opID + 1;
+    if (!any) {
+        initSegment(0, 1, 1);
+        firstSeq_ = 1;
+        activate(0);
+        needsReplay_ = false;
+        return;
+    }
+    const Segment& head = segs_[newest];
+    WalHeader header{};
+    if (head.version >= 5 && ::pread(head.fd, &header, sizeof(header), 0) == ssize_t(sizeof(header))) {
+        firstSeq_ = header.firstSeq;
+        generation_ = header.generation;
+    } else {
+        firstSeq_ = 0;
+    }
+    for (const auto& seg : segs_)
+        if (seg.version && seg.seq >= firstSeq_) nextOpID_ = std::max(nextOpID_, seg.firstOpID);
+    activate(newest);
+
+    bool records = false;
+    if (head.version < 5) {
+        appendOffset_ = fileEnd(head.fd);
+        records = appendOffset_ > headerBytes(head.version);
+        // An empty older log is upgraded in place; one with records is read in
+        // its own format until the next checkpoint recycles it.
+        if (!records) {
+            initSegment(0, 1, nextOpID_);
+            firstSeq_ = 1;
+            activate(0);
+        }
+    } else {
+        RecordHeader first{};
+        records = head.seq > firstSeq_ ||
+                  (::pread(head.fd, &first, sizeof(first), appendOffset_) == ssize_t(sizeof(first)) &&
+                   first.type != 0 && first.opID >= head.firstOpID);
+    }
+    needsReplay_ = records;
 }
 
-void Wal::ensureHeader() {
-    const off_t end = ::lseek(fd_, 0, SEEK_END);
-    if (end < 0)
-        throw std::runtime_error(std::string("seek WAL failed: ") + std::strerror(errno));
-    if (end == 0) {
-        WalHeader header{WAL_MAGIC, WAL_VERSION, 0};
-        if (::pwrite(fd_, &header, sizeof(header), 0) != ssize_t(sizeof(header)))
-            throw std::runtime_error(std::string("write WAL header failed: ") + std::strerror(errno));
-        return;
+void Wal::initSegment(size_t slot, uint64_t seq, uint64_t firstOpID) {
+    Segment& seg = segs_[slot];
+    // Older-format bytes could pass as records; start such a file from empty.
+    if (seg.version != 0 && seg.version < 5 && ::ftruncate(seg.fd, 0) != 0)
+        throw std::runtime_error(std::string("truncate WAL failed: ") + std::strerror(errno));
+    preallocate(seg.fd, off_t(segmentBytes_));
+    // Header plus an end marker; records left from the slot's previous use
+    // also have opIDs below firstOpID, so readers never take them as new.
+    uint8_t head[sizeof(WalHeader) + sizeof(RecordHeader)] = {};
+    const WalHeader header{WAL_MAGIC, WAL_VERSION, generation_, firstOpID, seq, firstSeq_};
+    std::memcpy(head, &header, sizeof(header));
+    writeFully(seg.fd, head, sizeof(head), 0);
+    seg.version = WAL_VERSION;
+    seg.seq = seq;
+    seg.firstOpID = firstOpID;
+}
+
+void Wal::activate(size_t slot) {
+    {
+        std::lock_guard<std::mutex> lock(fdMu_);
+        fd_ = segs_[slot].fd;
     }
+    active_ = slot;
+    version_ = segs_[slot].version;
+    appendOffset_ = headerBytes(version_);
+}
 
-    WalHeader header{};
-    if (::pread(fd_, &header, sizeof(header), 0) != ssize_t(sizeof(header)))
-        throw std::runtime_error(std::string("read WAL header failed: ") + std::strerror(errno));
-    if (header.magic != WAL_MAGIC || header.version != WAL_VERSION)
-        throw std::runtime_error("invalid WAL header");
+void Wal::rotate(uint64_t firstOpID) {
+    // Later segments only hold later records, so the full one is ended and
+    // made durable before anything lands in the next.
+    const uint8_t marker[sizeof(RecordHeader)] = {};
+    if (uint64_t(appendOffset_) + sizeof(marker) <= segmentBytes_)
+        writeFully(fd_, marker, sizeof(marker), appendOffset_);
+    syncFd(fd_, /*dataOnly=*/true);
+    segs_[active_].bytes = uint64_t(appendOffset_);
+    sealedBytes_ += uint64_t(appendOffset_);
+    const uint64_t seq = segs_[active_].seq + 1;
+    size_t slot = 0;
+    while (slot < segs_.size() && (slot == active_ || (segs_[slot].version && segs_[slot].seq >= firstSeq_)))
+        ++slot;
+    if (slot == segs_.size()) {
+        Segment seg;
+        seg.fd = ::open(segmentPath(slot).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if (seg.fd < 0)
+            throw std::runtime_error(std::string("open WAL segment failed: ") + std::strerror(errno));
+        segs_.push_back(seg);
+    }
+    initSegment(slot, seq, firstOpID);
+    activate(slot);
 }
 
-void Wal::appendRecord(uint8_t type, uint64_t opID, const std::vector<uint8_t>& payload) {
+size_t Wal::beginRecord(uint8_t type, uint8_t flags, uint64_t opID) {
+    if (needsReplay_)
+        throw std::runtime_error("WAL has unreplayed records; replay before appending");
+    const size_t at = buf_.size();
     RecordHeader header{};
-    header.payloadSize = static_cast<uint32_t>(payload.size());
     header.type = type;
+    header.flags = flags;
     header.opID = opID;
+    appendScalar(buf_, header);
+    return at;
+}
 
-    std::vector<uint8_t> checksumBuf;
-    checksumBuf.reserve(1 + sizeof(opID) + payload.size());
-    checksumBuf.push_back(type);
-    appendScalar(checksumBuf, opID);
-    checksumBuf.insert(checksumBuf.end(), payload.begin(), payload.end());
-    header.checksum = fnv1a32(checksumBuf.data(), checksumBuf.size());
+void Wal::endRecord(size_t at) {
+    // Patch size and checksum in place once the payload has been serialized
+    // straight into the log buffer.
+    RecordHeader header;
+    std::memcpy(&header, buf_.data() + at, sizeof(header));
+    header.payloadSize = static_cast<uint32_t>(buf_.size() - at - sizeof(header));
+    header.checksum = recordChecksum(version_, header, buf_.data() + at + sizeof(header));
+    std::memcpy(buf_.data() + at, &header, sizeof(header));
+    // Long uncommitted runs spill early; commits always write through.
+    if (buf_.size() >= kLogBufferBytes) writeBuffered();
+}
 
-    const off_t end = ::lseek(fd_, 0, SEEK_END);
-    if (end < 0)
-        throw std::runtime_error(std::string("seek WAL append failed: ") + std::strerror(errno));
-    if (::pwrite(fd_, &header, sizeof(header), end) != ssize_t(sizeof(header)))
-        throw std::runtime_error(std::string("write WAL record header failed: ") + std::strerror(errno));
-    if (!payload.empty()) {
-        if (::pwrite(fd_, payload.data(), payload.size(), end + sizeof(header)) != ssize_t(payload.size()))
-            throw std::runtime_error(std::string("write WAL payload failed: ") + std::strerror(errno));
+void Wal::writeBuffered() {
+    const size_t records = buf_.size();
+    size_t done = 0;
+    try {
+        while (done < records) {
+            // Whole records that still fit in the active segment; one larger
+            // than a segment gets an empty segment to itself and extends it.
+            // A pre-segment log keeps growing in place until it is recycled.
+            size_t n = 0;
+            uint64_t firstOpID = 0;
+            while (done + n < records) {
+                RecordHeader header;
+                std::memcpy(&header, buf_.data() + done + n, sizeof(header));
+                if (n == 0) firstOpID = header.opID;
+                const size_t record = sizeof(header) + header.payloadSize;
+                const bool empty = n == 0 && appendOffset_ == headerBytes(version_);
+                if (!empty && version_ >= 5 && uint64_t(appendOffset_) + n + record > segmentBytes_) break;
+                n += record;
+            }
+            if (n == 0) {
+                rotate(firstOpID);
+                continue;
+            }
+            // A zeroed header after the last record ends the log for readers;
+            // a recycled segment still holds older bytes past it. It rides on
+            // the same write and the next write covers it.
+            size_t marker = 0;
+            if (version_ >= 5 && done + n == records &&
+                uint64_t(appendOffset_) + n + sizeof(RecordHeader) <= segmentBytes_) {
+                marker = sizeof(RecordHeader);
+                buf_.resize(records + marker);
+            }
+            writeFully(fd_, buf_.data() + done, n + marker, appendOffset_);
+            appendOffset_ += off_t(n);
+            done += n;
+        }
+    } catch (...) {
+        buf_.resize(records);
+        buf_.erase(buf_.begin(), buf_.begin() + ptrdiff_t(done));
+        throw;
     }
+    buf_.clear();  // keeps capacity for the next batch
 }
 
 uint64_t Wal::appendInsert(uint32_t rowID, const std::vector<ColValue>& values) {
     const uint64_t opID = nextOpID_++;
-    appendRecord(static_cast<uint8_t>(RecordType::Insert), opID, encodeInsertPayload(rowID, values));
+    writeInsert(rowID, values, 0, opID);
     return opID;
 }
 
+void Wal::writeInsert(uint32_t rowID, const std::vector<ColValue>& values, uint8_t flags, uint64_t opID) {
+    if (packed() && matchesSchema(values, schema_)) {
+        const size_t at = beginRecord(static_cast<uint8_t>(RecordType::PackedInsert), flags, opID);
+        encodePackedInsert(buf_, rowID, values);
+        endRecord(at);
+        return;
+    }
+    const size_t at = beginRecord(static_cast<uint8_t>(RecordType::Insert), flags, opID);
+    encodeInsertPayload(buf_, rowID, values);
+    endRecord(at);
+}
+
+bool Wal::packed() const {
+    return version_ >= kPackedVersion && !schema_.empty();
+}
+
+void Wal::setSchema(std::vector<ColType> colTypes) {
+    schema_ = std::move(colTypes);
+}
+
+const std::vector<ColType>& Wal::replaySchema() {
+    if (schema_.empty()) {
+        // A log opened on its own: the column types live in the table file.
+        const std::string table = path_.substr(0, path_.size() - 4);  // strip ".wal"
+        const int fd = ::open(table.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("packed WAL record needs the table schema");
+        try {
+            schema_ = MasterPage::load(fd).colTypes;
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+    }
+    return schema_;
+}
+
 uint64_t Wal::appendDelete(uint32_t rowID) {
     const uint64_t opID = nextOpID_++;
-    appendRecord(static_cast<uint8_t>(RecordType::Delete), opID, encodeDeletePayload(rowID));
+    const size_t at = beginRecord(static_cast<uint8_t>(RecordType::Delete), 0, opID);
+    appendScalar(buf_, rowID);
+    endRecord(at);
     return opID;
 }
 
-void Wal::appendCommit(uint64_t opID) {
-    appendRecord(static_cast<uint8_t>(RecordType::Commit), opID, {});
+uint64_t Wal::appendCommit(uint64_t opID) {
+    endRecord(beginRecord(static_cast<uint8_t>(RecordType::Commit), 0, opID));
+    return publishCommit();
 }
 
-std::vector<Wal::Operation> Wal::committedOperations() const {
-    std::vector<Operation> committed;
-    if (fd_ < 0) return committed;
-
-    std::unordered_map<uint64_t, Operation> pending;
-    off_t pos = sizeof(WalHeader);
-    const off_t end = ::lseek(fd_, 0, SEEK_END);
-    while (pos + off_t(sizeof(RecordHeader)) <= end) {
-        RecordHeader header{};
-        if (::pread(fd_, &header, sizeof(header), pos) != ssize_t(sizeof(header)))
-            break;
+uint64_t Wal::commitBatch(const std::vector<Operation>& ops) {
+    const uint64_t first = nextOpID_;
+    try {
+        appendBatch(ops);
+        return publishCommit();
+    } catch (...) {
+        discardFrom(first);
+        throw;
+    }
+}
 
-        const off_t payloadPos = pos + sizeof(header);
-        const off_t nextPos = payloadPos + off_t(header.payloadSize);
-        if (nextPos > end) break;
+void Wal::discardFrom(uint64_t first) {
+    // Whatever of a failed commit is still buffered was not written; its
+    // records are the ones from `first` on. Spilled ones have no commit record.
+    size_t keep = 0;
+    while (keep < buf_.size()) {
+        RecordHeader header;
+        std::memcpy(&header, buf_.data() + keep, sizeof(header));
+        if (header.opID >= first) break;
+        keep += sizeof(header) + header.payloadSize;
+    }
+    buf_.resize(keep);
+    nextOpID_ = first;
+}
 
-        std::vector<uint8_t> payload(header.payloadSize);
-        if (!payload.empty()) {
-            if (::pread(fd_, payload.data(), payload.size(), payloadPos) != ssize_t(payload.size()))
-                break;
+void Wal::appendBatch(const std::vector<Operation>& ops) {
+    if (!ops.empty() && packed() && encodeBatchBody(batchBody_, ops, schema_)) {
+        // One self-committing record; its opID is the batch's last.
+        nextOpID_ += ops.size();
+        const size_t at = beginRecord(static_cast<uint8_t>(RecordType::Batch), kFlagAutoCommit, nextOpID_ - 1);
+        bool compressed = false;
+        if (batchBody_.size() >= kCompressMinBytes) {
+            uLongf zlen = ::compressBound(uLong(batchBody_.size()));
+            batchZip_.resize(zlen);
+            if (::compress2(batchZip_.data(), &zlen, batchBody_.data(), uLong(batchBody_.size()), Z_BEST_SPEED) == Z_OK &&
+                zlen + 8 < batchBody_.size()) {
+                appendScalar(buf_, static_cast<uint8_t>(BatchCodec::Zlib));
+                appendVarint(buf_, batchBody_.size());
+                appendBytes(buf_, batchZip_.data(), zlen);
+                compressed = true;
+            }
         }
+        if (!compressed) {
+            appendScalar(buf_, static_cast<uint8_t>(BatchCodec::Raw));
+            appendBytes(buf_, batchBody_.data(), batchBody_.size());
+        }
+        endRecord(at);
+        return;
+    }
+    // Per-op records and a commit record covering them.
+    const uint64_t first = nextOpID_;
+    for (const auto& op : ops) {
+        if (op.kind == Operation::Kind::Insert)
+            appendInsert(op.rowID, op.values);
+        else
+            appendDelete(op.rowID);
+    }
+    const size_t at = beginRecord(static_cast<uint8_t>(RecordType::Commit), 0, nextOpID_ - 1);
+    appendScalar(buf_, first);
+    endRecord(at);
+}
 
-        std::vector<uint8_t> checksumBuf;
-        checksumBuf.reserve(1 + sizeof(header.opID) + payload.size());
-        checksumBuf.push_back(header.type);
-        appendScalar(checksumBuf, header.opID);
-        checksumBuf.insert(checksumBuf.end(), payload.begin(), payload.end());
-        if (fnv1a32(checksumBuf.data(), checksumBuf.size()) != header.checksum)
-            break;
+uint64_t Wal::commitInsert(uint32_t rowID, const std::vector<ColValue>& values) {
+    const uint64_t opID = nextOpID_++;
+    try {
+        writeInsert(rowID, values, kFlagAutoCommit, opID);
+        return publishCommit();
+    } catch (...) {
+        discardFrom(opID);
+        throw;
+    }
+}
 
+uint64_t Wal::commitDelete(uint32_t rowID) {
+    const uint64_t opID = nextOpID_++;
+    try {
+        const size_t at = beginRecord(static_cast<uint8_t>(RecordType::Delete), kFlagAutoCommit, opID);
+        appendScalar(buf_, rowID);
+        endRecord(at);
+        return publishCommit();
+    } catch (...) {
+        discardFrom(opID);
+        throw;
+    }
+}
+
+uint64_t Wal::publishCommit() {
+    // The buffer drains at every commit boundary, so the commit is in the file
+    // before its caller applies it. Column pages reach disk only when a
+    // checkpoint writes them, which is always after the log they depend on.
+    writeBuffered();
+    std::lock_guard<std::mutex> lock(mu_);
+    const uint64_t epoch = ++commitEpoch_;
+    if (groupCommit_) cv_.notify_all();
+    return epoch;
+}
+
+uint64_t Wal::replay(const std::function<void(const Operation&)>& apply) {
+    if (fd_ < 0) return 0;
+    writeBuffered();
+
+    // Live segments in log order.
+    std::vector<size_t> order;
+    for (size_t slot = 0; slot < segs_.size(); ++slot)
+        if (segs_[slot].version && segs_[slot].seq >= firstSeq_) order.push_back(slot);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return segs_[a].seq < segs_[b].seq; });
+
+    // Autocommit records apply as they are read. Other ops wait for a commit
+    // record covering them; only their locations are held until then.
+    struct Location {
+        size_t segment;  // index into readers
+        off_t at;
+    };
+    std::vector<RecordReader> readers;
+    readers.reserve(order.size());
+    std::unordered_map<uint64_t, Location> pending;
+    std::vector<std::pair<uint64_t, Location>> batch;
+    Operation op;
+    uint64_t applied = 0;
+    RecordHeader header{};
+    PayloadView payload{};
+    off_t at = 0;
+    std::vector<Operation> batchOps;
+    std::vector<uint8_t> inflated;
+    auto applyRecord = [&](const RecordHeader& h, const PayloadView& p) {
+        const auto type = static_cast<RecordType>(h.type);
         try {
-            switch (static_cast<RecordType>(header.type)) {
-                case RecordType::Insert:
-                    pending[header.opID] = decodeInsert(header.opID, payload);
-                    break;
-                case RecordType::Delete:
-                    pending[header.opID] = decodeDelete(header.opID, payload);
-                    break;
-                case RecordType::Commit: {
-                    auto it = pending.find(header.opID);
-                    if (it != pending.end()) {
-                        committed.push_back(it->second);
-                        pending.erase(it);
+            if (type == RecordType::Batch) {
+                // Decoded whole before any of it is applied.
+                decodeBatch(h.opID, p, replaySchema(), inflated, batchOps);
+            } else if (type == RecordType::PackedInsert) {
+                decodePackedInsert(h.opID, p, replaySchema(), op);
+            } else if (type == RecordType::Insert) {
+                decodeInsert(h.opID, p, op);
+            } else {
+                decodeDelete(h.opID, p, op);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (type == RecordType::Batch) {
+            for (const auto& batchOp : batchOps) apply(batchOp);
+            applied += batchOps.size();
+            return true;
+        }
+        apply(op);
+        ++applied;
+        return true;
+    };
+    bool intact = true;
+    size_t last = 0;
+    for (; last < order.size(); ++last) {
+        const Segment& seg = segs_[order[last]];
+        readers.emplace_back(seg.fd, seg.version, headerBytes(seg.version), fileEnd(seg.fd),
+                             seg.version >= 5 ? seg.firstOpID : 0);
+        RecordReader& reader = readers.back();
+        while (intact && reader.next(header, payload, at)) {
+            if (header.opID >= nextOpID_) nextOpID_ = header.opID + 1;
+            const auto type = static_cast<RecordType>(header.type);
+            if (type == RecordType::Commit) {
+                // A commit covers [first, opID]; the payload carries `first` for
+                // a transaction batch and is empty for a single op.
+                uint64_t first = header.opID;
+                if (payload.size >= sizeof(first)) std::memcpy(&first, payload.data, sizeof(first));
+                batch.clear();
+                for (const auto& [id, loc] : pending)
+                    if (id >= first && id <= header.opID) batch.emplace_back(id, loc);
+                std::sort(batch.begin(), batch.end(),
+                          [](const auto& a, const auto& b) { return a.first < b.first; });
+                for (const auto& [id, loc] : batch) {
+                    pending.erase(id);
+                    RecordHeader opHeader{};
+                    PayloadView opPayload{};
+                    if (!readers[loc.segment].recordAt(loc.at, opHeader, opPayload) ||
+                        !applyRecord(opHeader, opPayload)) {
+                        intact = false;
+                        break;
                     }
-                    break;
                 }
-                default:
-                    return committed;
+            } else if (type != RecordType::Insert && type != RecordType::Delete &&
+                       type != RecordType::PackedInsert && type != RecordType::Batch) {
+                intact = false;
+            } else if (!(header.flags & kFlagAutoCommit)) {
+                pending[header.opID] = {last, at};
+            } else {
+                intact = applyRecord(header, payload);
             }
-        } catch (...) {
-            break;
         }
+        if (!intact || reader.stop() == RecordReader::Stop::Corrupt || last + 1 == order.size()) break;
+        reader.release();  // only pending ops are read from it again
+    }
+    if (order.empty()) return applied;
+    if (last == order.size()) --last;
 
-        pos = nextPos;
+    // The log ends where reading stopped: segments past it are retired, and a
+    // torn or corrupt tail is cut so new records are not appended behind it.
+    for (size_t i = last + 1; i < order.size(); ++i) {
+        Segment& seg = segs_[order[i]];
+        const uint32_t retired = 0;
+        if (::pwrite(seg.fd, &retired, sizeof(retired), 0) != ssize_t(sizeof(retired)))
+            throw std::runtime_error(std::string("retire WAL segment failed: ") + std::strerror(errno));
+        seg.version = 0;
+    }
+    sealedBytes_ = 0;
+    for (size_t i = 0; i < last; ++i) {
+        segs_[order[i]].bytes = uint64_t(readers[i].position());
+        sealedBytes_ += segs_[order[i]].bytes;
+    }
+    activate(order[last]);
+    const off_t good = readers[last].position();
+    appendOffset_ = good;
+    const bool torn = !intact || readers[last].stop() == RecordReader::Stop::Corrupt;
+    if (version_ < 5 ? good < fileEnd(fd_) : torn) {
+        if (::ftruncate(fd_, good) != 0)
+            throw std::runtime_error(std::string("truncate WAL tail failed: ") + std::strerror(errno));
+        if (version_ >= 5) preallocate(fd_, off_t(segmentBytes_));
     }
+    needsReplay_ = false;
+    return applied;
+}
 
+std::vector<Wal::Operation> Wal::committedOperations() {
+    std::vector<Operation> committed;
+    replay([&](const Operation& op) { committed.push_back(op); });
     return committed;
 }
 
-void Wal::sync() const {
-    if (fd_ >= 0) ::fsync(fd_);
+void Wal::sync() {
+    if (fd_ >= 0) writeBuffered();
+    uint64_t epoch;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        epoch = commitEpoch_;
+    }
+    syncThrough(epoch, /*dataOnly=*/false);
+}
+
+void Wal::syncThrough(uint64_t epoch, bool dataOnly) {
+    {
+        std::lock_guard<std::mutex> lock(fdMu_);
+        if (fd_ < 0) return;
+        syncFd(fd_, dataOnly);
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    ++syncCount_;
+    if (epoch > durableEpoch_) durableEpoch_ = epoch;
+    cv_.notify_all();
+}
+
+void Wal::setGroupCommit(bool enabled) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (enabled == groupCommit_) return;
+        groupCommit_ = enabled;
+        syncError_.clear();
+    }
+    updateSyncer();
+}
+
+bool Wal::groupCommit() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return groupCommit_;
+}
+
+void Wal::setSyncInterval(std::chrono::milliseconds interval) {
+    if (interval.count() < 0) throw std::invalid_argument("sync interval must not be negative");
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (interval == syncInterval_) return;
+        syncInterval_ = interval;
+        syncError_.clear();
+    }
+    updateSyncer();
+}
+
+std::chrono::milliseconds Wal::syncInterval() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return syncInterval_;
+}
+
+// Starts the sync thread when group commit or periodic sync needs it and
+// stops it once neither does; a thread that quit on a sync error is replaced.
+void Wal::updateSyncer() {
+    std::unique_lock<std::mutex> lock(mu_);
+    const bool needed = groupCommit_ || syncInterval_.count() > 0;
+    if (syncer_.joinable() && (syncerExited_ || !needed)) {
+        stopSyncer_ = true;
+        lock.unlock();
+        cv_.notify_all();
+        syncer_.join();
+        lock.lock();
+    }
+    if (needed && !syncer_.joinable()) {
+        stopSyncer_ = false;
+        syncerExited_ = false;
+        syncer_ = std::thread(&Wal::syncLoop, this);
+        return;
+    }
+    cv_.notify_all();  // pick up the new mode
+}
+
+void Wal::syncLoop() {
+    std::unique_lock<std::mutex> lock(mu_);
+    for (;;) {
+        const auto ready = [&] { return stopSyncer_ || (groupCommit_ && commitEpoch_ > durableEpoch_); };
+        if (!groupCommit_ && syncInterval_.count() > 0) cv_.wait_for(lock, syncInterval_, ready);
+        else cv_.wait(lock, ready);
+        // Drain what is pending even when asked to stop so no waiter is stranded.
+        if (!syncError_.empty() || (stopSyncer_ && commitEpoch_ <= durableEpoch_)) break;
+        if (commitEpoch_ <= durableEpoch_) continue;
+        // Everything appended so far rides on this sync; commits that land
+        // while it runs form the next batch.
+        const uint64_t epoch = commitEpoch_;
+        lock.unlock();
+        try {
+            syncThrough(epoch, /*dataOnly=*/true);
+        } catch (const std::exception& e) {
+            lock.lock();
+            syncError_ = e.what();
+            cv_.notify_all();
+            break;
+        }
+        lock.lock();
+    }
+    syncerExited_ = true;
+}
+
+void Wal::awaitDurable(uint64_t epoch) {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [&] { return !groupCommit_ || durableEpoch_ >= epoch || !syncError_.empty(); });
+    if (durableEpoch_ < epoch && !syncError_.empty()) throw std::runtime_error(syncError_);
+}
+
+uint64_t Wal::syncCount() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return syncCount_;
 }
 
 void Wal::truncate() {
     if (fd_ < 0) return;
-    if (::ftruncate(fd_, sizeof(WalHeader)) != 0)
-        throw std::runtime_error(std::string("truncate WAL failed: ") + std::strerror(errno));
-    nextOpID_ = 1;
+    buf_.clear();
+    // Every segment is now free. Slot 0 becomes the head, opIDs keep counting
+    // from its header, and the rest stay on disk to be recycled, up to
+    // kMaxSegmentFiles.
+    uint64_t seq = 0;
+    for (const auto& seg : segs_) seq = std::max(seq, seg.seq);
+    firstSeq_ = seq + 1;
+    initSegment(0, firstSeq_, nextOpID_);
+    activate(0);
+    {
+        std::lock_guard<std::mutex> lock(fdMu_);  // no sync is using the files closed here
+        while (segs_.size() > kMaxSegmentFiles) {
+            ::close(segs_.back().fd);
+            std::remove(segmentPath(segs_.size() - 1).c_str());
+            segs_.pop_back();
+        }
+    }
+    sealedBytes_ = 0;
+    needsReplay_ = false;
+}
+
+void Wal::rebase() {
+    ++generation_;
+    truncate();
+}
+
+uint64_t Wal::beginCheckpoint() {
+    if (fd_ < 0) return 0;
+    writeBuffered();
+    if (version_ < 5) return 0;
+    if (appendOffset_ > headerBytes(version_)) rotate(nextOpID_);
+    return segs_[active_].seq << kLsnOffsetBits;
+}
+
+void Wal::endCheckpoint(uint64_t lsn) {
+    if (fd_ < 0) return;
+    if (lsn == 0) {
+        truncate();
+        return;
+    }
+    const uint64_t seq = lsn >> kLsnOffsetBits;
+    if (seq <= firstSeq_) return;
+    // Nothing was appended meanwhile, so the whole log is covered.
+    if (segs_[active_].seq == seq && appendOffset_ == headerBytes(version_) && buf_.empty()) {
+        truncate();
+        return;
+    }
+    // Readers take firstSeq from the newest segment, which is the active one
+    // (rotation only moves forward). The field rides on the next sync; until
+    // then a crash replays the retired records too, which recovery skips as
+    // already applied.
+    firstSeq_ = seq;
+    writeFully(fd_, reinterpret_cast<const uint8_t*>(&firstSeq_), sizeof(firstSeq_),
+               off_t(offsetof(WalHeader, firstSeq)));
+    sealedBytes_ = 0;
+    for (size_t slot = 0; slot < segs_.size(); ++slot)
+        if (slot != active_ && segs_[slot].version && segs_[slot].seq >= firstSeq_)
+            sealedBytes_ += segs_[slot].bytes;
+    std::lock_guard<std::mutex> lock(fdMu_);
+    while (segs_.size() > kMaxSegmentFiles && segs_.size() - 1 != active_ &&
+           segs_.back().seq < firstSeq_) {
+        ::close(segs_.back().fd);
+        std::remove(segmentPath(segs_.size() - 1).c_str());
+        segs_.pop_back();
+    }
 }
 
 bool Wal::hasEntries() const {
     if (fd_ < 0) return false;
-    struct stat st{};
-    if (::fstat(fd_, &st) != 0) return false;
-    return st.st_size > off_t(sizeof(WalHeader));
+    return needsReplay_ || sealedBytes_ > 0 || appendOffset_ + off_t(buf_.size()) > headerBytes(version_);
+}
+
+WalTail::WalTail(const std::string& tablePath, std::vector<ColType> schema)
+    : path_(tablePath + ".wal"), schema_(std::move(schema)) {}
+
+void WalTail::rewind() {
+    TailSegments segs(path_);
+    const auto* live = segs.oldestLive();
+    if (!live) throw std::runtime_error("WAL has no segments to follow; checkpoint the table first");
+    seq_ = live->header.seq;
+    offset_ = off_t(sizeof(WalHeader));
+    nextOpID_ = live->header.nextOpID;
+    generation_ = live->header.generation;
+    pending_.clear();
+}
+
+bool WalTail::resume(uint16_t generation, uint64_t opID) {
+    rewind();
+    if (generation != generation_ || opID < nextOpID_) return false;
+    nextOpID_ = opID;
+    return true;
+}
+
+bool WalTail::poll(const std::function<void(const Wal::Operation&)>& apply) {
+    TailSegments segs(path_);
+    struct Record {
+        RecordHeader header;
+        std::vector<uint8_t> payload;
+    };
+    std::vector<Record> records;
+    Wal::Operation op;
+    std::vector<Wal::Operation> batchOps;
+    std::vector<uint8_t> inflated;
+    auto applyRecord = [&](const Record& record) {
+        const RecordHeader& header = record.header;
+        const PayloadView payload{record.payload.data(), record.payload.size()};
+        switch (static_cast<RecordType>(header.type)) {
+            case RecordType::Commit: {
+                uint64_t first = header.opID;
+                if (payload.size >= sizeof(first)) std::memcpy(&first, payload.data, sizeof(first));
+                // Writers take turns, so anything pending below this batch
+                // was never committed.
+                pending_.erase(pending_.begin(), pending_.lower_bound(first));
+                for (auto it = pending_.begin(); it != pending_.end() && it->first <= header.opID;
+                     it = pending_.erase(it))
+                    apply(it->second);
+                return;
+            }
+            case RecordType::Batch:
+                pending_.clear();
+                decodeBatch(header.opID, payload, schema_, inflated, batchOps);
+                for (const auto& batchOp : batchOps) apply(batchOp);
+                return;
+            case RecordType::PackedInsert:
+                decodePackedInsert(header.opID, payload, schema_, op);
+                break;
+            case RecordType::Insert:
+                decodeInsert(header.opID, payload, op);
+                break;
+            case RecordType::Delete:
+                decodeDelete(header.opID, payload, op);
+                break;
+            default:
+                throw std::runtime_error("unknown WAL record type");
+        }
+        if (!(header.flags & kFlagAutoCommit)) {
+            pending_[header.opID] = op;
+            return;
+        }
+        pending_.clear();
+        apply(op);
+    };
+
+    for (;;) {
+        const auto* seg = segs.find(seq_);
+        if (seg && seg->header.generation != generation_) return false;
+        if (seg) {
+            // Decided before reading: once a later segment exists, this one
+            // gets no more records, so reading it to the end finishes it.
+            const bool sealed = segs.newest()->header.seq > seq_;
+            RecordReader reader(seg->fd, seg->header.version, offset_, fileEnd(seg->fd), seg->header.nextOpID);
+            records.clear();
+            RecordHeader header{};
+            PayloadView payload{};
+            off_t at = 0;
+            while (reader.next(header, payload, at))
+                records.push_back({header, std::vector<uint8_t>(payload.data, payload.data + payload.size)});
+            // Recycled while it was read: the records may be from its next use.
+            WalHeader now{};
+            if (!readSegmentHeader(seg->fd, now) || now.seq != seq_) {
+                segs.load();
+                continue;
+            }
+            // Only the active segment may end in a record still being written.
+            if (sealed && reader.stop() == RecordReader::Stop::Corrupt) return false;
+            for (const auto& record : records) {
+                if (record.header.opID < nextOpID_) continue;  // applied before a rewind
+                nextOpID_ = record.header.opID + 1;
+                applyRecord(record);
+            }
+            offset_ = reader.position();
+            if (!sealed) return true;
+            if (const auto* next = segs.find(seq_ + 1)) {
+                if (next->header.generation != generation_) return false;
+                ++seq_;
+                offset_ = off_t(sizeof(WalHeader));
+                continue;
+            }
+        }
+        // The segment, or the one after it, was recycled. Go on from where the
+        // log now begins if nothing between was missed.
+        const auto* live = segs.oldestLive();
+        if (live && live->header.seq <= seq_) return true;  // a header mid-rewrite; try again
+        if (!live || live->header.generation != generation_ || live->header.nextOpID > nextOpID_)
+            return false;
+        seq_ = live->header.seq;
+        offset_ = off_t(sizeof(WalHeader));
+    }
 }
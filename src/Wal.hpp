@@ -1,7 +1,14 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <string>
+#include <sys/types.h>
+#include <thread>
 #include <vector>
 
 #include "ValueTypes.hpp"
@@ -20,26 +27,183 @@ public:
         std::vector<ColValue> values;
     };
 
-    explicit Wal(const std::string& tablePath);
+    // The log is a chain of fixed-size segment files: <table>.wal, then
+    // <table>.wal.1, .2, ... as needed. Segments are preallocated, so appends
+    // never change a file's size and fdatasync has no size metadata to flush;
+    // after a checkpoint they are recycled instead of deleted.
+    static constexpr uint64_t kDefaultSegmentBytes = 4u << 20;
+    static constexpr size_t kMaxSegmentFiles = 4;  // kept for recycling after a checkpoint
+    // An LSN is a segment's sequence number above kLsnOffsetBits, then the
+    // byte offset within it; it only grows, across segments and checkpoints.
+    static constexpr unsigned kLsnOffsetBits = 40;
+
+    explicit Wal(const std::string& tablePath, uint64_t segmentBytes = kDefaultSegmentBytes);
     ~Wal();
 
     void openOrCreate(bool create);
+    // Column types of the table, in order. With a schema, inserts are logged
+    // packed (varint/zig-zag values, no type tags) and commitBatch writes one
+    // column-wise record, zlib-compressed when that is smaller. Without one,
+    // replay reads the types from the table file when it meets such records.
+    void setSchema(std::vector<ColType> colTypes);
+    // Records are serialized into an in-memory log buffer; a commit writes
+    // everything buffered in one pwrite at the tracked append offset.
     uint64_t appendInsert(uint32_t rowID, const std::vector<ColValue>& values);
     uint64_t appendDelete(uint32_t rowID);
-    void appendCommit(uint64_t opID);
+    // Returns the commit's epoch; pass it to awaitDurable to block until the
+    // record has reached stable storage.
+    uint64_t appendCommit(uint64_t opID);
+    // Logs `ops` followed by one commit record covering all of them, so replay
+    // applies the batch whole or not at all. Returns the commit's epoch. If
+    // the write fails, the batch is dropped from the log buffer before the
+    // error propagates, so no later commit writes it.
+    uint64_t commitBatch(const std::vector<Operation>& ops);
+    // Single-record autocommit forms of appendInsert/appendDelete + appendCommit.
+    uint64_t commitInsert(uint32_t rowID, const std::vector<ColValue>& values);
+    uint64_t commitDelete(uint32_t rowID);
+
+    // Streams committed operations to `apply` in commit order in one pass with
+    // bounded memory, advances nextOpID past every record seen, and cuts off a
+    // torn tail. Required before appending to a log opened with records in it.
+    // Returns the number of operations applied.
+    uint64_t replay(const std::function<void(const Operation&)>& apply);
+    // replay() collected into a vector; for tests and small logs.
+    std::vector<Operation> committedOperations();
 
-    std::vector<Operation> committedOperations() const;
+    // Group commit: a background thread fdatasyncs the log whenever commits are
+    // pending, so every writer waiting in awaitDurable shares one sync.
+    void setGroupCommit(bool enabled);
+    bool groupCommit() const;
+    // Periodic sync: with group commit off, the same thread fdatasyncs pending
+    // commits every `interval` instead; zero turns it off.
+    void setSyncInterval(std::chrono::milliseconds interval);
+    std::chrono::milliseconds syncInterval() const;
+    // No-op unless group commit is on. Throws if the covering sync failed.
+    void awaitDurable(uint64_t epoch);
+    uint64_t syncCount() const;
 
-    void sync() const;
+    void sync();
     void truncate();
+    // truncate() for a table that was just changed outside the log (compaction,
+    // DDL, unlogged writes): the new head carries a bumped generation, which
+    // tells a WalTail that its copy of the table no longer matches.
+    void rebase();
+    // Fuzzy checkpoints. beginCheckpoint seals the active segment so records
+    // appended from here on start a new one, and returns the checkpoint LSN:
+    // where the log will begin once the checkpoint's data is durable. Then
+    // endCheckpoint(lsn) retires the segments before it, leaving any appended
+    // meanwhile live (with none, it truncates). A pre-segment (v1-v4) log cannot be split and returns 0,
+    // for which endCheckpoint truncates; only recovery checkpoints one.
+    uint64_t beginCheckpoint();
+    void endCheckpoint(uint64_t lsn);
     bool hasEntries() const;
+    // Bytes in the live segments, headers included (buffered records count).
+    uint64_t sizeBytes() const { return sealedBytes_ + uint64_t(appendOffset_) + buf_.size(); }
+    // LSN just past the last record written to the active segment.
+    uint64_t endLsn() const {
+        return segs_.empty() ? 0 : (segs_[active_].seq << kLsnOffsetBits) | uint64_t(appendOffset_);
+    }
+    // Segment files on disk, live or waiting to be recycled.
+    size_t segmentFiles() const { return segs_.size(); }
+    // Highest opID handed out so far; opIDs never repeat, so this orders the log.
+    uint64_t lastOpID() const { return nextOpID_ - 1; }
     std::string path() const { return path_; }
 
 private:
+    struct Segment {
+        int fd = -1;
+        uint16_t version = 0;    // 0 = free slot
+        uint64_t seq = 0;        // 0 for a pre-segment (v1-v4) log
+        uint64_t firstOpID = 0;  // records below this are left over from an earlier use
+        uint64_t bytes = 0;      // end of its records once sealed
+    };
+
     std::string path_;
-    int fd_ = -1;
-    uint64_t nextOpID_ = 1;
+    uint64_t segmentBytes_;
+    std::vector<Segment> segs_;  // by slot; slot 0 is path_
+    size_t active_ = 0;
+    uint64_t firstSeq_ = 1;      // oldest live segment; lower seqs are free
+    uint64_t sealedBytes_ = 0;   // bytes in live segments ahead of the active one
+    int fd_ = -1;                // active segment; swapped under fdMu_
+    uint16_t version_ = 0;
+    uint64_t nextOpID_ = 1;      // persisted in each segment header
+    uint16_t generation_ = 0;    // likewise; see rebase()
+    bool needsReplay_ = false;
+    off_t appendOffset_ = 0;     // end of the records already written to fd_
+    std::vector<uint8_t> buf_;   // records not yet written
+    std::mutex fdMu_;            // held across a sync so its segment stays open
+    std::vector<ColType> schema_;
+    std::vector<uint8_t> batchBody_;  // commitBatch scratch: encoded ops
+    std::vector<uint8_t> batchZip_;   // and their compressed form
+
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::thread syncer_;
+    bool groupCommit_ = false;
+    std::chrono::milliseconds syncInterval_{0};
+    bool stopSyncer_ = false;
+    bool syncerExited_ = false;
+    uint64_t commitEpoch_ = 0;   // commits appended
+    uint64_t durableEpoch_ = 0;  // commits known to be on disk
+    uint64_t syncCount_ = 0;
+    std::string syncError_;
 
-    void ensureHeader();
-    void appendRecord(uint8_t type, uint64_t opID, const std::vector<uint8_t>& payload);
+    std::string segmentPath(size_t slot) const;
+    void loadSegments();
+    void initSegment(size_t slot, uint64_t seq, uint64_t firstOpID);
+    void activate(size_t slot);
+    void rotate(uint64_t firstOpID);
+    void closeSegments();
+    bool packed() const;
+    const std::vector<ColType>& replaySchema();
+    void writeInsert(uint32_t rowID, const std::vector<ColValue>& values, uint8_t flags, uint64_t opID);
+    void appendBatch(const std::vector<Operation>& ops);
+    void discardFrom(uint64_t first);
+    size_t beginRecord(uint8_t type, uint8_t flags, uint64_t opID);
+    void endRecord(size_t at);
+    void writeBuffered();
+    uint64_t publishCommit();
+    void updateSyncer();
+    void syncLoop();
+    void syncThrough(uint64_t epoch, bool dataOnly);
+};
+
+// Follows the log of a table another process has open, without writing to it:
+// each poll() applies what was committed since the previous one, in order. It
+// reads only whole records, so one still being written is picked up by the
+// next poll, and it moves to the next segment once the writer has.
+class WalTail {
+public:
+    // `tablePath` is the followed table's file; `schema` its column types.
+    WalTail(const std::string& tablePath, std::vector<ColType> schema);
+
+    // Start over at the oldest live segment. Throws std::runtime_error if the
+    // log predates segments (v1-v4); a checkpoint on the writer upgrades it.
+    void rewind();
+    // rewind(), then skip the records below `opID`. False if some of them are
+    // no longer in the log, or it was rebased after `generation`.
+    bool resume(uint16_t generation, uint64_t opID);
+    // Applies newly committed operations; replayed ones are skipped, so this
+    // may run over records already in the follower's copy. False when that
+    // copy can no longer be brought up to date from the log: records not yet
+    // read were retired by a checkpoint, or the table was rebased. Take a new
+    // copy, then rewind().
+    bool poll(const std::function<void(const Wal::Operation&)>& apply);
+    // OpID of the next record to apply.
+    uint64_t nextOpID() const { return nextOpID_; }
+    // OpIDs below this were either applied or never committed; one held for
+    // its commit record stops it.
+    uint64_t settledOpID() const { return pending_.empty() ? nextOpID_ : pending_.begin()->first; }
+    // Of the log being read; it changes when the table is rebased.
+    uint16_t generation() const { return generation_; }
+    const std::vector<ColType>& schema() const { return schema_; }
+
+private:
+    std::string path_;  // of segment 0
+    std::vector<ColType> schema_;
+    uint64_t seq_ = 0;            // segment being read
+    off_t offset_ = 0;            // of the next record in it
+    uint64_t nextOpID_ = 1;
+    uint16_t generation_ = 0;     // of the log the copy was taken from
+    std::map<uint64_t, Wal::Operation> pending_;  // read, awaiting a commit record
 };
@@ -1,10 +1,13 @@
 #include "Engine.hpp"
 #include "MiniSQL.hpp"
 #include "QuerySession.hpp"
+#include "Replica.hpp"
 #include "Server.hpp"
 #include "Table.hpp"
 #include "ValueTypes.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstdint>
@@ -16,9 +19,12 @@
 #include <cctype>
 #include <unistd.h>
 
+// How often `mdb replica` applies the primary's new WAL records.
+static constexpr std::chrono::milliseconds kReplicaPollInterval{100};
+
 static void usage(const char* argv0) {
     std::fprintf(stderr,
-        "Usage:\n"
+        "Usage: %s [--sync off|normal|full] <command> ...\n"
         "  %s create <file> <pageSize> <numCols>\n"
         "  %s insert <file> <v0> [v1 ...]\n"
         "  %s select-eq <file> <col> <val>\n"
@@ -26,9 +32,21 @@ static void usage(const char* argv0) {
         "  %s query <sql>\n"
         "  %s repl\n"
         "  %s serve <port>\n"
+        "  %s replica <table> <copy> <port>\n"
         "  %s flush <table>\n"
+        "  %s compact <table>\n"
+        "  %s bench-insert <file> <rows>\n"
         "  %s sum <file> <col>\n",
-        argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0);
+        argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0);
+}
+
+static bool parseDurability(const char* s, Table::Durability& out) {
+    const std::string level = s;
+    if (level == "off") out = Table::Durability::Off;
+    else if (level == "normal") out = Table::Durability::Normal;
+    else if (level == "full") out = Table::Durability::Full;
+    else return false;
+    return true;
 }
 
 static bool parseU16(const char* s, uint16_t& out) {
@@ -83,8 +101,9 @@ static bool findStatementTerminator(const std::string& input, size_t& pos) {
     return false;
 }
 
-static int runRepl() {
+static int runRepl(Table::Durability durability) {
     Engine engine;
+    engine.setDurability(durability);
     std::string pending;
     std::string line;
     printReplHelp();
@@ -124,6 +143,17 @@ static int runRepl() {
 }
 
 int main(int argc, char** argv) {
+    // --sync sets the durability level for the tables this command writes.
+    Table::Durability durability = Table::Durability::Normal;
+    if (argc >= 3 && std::strcmp(argv[1], "--sync") == 0) {
+        if (!parseDurability(argv[2], durability)) {
+            std::fprintf(stderr, "Bad sync level: %s\n", argv[2]);
+            return 1;
+        }
+        argv[2] = argv[0];
+        argc -= 2;
+        argv += 2;
+    }
     if (argc < 2) { usage(argv[0]); return 1; }
     std::string cmd = argv[1];
 
@@ -135,12 +165,13 @@ int main(int argc, char** argv) {
             sql += argv[i];
         }
         Engine engine;
+        engine.setDurability(durability);
         return executeMiniSQLToStream(engine, sql, "query") ? 0 : 1;
     }
 
     if (cmd == "repl") {
         if (argc != 2) { usage(argv[0]); return 1; }
-        return runRepl();
+        return runRepl(durability);
     }
 
     if (cmd == "serve") {
@@ -150,7 +181,31 @@ int main(int argc, char** argv) {
             std::fprintf(stderr, "Bad port\n");
             return 1;
         }
-        return runServer(port);
+        return runServer(port, durability);
+    }
+
+    if (cmd == "replica") {
+        if (argc != 5) { usage(argv[0]); return 1; }
+        uint16_t port = 0;
+        if (!parseU16(argv[4], port) || port == 0) {
+            std::fprintf(stderr, "Bad port\n");
+            return 1;
+        }
+        const std::string baseName = toBaseTableName(argv[2]);
+        const std::string path = baseName + ".mdb";
+        if (::access(path.c_str(), F_OK) != 0) {
+            std::fprintf(stderr, "replica error: table file does not exist\n");
+            return 1;
+        }
+        try {
+            // Queries name the primary's table; they read the copy.
+            Replica replica(path, toBaseTableName(argv[3]) + ".mdb");
+            replica.follow(kReplicaPollInterval);
+            return runReplicaServer(port, replica, baseName);
+        } catch (const std::exception& ex) {
+            std::fprintf(stderr, "replica error: %s\n", ex.what());
+            return 1;
+        }
     }
 
     if (cmd == "flush") {
@@ -172,6 +227,29 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (cmd == "compact") {
+        if (argc != 3) { usage(argv[0]); return 1; }
+        const std::string baseName = toBaseTableName(argv[2]);
+        const std::string path = baseName + ".mdb";
+        if (::access(path.c_str(), F_OK) != 0) {
+            std::fprintf(stderr, "compact error: table file does not exist\n");
+            return 1;
+        }
+        try {
+            Engine engine;
+            const auto remap = engine.compact(baseName);
+            size_t dropped = 0;
+            for (uint32_t newID : remap)
+                if (newID == RowIndex::kDroppedRow) ++dropped;
+            std::printf("compacted %s (live=%zu, dropped=%zu)\n",
+                        baseName.c_str(), remap.size() - dropped, dropped);
+            return 0;
+        } catch (const std::exception& ex) {
+            std::fprintf(stderr, "compact error: %s\n", ex.what());
+            return 1;
+        }
+    }
+
     if (cmd == "create") {
         if (argc != 5) { usage(argv[0]); return 1; }
         const char* path = argv[2];
@@ -189,6 +267,7 @@ int main(int argc, char** argv) {
         if (argc < 4) { usage(argv[0]); return 1; }
         const char* path = argv[2];
         Table t(path); // open existing
+        t.setDurability(durability);
         std::vector<ValueType> row;
         row.reserve(argc - 3);
         for (int i = 3; i < argc; ++i) {
@@ -209,6 +288,27 @@ int main(int argc, char** argv) {
         return 0;
     }
 
+    if (cmd == "bench-insert") {
+        // Single-writer insert throughput at the chosen --sync level.
+        if (argc != 4) { usage(argv[0]); return 1; }
+        const char* path = argv[2];
+        uint32_t rows = 0;
+        if (!parseU32(argv[3], rows) || rows == 0) {
+            std::fprintf(stderr, "Bad row count\n"); return 1;
+        }
+        Table t(path);
+        t.setDurability(durability);
+        std::vector<ValueType> row(t.numColumns());
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rows; ++i) {
+            std::fill(row.begin(), row.end(), static_cast<ValueType>(i));
+            t.insertRow(row);
+        }
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("inserted %u rows in %.3f s (%.0f rows/s)\n", rows, secs, rows / secs);
+        return 0;
+    }
+
     if (cmd == "select-eq") {
         if (argc != 5) { usage(argv[0]); return 1; }
         const char* path = argv[2];
@@ -27,6 +27,9 @@ typedef struct MdbEngine MdbEngine;
 #define MDB_ERR_IO   -3
 #define MDB_ERR_OOM  -4
 #define MDB_ERR_TYPE -5
+#define MDB_NOT_FOUND -6   /* mdb_get_by_key: no live row has the key;
+                              mdb_cdc_next: no new changes yet */
+#define MDB_ERR_LOST  -7   /* mdb_cdc_*: changes after the position left the WAL */
 
 /* ── Column types ─────────────────────────────────────────────────────────── */
 /*
@@ -57,7 +60,9 @@ typedef struct {
 typedef enum {
     MDB_PRED_EQ        = 0,   /* lo holds the equality value */
     MDB_PRED_BETWEEN   = 1,   /* lo..hi inclusive range */
-    MDB_PRED_EQ_STRING = 2    /* needle field used */
+    MDB_PRED_EQ_STRING = 2,   /* needle field used */
+    MDB_PRED_PREFIX_STRING  = 3,  /* rows whose string starts with needle */
+    MDB_PRED_BETWEEN_STRING = 4   /* needle..needle_hi inclusive, byte order */
 } MdbPredKind;
 
 typedef struct {
@@ -65,7 +70,8 @@ typedef struct {
     MdbPredKind kind;
     uint32_t    lo;           /* EQ: equality value; BETWEEN: range start */
     uint32_t    hi;           /* BETWEEN: range end (ignored for EQ) */
-    const char* needle;       /* EQ_STRING only; NULL for numeric predicates */
+    const char* needle;       /* string predicates; NULL for numeric predicates */
+    const char* needle_hi;    /* BETWEEN_STRING upper bound; NULL otherwise */
 } MdbPredicate;
 
 /* ── Result handles ───────────────────────────────────────────────────────── */
@@ -100,6 +106,43 @@ int mdb_insert(MdbEngine* e, const char* table,
 int mdb_delete(MdbEngine* e, const char* table, uint32_t row_id);
 int mdb_flush(MdbEngine* e, const char* table);
 
+/*
+ * Durability level for writes (see Table::Durability):
+ *   MDB_SYNC_OFF     no WAL; a crash loses writes since the last flush
+ *   MDB_SYNC_NORMAL  WAL written per commit, fdatasynced in the background
+ *                    every 200 ms (the default)
+ *   MDB_SYNC_FULL    every commit waits for its (group-committed) fdatasync
+ * With table == NULL the level applies to every table the engine has open and
+ * to tables it opens later.
+ */
+typedef enum {
+    MDB_SYNC_OFF    = 0,
+    MDB_SYNC_NORMAL = 1,
+    MDB_SYNC_FULL   = 2
+} MdbDurability;
+
+int mdb_set_durability(MdbEngine* e, const char* table, MdbDurability level);
+
+/*
+ * Transactions: between mdb_begin and mdb_commit the table's inserts, deletes
+ * and upserts are buffered and then logged with a single WAL commit, so a
+ * crash keeps all of them or none.  Call all three from the same thread;
+ * other writers to the table wait until the transaction ends.  Reads do not
+ * see uncommitted rows.  mdb_rollback discards the buffered writes.
+ */
+int mdb_begin(MdbEngine* e, const char* table);
+int mdb_commit(MdbEngine* e, const char* table);
+int mdb_rollback(MdbEngine* e, const char* table);
+
+/*
+ * Drops deleted rows from the row index and renumbers the live ones densely.
+ * If out_map is non-NULL it receives a row set indexed by old row ID:
+ * row_ids[old] is the new row ID, or MDB_ROW_DROPPED for deleted rows.
+ * Free it with mdb_free_rows.
+ */
+#define MDB_ROW_DROPPED 0xFFFFFFFFu
+int mdb_compact(MdbEngine* e, const char* table, MdbRowSet** out_map);
+
 /*
  * Fills out_values[0..num_cols-1].  For STRING columns out_values[i].str
  * points into the engine scratch buffer; see MdbValue docs above.
@@ -107,6 +150,71 @@ int mdb_flush(MdbEngine* e, const char* table);
 int mdb_fetch_row(MdbEngine* e, const char* table, uint32_t row_id,
                   MdbValue* out_values, uint32_t num_cols);
 
+/* ── Primary key ──────────────────────────────────────────────────────────── */
+/*
+ * Declares col as the table's primary key; persisted with the table.  Fails
+ * with MDB_ERR_ARG if another key is declared or existing rows repeat a value.
+ * Afterwards mdb_insert rejects a duplicate key with MDB_ERR_ARG.
+ */
+int mdb_set_primary_key(MdbEngine* e, const char* table, uint16_t col);
+
+/*
+ * Index point read.  Returns MDB_NOT_FOUND if no live row has the key;
+ * otherwise fills out_values like mdb_fetch_row (skipped when num_cols is 0)
+ * and the row ID (out_row_id may be NULL).
+ */
+int mdb_get_by_key(MdbEngine* e, const char* table, const MdbValue* key,
+                   MdbValue* out_values, uint32_t num_cols, uint32_t* out_row_id);
+
+/* Inserts the row, first deleting any live row with the same key. */
+int mdb_upsert(MdbEngine* e, const char* table,
+               const MdbValue* values, uint32_t num_cols, uint32_t* out_row_id);
+
+/* ── Change data capture ──────────────────────────────────────────────────── */
+/*
+ * A cursor over the committed inserts and deletes of a table, read from its
+ * WAL in commit order (see ChangeStream).  Each change carries an lsn; a cursor
+ * opened with after_lsn set to one resumes right after that change.
+ * MDB_CDC_START starts at the oldest change still in the WAL and MDB_CDC_END
+ * at the next one committed.  The WAL only holds changes since the last
+ * checkpoint, and compaction or DDL on the table starts it over: a position
+ * that is no longer covered fails with MDB_ERR_LOST, after which the consumer
+ * rereads the table and opens a new cursor.  Writes made with MDB_SYNC_OFF
+ * are not logged, so they never appear.
+ *
+ * The cursor reports errors through the engine it was opened on, which must
+ * outlive it.
+ */
+typedef struct MdbCdcCursor MdbCdcCursor;
+
+#define MDB_CDC_START 0u
+#define MDB_CDC_END   UINT64_MAX
+
+typedef enum {
+    MDB_CDC_INSERT = 1,
+    MDB_CDC_DELETE = 2
+} MdbCdcOp;
+
+/*
+ * values has num_values entries for an insert and is NULL for a delete.
+ * It and its strings stay valid until the next mdb_cdc_next on the cursor.
+ */
+typedef struct {
+    uint64_t        lsn;
+    MdbCdcOp        op;
+    uint32_t        row_id;
+    const MdbValue* values;
+    uint32_t        num_values;
+} MdbCdcEvent;
+
+int mdb_cdc_open(MdbEngine* e, const char* table, uint64_t after_lsn,
+                 MdbCdcCursor** out_cursor);
+/* MDB_OK with the next change, MDB_NOT_FOUND when there is none yet. */
+int mdb_cdc_next(MdbCdcCursor* c, MdbCdcEvent* out_event);
+/* Where to resume: the last change returned, or later once caught up. */
+uint64_t mdb_cdc_position(const MdbCdcCursor* c);
+void mdb_cdc_close(MdbCdcCursor* c);  /* NULL is ignored */
+
 /* ── Scans ────────────────────────────────────────────────────────────────── */
 MdbRowSet* mdb_scan_eq       (MdbEngine* e, const char* table,
                                uint16_t col, uint32_t val);
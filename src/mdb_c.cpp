@@ -16,6 +16,7 @@
 #include <unistd.h>
 #include <vector>
 
+#include "ChangeStream.hpp"
 #include "Engine.hpp"
 #include "Predicate.hpp"
 #include "ValueTypes.hpp"
@@ -27,12 +28,25 @@ static_assert((int)MDB_FLOAT  == (int)ColType::FLOAT,  "MdbColType/ColType misma
 static_assert((int)MDB_DOUBLE == (int)ColType::DOUBLE, "MdbColType/ColType mismatch");
 static_assert((int)MDB_STRING == (int)ColType::STRING, "MdbColType/ColType mismatch");
 
+static_assert(MDB_ROW_DROPPED == RowIndex::kDroppedRow, "MDB_ROW_DROPPED/kDroppedRow mismatch");
+
 static_assert((int)MDB_PRED_EQ        == (int)Predicate::Kind::EQ,
               "MdbPredKind/Predicate::Kind mismatch");
 static_assert((int)MDB_PRED_BETWEEN   == (int)Predicate::Kind::BETWEEN,
               "MdbPredKind/Predicate::Kind mismatch");
 static_assert((int)MDB_PRED_EQ_STRING == (int)Predicate::Kind::EQ_STRING,
               "MdbPredKind/Predicate::Kind mismatch");
+static_assert((int)MDB_PRED_PREFIX_STRING  == (int)Predicate::Kind::PREFIX_STRING,
+              "MdbPredKind/Predicate::Kind mismatch");
+static_assert((int)MDB_PRED_BETWEEN_STRING == (int)Predicate::Kind::BETWEEN_STRING,
+              "MdbPredKind/Predicate::Kind mismatch");
+static_assert((int)MDB_CDC_INSERT == (int)Wal::Operation::Kind::Insert, "MdbCdcOp/Operation::Kind mismatch");
+static_assert((int)MDB_CDC_DELETE == (int)Wal::Operation::Kind::Delete, "MdbCdcOp/Operation::Kind mismatch");
+static_assert(MDB_CDC_START == ChangeStream::kFromStart && MDB_CDC_END == ChangeStream::kFromEnd,
+              "MDB_CDC_START/END mismatch");
+static_assert((int)MDB_SYNC_OFF    == (int)Table::Durability::Off,    "MdbDurability/Durability mismatch");
+static_assert((int)MDB_SYNC_NORMAL == (int)Table::Durability::Normal, "MdbDurability/Durability mismatch");
+static_assert((int)MDB_SYNC_FULL   == (int)Table::Durability::Full,   "MdbDurability/Durability mismatch");
 
 // ── Engine wrapper ─────────────────────────────────────────────────────────────
 struct MdbEngine {
@@ -100,6 +114,7 @@ static std::vector<Predicate> toPredicates(const MdbPredicate* preds, uint32_t n
         p.lo     = preds[i].lo;
         p.hi     = preds[i].hi;
         if (preds[i].needle) p.needle = preds[i].needle;
+        if (preds[i].needle_hi) p.needleHi = preds[i].needle_hi;
         out.push_back(std::move(p));
     }
     return out;
@@ -196,6 +211,112 @@ int mdb_flush(MdbEngine* e, const char* table) {
       catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
 }
 
+int mdb_set_durability(MdbEngine* e, const char* table, MdbDurability level) {
+    if (!e) return MDB_ERR_ARG;
+    if (level != MDB_SYNC_OFF && level != MDB_SYNC_NORMAL && level != MDB_SYNC_FULL) {
+        e->lastError = "unknown durability level";
+        return MDB_ERR_ARG;
+    }
+    try {
+        const auto durability = static_cast<Table::Durability>(level);
+        if (table)
+            requireExistingTable(e, table).setDurability(durability);
+        else
+            e->engine.setDurability(durability);
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+int mdb_begin(MdbEngine* e, const char* table) {
+    if (!e || !table) return MDB_ERR_ARG;
+    try {
+        requireExistingTable(e, table).begin();
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+int mdb_commit(MdbEngine* e, const char* table) {
+    if (!e || !table) return MDB_ERR_ARG;
+    try {
+        requireExistingTable(e, table).commit();
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+int mdb_rollback(MdbEngine* e, const char* table) {
+    if (!e || !table) return MDB_ERR_ARG;
+    try {
+        requireExistingTable(e, table).rollback();
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+int mdb_compact(MdbEngine* e, const char* table, MdbRowSet** out_map) {
+    if (!e || !table) return MDB_ERR_ARG;
+    if (out_map) *out_map = nullptr;
+    try {
+        auto remap = requireExistingTable(e, table).compact();
+        if (out_map) {
+            *out_map = makeRowSet(std::move(remap));
+            if (!*out_map) { e->lastError = "out of memory"; return MDB_ERR_OOM; }
+        }
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+// Fills out[0..numCols-1] from a live row; STRING values point into e->strScratch.
+// Returns MDB_ERR if the row (or one of its slots) is gone.
+static int fillRowValues(MdbEngine* e, Table& t, uint32_t rowID, MdbValue* out, uint32_t numCols) {
+    auto row = t.fetchTypedRow(rowID);
+    if (row.size() < numCols) return MDB_ERR;
+
+    // First pass: pack all STRING data into the scratch buffer and record
+    // each string's start offset so pointers remain stable after resize.
+    e->strScratch.clear();
+    std::vector<size_t> strOffset(numCols, static_cast<size_t>(-1));
+    for (uint32_t i = 0; i < numCols; i++) {
+        if (row[i] && row[i]->type == ColType::STRING) {
+            strOffset[i] = e->strScratch.size();
+            e->strScratch += row[i]->str;
+            e->strScratch += '\0';
+        }
+    }
+
+    // Second pass: fill caller's MdbValue array.
+    const char* base = e->strScratch.c_str();
+    for (uint32_t i = 0; i < numCols; i++) {
+        if (!row[i]) return MDB_ERR;  // slot was deleted
+        const ColValue& cv = *row[i];
+        MdbValue& mv = out[i];
+        mv.type = static_cast<MdbColType>(static_cast<int>(cv.type));
+        mv.i64  = 0;        // zero the widest union member first
+        mv.str  = nullptr;
+        switch (cv.type) {
+            case ColType::UINT32:  mv.u32 = cv.u32; break;
+            case ColType::INT64:   mv.i64 = cv.i64; break;
+            case ColType::FLOAT:   mv.f32 = cv.f32; break;
+            case ColType::DOUBLE:  mv.f64 = cv.f64; break;
+            case ColType::STRING:  mv.str = base + strOffset[i]; break;
+        }
+    }
+    return MDB_OK;
+}
+
 int mdb_fetch_row(MdbEngine* e, const char* table, uint32_t row_id,
                   MdbValue* out_values, uint32_t num_cols) {
     if (!e || !table || !out_values || num_cols == 0) return MDB_ERR_ARG;
@@ -203,43 +324,132 @@ int mdb_fetch_row(MdbEngine* e, const char* table, uint32_t row_id,
         Table& t = requireExistingTable(e, table);
         if (num_cols > t.numColumns())
             throw std::invalid_argument("requested column count exceeds table schema");
-        auto row = t.fetchTypedRow(row_id);
-        if (row.size() < num_cols) return MDB_ERR;
-
-        // First pass: pack all STRING data into the scratch buffer and record
-        // each string's start offset so pointers remain stable after resize.
-        e->strScratch.clear();
-        std::vector<size_t> strOffset(num_cols, static_cast<size_t>(-1));
-        for (uint32_t i = 0; i < num_cols; i++) {
-            if (row[i] && row[i]->type == ColType::STRING) {
-                strOffset[i] = e->strScratch.size();
-                e->strScratch += row[i]->str;
-                e->strScratch += '\0';
-            }
+        const int rc = fillRowValues(e, t, row_id, out_values, num_cols);
+        if (rc != MDB_OK) return rc;
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+// ── Primary key ───────────────────────────────────────────────────────────────
+
+int mdb_set_primary_key(MdbEngine* e, const char* table, uint16_t col) {
+    if (!e || !table) return MDB_ERR_ARG;
+    try {
+        Table& t = requireExistingTable(e, table);
+        requireValidColumnIndex(t, col);
+        t.setPrimaryKey(col);
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+int mdb_get_by_key(MdbEngine* e, const char* table, const MdbValue* key,
+                   MdbValue* out_values, uint32_t num_cols, uint32_t* out_row_id) {
+    if (!e || !table || !key || (num_cols && !out_values)) return MDB_ERR_ARG;
+    try {
+        Table& t = requireExistingTable(e, table);
+        if (num_cols > t.numColumns())
+            throw std::invalid_argument("requested column count exceeds table schema");
+        const auto rowID = t.findByKey(toColValues(key, 1).front());
+        if (!rowID) { e->lastError = "key not found"; return MDB_NOT_FOUND; }
+        if (num_cols) {
+            const int rc = fillRowValues(e, t, *rowID, out_values, num_cols);
+            if (rc != MDB_OK) return rc;
         }
+        if (out_row_id) *out_row_id = *rowID;
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
 
-        // Second pass: fill caller's MdbValue array.
-        const char* base = e->strScratch.c_str();
-        for (uint32_t i = 0; i < num_cols; i++) {
-            if (!row[i]) return MDB_ERR;  // slot was deleted
-            const ColValue& cv = *row[i];
-            MdbValue& mv = out_values[i];
+int mdb_upsert(MdbEngine* e, const char* table,
+               const MdbValue* values, uint32_t num_cols, uint32_t* out_row_id) {
+    if (!e || !table || !values) return MDB_ERR_ARG;
+    try {
+        Table& t = requireExistingTable(e, table);
+        requireMatchingRowWidth(t, num_cols);
+        const uint32_t rid = t.upsertTypedRow(toColValues(values, num_cols));
+        if (out_row_id) *out_row_id = rid;
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+// ── Change data capture ──────────────────────────────────────────────────────
+
+struct MdbCdcCursor {
+    MdbEngine*           engine;
+    ChangeStream         stream;
+    Wal::Operation       change;  // backing store for the last event
+    std::vector<MdbValue> values;
+};
+
+int mdb_cdc_open(MdbEngine* e, const char* table, uint64_t after_lsn,
+                 MdbCdcCursor** out_cursor) {
+    if (!e || !table || !out_cursor) return MDB_ERR_ARG;
+    *out_cursor = nullptr;
+    try {
+        const std::string path = tableFilePath(table);
+        if (access(path.c_str(), F_OK) != 0)
+            throw std::invalid_argument("table does not exist");
+        *out_cursor = new MdbCdcCursor{e, ChangeStream(path, after_lsn), {}, {}};
+        clearLastError(e);
+        return MDB_OK;
+    } catch (const ChangeStream::Lost&     ex) { e->lastError = ex.what(); return MDB_ERR_LOST; }
+      catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
+      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+int mdb_cdc_next(MdbCdcCursor* c, MdbCdcEvent* out_event) {
+    if (!c || !out_event) return MDB_ERR_ARG;
+    MdbEngine* e = c->engine;
+    try {
+        if (!c->stream.next(c->change)) {
+            clearLastError(e);
+            return MDB_NOT_FOUND;
+        }
+        const Wal::Operation& change = c->change;
+        c->values.assign(change.values.size(), MdbValue{});
+        for (size_t i = 0; i < change.values.size(); i++) {
+            const ColValue& cv = change.values[i];
+            MdbValue& mv = c->values[i];
             mv.type = static_cast<MdbColType>(static_cast<int>(cv.type));
-            mv.i64  = 0;        // zero the widest union member first
-            mv.str  = nullptr;
             switch (cv.type) {
                 case ColType::UINT32:  mv.u32 = cv.u32; break;
                 case ColType::INT64:   mv.i64 = cv.i64; break;
                 case ColType::FLOAT:   mv.f32 = cv.f32; break;
                 case ColType::DOUBLE:  mv.f64 = cv.f64; break;
-                case ColType::STRING:  mv.str = base + strOffset[i]; break;
+                case ColType::STRING:  mv.str = cv.str.c_str(); break;
             }
         }
+        out_event->lsn        = c->stream.position();
+        out_event->op         = static_cast<MdbCdcOp>(static_cast<int>(change.kind));
+        out_event->row_id     = change.rowID;
+        out_event->values     = c->values.empty() ? nullptr : c->values.data();
+        out_event->num_values = static_cast<uint32_t>(c->values.size());
         clearLastError(e);
         return MDB_OK;
-    } catch (const std::invalid_argument& ex) { e->lastError = ex.what(); return MDB_ERR_ARG; }
-      catch (const std::exception&         ex) { e->lastError = ex.what(); return MDB_ERR; }
-      catch (...)                              { e->lastError = "unknown"; return MDB_ERR; }
+    } catch (const ChangeStream::Lost& ex) { e->lastError = ex.what(); return MDB_ERR_LOST; }
+      catch (const std::exception&     ex) { e->lastError = ex.what(); return MDB_ERR; }
+      catch (...)                          { e->lastError = "unknown"; return MDB_ERR; }
+}
+
+uint64_t mdb_cdc_position(const MdbCdcCursor* c) {
+    return c ? c->stream.position() : MDB_CDC_START;
+}
+
+void mdb_cdc_close(MdbCdcCursor* c) {
+    delete c;
 }
 
 // ── Scans ──────────────────────────────────────────────────────────────────────
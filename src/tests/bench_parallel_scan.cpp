@@ -0,0 +1,94 @@
+// tests/bench_parallel_scan.cpp — morsel-parallel scan throughput by thread count.
+// usage: bench_parallel_scan [rows]   (default 2,000,000)
+#include "../Engine.hpp"
+#include "../Wal.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+const std::string kBase = "/tmp/par_bench";
+
+void cleanup() {
+    for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal", ".mdb.1.str"})
+        std::remove((kBase + suffix).c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((kBase + ".mdb.wal." + std::to_string(slot)).c_str());
+}
+
+// Best of `reps` runs, in milliseconds.
+double bestMs(int reps, const std::function<void()>& fn) {
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        const auto t0 = Clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+    return best;
+}
+
+struct Scan {
+    const char* name;
+    std::function<size_t(Table&)> run;  // returns a result size, checked across thread counts
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const uint32_t rows = argc > 1 ? uint32_t(std::strtoul(argv[1], nullptr, 10)) : 2'000'000;
+    std::vector<size_t> threadCounts;
+    for (size_t n = 1; n < std::thread::hardware_concurrency(); n *= 2) threadCounts.push_back(n);
+    threadCounts.push_back(std::max(1u, std::thread::hardware_concurrency()));
+
+    cleanup();
+    {
+        Engine e;
+        auto& t = e.createTypedTable(kBase, {ColType::UINT32, ColType::STRING, ColType::DOUBLE});
+        t.setDurability(Table::Durability::Off);
+        for (uint32_t i = 0; i < rows; ++i)
+            t.insertTypedRow({ColValue(i % 1000), ColValue("s" + std::to_string(i % 29)), ColValue(i * 0.5)});
+    }
+
+    const std::vector<Scan> scans = {
+        {"scanEquals", [](Table& t) { return t.scanEquals(0, 123).size(); }},
+        {"whereBetween", [](Table& t) { return t.whereBetween(0, 100, 350).size(); }},
+        {"scanEqualsString", [](Table& t) { return t.scanEqualsString(1, "s7").size(); }},
+        {"sumColumn(double)", [](Table& t) { return size_t(t.sumColumn(2)); }},
+        {"materializeColumn", [](Table& t) { return t.materializeColumn(0).size(); }},
+    };
+
+    std::printf("%u rows, %u hardware threads; best of 5, ms\n", rows, std::thread::hardware_concurrency());
+    std::printf("%-20s", "threads");
+    for (size_t n : threadCounts) std::printf("%10zu", n);
+    std::printf("\n");
+
+    std::vector<size_t> expected(scans.size());
+    for (size_t s = 0; s < scans.size(); ++s) {
+        std::printf("%-20s", scans[s].name);
+        for (size_t n : threadCounts) {
+            // A fresh engine per thread count: the first run faults the pages in.
+            Engine e;
+            e.setParallelism(n);
+            auto& t = e.openTable(kBase);
+            t.setUseGPU(false);
+            size_t got = 0;
+            const double ms = bestMs(5, [&] { got = scans[s].run(t); });
+            if (n == threadCounts.front()) expected[s] = got;
+            assert(got == expected[s]);
+            std::printf("%10.2f", ms);
+        }
+        std::printf("\n");
+    }
+    cleanup();
+    return 0;
+}
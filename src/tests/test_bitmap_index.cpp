@@ -0,0 +1,214 @@
+#include "../BitmapIndex.hpp"
+#include "../Engine.hpp"
+#include "../MiniSQL.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".bmp").c_str());
+    }
+}
+
+std::vector<uint32_t> toVector(const std::set<uint32_t>& s) { return {s.begin(), s.end()}; }
+
+void testRoaring() {
+    std::mt19937 rng(3);
+    std::set<uint32_t> refA, refB;
+    RoaringBitmap a, b;
+    // A: dense run in chunk 0 (bitset container) plus sparse values elsewhere.
+    for (uint32_t x = 0; x < 10000; ++x) { a.add(x); refA.insert(x); }
+    for (int i = 0; i < 3000; ++i) {
+        const uint32_t x = rng() % 2000000;
+        a.add(x); refA.insert(x);
+    }
+    // B: every third value of the dense run, and a second dense chunk.
+    for (uint32_t x = 0; x < 10000; x += 3) { b.add(x); refB.insert(x); }
+    for (uint32_t x = 5u << 16; x < (5u << 16) + 6000; ++x) { b.add(x); refB.insert(x); }
+
+    assert(a.cardinality() == refA.size() && a.toVector() == toVector(refA));
+    assert(b.cardinality() == refB.size() && b.toVector() == toVector(refB));
+    assert(a.contains(9999) && !b.contains(1));
+
+    std::set<uint32_t> refAnd, refOr;
+    std::set_intersection(refA.begin(), refA.end(), refB.begin(), refB.end(),
+                          std::inserter(refAnd, refAnd.end()));
+    std::set_union(refA.begin(), refA.end(), refB.begin(), refB.end(),
+                   std::inserter(refOr, refOr.end()));
+    RoaringBitmap andAB = a;
+    andAB &= b;
+    assert(andAB.toVector() == toVector(refAnd));
+    RoaringBitmap orAB = a;
+    orAB |= b;
+    assert(orAB.toVector() == toVector(refOr));
+
+    // Removing shrinks bitset containers back to arrays and drops empty ones.
+    for (uint32_t x = 0; x < 10000; ++x) { a.remove(x); refA.erase(x); }
+    assert(a.toVector() == toVector(refA));
+    assert(!a.remove(5));
+
+    auto sortedVals = toVector(refB);
+    assert(RoaringBitmap::fromSorted(sortedVals).toVector() == sortedVals);
+
+    std::string bytes;
+    orAB.serialize(bytes);
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(bytes.data());
+    const RoaringBitmap back = RoaringBitmap::deserialize(p, p + bytes.size());
+    assert(back.toVector() == toVector(refOr));
+
+    bool threw = false;
+    const uint8_t* q = reinterpret_cast<const uint8_t*>(bytes.data());
+    try { RoaringBitmap::deserialize(q, q + bytes.size() / 2); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw);
+}
+
+Predicate eq(uint16_t col, uint32_t v) {
+    Predicate p;
+    p.kind = Predicate::Kind::EQ;
+    p.colIdx = col;
+    p.lo = v;
+    return p;
+}
+
+Predicate eqString(uint16_t col, const std::string& s) {
+    Predicate p;
+    p.kind = Predicate::Kind::EQ_STRING;
+    p.colIdx = col;
+    p.needle = s;
+    return p;
+}
+
+Predicate between(uint16_t col, uint32_t lo, uint32_t hi) {
+    Predicate p;
+    p.kind = Predicate::Kind::BETWEEN;
+    p.colIdx = col;
+    p.lo = lo;
+    p.hi = hi;
+    return p;
+}
+
+void testTableBitmaps() {
+    const std::string base = "/tmp/bitmap_table";
+    cleanup(base, 3);
+    const std::vector<ColType> types = {ColType::UINT32, ColType::STRING, ColType::UINT32};
+    const char* regions[] = {"north", "south", "east", "west"};
+    std::vector<uint32_t> expectedAnd, expectedOr, expectedMixed;
+    {
+        Table t(base + ".mdb", 4096, types);
+        t.setUseGPU(false);
+        for (uint32_t i = 0; i < 5000; ++i)
+            t.insertTypedRow({ColValue(i % 7), ColValue(std::string(regions[i % 4])), ColValue(i)});
+
+        // Reference answers from plain scans.
+        expectedAnd = t.whereAnd({eq(0, 3), eqString(1, "east")});
+        expectedOr = t.whereOr({eq(0, 3), eqString(1, "east")});
+        expectedMixed = t.whereAnd({between(0, 1, 2), between(2, 100, 900)});
+
+        t.createBitmapIndex(0);
+        t.createBitmapIndex(1);
+        assert(t.hasBitmapIndex(0) && t.hasBitmapIndex(1));
+        assert(::access((base + ".mdb.1.bmp").c_str(), F_OK) == 0);
+
+        bool threw = false;
+        try { t.createBitmapIndex(2); } catch (const std::invalid_argument&) { threw = true; }
+        assert(threw);  // 5000 distinct values
+        assert(!t.hasBitmapIndex(2));
+
+        assert(t.whereAnd({eq(0, 3), eqString(1, "east")}) == expectedAnd);
+        assert(t.whereOr({eq(0, 3), eqString(1, "east")}) == expectedOr);
+        assert(t.whereAnd({between(0, 1, 2), between(2, 100, 900)}) == expectedMixed);
+        assert(t.whereAnd({eq(0, 9), between(2, 0, 4999)}).empty());
+
+        // Maintenance.
+        t.deleteRow(expectedAnd.front());
+        expectedAnd.erase(expectedAnd.begin());
+        const uint32_t rid = t.insertTypedRow({ColValue(uint32_t(3)), ColValue(std::string("east")),
+                                               ColValue(uint32_t(9))});
+        expectedAnd.push_back(rid);
+        assert(t.whereAnd({eq(0, 3), eqString(1, "east")}) == expectedAnd);
+        t.flushDurable();
+    }
+    {
+        // Clean reopen loads the saved bitmaps.
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.hasBitmapIndex(0) && t.hasBitmapIndex(1));
+        assert(t.whereAnd({eq(0, 3), eqString(1, "east")}) == expectedAnd);
+
+        // WAL-only change: the bitmap file is stale until rebuilt on reopen.
+        t.deleteRow(expectedAnd.back());
+        expectedAnd.pop_back();
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.whereAnd({eq(0, 3), eqString(1, "east")}) == expectedAnd);
+
+        const auto remap = t.compact();
+        std::vector<uint32_t> remapped;
+        for (uint32_t oldID : expectedAnd) remapped.push_back(remap[oldID]);
+        assert(t.whereAnd({eq(0, 3), eqString(1, "east")}) == remapped);
+
+        t.dropBitmapIndex(1);
+        assert(!t.hasBitmapIndex(1));
+        assert(::access((base + ".mdb.1.bmp").c_str(), F_OK) != 0);
+        assert(t.whereAnd({eq(0, 3), eqString(1, "east")}) == remapped);
+    }
+    {
+        // A corrupt bitmap file is rebuilt rather than trusted.
+        FILE* f = std::fopen((base + ".mdb.0.bmp").c_str(), "wb");
+        std::fputs("garbage", f);
+        std::fclose(f);
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.hasBitmapIndex(0));
+        assert(t.scanEquals(0, 3).size() == t.whereOr({eq(0, 3), eq(0, 3)}).size());
+    }
+    cleanup(base, 3);
+}
+
+void testCreateBitmapIndexSQL() {
+    const std::string base = "/tmp/bitmap_sql";
+    cleanup(base, 2);
+    Engine engine;
+    Table& t = engine.createTable(base, 2);
+    for (uint32_t i = 0; i < 100; ++i) t.insertRow({i % 5, i % 2});
+
+    executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c0) USING BITMAP");
+    executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c1) USING BITMAP");
+    assert(t.hasBitmapIndex(0) && t.hasBitmapIndex(1));
+    auto result = executeMiniSQL(engine, "SELECT COUNT(*) FROM '" + base + "' WHERE c0 = 4 AND c1 = 0");
+    assert(result.rows.size() == 1 && result.rows[0][0] == "10");
+    result = executeMiniSQL(engine, "SELECT COUNT(*) FROM '" + base + "' WHERE c0 = 4 OR c1 = 0");
+    assert(result.rows.size() == 1 && result.rows[0][0] == "60");
+    cleanup(base, 2);
+}
+
+} // namespace
+
+int main() {
+    testRoaring();
+    testTableBitmaps();
+    testCreateBitmapIndexSQL();
+    std::puts("test_bitmap_index: passed");
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "../BloomFilter.hpp"
+#include "../Engine.hpp"
+#include "../Join.hpp"
+#include "../MiniSQL.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".blm").c_str());
+    }
+}
+
+void testRawFilter() {
+    const std::string path = "/tmp/bloom_raw.blm";
+    std::remove(path.c_str());
+    const uint32_t perPage = 1000;
+    {
+        BloomFilter bloom(path);
+        bloom.create(perPage, 10);
+        for (uint16_t pid = 1; pid <= 4; ++pid)
+            for (uint32_t i = 0; i < perPage; ++i)
+                bloom.add(pid, BloomFilter::hashOf(ColValue(pid * 100000u + i), ColType::UINT32));
+        bloom.sync();
+    }
+    BloomFilter bloom(path);
+    assert(bloom.open());
+    assert(bloom.bitsPerKey() == 10);
+
+    // No false negatives; roughly 1% false positives at 10 bits per key.
+    uint32_t falsePositives = 0;
+    for (uint16_t pid = 1; pid <= 4; ++pid) {
+        for (uint32_t i = 0; i < perPage; ++i)
+            assert(bloom.mayContain(pid, BloomFilter::hashOf(ColValue(pid * 100000u + i), ColType::UINT32)));
+        for (uint32_t i = 0; i < perPage; ++i)
+            falsePositives += bloom.mayContain(pid, BloomFilter::hashOf(ColValue(900000u + i), ColType::UINT32));
+    }
+    assert(falsePositives < 4 * perPage / 25);
+    // A page never written has an empty filter.
+    assert(!bloom.mayContain(9, BloomFilter::hashOf(ColValue(1u), ColType::UINT32)));
+
+    bool threw = false;
+    try { BloomFilter::hashOf(ColValue(1.5f), ColType::FLOAT); } catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    std::fputs("junk", f);
+    std::fclose(f);
+    assert(!BloomFilter(path).open());
+    std::remove(path.c_str());
+}
+
+void testTableBloom() {
+    const std::string base = "/tmp/bloom_table";
+    cleanup(base, 3);
+    const std::vector<ColType> types = {ColType::UINT32, ColType::STRING, ColType::FLOAT};
+    std::vector<uint32_t> byID, byName;
+    {
+        Table t(base + ".mdb", 4096, types);
+        t.setUseGPU(false);
+        for (uint32_t i = 0; i < 5000; ++i)
+            t.insertTypedRow({ColValue(i / 3), ColValue("k" + std::to_string(i / 10)), ColValue(float(i))});
+        byID = t.scanEquals(0, 777);
+        byName = t.scanEqualsString(1, "k321");
+        assert(byID.size() == 3 && byName.size() == 10);
+
+        t.createBloomFilter(0);
+        t.createBloomFilter(1, 16);
+        assert(t.hasBloomFilter(0) && t.hasBloomFilter(1));
+        assert(::access((base + ".mdb.1.blm").c_str(), F_OK) == 0);
+
+        bool threw = false;
+        try { t.createBloomFilter(2); } catch (const std::invalid_argument&) { threw = true; }
+        assert(threw);
+
+        assert(t.scanEquals(0, 777) == byID);
+        assert(t.scanEqualsString(1, "k321") == byName);
+        assert(t.scanEquals(0, 99999).empty());
+        assert(t.scanEqualsString(1, "missing").empty());
+
+        // Inserts set filter bits; deletes leave them but scans still verify.
+        t.deleteRow(byID.front());
+        byID.erase(byID.begin());
+        byID.push_back(t.insertTypedRow({ColValue(uint32_t(777)), ColValue(std::string("k321")), ColValue(0.0f)}));
+        byName.push_back(byID.back());
+        assert(t.scanEquals(0, 777) == byID);
+        assert(t.scanEqualsString(1, "k321") == byName);
+        t.flushDurable();
+
+        // WAL-only change, replayed and rebuilt on reopen.
+        byID.push_back(t.insertTypedRow({ColValue(uint32_t(777)), ColValue(std::string("late")), ColValue(1.0f)}));
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.hasBloomFilter(0) && t.hasBloomFilter(1));
+        assert(t.scanEquals(0, 777) == byID);
+        assert((t.scanEqualsString(1, "late") == std::vector<uint32_t>{byID.back()}));
+
+        t.dropBloomFilter(1);
+        assert(!t.hasBloomFilter(1));
+        assert(::access((base + ".mdb.1.blm").c_str(), F_OK) != 0);
+        assert(t.scanEqualsString(1, "k321") == byName);
+    }
+    {
+        // A corrupt filter file is rebuilt rather than trusted.
+        FILE* f = std::fopen((base + ".mdb.0.blm").c_str(), "wb");
+        std::fputs("junk", f);
+        std::fclose(f);
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.hasBloomFilter(0));
+        assert(t.scanEquals(0, 777) == byID);
+    }
+    {
+        // Unlogged inserts: their filter bits reach the file with the closing checkpoint.
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        t.setDurability(Table::Durability::Off);
+        byID.push_back(t.insertTypedRow({ColValue(uint32_t(4242)), ColValue(std::string("off")), ColValue(2.0f)}));
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.scanEquals(0, 4242) == std::vector<uint32_t>{byID.back()});
+    }
+    cleanup(base, 3);
+}
+
+void testJoinPruning() {
+    const std::string left = "/tmp/bloom_join_l", right = "/tmp/bloom_join_r";
+    cleanup(left, 2);
+    cleanup(right, 2);
+    Engine engine;
+    Table& l = engine.createTable(left, 2);
+    Table& r = engine.createTable(right, 2);
+    for (uint32_t i = 0; i < 20000; ++i) l.insertRow({i, i % 7});
+    for (uint32_t k : {5u, 12345u, 19999u, 50000u}) r.insertRow({k, 0});
+
+    auto expected = Join::hashJoinEq(l, 0, r, 0);
+    executeMiniSQL(engine, "CREATE INDEX ON '" + left + "' (c0) USING BLOOM");
+    assert(l.hasBloomFilter(0));
+    auto pruned = Join::hashJoinEq(l, 0, r, 0);
+    std::sort(expected.begin(), expected.end());
+    std::sort(pruned.begin(), pruned.end());
+    assert(pruned == expected && pruned.size() == 3);
+    cleanup(left, 2);
+    cleanup(right, 2);
+}
+
+} // namespace
+
+int main() {
+    testRawFilter();
+    testTableBloom();
+    testJoinPruning();
+    std::puts("test_bloom_filter: passed");
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include "../BPlusTree.hpp"
+#include "../Engine.hpp"
+#include "../MiniSQL.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".bpt").c_str());
+    }
+}
+
+using Entry = std::pair<uint32_t, uint32_t>;  // (value, rowID)
+
+std::vector<uint32_t> treeRange(const BPlusTree& tree, uint32_t lo, uint32_t hi) {
+    std::vector<uint32_t> out;
+    tree.scanRange(BPlusTree::encodeNumeric(ColValue(lo), ColType::UINT32),
+                   BPlusTree::encodeNumeric(ColValue(hi), ColType::UINT32),
+                   [&](const BPlusTree::Key&, uint32_t rowID) {
+                       out.push_back(rowID);
+                       return true;
+                   });
+    return out;
+}
+
+std::vector<uint32_t> referenceRange(const std::set<Entry>& ref, uint32_t lo, uint32_t hi) {
+    std::vector<uint32_t> out;
+    for (auto it = ref.lower_bound({lo, 0}); it != ref.end() && it->first <= hi; ++it)
+        out.push_back(it->second);
+    return out;
+}
+
+void testEncodingOrder() {
+    const std::vector<int64_t> ints = {INT64_MIN, -5000000000LL, -1, 0, 1, 7, INT64_MAX};
+    for (size_t i = 1; i < ints.size(); ++i)
+        assert(BPlusTree::encodeNumeric(ColValue(ints[i - 1]), ColType::INT64) <
+               BPlusTree::encodeNumeric(ColValue(ints[i]), ColType::INT64));
+
+    const std::vector<double> dbls = {-1e300, -2.5, -1e-300, 0.0, 1e-300, 3.25, 1e300};
+    for (size_t i = 1; i < dbls.size(); ++i)
+        assert(BPlusTree::encodeNumeric(ColValue(dbls[i - 1]), ColType::DOUBLE) <
+               BPlusTree::encodeNumeric(ColValue(dbls[i]), ColType::DOUBLE));
+    assert(BPlusTree::encodeNumeric(ColValue(-0.0), ColType::DOUBLE) ==
+           BPlusTree::encodeNumeric(ColValue(0.0), ColType::DOUBLE));
+
+    assert(BPlusTree::encodeNumeric(ColValue(-1.5f), ColType::FLOAT) <
+           BPlusTree::encodeNumeric(ColValue(0.25f), ColType::FLOAT));
+    assert(BPlusTree::encodeNumeric(ColValue(uint32_t(255)), ColType::UINT32) <
+           BPlusTree::encodeNumeric(ColValue(uint32_t(256)), ColType::UINT32));
+}
+
+void testTreeAgainstReference() {
+    const std::string path = "/tmp/btree_raw.bpt";
+    std::remove(path.c_str());
+    std::set<Entry> ref;
+    std::mt19937 rng(42);
+
+    {
+        BPlusTree tree(path, BPlusTree::kNumericKeyBytes);
+        tree.openOrCreate(/*create=*/true);
+        // Enough entries for a three-level tree; values repeat so duplicates
+        // span leaf boundaries.
+        for (uint32_t rowID = 0; rowID < 120000; ++rowID) {
+            const uint32_t v = rng() % 5000;
+            assert(tree.insert(BPlusTree::encodeNumeric(ColValue(v), ColType::UINT32), rowID));
+            ref.insert({v, rowID});
+        }
+        assert(!tree.insert(BPlusTree::encodeNumeric(ColValue(ref.begin()->first), ColType::UINT32),
+                            ref.begin()->second));
+        assert(tree.size() == ref.size());
+
+        // Erase every third entry.
+        std::vector<Entry> doomed;
+        size_t i = 0;
+        for (const auto& e : ref)
+            if (i++ % 3 == 0) doomed.push_back(e);
+        for (const auto& e : doomed) {
+            assert(tree.erase(BPlusTree::encodeNumeric(ColValue(e.first), ColType::UINT32), e.second));
+            ref.erase(e);
+        }
+        assert(!tree.erase(BPlusTree::encodeNumeric(ColValue(doomed[0].first), ColType::UINT32),
+                           doomed[0].second));
+        assert(tree.size() == ref.size());
+        tree.sync();
+    }
+    {
+        BPlusTree tree(path, BPlusTree::kNumericKeyBytes);
+        tree.openOrCreate(/*create=*/false);
+        assert(tree.size() == ref.size());
+        assert(treeRange(tree, 0, UINT32_MAX) == referenceRange(ref, 0, UINT32_MAX));
+        for (uint32_t v : {0u, 1u, 777u, 4999u, 5000u})
+            assert(treeRange(tree, v, v) == referenceRange(ref, v, v));
+        assert(treeRange(tree, 1200, 1300) == referenceRange(ref, 1200, 1300));
+        assert(treeRange(tree, 10, 9).empty());
+
+        // Early stop is reported to the caller.
+        size_t seen = 0;
+        const bool complete = tree.scanRange(
+            BPlusTree::encodeNumeric(ColValue(uint32_t(0)), ColType::UINT32),
+            BPlusTree::encodeNumeric(ColValue(uint32_t(UINT32_MAX)), ColType::UINT32),
+            [&](const BPlusTree::Key&, uint32_t) { return ++seen < 10; });
+        assert(!complete && seen == 10);
+
+        // Bulk load replaces the contents and stays searchable and updatable.
+        std::vector<std::pair<BPlusTree::Key, uint32_t>> sorted;
+        for (const auto& e : ref)
+            sorted.emplace_back(BPlusTree::encodeNumeric(ColValue(e.first), ColType::UINT32), e.second);
+        tree.bulkLoad(sorted);
+        assert(tree.size() == ref.size());
+        assert(treeRange(tree, 0, UINT32_MAX) == referenceRange(ref, 0, UINT32_MAX));
+        assert(tree.insert(BPlusTree::encodeNumeric(ColValue(uint32_t(2500)), ColType::UINT32), 999999));
+        ref.insert({2500, 999999});
+        assert(treeRange(tree, 2400, 2600) == referenceRange(ref, 2400, 2600));
+    }
+    std::remove(path.c_str());
+}
+
+void testTableIndex() {
+    const std::string base = "/tmp/btree_table";
+    cleanup(base, 3);
+    const std::vector<ColType> types = {ColType::UINT32, ColType::INT64, ColType::DOUBLE};
+    {
+        Table t(base + ".mdb", 4096, types);
+        t.setUseGPU(false);
+        for (uint32_t i = 0; i < 3000; ++i)
+            t.insertTypedRow({ColValue(i % 500), ColValue(int64_t(i) - 1500), ColValue(double(i) * -0.5)});
+
+        t.createIndex(0);
+        t.createIndex(1);
+        t.createIndex(2);
+        assert(t.hasIndex(0) && t.hasIndex(1) && t.hasIndex(2));
+        assert(::access((base + ".mdb.0.bpt").c_str(), F_OK) == 0);
+
+        // Index-served point lookup and range, sorted by rowID.
+        auto hits = t.scanEquals(0, 7);
+        assert((hits == std::vector<uint32_t>{7, 507, 1007, 1507, 2007, 2507}));
+        hits = t.whereBetween(0, 10, 11);
+        assert(hits.size() == 12 && std::is_sorted(hits.begin(), hits.end()));
+
+        // Non-selective range falls back to the scan and still answers correctly.
+        assert(t.whereBetween(0, 0, 499).size() == 3000);
+
+        // Typed lookups across negative values.
+        auto neg = t.indexRange(1, ColValue(int64_t(-3)), ColValue(int64_t(2)));
+        assert((neg == std::vector<uint32_t>{1497, 1498, 1499, 1500, 1501, 1502}));
+        auto dbl = t.indexRange(2, ColValue(-2.0), ColValue(-1.0));
+        assert((dbl == std::vector<uint32_t>{2, 3, 4}));
+
+        // Maintenance on insert and delete.
+        t.deleteRow(507);
+        const uint32_t rid = t.insertTypedRow({ColValue(uint32_t(7)), ColValue(int64_t(0)), ColValue(1.0)});
+        assert(rid == 3000);
+        hits = t.scanEquals(0, 7);
+        assert((hits == std::vector<uint32_t>{7, 1007, 1507, 2007, 2507, 3000}));
+        assert((t.indexRange(1, ColValue(int64_t(0)), ColValue(int64_t(0))) == std::vector<uint32_t>{1500, 3000}));
+
+        // Predicate path uses the same index.
+        Predicate p;
+        p.kind = Predicate::Kind::EQ;
+        p.colIdx = 0;
+        p.lo = 7;
+        assert(t.scanPredicate(p) == hits);
+
+        // Typed predicates are served by the typed indexes too, and by a scan
+        // once the range is not selective or the index is gone.
+        Predicate ip;
+        ip.kind = Predicate::Kind::BETWEEN;
+        ip.colIdx = 1;
+        ip.typedLo = ColValue(int64_t(-3));
+        ip.typedHi = ColValue(int64_t(2));
+        assert((t.scanPredicate(ip) == std::vector<uint32_t>{1497, 1498, 1499, 1500, 1501, 1502, 3000}));
+        ip.kind = Predicate::Kind::EQ;
+        ip.typedLo = ColValue(int64_t(0));
+        assert((t.scanPredicate(ip) == std::vector<uint32_t>{1500, 3000}));
+        ip.kind = Predicate::Kind::BETWEEN;
+        ip.typedLo = ColValue(INT64_MIN);
+        ip.typedHi = ColValue(int64_t(-1));
+        assert(t.scanPredicate(ip).size() == 1499);  // rows 0-1499 less 507: past the index limit
+        Predicate dp;
+        dp.kind = Predicate::Kind::BETWEEN;
+        dp.colIdx = 2;
+        dp.typedLo = ColValue(-2.0);
+        dp.typedHi = ColValue(-1.0);
+        assert(t.scanPredicate(dp) == dbl);
+        assert((t.whereAnd({dp, ip}) == dbl));
+        dp.typedLo = ColValue(int64_t(-2));  // wrong type for a DOUBLE column
+        bool threw = false;
+        try { t.scanPredicate(dp); } catch (const std::invalid_argument&) { threw = true; }
+        assert(threw);
+        dp.typedLo = ColValue(-2.0);
+
+        t.dropIndex(2);
+        assert(t.scanPredicate(dp) == dbl);
+        assert(!t.hasIndex(2));
+        assert(::access((base + ".mdb.2.bpt").c_str(), F_OK) != 0);
+        threw = false;
+        try { t.indexRange(2, ColValue(0.0), ColValue(1.0)); } catch (const std::invalid_argument&) { threw = true; }
+        assert(threw);
+        t.flushDurable();
+
+        // Left in the WAL only: reopen must rebuild the index to include it.
+        t.insertTypedRow({ColValue(uint32_t(7)), ColValue(int64_t(5000)), ColValue(2.0)});
+        t.deleteRow(7);
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.hasIndex(0) && t.hasIndex(1) && !t.hasIndex(2));
+        auto hits = t.scanEquals(0, 7);
+        assert((hits == std::vector<uint32_t>{1007, 1507, 2007, 2507, 3000, 3001}));
+
+        // Compaction renumbers rows; the index follows.
+        const auto remap = t.compact();
+        hits = t.scanEquals(0, 7);
+        std::vector<uint32_t> expected;
+        for (uint32_t oldID : {1007u, 1507u, 2007u, 2507u, 3000u, 3001u}) expected.push_back(remap[oldID]);
+        assert(hits == expected);
+        assert((t.indexRange(1, ColValue(int64_t(5000)), ColValue(int64_t(5000))) ==
+                std::vector<uint32_t>{remap[3001]}));
+    }
+    {
+        // Recreating the table discards old index files.
+        Table t(base + ".mdb", 4096, types);
+        assert(!t.hasIndex(0));
+        assert(::access((base + ".mdb.0.bpt").c_str(), F_OK) != 0);
+        Table s("/tmp/btree_str.mdb", 4096, std::vector<ColType>{ColType::STRING});
+        s.createIndex(0);  // STRING columns get a prefix-keyed tree
+        assert(s.hasIndex(0));
+    }
+    cleanup(base, 3);
+    cleanup("/tmp/btree_str", 1);
+}
+
+void testCreateIndexSQL() {
+    const std::string base = "/tmp/btree_sql";
+    cleanup(base, 2);
+    Engine engine;
+    Table& t = engine.createTable(base, 2);
+    for (uint32_t i = 0; i < 200; ++i) t.insertRow({i % 20, i});
+
+    auto result = executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c0);");
+    assert(result.headers.size() == 1 && result.rows.size() == 1);
+    assert(t.hasIndex(0));
+
+    result = executeMiniSQL(engine, "SELECT c1 FROM '" + base + "' WHERE c0 = 3");
+    assert(result.rows.size() == 10);
+    assert(result.rows[0][0] == "3" && result.rows[9][0] == "183");
+
+    bool threw = false;
+    try { executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c5)"); }
+    catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+    cleanup(base, 2);
+}
+
+} // namespace
+
+int main() {
+    testEncodingOrder();
+    testTreeAgainstReference();
+    testTableIndex();
+    testCreateIndexSQL();
+    std::puts("test_btree_index: passed");
+    return 0;
+}
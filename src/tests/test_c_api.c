@@ -187,8 +187,10 @@ static void test_where_and_or(void) {
     MdbPredicate preds_and[2];
     preds_and[0].col_idx = 0; preds_and[0].kind = MDB_PRED_BETWEEN;
     preds_and[0].lo = 3; preds_and[0].hi = 9; preds_and[0].needle = NULL;
+    preds_and[0].needle_hi = NULL;
     preds_and[1].col_idx = 1; preds_and[1].kind = MDB_PRED_BETWEEN;
     preds_and[1].lo = 8; preds_and[1].hi = 18; preds_and[1].needle = NULL;
+    preds_and[1].needle_hi = NULL;
 
     MdbRowSet* rs_and = mdb_where_and(e, "/tmp/c_andor", preds_and, 2);
     CHECK(rs_and != NULL);
@@ -201,8 +203,10 @@ static void test_where_and_or(void) {
     MdbPredicate preds_or[2];
     preds_or[0].col_idx = 0; preds_or[0].kind = MDB_PRED_EQ;
     preds_or[0].lo = 1; preds_or[0].hi = 0; preds_or[0].needle = NULL;
+    preds_or[0].needle_hi = NULL;
     preds_or[1].col_idx = 0; preds_or[1].kind = MDB_PRED_EQ;
     preds_or[1].lo = 5; preds_or[1].hi = 0; preds_or[1].needle = NULL;
+    preds_or[1].needle_hi = NULL;
 
     MdbRowSet* rs_or = mdb_where_or(e, "/tmp/c_andor", preds_or, 2);
     CHECK(rs_or != NULL);
@@ -264,6 +268,182 @@ static void test_flush_reopen(void) {
     printf("PASS test_flush_reopen\n");
 }
 
+static void test_compact(void) {
+    MdbEngine* e = mdb_open();
+    CHECK(e != NULL);
+
+    MdbColType types[] = { MDB_UINT32 };
+    CHECK(mdb_create_table(e, "/tmp/c_compact", types, 1) == MDB_OK);
+    for (uint32_t i = 0; i < 6; i++) {
+        MdbValue v = uint32_val(i * 10);
+        CHECK(mdb_insert(e, "/tmp/c_compact", &v, 1, NULL) == MDB_OK);
+    }
+    CHECK(mdb_delete(e, "/tmp/c_compact", 1) == MDB_OK);
+    CHECK(mdb_delete(e, "/tmp/c_compact", 4) == MDB_OK);
+
+    MdbRowSet* map = NULL;
+    CHECK(mdb_compact(e, "/tmp/c_compact", &map) == MDB_OK);
+    CHECK(map != NULL && map->count == 6);
+    if (map && map->count == 6) {
+        CHECK(map->row_ids[0] == 0);
+        CHECK(map->row_ids[1] == MDB_ROW_DROPPED);
+        CHECK(map->row_ids[2] == 1);
+        CHECK(map->row_ids[3] == 2);
+        CHECK(map->row_ids[4] == MDB_ROW_DROPPED);
+        CHECK(map->row_ids[5] == 3);
+    }
+    mdb_free_rows(map);
+
+    MdbValue out;
+    CHECK(mdb_fetch_row(e, "/tmp/c_compact", 3, &out, 1) == MDB_OK);
+    CHECK(out.u32 == 50);
+    CHECK(mdb_compact(e, "/tmp/c_compact", NULL) == MDB_OK);
+    CHECK(mdb_compact(e, "/tmp/c_missing_compact", NULL) == MDB_ERR_ARG);
+
+    mdb_close(e);
+    printf("PASS test_compact\n");
+}
+
+static void test_primary_key(void) {
+    MdbEngine* e = mdb_open();
+    CHECK(e != NULL);
+
+    MdbColType types[] = { MDB_UINT32, MDB_STRING };
+    CHECK(mdb_create_table(e, "/tmp/c_pk", types, 2) == MDB_OK);
+    MdbValue row[2] = { uint32_val(7), string_val("seven") };
+    CHECK(mdb_insert(e, "/tmp/c_pk", row, 2, NULL) == MDB_OK);
+    CHECK(mdb_set_primary_key(e, "/tmp/c_pk", 0) == MDB_OK);
+    CHECK(mdb_set_primary_key(e, "/tmp/c_pk", 1) == MDB_ERR_ARG);
+    CHECK(mdb_insert(e, "/tmp/c_pk", row, 2, NULL) == MDB_ERR_ARG);
+
+    MdbValue updated[2] = { uint32_val(7), string_val("SEVEN") };
+    uint32_t rid = 0;
+    CHECK(mdb_upsert(e, "/tmp/c_pk", updated, 2, &rid) == MDB_OK);
+    CHECK(rid == 1);
+
+    MdbValue key = uint32_val(7);
+    MdbValue out[2];
+    uint32_t found = 0;
+    CHECK(mdb_get_by_key(e, "/tmp/c_pk", &key, out, 2, &found) == MDB_OK);
+    CHECK(found == 1 && out[1].str && strcmp(out[1].str, "SEVEN") == 0);
+    key = uint32_val(8);
+    CHECK(mdb_get_by_key(e, "/tmp/c_pk", &key, out, 2, NULL) == MDB_NOT_FOUND);
+    key = string_val("7");
+    CHECK(mdb_get_by_key(e, "/tmp/c_pk", &key, NULL, 0, NULL) == MDB_ERR_ARG);
+
+    mdb_close(e);
+    printf("PASS test_primary_key\n");
+}
+
+static void test_transactions(void) {
+    MdbEngine* e = mdb_open();
+    CHECK(e != NULL);
+
+    MdbColType types[] = { MDB_UINT32, MDB_STRING };
+    CHECK(mdb_create_table(e, "/tmp/c_txn", types, 2) == MDB_OK);
+    CHECK(mdb_set_primary_key(e, "/tmp/c_txn", 0) == MDB_OK);
+    CHECK(mdb_commit(e, "/tmp/c_txn") == MDB_ERR_ARG);
+    CHECK(mdb_rollback(e, "/tmp/c_txn") == MDB_ERR_ARG);
+
+    CHECK(mdb_begin(e, "/tmp/c_txn") == MDB_OK);
+    CHECK(mdb_begin(e, "/tmp/c_txn") == MDB_ERR_ARG);
+    MdbValue a[2] = { uint32_val(1), string_val("one") };
+    MdbValue b[2] = { uint32_val(2), string_val("two") };
+    uint32_t rid_a = 0, rid_b = 0;
+    CHECK(mdb_insert(e, "/tmp/c_txn", a, 2, &rid_a) == MDB_OK);
+    CHECK(mdb_insert(e, "/tmp/c_txn", b, 2, &rid_b) == MDB_OK);
+    CHECK(mdb_insert(e, "/tmp/c_txn", a, 2, NULL) == MDB_ERR_ARG);  /* key 1 is pending */
+    CHECK(rid_a == 0 && rid_b == 1);
+    MdbRowSet* rs = mdb_scan_eq(e, "/tmp/c_txn", 0, 1);
+    CHECK(rs != NULL && rs->count == 0);  /* not visible before commit */
+    mdb_free_rows(rs);
+    CHECK(mdb_commit(e, "/tmp/c_txn") == MDB_OK);
+    MdbValue out[2];
+    CHECK(mdb_fetch_row(e, "/tmp/c_txn", rid_b, out, 2) == MDB_OK);
+    CHECK(out[1].str && strcmp(out[1].str, "two") == 0);
+
+    CHECK(mdb_begin(e, "/tmp/c_txn") == MDB_OK);
+    CHECK(mdb_delete(e, "/tmp/c_txn", rid_a) == MDB_OK);
+    CHECK(mdb_rollback(e, "/tmp/c_txn") == MDB_OK);
+    CHECK(mdb_fetch_row(e, "/tmp/c_txn", rid_a, out, 2) == MDB_OK);
+    CHECK(mdb_begin(e, "/tmp/c_missing_txn") == MDB_ERR_ARG);
+
+    mdb_close(e);
+    printf("PASS test_transactions\n");
+}
+
+static void test_durability(void) {
+    MdbEngine* e = mdb_open();
+    CHECK(e != NULL);
+
+    CHECK(mdb_set_durability(e, NULL, MDB_SYNC_OFF) == MDB_OK);
+    MdbColType types[] = { MDB_UINT32 };
+    CHECK(mdb_create_table(e, "/tmp/c_sync", types, 1) == MDB_OK);
+    for (uint32_t v = 0; v < 10; v++) {
+        MdbValue row[1] = { uint32_val(v) };
+        CHECK(mdb_insert(e, "/tmp/c_sync", row, 1, NULL) == MDB_OK);
+    }
+    CHECK(mdb_set_durability(e, "/tmp/c_sync", MDB_SYNC_FULL) == MDB_OK);
+    MdbValue row[1] = { uint32_val(10) };
+    CHECK(mdb_insert(e, "/tmp/c_sync", row, 1, NULL) == MDB_OK);
+    CHECK(mdb_set_durability(e, "/tmp/c_sync", (MdbDurability)7) == MDB_ERR_ARG);
+    CHECK(mdb_set_durability(e, "/tmp/c_missing_sync", MDB_SYNC_NORMAL) == MDB_ERR_ARG);
+    mdb_close(e);
+
+    e = mdb_open();
+    CHECK(e != NULL);
+    MdbRowSet* rs = mdb_scan_between(e, "/tmp/c_sync", 0, 0, 10);
+    CHECK(rs != NULL && rs->count == 11);
+    mdb_free_rows(rs);
+    mdb_close(e);
+    printf("PASS test_durability\n");
+}
+
+static void test_cdc(void) {
+    MdbEngine* e = mdb_open();
+    CHECK(e != NULL);
+
+    MdbColType types[] = { MDB_UINT32, MDB_STRING };
+    CHECK(mdb_create_table(e, "/tmp/c_cdc", types, 2) == MDB_OK);
+    MdbValue a[2] = { uint32_val(1), string_val("one") };
+    MdbValue b[2] = { uint32_val(2), string_val("two") };
+    CHECK(mdb_insert(e, "/tmp/c_cdc", a, 2, NULL) == MDB_OK);
+    CHECK(mdb_insert(e, "/tmp/c_cdc", b, 2, NULL) == MDB_OK);
+    CHECK(mdb_delete(e, "/tmp/c_cdc", 0) == MDB_OK);
+
+    MdbCdcCursor* c = NULL;
+    MdbCdcEvent ev;
+    CHECK(mdb_cdc_open(e, "/tmp/c_cdc", MDB_CDC_START, &c) == MDB_OK);
+    CHECK(mdb_cdc_next(c, &ev) == MDB_OK);
+    CHECK(ev.op == MDB_CDC_INSERT && ev.row_id == 0 && ev.num_values == 2);
+    CHECK(ev.values && ev.values[0].u32 == 1 && strcmp(ev.values[1].str, "one") == 0);
+    const uint64_t after_first = ev.lsn;
+    CHECK(mdb_cdc_next(c, &ev) == MDB_OK);
+    CHECK(ev.op == MDB_CDC_INSERT && ev.row_id == 1 && ev.lsn > after_first);
+    CHECK(mdb_cdc_next(c, &ev) == MDB_OK);
+    CHECK(ev.op == MDB_CDC_DELETE && ev.row_id == 0 && ev.values == NULL && ev.num_values == 0);
+    CHECK(mdb_cdc_next(c, &ev) == MDB_NOT_FOUND);
+    CHECK(mdb_cdc_position(c) == ev.lsn);
+    mdb_cdc_close(c);
+
+    /* Resume after the first change. */
+    CHECK(mdb_cdc_open(e, "/tmp/c_cdc", after_first, &c) == MDB_OK);
+    CHECK(mdb_cdc_next(c, &ev) == MDB_OK && ev.row_id == 1 && strcmp(ev.values[1].str, "two") == 0);
+    mdb_cdc_close(c);
+
+    /* A checkpoint drops the WAL it was read from. */
+    CHECK(mdb_flush(e, "/tmp/c_cdc") == MDB_OK);
+    CHECK(mdb_insert(e, "/tmp/c_cdc", a, 2, NULL) == MDB_OK);
+    CHECK(mdb_cdc_open(e, "/tmp/c_cdc", after_first, &c) == MDB_ERR_LOST);
+    CHECK(c == NULL && mdb_last_error(e) != NULL);
+    CHECK(mdb_cdc_open(e, "/tmp/c_missing_cdc", MDB_CDC_START, &c) == MDB_ERR_ARG);
+    CHECK(mdb_cdc_next(NULL, &ev) == MDB_ERR_ARG);
+    mdb_cdc_close(NULL);
+
+    mdb_close(e);
+    printf("PASS test_cdc\n");
+}
+
 static void test_groupby(void) {
     MdbEngine* e = mdb_open();
     CHECK(e != NULL);
@@ -381,6 +561,7 @@ static void test_error_propagation(void) {
     bad.lo      = 0;
     bad.hi      = 0;
     bad.needle  = NULL;
+    bad.needle_hi = NULL;
     MdbRowSet* rs = mdb_where_and(e, "/tmp/c_err", &bad, 1);
     CHECK(rs == NULL);
     const char* err = mdb_last_error(e);
@@ -499,6 +680,11 @@ int main(void) {
     test_where_and_or();
     test_delete();
     test_flush_reopen();
+    test_compact();
+    test_primary_key();
+    test_transactions();
+    test_durability();
+    test_cdc();
     test_groupby();
     test_join();
     test_null_safety();
@@ -0,0 +1,168 @@
+#include "../ChangeStream.hpp"
+#include "../Table.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.1.str").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles + 2; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+}
+
+std::vector<ColValue> row(uint32_t i) {
+    return {ColValue(i), ColValue("v" + std::to_string(i))};
+}
+
+std::vector<Wal::Operation> drain(ChangeStream& stream) {
+    std::vector<Wal::Operation> changes;
+    Wal::Operation change;
+    while (stream.next(change)) changes.push_back(change);
+    return changes;
+}
+
+bool isInsert(const Wal::Operation& change, uint32_t rowID) {
+    return change.kind == Wal::Operation::Kind::Insert && change.rowID == rowID &&
+           change.values.size() == 2 && change.values[0].u32 == rowID && change.values[1].str == row(rowID)[1].str;
+}
+
+bool isDelete(const Wal::Operation& change, uint32_t rowID) {
+    return change.kind == Wal::Operation::Kind::Delete && change.rowID == rowID && change.values.empty();
+}
+
+bool lost(const std::string& path, uint64_t after) {
+    try {
+        ChangeStream stream(path, after);
+        Wal::Operation change;
+        while (stream.next(change)) {}
+    } catch (const ChangeStream::Lost&) {
+        return true;
+    }
+    return false;
+}
+
+void testCommitOrder() {
+    const std::string base = "/tmp/cdc_order";
+    cleanup(base);
+    Table table(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING});
+    for (uint32_t i = 0; i < 5; ++i) table.insertTypedRow(row(i));
+    table.deleteRow(1);
+
+    ChangeStream stream(base + ".mdb");
+    auto changes = drain(stream);
+    assert(changes.size() == 6);
+    for (uint32_t i = 0; i < 5; ++i) assert(isInsert(changes[i], i));
+    assert(isDelete(changes[5], 1));
+    for (size_t i = 1; i < changes.size(); ++i) assert(changes[i].opID > changes[i - 1].opID);
+
+    // A transaction shows up once it commits, whole.
+    table.begin();
+    table.insertTypedRow(row(5));
+    table.deleteRow(0);
+    assert(drain(stream).empty());
+    table.commit();
+    changes = drain(stream);
+    assert(changes.size() == 2 && isInsert(changes[0], 5) && isDelete(changes[1], 0));
+    table.begin();
+    table.insertTypedRow(row(6));
+    table.rollback();
+    assert(drain(stream).empty());
+    cleanup(base);
+}
+
+void testResume() {
+    const std::string base = "/tmp/cdc_resume";
+    const std::string path = base + ".mdb";
+    cleanup(base);
+    Table table(path, 4096, {ColType::UINT32, ColType::STRING});
+    for (uint32_t i = 0; i < 100; ++i) table.insertTypedRow(row(i));
+
+    // Stop partway; a new stream picks up right after.
+    uint64_t position = 0;
+    {
+        ChangeStream stream(path);
+        Wal::Operation change;
+        for (uint32_t i = 0; i < 40; ++i) {
+            assert(stream.next(change) && isInsert(change, i));
+        }
+        position = stream.position();
+    }
+    {
+        ChangeStream stream(path, position);
+        const auto changes = drain(stream);
+        assert(changes.size() == 60 && isInsert(changes.front(), 40) && isInsert(changes.back(), 99));
+        position = stream.position();
+    }
+
+    // Mid-batch: the rest of the transaction, not all of it again.
+    table.begin();
+    for (uint32_t i = 100; i < 110; ++i) table.insertTypedRow(row(i));
+    table.commit();
+    {
+        ChangeStream stream(path, position);
+        Wal::Operation change;
+        for (uint32_t i = 100; i < 103; ++i) assert(stream.next(change) && isInsert(change, i));
+        position = stream.position();
+    }
+    {
+        ChangeStream stream(path, position);
+        const auto changes = drain(stream);
+        assert(changes.size() == 7 && isInsert(changes.front(), 103));
+        position = stream.position();
+    }
+
+    // A consumer that kept up resumes across a checkpoint; one that did not
+    // has lost its place.
+    const uint64_t behind = ChangeStream::makePosition(0, 50);
+    table.flushDurable();
+    table.insertTypedRow(row(110));
+    {
+        ChangeStream stream(path, position);
+        const auto changes = drain(stream);
+        assert(changes.size() == 1 && isInsert(changes[0], 110));
+        position = stream.position();
+    }
+    assert(lost(path, behind));
+
+    // From the end: only what is committed afterwards.
+    ChangeStream tail(path, ChangeStream::kFromEnd);
+    assert(tail.position() == position);
+    assert(drain(tail).empty());
+    table.deleteRow(3);
+    auto changes = drain(tail);
+    assert(changes.size() == 1 && isDelete(changes[0], 3));
+
+    // Compaction renumbers the rows: every earlier position is lost, the
+    // open stream included.
+    table.compact();
+    table.insertTypedRow(row(111));
+    assert(lost(path, tail.position()));
+    bool threw = false;
+    try {
+        drain(tail);
+    } catch (const ChangeStream::Lost&) {
+        threw = true;
+    }
+    assert(threw);
+    ChangeStream fresh(path);
+    changes = drain(fresh);
+    assert(changes.size() == 1 && changes[0].rowID == 110 && changes[0].values[0].u32 == 111);
+    assert(fresh.position() >> ChangeStream::kPositionOpIDBits == 1);
+    cleanup(base);
+}
+
+} // namespace
+
+int main() {
+    testCommitOrder();
+    testResume();
+    std::puts("test_changes: passed");
+    return 0;
+}
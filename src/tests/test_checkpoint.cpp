@@ -0,0 +1,227 @@
+#include "../Engine.hpp"
+#include "../Table.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr uint64_t kWalHeader = 32;
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".bpt").c_str());
+    }
+}
+
+template <typename Pred>
+bool eventually(Pred pred) {
+    for (int i = 0; i < 500; ++i) {
+        if (pred()) return true;
+        std::this_thread::sleep_for(10ms);
+    }
+    return pred();
+}
+
+void testSizeTrigger() {
+    const std::string base = "/tmp/ckpt_size";
+    cleanup(base, 2);
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING});
+        t.createIndex(0);
+        Table::CheckpointPolicy policy;
+        policy.walBytes = 32 * 1024;
+        t.setCheckpointPolicy(policy);
+
+        // Concurrent writers keep going while checkpoints run underneath them.
+        std::vector<std::thread> writers;
+        for (uint32_t w = 0; w < 4; ++w)
+            writers.emplace_back([&, w] {
+                for (uint32_t i = 0; i < 2500; ++i)
+                    t.insertTypedRow({ColValue(w * 2500 + i), ColValue(std::string(40, char('a' + w)))});
+            });
+        for (auto& th : writers) th.join();
+
+        assert(eventually([&] { return t.checkpointStats().count >= 1; }));
+        const auto stats = t.checkpointStats();
+        assert(stats.lastError.empty());
+        assert(stats.lsn >= 1 && stats.lsn <= 10000);
+        assert(stats.duration.count() > 0);
+        // Without checkpoints this log would be ~700 KiB.
+        assert(eventually([&] { return t.walBytes() < 200 * 1024; }));
+        assert(t.liveRows() == 10000);
+        assert(t.indexRange(0, ColValue(100u), ColValue(199u)).size() == 100);
+    }
+    {
+        Table t(base + ".mdb");
+        assert(t.liveRows() == 10000);
+        const auto last = t.indexRange(0, ColValue(9999u), ColValue(9999u));
+        assert(last.size() == 1 && t.fetchTypedRow(last[0])[1]->str == std::string(40, 'd'));
+        assert(t.indexRange(0, ColValue(0u), ColValue(9999u)).size() == 10000);
+    }
+    cleanup(base, 2);
+}
+
+void testIntervalTrigger() {
+    const std::string base = "/tmp/ckpt_interval";
+    cleanup(base, 1);
+    Table t(base + ".mdb", 4096, {ColType::UINT32});
+    Table::CheckpointPolicy policy;
+    policy.interval = 20ms;
+    t.setCheckpointPolicy(policy);
+
+    for (uint32_t i = 0; i < 10; ++i) t.insertTypedRow({ColValue(i)});
+    assert(eventually([&] { return t.walBytes() == kWalHeader; }));
+    const auto first = t.checkpointStats();
+    assert(first.count >= 1 && first.lsn == 10);
+
+    // An empty log is not checkpointed again.
+    std::this_thread::sleep_for(100ms);
+    assert(t.checkpointStats().count == first.count);
+
+    // Manual checkpoints are counted too, and turning the policy off stops the thread.
+    t.setCheckpointPolicy({});
+    t.insertTypedRow({ColValue(10u)});
+    std::this_thread::sleep_for(60ms);
+    assert(t.walBytes() > kWalHeader);
+    t.flushDurable();
+    const auto manual = t.checkpointStats();
+    assert(manual.count == first.count + 1 && manual.lsn == 11);
+    cleanup(base, 1);
+}
+
+void testDirtyPagesOnly() {
+    const std::string base = "/tmp/ckpt_dirty";
+    cleanup(base, 1);
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32});
+        t.setUseGPU(false);
+        for (uint32_t i = 0; i < 20000; ++i) t.insertTypedRow({ColValue(i)});
+        t.flushDurable();
+        const auto full = t.checkpointStats();
+        assert(full.pages >= 20 && full.rows == 20000);
+        assert(t.walBytes() == kWalHeader);
+
+        // Cost follows the change: one appended row and one delete touch two
+        // pages and two RowIndex entries, however large the table is.
+        t.insertTypedRow({ColValue(20000u)});
+        t.deleteRow(5);
+        t.flushDurable();
+        const auto small = t.checkpointStats();
+        assert(small.pages == 2 && small.rows == 2);
+        assert(small.walLsn > full.walLsn);
+
+        t.flushDurable();
+        assert(t.checkpointStats().pages == 0 && t.checkpointStats().rows == 0);
+        // Zone maps come from the cached pages, not stale headers on disk.
+        t.insertTypedRow({ColValue(1000000u)});
+        assert(t.maxColumn(0) == 1000000u);
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.liveRows() == 20001);
+        assert(t.scanEquals(0, 5).empty());
+        assert(t.scanEquals(0, 20000).size() == 1);
+        assert(t.maxColumn(0) == 1000000u);
+    }
+    cleanup(base, 1);
+}
+
+void testAppendsDuringCheckpoint() {
+    const std::string base = "/tmp/ckpt_fuzzy";
+    cleanup(base, 2);
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING});
+        t.setUseGPU(false);
+        t.setGroupCommit(true);
+        std::atomic<bool> done{false};
+        std::thread writer([&] {
+            for (uint32_t i = 0; i < 5000; ++i) {
+                t.insertTypedRow({ColValue(i), ColValue("row" + std::to_string(i))});
+                if (i % 7 == 0) t.deleteRow(i);
+            }
+            done = true;
+        });
+        uint64_t checkpoints = 0;
+        while (!done) {
+            t.flushDurable();
+            ++checkpoints;
+        }
+        writer.join();
+        assert(checkpoints >= 1);
+        // Whatever landed after the last capture is still in the WAL.
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.liveRows() == 5000 - 715);
+        assert(t.scanEquals(0, 7).empty());
+        assert(t.fetchTypedRow(4999)[1]->str == "row4999");
+        t.flushDurable();
+        assert(t.walBytes() == kWalHeader);
+    }
+    cleanup(base, 2);
+}
+
+void testWalCheckpointLsn() {
+    const std::string base = "/tmp/ckpt_wal";
+    const std::string path = base + ".mdb";
+    cleanup(base, 0);
+    {
+        Wal wal(path);
+        wal.openOrCreate(true);
+        wal.appendCommit(wal.appendDelete(1));
+        const uint64_t lsn = wal.beginCheckpoint();
+        assert(lsn > 0 && lsn < wal.endLsn());
+        wal.appendCommit(wal.appendDelete(2));  // lands after the checkpoint LSN
+        wal.endCheckpoint(lsn);
+        assert(wal.segmentFiles() == 2);
+        wal.sync();
+    }
+    Wal wal(path);
+    wal.openOrCreate(false);
+    const auto ops = wal.committedOperations();
+    assert(ops.size() == 1 && ops[0].rowID == 2);
+    cleanup(base, 0);
+}
+
+void testEngineAPI() {
+    const std::string base = "/tmp/ckpt_engine";
+    cleanup(base, 2);
+    Engine engine;
+    engine.createTable(base, 2);
+    Table::CheckpointPolicy policy;
+    policy.walBytes = 1;  // every write
+    engine.setCheckpointPolicy(base, policy);
+    engine.insert(base, {1, 2});
+    assert(eventually([&] { return engine.checkpointStats(base).count >= 1; }));
+    assert(engine.checkpointStats(base).lsn == 1);
+    cleanup(base, 2);
+}
+
+} // namespace
+
+int main() {
+    testSizeTrigger();
+    testIntervalTrigger();
+    testDirtyPagesOnly();
+    testAppendsDuringCheckpoint();
+    testWalCheckpointLsn();
+    testEngineAPI();
+    std::puts("test_checkpoint: passed");
+    return 0;
+}
@@ -1,12 +1,22 @@
 #include "../Engine.hpp"
+#include "../Wal.hpp"
 #include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstdio>
 #include <stdexcept>
+#include <string>
 
 extern "C" bool metalIsAvailable();
 
+// <name>.mdb, its row index and every WAL segment.
+static void removeTableFiles(const std::string& name) {
+    for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal"})
+        std::remove((name + suffix).c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((name + ".mdb.wal." + std::to_string(slot)).c_str());
+}
+
 static Predicate eqPred(uint16_t colIdx, ValueType value) {
     Predicate p;
     p.colIdx = colIdx;
@@ -33,6 +43,14 @@ static Predicate stringPred(uint16_t colIdx, const char* needle) {
     return p;
 }
 
+static Predicate prefixPred(uint16_t colIdx, const char* prefix) {
+    Predicate p;
+    p.colIdx = colIdx;
+    p.kind = Predicate::Kind::PREFIX_STRING;
+    p.needle = prefix;
+    return p;
+}
+
 static void assertSorted(const std::vector<uint32_t>& rowIDs) {
     assert(std::is_sorted(rowIDs.begin(), rowIDs.end()));
 }
@@ -103,8 +121,7 @@ int main() {
         assert(!selectiveAnd.empty());
         assert(!worstOr.empty());
 
-        std::remove("compound_tbl.mdb");
-        std::remove("compound_tbl.mdb.idx");
+        removeTableFiles("compound_tbl");
     }
 
     {
@@ -142,8 +159,7 @@ int main() {
                     haveMetal ? "GPU-capable dispatch" : "CPU-only fallback",
                     eqMs, singleAndMs, andMs, orMs);
 
-        std::remove("compound_bench.mdb");
-        std::remove("compound_bench.mdb.idx");
+        removeTableFiles("compound_bench");
     }
 
     {
@@ -214,8 +230,7 @@ int main() {
         auto emptyOr = e.whereOr("compound_typed", {});
         assert(emptyOr.empty());
 
-        std::remove("compound_typed.mdb");
-        std::remove("compound_typed.mdb.idx");
+        removeTableFiles("compound_typed");
         std::remove("compound_typed.mdb.0.str");
     }
 
@@ -249,8 +264,7 @@ int main() {
         std::printf("  compound WHERE benchmark (100k numeric+string, %s path): whereAnd=%.2f ms manual-intersect=%.2f ms\n",
                     haveMetal ? "GPU-capable dispatch" : "CPU-only fallback", compoundMs, manualMs);
 
-        std::remove("compound_bench_typed.mdb");
-        std::remove("compound_bench_typed.mdb.idx");
+        removeTableFiles("compound_bench_typed");
         std::remove("compound_bench_typed.mdb.1.str");
     }
 
@@ -267,11 +281,66 @@ int main() {
         assert(hits.size() == 1);
         assert(hits[0] == 0);
 
-        std::remove("compound_reopen.mdb");
-        std::remove("compound_reopen.mdb.idx");
+        removeTableFiles("compound_reopen");
         std::remove("compound_reopen.mdb.0.str");
     }
 
+    {
+        // Fused single pass over four columns: same rows as a row-at-a-time
+        // check, with and without indexes taking some predicates over.
+        Engine e;
+        auto& t = e.createTypedTable("compound_fused",
+                                     {ColType::UINT32, ColType::UINT32, ColType::UINT32, ColType::STRING});
+        t.setDurability(Table::Durability::Off);
+        constexpr uint32_t N = 20'000;
+        auto row = [](uint32_t i) {
+            return std::vector<ColValue>{ColValue(i % 100), ColValue(i), ColValue(i % 7),
+                                         ColValue("c" + std::to_string(i % 13))};
+        };
+        for (uint32_t i = 0; i < N; ++i) t.insertTypedRow(row(i));
+        for (uint32_t i = 0; i < N; i += 3) t.deleteRow(i);
+        for (uint32_t i = N; i < N + 500; ++i) t.insertTypedRow(row(i));  // reuses freed slots
+
+        const std::vector<Predicate> all = {betweenPred(0, 10, 59), betweenPred(1, 3'000, 15'000), eqPred(2, 3),
+                                            prefixPred(3, "c1")};
+        const std::vector<Predicate> any = {betweenPred(1, 100, 200), stringPred(3, "c5"), eqPred(2, 6)};
+        auto expected = [&](bool anyOf) {
+            std::vector<uint32_t> rowIDs;
+            for (uint32_t rid = 0; rid < t.rowsRecorded(); ++rid) {
+                auto r = t.fetchTypedRow(rid);
+                if (!r[0]) continue;
+                const uint32_t a = r[0]->u32, b = r[1]->u32, c = r[2]->u32;
+                const std::string& str = r[3]->str;
+                const bool match = anyOf ? (b >= 100 && b <= 200) || str == "c5" || c == 6
+                                         : a >= 10 && a <= 59 && b >= 3'000 && b <= 15'000 && c == 3 &&
+                                               str.compare(0, 2, "c1") == 0;
+                if (match) rowIDs.push_back(rid);
+            }
+            return rowIDs;
+        };
+        const auto wantAnd = expected(false);
+        const auto wantOr = expected(true);
+        assert(!wantAnd.empty() && !wantOr.empty());
+        assert(t.whereAnd(all) == wantAnd);
+        assert(t.whereOr(any) == wantOr);
+
+        // Only the zone maps of the last pages can hold these values.
+        auto tail = t.whereAnd({betweenPred(1, N + 490, N + 499), eqPred(2, (N + 495) % 7)});
+        assert(tail.size() == 1 && t.fetchTypedRow(tail[0])[1]->u32 == N + 495);
+        assert(t.whereAnd({betweenPred(1, N + 500, N + 900), eqPred(2, 1)}).empty());
+
+        t.createBitmapIndex(2);
+        assert(t.whereAnd(all) == wantAnd);
+        assert(t.whereOr(any) == wantOr);
+        t.createIndex(0);
+        assert(t.whereAnd(all) == wantAnd);
+        assert(t.whereOr(any) == wantOr);
+
+        removeTableFiles("compound_fused");
+        for (const char* suffix : {".mdb.3.str", ".mdb.2.bmp", ".mdb.0.bpt"})
+            std::remove((std::string("compound_fused") + suffix).c_str());
+    }
+
     std::puts("test_compound_where: passed");
     return 0;
 }
@@ -0,0 +1,138 @@
+#include "../Engine.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t kWalHeader = 32;
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c)
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+}
+
+void testWalPeriodicSync() {
+    const std::string base = "/tmp/sync_wal";
+    cleanup(base, 0);
+    Wal wal(base + ".mdb");
+    wal.openOrCreate(true);
+    bool threw = false;
+    try { wal.setSyncInterval(std::chrono::milliseconds(-1)); } catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+
+    wal.setSyncInterval(std::chrono::milliseconds(10));
+    assert(wal.syncInterval() == std::chrono::milliseconds(10));
+    wal.awaitDurable(wal.appendCommit(wal.appendDelete(0)));  // does not wait
+    for (int i = 0; i < 200 && wal.syncCount() == 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    assert(wal.syncCount() >= 1);
+
+    // Group commit takes over from the same thread and hands back.
+    wal.setGroupCommit(true);
+    const uint64_t before = wal.syncCount();
+    wal.awaitDurable(wal.appendCommit(wal.appendDelete(1)));
+    assert(wal.syncCount() > before);
+    wal.setGroupCommit(false);
+    wal.setSyncInterval(std::chrono::milliseconds(0));
+    const uint64_t idle = wal.syncCount();
+    wal.appendCommit(wal.appendDelete(2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    assert(wal.syncCount() == idle);
+    assert(wal.committedOperations().size() == 3);
+    cleanup(base, 0);
+}
+
+void testTableLevels() {
+    const std::string base = "/tmp/sync_table";
+    cleanup(base, 2);
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING});
+        t.setUseGPU(false);
+        assert(t.durability() == Table::Durability::Normal);
+        t.insertTypedRow({ColValue(0u), ColValue(std::string("logged"))});
+        assert(t.walBytes() > kWalHeader);
+
+        // Entering Off checkpoints; nothing written while off reaches the WAL.
+        t.setDurability(Table::Durability::Off);
+        assert(t.walBytes() == kWalHeader);
+        for (uint32_t i = 1; i < 100; ++i)
+            t.insertTypedRow({ColValue(i), ColValue("bulk" + std::to_string(i))});
+        t.deleteRow(50);
+        t.begin();
+        t.insertTypedRow({ColValue(100u), ColValue(std::string("txn"))});
+        t.commit();
+        assert(t.walBytes() == kWalHeader);
+
+        t.setDurability(Table::Durability::Full);
+        assert(t.groupCommit());
+        t.insertTypedRow({ColValue(101u), ColValue(std::string("synced"))});
+        assert(t.walBytes() > kWalHeader);
+        t.setGroupCommit(false);
+        assert(t.durability() == Table::Durability::Normal);
+    }
+    {
+        // The Off rows came from the checkpoint on leaving Off, the last one
+        // from WAL replay.
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.liveRows() == 101);
+        assert(t.scanEquals(0, 50).empty());
+        assert(t.scanEquals(0, 100) == std::vector<uint32_t>{100});
+        assert(t.fetchTypedRow(101)[1]->str == "synced");
+
+        // A table closed while Off checkpoints on the way out.
+        t.setDurability(Table::Durability::Off);
+        t.insertTypedRow({ColValue(102u), ColValue(std::string("last"))});
+    }
+    {
+        Table t(base + ".mdb");
+        assert(t.liveRows() == 102);
+        assert(t.fetchTypedRow(102)[1]->str == "last");
+    }
+    cleanup(base, 2);
+}
+
+void testEngineDefault() {
+    const std::string a = "/tmp/sync_engine_a";
+    const std::string b = "/tmp/sync_engine_b";
+    cleanup(a, 2);
+    cleanup(b, 2);
+    Engine engine;
+    engine.createTable(a, 2);
+    engine.setDurability(Table::Durability::Full);
+    assert(engine.durability() == Table::Durability::Full);
+    assert(engine.openTable(a).durability() == Table::Durability::Full);
+    engine.createTable(b, 2);
+    assert(engine.openTable(b).durability() == Table::Durability::Full);
+    engine.setDurability(b, Table::Durability::Off);
+    assert(engine.openTable(a).durability() == Table::Durability::Full);
+    assert(engine.openTable(b).durability() == Table::Durability::Off);
+    engine.insert(a, {1, 2});
+    engine.insert(b, {3, 4});
+    assert(engine.whereEq(b, 0, 3).size() == 1);
+    cleanup(a, 2);
+    cleanup(b, 2);
+}
+
+} // namespace
+
+int main() {
+    testWalPeriodicSync();
+    testTableLevels();
+    testEngineDefault();
+    std::puts("test_durability: passed");
+    return 0;
+}
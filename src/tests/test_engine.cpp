@@ -1,7 +1,17 @@
 #include "../Engine.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <unistd.h>
 #include <cstdio>
+#include <string>
+
+// <name>.mdb, its row index and every WAL segment.
+static void removeTableFiles(const std::string& name) {
+    for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal"})
+        std::remove((name + suffix).c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((name + ".mdb.wal." + std::to_string(slot)).c_str());
+}
 
 int main() {
     Engine e;
@@ -56,9 +66,9 @@ int main() {
     auto pairs = e.join("eng_A", 0, "eng_B", 0);
     assert(!pairs.empty());
 
-    std::remove("eng_tbl.mdb");  std::remove("eng_tbl.mdb.idx");
-    std::remove("eng_A.mdb");    std::remove("eng_A.mdb.idx");
-    std::remove("eng_B.mdb");    std::remove("eng_B.mdb.idx");
+    removeTableFiles("eng_tbl");
+    removeTableFiles("eng_A");
+    removeTableFiles("eng_B");
     std::puts("test_engine: passed");
     return 0;
 }
@@ -1,6 +1,7 @@
 // tests/test_gpu_scan_equals.cpp
 #include "../Table.hpp"
 #include "../ValueTypes.hpp"
+#include "../Wal.hpp"
 
 #include <cassert>
 #include <iostream>
@@ -113,6 +114,9 @@ CLEANUP:
     std::cerr << "[TEST] unlink files\n";
     unlink(tmpl);
     unlink(idxPath.c_str());
+    unlink((std::string(tmpl) + ".wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        unlink((std::string(tmpl) + ".wal." + std::to_string(slot)).c_str());
     std::cerr << "[TEST] done\n";
     return 0;
 }
\ No newline at end of file
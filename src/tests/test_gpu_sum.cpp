@@ -1,6 +1,7 @@
 // tests/test_gpu_sum.cpp
 #include "../Table.hpp"
 #include "../ValueTypes.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <iostream>
 #include <unistd.h>
@@ -44,6 +45,9 @@ int main() {
     std::cout << "[TEST] unlink files\n";
     unlink(tmpl);
     unlink(idx.c_str());
+    unlink((std::string(tmpl) + ".wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        unlink((std::string(tmpl) + ".wal." + std::to_string(slot)).c_str());
     std::cout << "[TEST] done\n";
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "../Engine.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".hidx").c_str());
+    }
+}
+
+void testWalEpochs() {
+    const std::string base = "/tmp/gc_wal";
+    cleanup(base, 0);
+    Wal wal(base + ".mdb");
+    wal.openOrCreate(true);
+    // Without group commit, awaitDurable returns immediately.
+    const uint64_t first = wal.appendCommit(wal.appendDelete(0));
+    wal.awaitDurable(first);
+    assert(wal.syncCount() == 0);
+
+    wal.setGroupCommit(true);
+    assert(wal.groupCommit());
+    const uint64_t second = wal.appendCommit(wal.appendDelete(1));
+    assert(second == first + 1);
+    wal.awaitDurable(second);
+    assert(wal.syncCount() >= 1);
+    wal.setGroupCommit(false);
+    assert(!wal.groupCommit());
+
+    // Commits already pending when the sync thread starts share one sync.
+    uint64_t last = 0;
+    for (uint32_t i = 0; i < 50; ++i)
+        last = wal.appendCommit(wal.appendDelete(i));
+    const uint64_t before = wal.syncCount();
+    wal.setGroupCommit(true);
+    wal.awaitDurable(last);
+    assert(wal.syncCount() == before + 1);
+    wal.setGroupCommit(false);
+    assert(wal.committedOperations().size() == 52);
+    cleanup(base, 0);
+}
+
+void testConcurrentWriters() {
+    const std::string base = "/tmp/gc_table";
+    cleanup(base, 2);
+    const unsigned kThreads = 8;
+    const uint32_t kPerThread = 250;
+    std::vector<std::vector<uint32_t>> rowIDs(kThreads);
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING});
+        t.createHashIndex(0);
+        t.setGroupCommit(true);
+        assert(t.groupCommit());
+
+        std::vector<std::thread> writers;
+        for (unsigned w = 0; w < kThreads; ++w) {
+            writers.emplace_back([&, w] {
+                for (uint32_t i = 0; i < kPerThread; ++i) {
+                    const uint32_t key = w * kPerThread + i;
+                    rowIDs[w].push_back(t.insertTypedRow({ColValue(key), ColValue("v" + std::to_string(key))}));
+                }
+            });
+        }
+        for (auto& th : writers) th.join();
+
+        std::vector<uint32_t> all;
+        for (const auto& ids : rowIDs) all.insert(all.end(), ids.begin(), ids.end());
+        std::sort(all.begin(), all.end());
+        assert(all.size() == kThreads * kPerThread);
+        assert(std::adjacent_find(all.begin(), all.end()) == all.end());
+        assert(t.liveRows() == kThreads * kPerThread);
+        for (unsigned w = 0; w < kThreads; ++w)
+            for (uint32_t i = 0; i < kPerThread; i += 50) {
+                auto row = t.fetchTypedRow(rowIDs[w][i]);
+                assert(row[0]->u32 == w * kPerThread + i);
+                assert((t.scanEquals(0, w * kPerThread + i) == std::vector<uint32_t>{rowIDs[w][i]}));
+            }
+
+        // A delete also waits for its commit; nothing is checkpointed, so the
+        // rows below only survive through the WAL.
+        t.deleteRow(rowIDs[0][0]);
+    }
+    {
+        Table t(base + ".mdb");
+        assert(!t.groupCommit());
+        assert(t.liveRows() == kThreads * kPerThread - 1);
+        assert(t.scanEquals(0, 0).empty());
+        assert((t.scanEquals(0, kThreads * kPerThread - 1) == std::vector<uint32_t>{rowIDs[kThreads - 1].back()}));
+    }
+    cleanup(base, 2);
+}
+
+void testEngineToggle() {
+    const std::string base = "/tmp/gc_engine";
+    cleanup(base, 2);
+    Engine engine;
+    engine.createTable(base, 2);
+    engine.setGroupCommit(base, true);
+    assert(engine.openTable(base).groupCommit());
+    engine.insert(base, {1, 2});
+    engine.flush(base);
+    engine.setGroupCommit(base, false);
+    assert(engine.whereEq(base, 0, 1).size() == 1);
+    cleanup(base, 2);
+}
+
+} // namespace
+
+int main() {
+    testWalEpochs();
+    testConcurrentWriters();
+    testEngineToggle();
+    std::puts("test_group_commit: passed");
+    return 0;
+}
@@ -1,9 +1,19 @@
 #include "../Engine.hpp"
 #include "../GroupBy.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <cstdio>
 #include <cmath>
 #include <chrono>
+#include <string>
+
+// <name>.mdb, its row index and every WAL segment.
+static void removeTableFiles(const std::string& name) {
+    for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal"})
+        std::remove((name + suffix).c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((name + ".mdb.wal." + std::to_string(slot)).c_str());
+}
 
 int main() {
     // ── Small dataset: correctness of all aggregations ────────────────────────
@@ -35,8 +45,7 @@ int main() {
         assert(mn[0] == 0);
         assert(mx[0] == 995);
 
-        std::remove("gb_tbl.mdb");
-        std::remove("gb_tbl.mdb.idx");
+        removeTableFiles("gb_tbl");
     }
 
     // ── Large dataset: CPU vs GPU path agreement ──────────────────────────────
@@ -85,8 +94,7 @@ int main() {
         std::printf("  GPU group-by (%u rows, %u keys): cold=%.2f ms  hot=%.2f ms\n",
                     N, KEYS, msCold, msHot);
 
-        std::remove("gb_large.mdb");
-        std::remove("gb_large.mdb.idx");
+        removeTableFiles("gb_large");
     }
 
     std::puts("test_groupby: passed");
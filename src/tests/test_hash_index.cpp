@@ -0,0 +1,237 @@
+#include "../Engine.hpp"
+#include "../HashIndex.hpp"
+#include "../MiniSQL.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".hidx").c_str());
+    }
+}
+
+std::vector<uint32_t> sorted(std::vector<uint32_t> v) {
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+void testHashAgainstReference() {
+    const std::string path = "/tmp/hash_raw.hidx";
+    std::remove(path.c_str());
+    std::map<uint64_t, std::vector<uint32_t>> ref;
+    std::mt19937 rng(7);
+    uint32_t buckets = 0;
+
+    {
+        HashIndex hash(path);
+        hash.openOrCreate(/*create=*/true);
+        for (uint32_t rowID = 0; rowID < 200000; ++rowID) {
+            const uint64_t key = rng() % 50000;
+            assert(hash.insert(key, rowID));
+            ref[key].push_back(rowID);
+        }
+        assert(!hash.insert(ref.begin()->first, ref.begin()->second.front()));
+        assert(hash.size() == 200000);
+        assert(hash.bucketCount() > 4);
+
+        // Drop every row of every tenth key.
+        for (auto& [key, rows] : ref) {
+            if (key % 10 != 0) continue;
+            for (uint32_t rowID : rows) assert(hash.erase(key, rowID));
+            rows.clear();
+        }
+        assert(!hash.erase(10, 1u << 30));
+        buckets = hash.bucketCount();
+        hash.sync();
+    }
+    {
+        HashIndex hash(path);
+        hash.openOrCreate(/*create=*/false);
+        assert(hash.bucketCount() == buckets);
+        for (const auto& [key, rows] : ref)
+            assert(sorted(hash.lookup(key)) == rows);
+        assert(hash.lookup(999999).empty());
+
+        // Still splits correctly after reopen.
+        for (uint32_t rowID = 200000; rowID < 260000; ++rowID) {
+            const uint64_t key = rowID;
+            assert(hash.insert(key, rowID));
+        }
+        assert(hash.bucketCount() > buckets);
+        for (uint32_t rowID = 200000; rowID < 260000; rowID += 997)
+            assert((hash.lookup(rowID) == std::vector<uint32_t>{rowID}));
+        assert(sorted(hash.lookup(ref.rbegin()->first)) == ref.rbegin()->second);
+    }
+    std::remove(path.c_str());
+}
+
+void testTableHashIndex() {
+    const std::string base = "/tmp/hash_table";
+    cleanup(base, 3);
+    const std::vector<ColType> types = {ColType::UINT32, ColType::STRING, ColType::FLOAT};
+    {
+        Table t(base + ".mdb", 4096, types);
+        t.setUseGPU(false);
+        for (uint32_t i = 0; i < 2000; ++i)
+            t.insertTypedRow({ColValue(i), ColValue("user" + std::to_string(i % 100)), ColValue(float(i))});
+
+        t.createHashIndex(0);
+        t.createHashIndex(1);
+        assert(t.hasHashIndex(0) && t.hasHashIndex(1));
+        assert(::access((base + ".mdb.1.hidx").c_str(), F_OK) == 0);
+
+        bool threw = false;
+        try { t.createHashIndex(2); } catch (const std::invalid_argument&) { threw = true; }
+        assert(threw);
+
+        assert((t.scanEquals(0, 1234) == std::vector<uint32_t>{1234}));
+        assert(t.scanEquals(0, 5000).empty());
+        auto hits = t.scanEqualsString(1, "user42");
+        assert(hits.size() == 20 && hits.front() == 42 && hits.back() == 1942);
+        assert(std::is_sorted(hits.begin(), hits.end()));
+        assert(t.scanEqualsString(1, "nobody").empty());
+
+        // Maintenance.
+        t.deleteRow(42);
+        const uint32_t rid = t.insertTypedRow({ColValue(uint32_t(1234)), ColValue(std::string("user42")),
+                                               ColValue(0.0f)});
+        assert((t.scanEquals(0, 1234) == std::vector<uint32_t>{1234, rid}));
+        hits = t.scanEqualsString(1, "user42");
+        assert(hits.size() == 20 && hits.front() == 142 && hits.back() == rid);
+
+        // Compound predicates go through the same paths.
+        Predicate byID;
+        byID.kind = Predicate::Kind::EQ;
+        byID.colIdx = 0;
+        byID.lo = 1234;
+        Predicate byName;
+        byName.kind = Predicate::Kind::EQ_STRING;
+        byName.colIdx = 1;
+        byName.needle = "user34";
+        assert((t.whereAnd({byID, byName}) == std::vector<uint32_t>{1234}));
+        t.flushDurable();
+
+        // WAL-only changes are picked up by the rebuild on reopen.
+        t.insertTypedRow({ColValue(uint32_t(7777)), ColValue(std::string("late")), ColValue(1.0f)});
+        t.deleteRow(1234);
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.hasHashIndex(0) && t.hasHashIndex(1));
+        assert((t.scanEquals(0, 7777) == std::vector<uint32_t>{2001}));
+        assert((t.scanEquals(0, 1234) == std::vector<uint32_t>{2000}));
+        assert((t.scanEqualsString(1, "late") == std::vector<uint32_t>{2001}));
+
+        const auto remap = t.compact();
+        assert((t.scanEquals(0, 7777) == std::vector<uint32_t>{remap[2001]}));
+        assert(t.scanEqualsString(1, "user42").size() == 20);
+
+        t.dropHashIndex(1);
+        assert(!t.hasHashIndex(1));
+        assert(::access((base + ".mdb.1.hidx").c_str(), F_OK) != 0);
+        assert(t.scanEqualsString(1, "user42").size() == 20);
+    }
+    cleanup(base, 3);
+}
+
+void testCreateHashIndexSQL() {
+    const std::string base = "/tmp/hash_sql";
+    cleanup(base, 2);
+    Engine engine;
+    Table& t = engine.createTable(base, 2);
+    for (uint32_t i = 0; i < 300; ++i) t.insertRow({i, i * 2});
+
+    executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c0) USING HASH;");
+    assert(t.hasHashIndex(0) && !t.hasIndex(0));
+    auto result = executeMiniSQL(engine, "SELECT * FROM '" + base + "' WHERE c0 = 150");
+    assert(result.rows.size() == 1 && result.rows[0][1] == "300");
+
+    executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c1) USING BTREE");
+    assert(t.hasIndex(1) && !t.hasHashIndex(1));
+
+    bool threw = false;
+    try { executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c0) USING GIST"); }
+    catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+    cleanup(base, 2);
+    std::remove((base + ".mdb.1.bpt").c_str());
+}
+
+void copyFile(const std::string& from, const std::string& to) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+    assert(in && out);
+}
+
+// Index files are written through while the log's tail may be lost in an OS
+// crash: the indexes then name a row that was never recovered.
+void testIndexAheadOfLog() {
+    const std::string base = "/tmp/hash_ahead";
+    cleanup(base, 2);
+    std::remove((base + ".mdb.1.bpt").c_str());
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32, ColType::UINT32});
+        t.createHashIndex(0);
+        t.createIndex(1);
+        for (uint32_t i = 0; i < 100; ++i) t.insertTypedRow({ColValue(i), ColValue(i)});
+        t.flushDurable();
+    }
+    copyFile(base + ".mdb.wal", base + ".mdb.wal.saved");
+    const pid_t pid = ::fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        Table t(base + ".mdb");
+        t.insertTypedRow({ColValue(500u), ColValue(500u)});
+        std::_Exit(0);
+    }
+    int status = 0;
+    assert(::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    copyFile(base + ".mdb.wal.saved", base + ".mdb.wal");  // the insert never reached the disk
+    std::remove((base + ".mdb.wal.saved").c_str());
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.rowsRecorded() == 100);
+        assert(t.scanEquals(0, 500).empty() && t.whereBetween(1, 500, 500).empty());
+        // Its rowID goes to another row.
+        assert(t.insertTypedRow({ColValue(7u), ColValue(7u)}) == 100);
+        assert(t.scanEquals(0, 500).empty() && t.whereBetween(1, 500, 500).empty());
+        assert(t.scanEquals(0, 7) == std::vector<uint32_t>({7, 100}));
+        assert(t.whereBetween(1, 7, 7) == std::vector<uint32_t>({7, 100}));
+    }
+    cleanup(base, 2);
+    std::remove((base + ".mdb.1.bpt").c_str());
+}
+
+} // namespace
+
+int main() {
+    testHashAgainstReference();
+    testTableHashIndex();
+    testCreateHashIndexSQL();
+    testIndexAheadOfLog();
+    std::puts("test_hash_index: passed");
+    return 0;
+}
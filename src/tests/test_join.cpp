@@ -1,7 +1,17 @@
 #include "../Engine.hpp"
 #include "../Join.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <cstdio>
+#include <string>
+
+// <name>.mdb, its row index and every WAL segment.
+static void removeTableFiles(const std::string& name) {
+    for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal"})
+        std::remove((name + suffix).c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((name + ".mdb.wal." + std::to_string(slot)).c_str());
+}
 
 int main() {
     Engine e;
@@ -14,8 +24,8 @@ int main() {
     auto pairs = Join::hashJoinEq(A, 0, B, 0); // join on col0
     assert(!pairs.empty());
 
-    std::remove("A.mdb"); std::remove("A.mdb.idx");
-    std::remove("B.mdb"); std::remove("B.mdb.idx");
+    removeTableFiles("A");
+    removeTableFiles("B");
     std::puts("test_join: passed");
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "../Engine.hpp"
 #include "../MiniSQL.hpp"
+#include "../Wal.hpp"
 
 #include <array>
 #include <cassert>
@@ -162,19 +163,12 @@ int main() {
         assert(row[0] && row[0]->u32 == 77);
     }
 
-    std::remove("/tmp/sql_main.mdb");
-    std::remove("/tmp/sql_main.mdb.idx");
-    std::remove("/tmp/sql_main.mdb.wal");
-    std::remove("/tmp/sql_main.mdb.2.str");
-    std::remove("/tmp/sql_typed.mdb");
-    std::remove("/tmp/sql_typed.mdb.idx");
-    std::remove("/tmp/sql_typed.mdb.wal");
-    std::remove("/tmp/sql_cli.mdb");
-    std::remove("/tmp/sql_cli.mdb.idx");
-    std::remove("/tmp/sql_cli.mdb.wal");
-    std::remove("/tmp/sql_flush.mdb");
-    std::remove("/tmp/sql_flush.mdb.idx");
-    std::remove("/tmp/sql_flush.mdb.wal");
+    for (const std::string base : {"/tmp/sql_main", "/tmp/sql_typed", "/tmp/sql_cli", "/tmp/sql_flush"}) {
+        for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal", ".mdb.2.str"})
+            std::remove((base + suffix).c_str());
+        for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+            std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    }
 
     std::puts("test_mini_sql: passed");
     return 0;
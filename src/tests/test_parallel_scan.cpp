@@ -0,0 +1,131 @@
+#include "../Engine.hpp"
+#include "../ThreadPool.hpp"
+#include "../Wal.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void testPool() {
+    for (size_t threads : {1, 2, 4, 7}) {
+        ThreadPool pool(threads);
+        assert(pool.size() == threads);
+        for (size_t morsels : {0, 1, 3, 64, 1000}) {
+            // Uneven work, so finished workers have something to steal.
+            std::vector<std::atomic<int>> runs(morsels);
+            std::vector<std::atomic<int>> byWorker(threads);
+            pool.run(morsels, [&](size_t m, size_t w) {
+                assert(w < threads);
+                if (m % 17 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+                ++runs[m];
+                ++byWorker[w];
+            });
+            for (auto& r : runs) assert(r == 1);
+        }
+
+        bool threw = false;
+        std::atomic<int> ran{0};
+        try {
+            pool.run(100, [&](size_t m, size_t) {
+                ++ran;
+                if (m == 10) throw std::runtime_error("morsel failed");
+            });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && ran >= 1);
+
+        // A job started from a job runs inline; the pool is usable afterwards.
+        std::atomic<int> inner{0};
+        pool.run(8, [&](size_t, size_t) { pool.run(5, [&](size_t, size_t) { ++inner; }); });
+        assert(inner == 40);
+    }
+}
+
+void cleanup(const std::string& base) {
+    for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal", ".mdb.1.str"})
+        std::remove((base + suffix).c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+}
+
+struct Results {
+    std::vector<uint32_t> eq, range, str, prefix;
+    std::vector<ValueType> values;
+    ValueType sum, sumDouble;
+
+    bool operator==(const Results& o) const {
+        // Same rows, in the same (rowID) order.
+        return eq == o.eq && range == o.range && str == o.str && prefix == o.prefix && values == o.values &&
+               sum == o.sum && sumDouble == o.sumDouble;
+    }
+};
+
+Results runAll(Table& t) {
+    Results r;
+    r.eq = t.scanEquals(0, 123);
+    r.range = t.whereBetween(0, 100, 350);
+    r.str = t.scanEqualsString(1, "s7");
+    r.prefix = t.scanPrefixString(1, "s1");
+    r.values = t.materializeColumn(0);
+    r.sum = t.sumColumn(0);
+    r.sumDouble = t.sumColumn(2);
+    return r;
+}
+
+void testScans() {
+    const std::string name = "/tmp/par_scan";
+    cleanup(name);
+    Results serial;
+    {
+        Engine e;
+        auto& t = e.createTypedTable(name, {ColType::UINT32, ColType::STRING, ColType::DOUBLE});
+        t.setDurability(Table::Durability::Off);
+        t.setUseGPU(false);
+        constexpr uint32_t N = 300'000;
+        auto row = [](uint32_t i) {
+            return std::vector<ColValue>{ColValue(i % 1000), ColValue("s" + std::to_string(i % 29)),
+                                         ColValue(i * 0.5)};
+        };
+        for (uint32_t i = 0; i < N; ++i) t.insertTypedRow(row(i));
+        for (uint32_t i = 0; i < N; i += 11) t.deleteRow(i);
+        for (uint32_t i = N; i < N + 1000; ++i) t.insertTypedRow(row(i));  // reuses freed slots
+
+        e.setParallelism(1);
+        assert(e.parallelism() == 1);
+        serial = runAll(t);
+        assert(serial.values.size() == t.liveRows());
+        assert(!serial.eq.empty() && !serial.range.empty() && !serial.str.empty() && !serial.prefix.empty());
+
+        for (size_t threads : {2, 3, 4, 8}) {
+            e.setParallelism(threads);
+            assert(e.parallelism() == threads);
+            assert(runAll(t) == serial);
+        }
+    }
+    for (size_t threads : {2, 4, 8}) {
+        // Reopened: the workers fault the pages into the cache themselves.
+        Engine e;
+        e.setParallelism(threads);
+        auto& t = e.openTable(name);
+        t.setUseGPU(false);
+        assert(runAll(t) == serial);
+    }
+    cleanup(name);
+}
+
+} // namespace
+
+int main() {
+    testPool();
+    testScans();
+    std::puts("test_parallel_scan: passed");
+    return 0;
+}
@@ -1,6 +1,7 @@
 // tests/test_persist_pages.cpp
 #include "../Table.hpp"
 #include "../ValueTypes.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <iostream>
 #include <unistd.h>
@@ -53,6 +54,9 @@ int main() {
 
     unlink(tmpl);
     unlink(idx.c_str());
+    unlink((std::string(tmpl) + ".wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        unlink((std::string(tmpl) + ".wal." + std::to_string(slot)).c_str());
 
     std::cout << "test_persist_pages: passed (page I/O persists)\n";
     return 0;
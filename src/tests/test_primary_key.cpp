@@ -0,0 +1,170 @@
+#include "../Engine.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".hidx").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".bpt").c_str());
+    }
+}
+
+template <typename Fn>
+bool throwsInvalid(Fn fn) {
+    try { fn(); } catch (const std::invalid_argument&) { return true; }
+    return false;
+}
+
+void testStringKey() {
+    const std::string base = "/tmp/pk_string";
+    cleanup(base, 2);
+    const std::vector<ColType> types = {ColType::STRING, ColType::UINT32};
+    {
+        Table t(base + ".mdb", 4096, types);
+        for (uint32_t i = 0; i < 1000; ++i)
+            t.insertTypedRow({ColValue("user" + std::to_string(i)), ColValue(i)});
+        assert(!t.primaryKey());
+        assert(throwsInvalid([&] { t.findByKey(ColValue(std::string("user1"))); }));
+
+        t.setPrimaryKey(0);
+        assert(t.primaryKey() == uint16_t(0) && t.hasHashIndex(0));
+        assert(throwsInvalid([&] { t.setPrimaryKey(1); }));
+        assert(throwsInvalid([&] { t.dropHashIndex(0); }));
+
+        assert(t.findByKey(ColValue(std::string("user512"))) == 512u);
+        assert(!t.findByKey(ColValue(std::string("nobody"))));
+        assert(throwsInvalid([&] { t.findByKey(ColValue(uint32_t(5))); }));
+        assert(throwsInvalid([&] { t.insertTypedRow({ColValue(std::string("user7")), ColValue(0u)}); }));
+        assert(t.liveRows() == 1000);
+
+        // Upsert replaces the keyed row and inserts unknown keys.
+        const uint32_t rid = t.upsertTypedRow({ColValue(std::string("user7")), ColValue(70000u)});
+        assert(rid == 1000 && t.findByKey(ColValue(std::string("user7"))) == rid);
+        assert(t.fetchTypedRow(rid)[1]->u32 == 70000u);
+        assert(!t.fetchTypedRow(7)[0]);
+        assert(t.upsertTypedRow({ColValue(std::string("new")), ColValue(1u)}) == 1001);
+        assert(t.liveRows() == 1001);
+        t.flushDurable();
+
+        // WAL-only change, replayed on reopen.
+        t.deleteRow(512);
+    }
+    {
+        Table t(base + ".mdb");
+        assert(t.primaryKey() == uint16_t(0));
+        assert(!t.findByKey(ColValue(std::string("user512"))));
+        assert(t.findByKey(ColValue(std::string("new"))) == 1001u);
+        // The key slot is free again after a delete.
+        t.insertTypedRow({ColValue(std::string("user512")), ColValue(5u)});
+
+        const auto remap = t.compact();
+        assert(t.findByKey(ColValue(std::string("new"))) == remap[1001]);
+    }
+    {
+        // A missing key index is rebuilt on open.
+        ::unlink((base + ".mdb.0.hidx").c_str());
+        Table t(base + ".mdb");
+        assert(t.hasHashIndex(0));
+        assert(t.findByKey(ColValue(std::string("user999"))));
+    }
+    cleanup(base, 2);
+}
+
+void testNumericKey() {
+    const std::string base = "/tmp/pk_int64";
+    cleanup(base, 2);
+    Table t(base + ".mdb", 4096, {ColType::INT64, ColType::UINT32});
+    for (int64_t i = 0; i < 500; ++i)
+        t.insertTypedRow({ColValue(i * -3), ColValue(uint32_t(i))});
+    t.insertTypedRow({ColValue(int64_t(-3)), ColValue(0u)});
+    assert(throwsInvalid([&] { t.setPrimaryKey(0); }));  // -3 appears twice
+    assert(!t.primaryKey() && !t.hasIndex(0));
+
+    t.deleteRow(500);
+    t.setPrimaryKey(0);
+    assert(t.hasIndex(0));
+    assert(throwsInvalid([&] { t.dropIndex(0); }));
+    assert(t.findByKey(ColValue(int64_t(-300))) == 100u);
+    assert(!t.findByKey(ColValue(int64_t(1))));
+    t.upsertTypedRow({ColValue(int64_t(-300)), ColValue(9u)});
+    assert(t.fetchTypedRow(*t.findByKey(ColValue(int64_t(-300))))[1]->u32 == 9u);
+    cleanup(base, 2);
+}
+
+// Upserts key 1 over an existing row and returns where the log ends.
+uint64_t writeUpsert(const std::string& base) {
+    Table t(base + ".mdb", 4096, {ColType::UINT32, ColType::UINT32});
+    t.setPrimaryKey(0);
+    t.insertTypedRow({ColValue(1u), ColValue(10u)});
+    t.insertTypedRow({ColValue(2u), ColValue(20u)});
+    t.flushDurable();
+    assert(t.upsertTypedRow({ColValue(1u), ColValue(11u)}) == 2);
+    return t.walBytes();
+}
+
+void testUpsertReplay() {
+    const std::string base = "/tmp/pk_upsert_wal";
+    cleanup(base, 2);
+    writeUpsert(base);
+    {
+        Table t(base + ".mdb");  // replayed from the WAL
+        assert(t.liveRows() == 2 && t.findByKey(ColValue(1u)) == 2u);
+        assert(t.fetchTypedRow(2)[1]->u32 == 11u && !t.fetchTypedRow(0)[0]);
+    }
+    cleanup(base, 2);
+
+    // Tear the end of the log, as if the process died mid-write: neither the
+    // delete nor the insert is replayed.
+    const uint64_t logEnd = writeUpsert(base);
+    const int fd = ::open((base + ".mdb.wal").c_str(), O_WRONLY);
+    const uint32_t torn = 0xDEADBEEF;
+    assert(::pwrite(fd, &torn, sizeof(torn), off_t(logEnd) - 4) == ssize_t(sizeof(torn)));
+    ::close(fd);
+    {
+        Table t(base + ".mdb");
+        assert(t.liveRows() == 2 && t.rowsRecorded() == 2);
+        assert(t.findByKey(ColValue(1u)) == 0u && t.fetchTypedRow(0)[1]->u32 == 10u);
+    }
+    cleanup(base, 2);
+}
+
+void testEngineAPI() {
+    const std::string base = "/tmp/pk_engine";
+    cleanup(base, 2);
+    Engine engine;
+    engine.createTable(base, 2);
+    engine.insert(base, {10, 100});
+    engine.setPrimaryKey(base, 0);
+    assert(engine.getByKey(base, ColValue(10u)) == 0u);
+    assert(engine.upsert(base, {ColValue(10u), ColValue(200u)}) == 1);
+    assert(engine.whereEq(base, 1, 200).size() == 1);
+    assert(!engine.getByKey(base, ColValue(11u)));
+    cleanup(base, 2);
+}
+
+} // namespace
+
+int main() {
+    testStringKey();
+    testNumericKey();
+    testUpsertReplay();
+    testEngineAPI();
+    std::puts("test_primary_key: passed");
+    return 0;
+}
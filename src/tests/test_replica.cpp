@@ -0,0 +1,214 @@
+#include "../Engine.hpp"
+#include "../MiniSQL.hpp"
+#include "../Replica.hpp"
+#include "../Table.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles + 2; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".hidx").c_str());
+    }
+}
+
+std::vector<ColValue> row(uint32_t i) {
+    return {ColValue(i), ColValue("name-" + std::to_string(i % 10))};
+}
+
+// Same rows, same values, same rowIDs.
+void assertSameRows(Table& primary, Table& copy) {
+    assert(copy.rowsRecorded() == primary.rowsRecorded());
+    assert(copy.liveRows() == primary.liveRows());
+    for (uint32_t id = 0; id < primary.rowsRecorded(); ++id) {
+        const auto want = primary.fetchTypedRow(id);
+        const auto got = copy.fetchTypedRow(id);
+        assert(bool(want[0]) == bool(got[0]));
+        if (!want[0]) continue;
+        assert(got[0]->u32 == want[0]->u32 && got[1]->str == want[1]->str);
+    }
+}
+
+void testFollowsCommits() {
+    const std::string base = "/tmp/replica_follow";
+    const std::string copy = "/tmp/replica_follow_copy";
+    cleanup(base, 2);
+    cleanup(copy, 2);
+    Table primary(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING});
+    primary.setUseGPU(false);
+    primary.createHashIndex(1);
+    for (uint32_t i = 0; i < 2000; ++i) primary.insertTypedRow(row(i));
+    primary.flushDurable();
+    for (uint32_t i = 2000; i < 2500; ++i) primary.insertTypedRow(row(i));
+
+    // The copy is the checkpointed table plus the live WAL, indexes rebuilt.
+    Replica replica(base + ".mdb", copy + ".mdb");
+    assert(replica.poll());
+    {
+        const auto lock = replica.lock();
+        auto table = replica.table();
+        table->setUseGPU(false);
+        assertSameRows(primary, *table);
+        assert(table->hasHashIndex(1));
+        assert(table->scanEqualsString(1, "name-3").size() == 250);
+    }
+
+    // Autocommit writes, deletes and a transaction, across a checkpoint the
+    // replica had kept up with.
+    for (uint32_t i = 2500; i < 3000; ++i) primary.insertTypedRow(row(i));
+    for (uint32_t id = 0; id < 3000; id += 7) primary.deleteRow(id);
+    assert(replica.poll());
+    primary.flushDurable();
+    primary.begin();
+    for (uint32_t i = 3000; i < 3100; ++i) primary.insertTypedRow(row(i));
+    primary.deleteRow(2999);
+    assert(replica.poll());
+    assert(replica.table()->rowsRecorded() == 3000);  // not committed yet
+    primary.commit();
+    assert(replica.poll());
+    {
+        const auto lock = replica.lock();
+        assertSameRows(primary, *replica.table());
+        assert(replica.table()->scanEqualsString(1, "name-3").size() ==
+               primary.scanEqualsString(1, "name-3").size());
+    }
+    assert(replica.resyncs() == 0);
+    cleanup(base, 2);
+    cleanup(copy, 2);
+}
+
+void testResync() {
+    const std::string base = "/tmp/replica_resync";
+    const std::string copy = "/tmp/replica_resync_copy";
+    cleanup(base, 2);
+    cleanup(copy, 2);
+    Table primary(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING});
+    primary.setUseGPU(false);
+    for (uint32_t i = 0; i < 500; ++i) primary.insertTypedRow(row(i));
+    Replica replica(base + ".mdb", copy + ".mdb");
+
+    // A checkpoint retires records the replica never read: it copies again.
+    for (uint32_t i = 500; i < 1000; ++i) primary.insertTypedRow(row(i));
+    primary.flushDurable();
+    assert(!replica.poll());
+    assert(replica.resyncs() == 1);
+    assertSameRows(primary, *replica.table());
+
+    // Compaction renumbers rows outside the log, which rebases it.
+    for (uint32_t id = 0; id < 1000; id += 2) primary.deleteRow(id);
+    assert(replica.poll());
+    primary.compact();
+    primary.insertTypedRow(row(1000));
+    assert(!replica.poll());
+    assert(replica.resyncs() == 2);
+    assert(replica.table()->rowsRecorded() == 501);
+    assertSameRows(primary, *replica.table());
+
+    // Background polling.
+    replica.follow(5ms);
+    for (uint32_t i = 1001; i < 1100; ++i) primary.insertTypedRow(row(i));
+    bool caughtUp = false;
+    for (int i = 0; i < 500 && !caughtUp; ++i) {
+        std::this_thread::sleep_for(5ms);
+        const auto lock = replica.lock();
+        caughtUp = replica.table()->rowsRecorded() == primary.rowsRecorded();
+    }
+    assert(caughtUp && replica.lastError().empty());
+    replica.follow(0ms);
+    cleanup(base, 2);
+    cleanup(copy, 2);
+}
+
+// The primary in another process, checkpointing as it goes.
+void testPrimaryProcess() {
+    const std::string base = "/tmp/replica_proc";
+    const std::string copy = "/tmp/replica_proc_copy";
+    cleanup(base, 2);
+    cleanup(copy, 2);
+    constexpr uint32_t kRows = 20000;
+    { Table create(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING}); }
+    const pid_t pid = ::fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        Table primary(base + ".mdb");
+        Table::CheckpointPolicy policy;
+        policy.walBytes = 64 * 1024;
+        primary.setCheckpointPolicy(policy);
+        for (uint32_t i = 0; i < kRows; ++i) primary.insertTypedRow(row(i));
+        std::_Exit(0);
+    }
+    std::this_thread::sleep_for(20ms);
+    Replica replica(base + ".mdb", copy + ".mdb");
+    int status = 0;
+    while (::waitpid(pid, &status, WNOHANG) == 0) replica.poll();
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    replica.poll();
+    Table& table = *replica.table();
+    assert(table.rowsRecorded() == kRows && table.liveRows() == kRows);
+    for (uint32_t id = 0; id < kRows; id += 97) {
+        const auto got = table.fetchTypedRow(id);
+        assert(got[0]->u32 == id && got[1]->str == row(id)[1].str);
+    }
+    cleanup(base, 2);
+    cleanup(copy, 2);
+}
+
+void testReadOnlyEngine() {
+    const std::string base = "/tmp/replica_sql";
+    const std::string copy = "/tmp/replica_sql_copy";
+    cleanup(base, 2);
+    cleanup(copy, 2);
+    {
+        Engine writer;
+        writer.createTypedTable(base, {ColType::UINT32, ColType::STRING});
+        for (uint32_t i = 0; i < 100; ++i) writer.insertTyped(base, row(i));
+    }
+    Replica replica(base + ".mdb", copy + ".mdb");
+    Engine engine;
+    engine.attachTable(base, replica.table());
+    engine.setReadOnly(true);
+    const auto result = executeMiniSQL(engine, "SELECT count(*) FROM '" + base + "' WHERE c1 = 'name-3'");
+    assert(result.rows.size() == 1 && result.rows[0][0] == "10");
+
+    auto refused = [&](auto fn) {
+        try { fn(); } catch (const std::invalid_argument&) { return true; }
+        return false;
+    };
+    assert(refused([&] { engine.insertTyped(base, row(100)); }));
+    assert(refused([&] { engine.compact(base); }));
+    assert(refused([&] { executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c0)"); }));
+    assert(refused([&] { engine.whereEq(copy, 0, 1); }));  // only attached tables
+    assert(replica.table()->rowsRecorded() == 100);
+    cleanup(base, 2);
+    cleanup(copy, 2);
+}
+
+} // namespace
+
+int main() {
+    testFollowsCommits();
+    testResync();
+    testPrimaryProcess();
+    testReadOnlyEngine();
+    std::puts("test_replica: passed");
+    return 0;
+}
@@ -1,6 +1,7 @@
 // tests/test_scan_hybrid.cpp
 #include "../Table.hpp"
 #include "../ValueTypes.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <algorithm>
 #include <iostream>
@@ -38,5 +39,8 @@ int main() {
 
     unlink(tmpl);
     unlink((std::string(tmpl) + ".idx").c_str());
+    unlink((std::string(tmpl) + ".wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        unlink((std::string(tmpl) + ".wal." + std::to_string(slot)).c_str());
     return 0;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "../Engine.hpp"
+#include "../Wal.hpp"
 
 #include <arpa/inet.h>
 #include <cassert>
@@ -97,9 +98,17 @@ void stopServer(pid_t pid) {
     (void)::waitpid(pid, &status, 0);
 }
 
+void cleanup() {
+    for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal", ".mdb.2.str"})
+        std::remove((std::string("/tmp/sql_server") + suffix).c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove(("/tmp/sql_server.mdb.wal." + std::to_string(slot)).c_str());
+}
+
 } // namespace
 
 int main() {
+    cleanup();
     Engine e;
     e.createTypedTable("/tmp/sql_server", {ColType::UINT32, ColType::UINT32, ColType::STRING});
     e.insertTyped("/tmp/sql_server", {ColValue(uint32_t(1)), ColValue(uint32_t(10)), ColValue(std::string("alice"))});
@@ -112,6 +121,18 @@ int main() {
     try {
         int fd = connectToServer(port);
 
+        // Before any query opens (and recovers) the table, its inserts are all
+        // still in the WAL.
+        std::string c1 = sendQuery(fd, ".changes '/tmp/sql_server'");
+        assert(c1 == "OK\nlsn\top\trow\tc0\tc1\tc2\n1\tinsert\t0\t1\t10\talice\n"
+                     "2\tinsert\t1\t2\t20\tbob\n3\tinsert\t2\t2\t30\talice\nEND\n");
+        std::string c2 = sendQuery(fd, ".changes /tmp/sql_server 1 1");
+        assert(c2 == "OK\nlsn\top\trow\tc0\tc1\tc2\n2\tinsert\t1\t2\t20\tbob\nEND\n");
+        std::string c3 = sendQuery(fd, ".changes /tmp/sql_server end");
+        assert(c3 == "OK\nlsn\top\trow\tc0\tc1\tc2\nEND\n");
+        std::string c4 = sendQuery(fd, ".changes /tmp/sql_server -1");
+        assert(c4 == "ERR\tinvalid .changes lsn\nEND\n");
+
         std::string r1 = sendQuery(fd, "SELECT c0, c1 FROM '/tmp/sql_server' WHERE c0 = 2");
         assert(r1 == "OK\nc0\tc1\n2\t20\n2\t30\nEND\n");
 
@@ -141,16 +162,12 @@ int main() {
         ::close(fd);
     } catch (...) {
         stopServer(serverPid);
-        std::remove("/tmp/sql_server.mdb");
-        std::remove("/tmp/sql_server.mdb.idx");
-        std::remove("/tmp/sql_server.mdb.2.str");
+        cleanup();
         throw;
     }
 
     stopServer(serverPid);
-    std::remove("/tmp/sql_server.mdb");
-    std::remove("/tmp/sql_server.mdb.idx");
-    std::remove("/tmp/sql_server.mdb.2.str");
+    cleanup();
     std::puts("test_server: passed");
     return 0;
 }
@@ -0,0 +1,194 @@
+#include "../SimdKernels.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using Simd::CmpOp;
+using Simd::Isa;
+
+const CmpOp kOps[] = {CmpOp::Eq, CmpOp::Ne, CmpOp::Lt, CmpOp::Le, CmpOp::Gt, CmpOp::Ge};
+const size_t kSizes[] = {0, 1, 3, 63, 64, 65, 127, 128, 200, 1000};
+
+template <typename T>
+bool compareT(CmpOp op, T v, T key) {
+    switch (op) {
+        case CmpOp::Eq: return v == key;
+        case CmpOp::Ne: return v != key;
+        case CmpOp::Lt: return v < key;
+        case CmpOp::Le: return v <= key;
+        case CmpOp::Gt: return v > key;
+        case CmpOp::Ge: return v >= key;
+    }
+    return false;
+}
+
+// Small value domains, so equality and the range edges match often.
+template <typename T>
+std::vector<T> randomValues(std::mt19937& rng, size_t n) {
+    std::vector<T> values(n);
+    for (auto& v : values) {
+        const int r = int(rng() % 21) - 10;
+        if constexpr (std::is_unsigned<T>::value) v = T(r + 10);
+        else v = T(r);
+    }
+    if constexpr (std::is_floating_point<T>::value) {
+        for (size_t i = 0; i < n; i += 7) values[i] = std::numeric_limits<T>::quiet_NaN();
+        if (n > 3) values[3] = -std::numeric_limits<T>::infinity();
+        if (n > 5) values[5] = std::numeric_limits<T>::infinity();
+        if (n > 9) values[9] = T(-0.0);
+    } else {
+        if (n > 3) values[3] = std::numeric_limits<T>::lowest();
+        if (n > 5) values[5] = std::numeric_limits<T>::max();
+    }
+    return values;
+}
+
+template <typename T>
+std::vector<T> keys() {
+    std::vector<T> k = {T(0), T(3), T(10), T(11), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max()};
+    if constexpr (std::is_floating_point<T>::value) {
+        k.push_back(T(2.5));
+        k.push_back(std::numeric_limits<T>::infinity());
+        k.push_back(-std::numeric_limits<T>::infinity());
+        k.push_back(std::numeric_limits<T>::quiet_NaN());
+    } else {
+        k.push_back(std::numeric_limits<T>::lowest() + 1);
+        k.push_back(std::numeric_limits<T>::max() - 1);
+    }
+    return k;
+}
+
+template <typename T>
+void checkPredicates(std::mt19937& rng) {
+    for (size_t n : kSizes) {
+        // Offset by one so the kernels see unaligned data.
+        std::vector<T> storage = randomValues<T>(rng, n + 1);
+        const T* values = storage.data() + 1;
+        std::vector<uint32_t> ids(n);
+        for (size_t i = 0; i < n; ++i) ids[i] = uint32_t(1000 + 3 * i);
+
+        auto check = [&](const std::vector<bool>& expected, const std::vector<uint64_t>& bits,
+                         size_t count, const std::vector<uint32_t>& selected, bool withIDs) {
+            std::vector<uint32_t> want;
+            for (size_t i = 0; i < n; ++i) {
+                assert(bool((bits[i / 64] >> (i % 64)) & 1) == expected[i]);
+                if (expected[i]) want.push_back(withIDs ? ids[i] : uint32_t(i));
+            }
+            if (n % 64) assert((bits.back() >> (n % 64)) == 0);
+            assert(count == want.size());
+            for (size_t i = 0; i < count; ++i) assert(selected[i] == want[i]);
+        };
+
+        for (T key : keys<T>()) {
+            for (CmpOp op : kOps) {
+                std::vector<bool> expected(n);
+                for (size_t i = 0; i < n; ++i) expected[i] = compareT(op, values[i], key);
+                std::vector<uint64_t> bits(Simd::maskWords(n), ~uint64_t(0));
+                Simd::maskCompare(values, n, op, key, bits.data());
+                std::vector<uint32_t> selected(n);
+                const bool withIDs = (size_t(op) & 1) == 0;
+                const size_t count =
+                    Simd::selectCompare(values, n, op, key, withIDs ? ids.data() : nullptr, selected.data());
+                check(expected, bits, count, selected, withIDs);
+            }
+        }
+        for (T lo : keys<T>()) {
+            for (T hi : keys<T>()) {
+                std::vector<bool> expected(n);
+                for (size_t i = 0; i < n; ++i) expected[i] = values[i] >= lo && values[i] <= hi;
+                std::vector<uint64_t> bits(Simd::maskWords(n), ~uint64_t(0));
+                Simd::maskBetween(values, n, lo, hi, bits.data());
+                std::vector<uint32_t> selected(n);
+                const size_t count = Simd::selectBetween(values, n, lo, hi, ids.data(), selected.data());
+                check(expected, bits, count, selected, true);
+            }
+        }
+    }
+}
+
+template <typename T>
+void checkReductions(std::mt19937& rng) {
+    for (size_t n : kSizes) {
+        std::vector<T> storage = randomValues<T>(rng, n + 1);
+        const T* values = storage.data() + 1;
+        T lo = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::max();
+        T hi = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::lowest();
+        for (size_t i = 0; i < n; ++i) {
+            if (values[i] < lo) lo = values[i];
+            if (values[i] > hi) hi = values[i];
+        }
+        assert(Simd::min(values, n) == lo);
+        assert(Simd::max(values, n) == hi);
+    }
+}
+
+void checkSums(std::mt19937& rng) {
+    for (size_t n : kSizes) {
+        std::vector<uint32_t> u(n + 1);
+        std::vector<int64_t> s(n + 1);
+        std::vector<float> f(n + 1);
+        std::vector<double> d(n + 1);
+        uint64_t uWant = 0, sWant = 0;
+        double fWant = 0, dWant = 0;
+        for (size_t i = 1; i <= n; ++i) {
+            u[i] = uint32_t(rng());
+            s[i] = int64_t((uint64_t(rng()) << 32) | rng());
+            f[i] = float(int(rng() % 2001) - 1000) / 8;
+            d[i] = double(int(rng() % 2001) - 1000) / 16;
+            uWant += u[i];
+            sWant += uint64_t(s[i]);
+            fWant += f[i];
+            dWant += d[i];
+        }
+        // UINT32 widens, INT64 wraps; these float values sum exactly.
+        assert(Simd::sum(u.data() + 1, n) == uWant);
+        assert(Simd::sum(s.data() + 1, n) == int64_t(sWant));
+        assert(Simd::sum(f.data() + 1, n) == fWant);
+        assert(Simd::sum(d.data() + 1, n) == dWant);
+    }
+    std::vector<uint32_t> big(1000, UINT32_MAX);
+    assert(Simd::sum(big.data(), big.size()) == uint64_t(UINT32_MAX) * 1000);
+}
+
+void testIsa(Isa isa) {
+    Simd::setIsa(isa);
+    assert(Simd::activeIsa() == isa);
+    std::mt19937 rng(46);
+    checkPredicates<uint32_t>(rng);
+    checkPredicates<int64_t>(rng);
+    checkPredicates<float>(rng);
+    checkPredicates<double>(rng);
+    checkReductions<uint32_t>(rng);
+    checkReductions<int64_t>(rng);
+    checkReductions<float>(rng);
+    checkReductions<double>(rng);
+    checkSums(rng);
+    std::printf("simd %s: ok\n", Simd::isaName(isa));
+}
+
+} // namespace
+
+int main() {
+    const Isa best = Simd::bestIsa();
+    assert(Simd::activeIsa() == best);
+    for (Isa isa : {Isa::Scalar, Isa::Sse42, Isa::Avx2, Isa::Avx512}) {
+        try {
+            testIsa(isa);
+        } catch (const std::invalid_argument&) {
+            assert(isa != Isa::Scalar && isa != best);
+        }
+    }
+    Simd::setIsa(best);
+    std::puts("test_simd: passed");
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "../BPlusTree.hpp"
+#include "../Engine.hpp"
+#include "../MiniSQL.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".bpt").c_str());
+    }
+}
+
+// Log-like values: a few services, deep shared paths (well past the 32-byte
+// key prefix) and a short tail that varies.
+std::string logLine(std::mt19937& rng) {
+    static const char* services[] = {"auth", "billing", "search", "search-api"};
+    std::string s = std::string(services[rng() % 4]) + "/v1/requests/handler/pipeline/stage";
+    s += std::to_string(rng() % 50);
+    if (rng() % 3 == 0) s = s.substr(0, 4 + rng() % 8);  // some short values
+    return s;
+}
+
+void testKeyEncoding() {
+    assert(BPlusTree::encodeString("abc").size() == BPlusTree::kStringKeyBytes);
+    assert(BPlusTree::encodeString("abc") < BPlusTree::encodeString("abd"));
+    assert(BPlusTree::encodeString("ab") < BPlusTree::encodeString("abc"));
+    const std::string longA(40, 'x');
+    assert(BPlusTree::encodeString(longA) == BPlusTree::encodeString(longA + "y"));
+    const auto [lo, hi] = BPlusTree::prefixRange("ab");
+    assert(lo <= BPlusTree::encodeString("ab") && BPlusTree::encodeString("abzzz") <= hi);
+    assert(hi < BPlusTree::encodeString("ac"));
+}
+
+void testStringIndexScans() {
+    const std::string base = "/tmp/strindex_table";
+    cleanup(base, 2);
+    std::mt19937 rng(11);
+    const std::vector<std::string> prefixes = {
+        "search", "search-api/", "auth/v1/requests/handler/pipeline/stage1", "", "zzz", "bill"};
+    {
+        Table t(base + ".mdb", 4096, {ColType::STRING, ColType::UINT32});
+        t.setUseGPU(false);
+        for (uint32_t i = 0; i < 3000; ++i)
+            t.insertTypedRow({ColValue(logLine(rng)), ColValue(i)});
+
+        // Reference answers from the scan paths.
+        std::vector<std::vector<uint32_t>> byPrefix;
+        for (const auto& p : prefixes) byPrefix.push_back(t.scanPrefixString(0, p));
+        const auto range = t.scanBetweenString(0, "billing/v1/requests/handler/pipeline/stage3", "search/v1");
+        const auto exact = t.scanEqualsString(0, "search/v1/requests/handler/pipeline/stage7");
+        assert(!byPrefix[0].empty() && !range.empty() && !exact.empty());
+        assert(byPrefix[3].size() == 3000 && byPrefix[4].empty());
+
+        t.createIndex(0);
+        assert(t.hasIndex(0));
+        for (size_t i = 0; i < prefixes.size(); ++i)
+            assert(t.scanPrefixString(0, prefixes[i]) == byPrefix[i]);
+        assert(t.scanBetweenString(0, "billing/v1/requests/handler/pipeline/stage3", "search/v1") == range);
+        assert(t.scanEqualsString(0, "search/v1/requests/handler/pipeline/stage7") == exact);
+        assert(t.scanBetweenString(0, "z", "a").empty());
+        assert(t.indexRange(0, ColValue(std::string("search/v1/")), ColValue(std::string("search/v1/~"))) ==
+               t.scanPrefixString(0, "search/v1/"));
+
+        // Compound predicates.
+        Predicate prefix;
+        prefix.kind = Predicate::Kind::PREFIX_STRING;
+        prefix.colIdx = 0;
+        prefix.needle = "auth";
+        Predicate ids;
+        ids.kind = Predicate::Kind::BETWEEN;
+        ids.colIdx = 1;
+        ids.lo = 0;
+        ids.hi = 999;
+        auto both = t.whereAnd({prefix, ids});
+        for (uint32_t rid : both) {
+            auto row = t.fetchTypedRow(rid);
+            assert(row[0]->str.compare(0, 4, "auth") == 0 && row[1]->u32 < 1000);
+        }
+
+        // Maintenance.
+        const uint32_t victim = byPrefix[1].front();
+        t.deleteRow(victim);
+        const uint32_t rid = t.insertTypedRow({ColValue(std::string("search-api/new")), ColValue(0u)});
+        auto expected = byPrefix[1];
+        expected.erase(expected.begin());
+        expected.push_back(rid);
+        assert(t.scanPrefixString(0, "search-api/") == expected);
+        t.flushDurable();
+        t.insertTypedRow({ColValue(std::string("search-api/late")), ColValue(1u)});  // WAL only
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.hasIndex(0));
+        assert((t.scanEqualsString(0, "search-api/late") == std::vector<uint32_t>{3001}));
+        const auto before = t.scanPrefixString(0, "search-api/");
+        const auto remap = t.compact();
+        std::vector<uint32_t> remapped;
+        for (uint32_t rid : before) remapped.push_back(remap[rid]);
+        assert(t.scanPrefixString(0, "search-api/") == remapped);
+    }
+    cleanup(base, 2);
+}
+
+void testLikeSQL() {
+    const std::string base = "/tmp/strindex_sql";
+    cleanup(base, 2);
+    Engine engine;
+    engine.createTypedTable(base, {ColType::STRING, ColType::UINT32});
+    const char* names[] = {"alpha", "alphabet", "alps", "beta", "gamma"};
+    for (uint32_t i = 0; i < 50; ++i)
+        engine.insertTyped(base, {ColValue(std::string(names[i % 5])), ColValue(i)});
+    executeMiniSQL(engine, "CREATE INDEX ON '" + base + "' (c0)");
+
+    auto result = executeMiniSQL(engine, "SELECT COUNT(*) FROM '" + base + "' WHERE c0 LIKE 'alp%'");
+    assert(result.rows.size() == 1 && result.rows[0][0] == "30");
+    result = executeMiniSQL(engine, "SELECT COUNT(*) FROM '" + base + "' WHERE c0 LIKE 'alpha%' AND c1 BETWEEN 0 AND 9");
+    assert(result.rows[0][0] == "4");
+    result = executeMiniSQL(engine, "SELECT COUNT(*) FROM '" + base + "' WHERE c0 BETWEEN 'alps' AND 'beta'");
+    assert(result.rows[0][0] == "20");
+
+    for (const char* bad : {"'%pha'", "'al_ha%'", "'alpha'"}) {
+        bool threw = false;
+        try { executeMiniSQL(engine, "SELECT * FROM '" + base + "' WHERE c0 LIKE " + bad); }
+        catch (const std::invalid_argument&) { threw = true; }
+        assert(threw);
+    }
+    cleanup(base, 2);
+}
+
+} // namespace
+
+int main() {
+    testKeyEncoding();
+    testStringIndexScans();
+    testLikeSQL();
+    std::puts("test_string_index: passed");
+    return 0;
+}
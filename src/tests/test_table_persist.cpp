@@ -1,6 +1,7 @@
 // tests/test_table_persist.cpp
 #include "../Table.hpp"
 #include "../ValueTypes.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <iostream>
 #include <fcntl.h>
@@ -45,5 +46,8 @@ int main() {
     std::cout << "test_table_persist: passed (row index survived restart)\n";
     unlink(tmpl);
     unlink((std::string(tmpl)+".idx").c_str());
+    unlink((std::string(tmpl) + ".wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        unlink((std::string(tmpl) + ".wal." + std::to_string(slot)).c_str());
     return 0;
 }
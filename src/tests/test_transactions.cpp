@@ -0,0 +1,286 @@
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <csignal>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+void cleanup(const std::string& base, uint16_t numCols) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < numCols; ++c) {
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+        std::remove((base + ".mdb." + std::to_string(c) + ".hidx").c_str());
+    }
+}
+
+bool throwsInvalid(const std::function<void()>& fn) {
+    try { fn(); } catch (const std::invalid_argument&) { return true; }
+    return false;
+}
+
+void testCommitAndRollback() {
+    const std::string base = "/tmp/txn_table";
+    cleanup(base, 2);
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32, ColType::STRING});
+        t.setUseGPU(false);
+        assert(throwsInvalid([&] { t.commit(); }));
+        assert(throwsInvalid([&] { t.rollback(); }));
+
+        t.begin();
+        assert(t.inTransaction());
+        assert(throwsInvalid([&] { t.begin(); }));
+        assert(throwsInvalid([&] { t.compact(); }));
+        for (uint32_t i = 0; i < 100; ++i)
+            assert(t.insertTypedRow({ColValue(i), ColValue(std::string("row") + std::to_string(i))}) == i);
+        t.deleteRow(7);  // pending insert
+        assert(t.scanEquals(0, 5).empty());  // not visible until commit
+        t.commit();
+        assert(!t.inTransaction());
+        assert(t.scanEquals(0, 5) == std::vector<uint32_t>{5});
+        assert(t.scanEquals(0, 7).empty());
+
+        t.begin();
+        t.deleteRow(5);
+        t.insertTypedRow({ColValue(500u), ColValue(std::string("gone"))});
+        t.rollback();
+        assert(t.scanEquals(0, 5) == std::vector<uint32_t>{5});
+        assert(t.scanEquals(0, 500).empty());
+        // rowIDs handed out by a rolled-back transaction are reused.
+        assert(t.insertTypedRow({ColValue(100u), ColValue(std::string("next"))}) == 100);
+    }
+    {
+        Table t(base + ".mdb");  // every batch comes back from the WAL
+        t.setUseGPU(false);
+        assert(t.scanEquals(0, 99) == std::vector<uint32_t>{99});
+        assert(t.scanEquals(0, 7).empty());
+        assert(t.scanEquals(0, 100) == std::vector<uint32_t>{100});
+        auto row = t.fetchTypedRow(42);
+        assert(row[1] && row[1]->str == "row42");
+    }
+    cleanup(base, 2);
+}
+
+void testOneCommitPerBatch() {
+    const std::string base = "/tmp/txn_wal";
+    cleanup(base, 1);
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32});
+        t.begin();
+        for (uint32_t i = 0; i < 10; ++i) t.insertTypedRow({ColValue(i)});
+        t.deleteRow(3);
+        t.commit();
+        t.begin();
+        t.rollback();  // nothing logged
+    }
+    Wal wal(base + ".mdb");
+    wal.openOrCreate(false);
+    const auto ops = wal.committedOperations();
+    assert(ops.size() == 11);
+    assert(ops.back().kind == Wal::Operation::Kind::Delete && ops.back().rowID == 3);
+    // One commit record, sharing the batch's last opID, covers all eleven.
+    assert(wal.lastOpID() == 11);
+    cleanup(base, 1);
+}
+
+void testTornBatchIsDropped() {
+    const std::string base = "/tmp/txn_torn";
+    cleanup(base, 1);
+    uint64_t logEnd = 0;
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32});
+        t.insertTypedRow({ColValue(1u)});
+        t.flushDurable();
+        t.begin();
+        for (uint32_t i = 0; i < 5; ++i) t.insertTypedRow({ColValue(10 + i)});
+        t.commit();
+        logEnd = t.walBytes();
+    }
+    // Tear the commit record, as if the process died mid-write: replay must
+    // apply none of the batch.
+    const int fd = ::open((base + ".mdb.wal").c_str(), O_WRONLY);
+    const uint32_t torn = 0xDEADBEEF;
+    assert(::pwrite(fd, &torn, sizeof(torn), off_t(logEnd) - 4) == ssize_t(sizeof(torn)));
+    ::close(fd);
+    Wal wal(base + ".mdb");
+    wal.openOrCreate(false);
+    assert(wal.committedOperations().empty());
+    cleanup(base, 1);
+}
+
+// Runs fn with writes past the first byte of any file failing (EFBIG).
+void withWritesFailing(const std::function<void()>& fn) {
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit saved{};
+    assert(::getrlimit(RLIMIT_FSIZE, &saved) == 0);
+    rlimit tight = saved;
+    tight.rlim_cur = 1;
+    assert(::setrlimit(RLIMIT_FSIZE, &tight) == 0);
+    fn();
+    assert(::setrlimit(RLIMIT_FSIZE, &saved) == 0);
+}
+
+void testFailedLogWriteKeepsTransaction() {
+    const std::string base = "/tmp/txn_walfail";
+    cleanup(base, 1);
+    {
+        Table t(base + ".mdb", 4096, {ColType::UINT32});
+        t.setUseGPU(false);
+        t.insertTypedRow({ColValue(1u)});
+
+        // Committed again once the log is writable.
+        t.begin();
+        for (uint32_t i = 0; i < 5; ++i) t.insertTypedRow({ColValue(10 + i)});
+        bool threw = false;
+        withWritesFailing([&] {
+            try { t.commit(); } catch (const std::runtime_error&) { threw = true; }
+        });
+        assert(threw && t.inTransaction());
+        assert(t.liveRows() == 1 && t.scanEquals(0, 10).empty());
+        t.commit();
+        assert(!t.inTransaction() && t.liveRows() == 6);
+
+        // Rolled back: a later commit must not write it.
+        t.begin();
+        t.insertTypedRow({ColValue(99u)});
+        threw = false;
+        withWritesFailing([&] {
+            try { t.commit(); } catch (const std::runtime_error&) { threw = true; }
+        });
+        assert(threw && t.inTransaction());
+        t.rollback();
+        t.insertTypedRow({ColValue(2u)});
+    }
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.liveRows() == 7);
+        assert(t.scanEquals(0, 12).size() == 1 && t.scanEquals(0, 2).size() == 1);
+        assert(t.scanEquals(0, 99).empty());
+    }
+    cleanup(base, 1);
+}
+
+// Runs fn in a child process that exits without closing anything, as if it
+// crashed; the table is then reopened from its log.
+void inCrashingChild(const std::function<void()>& fn) {
+    const pid_t pid = ::fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        fn();
+        std::_Exit(0);
+    }
+    int status = 0;
+    assert(::waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+void testFailedAutocommitIsNotReplayed() {
+    const std::string base = "/tmp/txn_autofail";
+    cleanup(base, 1);
+    { Table create(base + ".mdb", 4096, {ColType::UINT32}); }
+    inCrashingChild([&] {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.insertTypedRow({ColValue(1u)}) == 0);
+        bool threw = false;
+        withWritesFailing([&] {
+            try { t.insertTypedRow({ColValue(50u)}); } catch (const std::runtime_error&) { threw = true; }
+        });
+        assert(threw && t.liveRows() == 1);
+        threw = false;
+        withWritesFailing([&] {
+            try { t.deleteRow(0); } catch (const std::runtime_error&) { threw = true; }
+        });
+        assert(threw && t.liveRows() == 1);
+        // Takes the rowID the failed insert did not use.
+        assert(t.insertTypedRow({ColValue(2u)}) == 1);
+    });
+    {
+        Table t(base + ".mdb");
+        t.setUseGPU(false);
+        assert(t.rowsRecorded() == 2 && t.liveRows() == 2);
+        assert(t.fetchTypedRow(0)[0]->u32 == 1 && t.fetchTypedRow(1)[0]->u32 == 2);
+        assert(t.scanEquals(0, 50).empty());
+    }
+    cleanup(base, 1);
+}
+
+void testPrimaryKey() {
+    const std::string base = "/tmp/txn_pk";
+    cleanup(base, 2);
+    Table t(base + ".mdb", 4096, {ColType::STRING, ColType::UINT32});
+    t.setUseGPU(false);
+    t.setPrimaryKey(0);
+    t.insertTypedRow({ColValue(std::string("alice")), ColValue(1u)});
+
+    t.begin();
+    assert(throwsInvalid([&] { t.insertTypedRow({ColValue(std::string("alice")), ColValue(2u)}); }));
+    const uint32_t bob = t.insertTypedRow({ColValue(std::string("bob")), ColValue(3u)});
+    assert(throwsInvalid([&] { t.insertTypedRow({ColValue(std::string("bob")), ColValue(4u)}); }));
+    const uint32_t alice = t.upsertTypedRow({ColValue(std::string("alice")), ColValue(5u)});
+    const uint32_t bob2 = t.upsertTypedRow({ColValue(std::string("bob")), ColValue(6u)});
+    assert(bob2 != bob);
+    t.deleteRow(0);  // already replaced by the upsert; a no-op
+    t.commit();
+
+    assert(t.findByKey(ColValue(std::string("alice"))) == alice);
+    assert(t.findByKey(ColValue(std::string("bob"))) == bob2);
+    assert(t.fetchTypedRow(bob2)[1]->u32 == 6);
+    assert(t.fetchTypedRow(0)[0] == std::nullopt);
+    cleanup(base, 2);
+}
+
+void testWritersWaitForCommit() {
+    const std::string base = "/tmp/txn_threads";
+    cleanup(base, 1);
+    Table t(base + ".mdb", 4096, {ColType::UINT32});
+    t.setUseGPU(false);
+    t.begin();
+    t.insertTypedRow({ColValue(1u)});
+    std::atomic<bool> inserted{false};
+    std::thread other([&] {
+        t.insertTypedRow({ColValue(2u)});
+        inserted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!inserted);  // blocked on the open transaction
+    t.insertTypedRow({ColValue(3u)});
+    t.commit();
+    other.join();
+    assert(t.scanEquals(0, 1) == std::vector<uint32_t>{0});
+    assert(t.scanEquals(0, 3) == std::vector<uint32_t>{1});
+    assert(t.scanEquals(0, 2) == std::vector<uint32_t>{2});
+    cleanup(base, 1);
+}
+
+} // namespace
+
+int main() {
+    testCommitAndRollback();
+    testOneCommitPerBatch();
+    testTornBatchIsDropped();
+    testFailedLogWriteKeepsTransaction();
+    testFailedAutocommitIsNotReplayed();
+    testPrimaryKey();
+    testWritersWaitForCommit();
+    std::puts("test_transactions: passed");
+    return 0;
+}
@@ -1,7 +1,17 @@
 #include "../Engine.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <cstdio>
 #include <cmath>
+#include <string>
+
+// <name>.mdb, its row index and every WAL segment.
+static void removeTableFiles(const std::string& name) {
+    for (const char* suffix : {".mdb", ".mdb.idx", ".mdb.wal"})
+        std::remove((name + suffix).c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((name + ".mdb.wal." + std::to_string(slot)).c_str());
+}
 
 int main() {
     Engine e;
@@ -48,8 +58,7 @@ int main() {
         assert(row99[2].has_value() && row99[2]->i64 == 99000LL);
     }
 
-    std::remove("typed_tbl.mdb");
-    std::remove("typed_tbl.mdb.idx");
+    removeTableFiles("typed_tbl");
 
     // ── STRING column: insert, fetch, scan, persist ───────────────────────────
     {
@@ -98,8 +107,7 @@ int main() {
         assert(hits.size() == 2);
     }
 
-    std::remove("str_tbl.mdb");
-    std::remove("str_tbl.mdb.idx");
+    removeTableFiles("str_tbl");
     std::remove("str_tbl.mdb.0.str");
 
     std::puts("test_types: passed");
@@ -0,0 +1,206 @@
+#include "../Vectorized.hpp"
+#include "../Table.hpp"
+#include "../Wal.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t kCols = 5;  // UINT32, INT64, FLOAT, DOUBLE, STRING
+constexpr uint32_t kRows = 5000;
+
+void cleanup(const std::string& base) {
+    std::remove((base + ".mdb").c_str());
+    std::remove((base + ".mdb.idx").c_str());
+    std::remove((base + ".mdb.wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
+    for (uint16_t c = 0; c < kCols; ++c)
+        std::remove((base + ".mdb." + std::to_string(c) + ".str").c_str());
+}
+
+std::vector<ColValue> row(uint32_t i) {
+    return {ColValue(i % 100), ColValue(int64_t(i) * 1000 - 2000000), ColValue(float(i % 37) / 4),
+            ColValue(double(i) / 8), ColValue("k" + std::to_string(i % 50))};
+}
+
+Predicate between(uint16_t col, ValueType lo, ValueType hi) {
+    Predicate p;
+    p.kind = Predicate::Kind::BETWEEN;
+    p.colIdx = col;
+    p.lo = lo;
+    p.hi = hi;
+    return p;
+}
+
+Predicate prefix(uint16_t col, const std::string& needle) {
+    Predicate p;
+    p.kind = Predicate::Kind::PREFIX_STRING;
+    p.colIdx = col;
+    p.needle = needle;
+    return p;
+}
+
+// Row-at-a-time reference.
+template <typename Match>
+std::vector<uint32_t> expectedRows(Table& table, Match match) {
+    std::vector<uint32_t> rows;
+    for (uint32_t rowID = 0; rowID < table.rowsRecorded(); ++rowID) {
+        auto r = table.fetchTypedRow(rowID);
+        if (r[0] && match(*r[0], *r[4])) rows.push_back(rowID);
+    }
+    return rows;
+}
+
+std::vector<uint32_t> selectedRows(Table& table, const std::vector<Predicate>& predicates, bool anyOf,
+                                   const std::vector<uint16_t>& project) {
+    std::vector<uint32_t> rows;
+    Vectorized::Sink sink([&](Vectorized::Batch& batch) {
+        assert(batch.size <= Vectorized::kBatchSize && !batch.sel.empty());
+        assert(batch.columns.size() == project.size());
+        for (const auto& column : batch.columns) assert(column.size() == batch.sel.size());
+        for (size_t i = 0; i < batch.sel.size(); ++i) {
+            const uint32_t rowID = batch.rowIDs[batch.sel[i]];
+            auto r = table.fetchTypedRow(rowID);
+            for (size_t c = 0; c < project.size(); ++c) {
+                const ColValue v = batch.columns[c].at(i);
+                assert(v.type == r[project[c]]->type);
+                assert(v == *r[project[c]]);
+            }
+            rows.push_back(rowID);
+        }
+    });
+    Vectorized::Project projectOp(table, project, sink);
+    Vectorized::Filter filter(table, predicates, anyOf, projectOp);
+    std::vector<uint16_t> scanned = {0, 1, 2, 3, 4};
+    Vectorized::Scan(table, scanned).run(predicates.empty() ? static_cast<Vectorized::Operator&>(projectOp) : filter);
+    return rows;
+}
+
+void testFilterProject(Table& table) {
+    // Everything, then AND / OR across a numeric and a string column.
+    auto all = selectedRows(table, {}, false, {4, 0, 3});
+    assert(all == expectedRows(table, [](const ColValue&, const ColValue&) { return true; }));
+    assert(all.size() == table.liveRows());
+
+    auto both = selectedRows(table, {between(0, 10, 19), prefix(4, "k1")}, false, {1, 2});
+    assert(both == expectedRows(table, [](const ColValue& a, const ColValue& s) {
+        return a.u32 >= 10 && a.u32 <= 19 && s.str.compare(0, 2, "k1") == 0;
+    }));
+    assert(!both.empty());
+
+    auto either = selectedRows(table, {between(0, 95, 99), prefix(4, "k4")}, true, {0, 4});
+    assert(either == expectedRows(table, [](const ColValue& a, const ColValue& s) {
+        return (a.u32 >= 95 && a.u32 <= 99) || s.str.compare(0, 2, "k4") == 0;
+    }));
+
+    assert(selectedRows(table, {between(0, 200, 300)}, false, {0}).empty());
+
+    // Predicates go through Table's validation.
+    bool threw = false;
+    try {
+        Vectorized::Sink sink([](Vectorized::Batch&) {});
+        Vectorized::Filter filter(table, {between(1, 0, 1)}, false, sink);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+void testAggregate(Table& table) {
+    Predicate low = between(0, 0, 9);
+    for (uint16_t c = 0; c < 4; ++c) {
+        Vectorized::Aggregate aggregate(table, c);
+        Vectorized::Filter filter(table, {low}, false, aggregate);
+        Vectorized::Scan(table, {0, c}).run(filter);
+
+        uint64_t count = 0;
+        long double sum = 0;
+        ColValue lo, hi;
+        for (uint32_t rowID = 0; rowID < table.rowsRecorded(); ++rowID) {
+            auto r = table.fetchTypedRow(rowID);
+            if (!r[0] || r[0]->u32 > 9) continue;
+            const ColValue& v = *r[c];
+            if (count == 0 || v < lo) lo = v;
+            if (count == 0 || v > hi) hi = v;
+            sum += v.toDouble();
+            ++count;
+        }
+        assert(aggregate.count() == count && count > 0);
+        assert(aggregate.sum() == sum);
+        assert(aggregate.min().type == lo.type && aggregate.min() == lo);
+        assert(aggregate.max().type == hi.type && aggregate.max() == hi);
+    }
+
+    Vectorized::Aggregate rows(table);
+    Vectorized::Scan(table, {}).run(rows);
+    assert(rows.count() == table.liveRows());
+
+    bool threw = false;
+    try {
+        Vectorized::Aggregate strings(table, 4);
+        Vectorized::Scan(table, {4}).run(strings);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+// INT64 sums are taken in int64: exact where a running double would round,
+// and still right once the total passes INT64_MAX.
+void testInt64Sum(const std::string& base) {
+    cleanup(base);
+    {
+        Table table(base + ".mdb", 4096, {ColType::INT64});
+        table.setDurability(Table::Durability::Off);
+        const int64_t odd = (int64_t(1) << 53) + 1;  // not a double
+        for (int i = 0; i < 1000; ++i) table.insertTypedRow({ColValue(odd)});
+        Vectorized::Aggregate exact(table, 0);
+        Vectorized::Scan(table, {0}).run(exact);
+        assert(exact.sum() == static_cast<long double>(odd * 1000));
+    }
+    cleanup(base);
+    {
+        Table table(base + ".mdb", 4096, {ColType::INT64});
+        table.setDurability(Table::Durability::Off);
+        // One 2^62 per batch: each batch sum fits, the total reaches 2^64.
+        const int64_t quarter = int64_t(1) << 62;
+        for (uint32_t i = 0; i < 4 * Vectorized::kBatchSize; ++i)
+            table.insertTypedRow({ColValue(i % Vectorized::kBatchSize == 0 ? quarter : int64_t(0))});
+        Vectorized::Aggregate spill(table, 0);
+        Vectorized::Scan(table, {0}).run(spill);
+        assert(spill.sum() == static_cast<long double>(quarter) * 4);
+        assert(spill.max() == ColValue(quarter));
+    }
+    cleanup(base);
+}
+
+} // namespace
+
+int main() {
+    const std::string base = "/tmp/vec_pipeline";
+    cleanup(base);
+    {
+        Table table(base + ".mdb", 4096, {ColType::UINT32, ColType::INT64, ColType::FLOAT, ColType::DOUBLE,
+                                          ColType::STRING});
+        table.setDurability(Table::Durability::Off);
+        for (uint32_t i = 0; i < kRows; ++i) table.insertTypedRow(row(i));
+        // Holes inside and across batches, and a fully deleted stretch.
+        for (uint32_t i = 0; i < kRows; i += 7) table.deleteRow(i);
+        for (uint32_t i = 2040; i < 2060; ++i)
+            if (i % 7) table.deleteRow(i);
+        // Reused slots break the runs of consecutive slots.
+        for (uint32_t i = kRows; i < kRows + 300; ++i) table.insertTypedRow(row(i));
+
+        testFilterProject(table);
+        testAggregate(table);
+    }
+    cleanup(base);
+    testInt64Sum("/tmp/vec_int64");
+    std::puts("test_vectorized: passed");
+    return 0;
+}
@@ -1,9 +1,11 @@
 #include "../Table.hpp"
+#include "../Wal.hpp"
 
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <fcntl.h>
+#include <stdexcept>
 #include <string>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -11,7 +13,16 @@
 
 namespace {
 
+constexpr off_t kHeader = 32;  // magic, version, reserved, first opID, seq, first live seq
+constexpr off_t kInsertRecord = 20 + 1 + 1;  // packed: varint rowID + one small UINT32
+
 #pragma pack(push, 1)
+struct TestWalHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+};
+
 struct TestRecordHeader {
     uint32_t payloadSize;
     uint8_t  type;
@@ -21,6 +32,35 @@ struct TestRecordHeader {
 };
 #pragma pack(pop)
 
+void appendBytes(const std::string& path, const void* buf, size_t n);
+
+uint32_t fnv1a32(const void* data, size_t n, uint32_t hash = 2166136261u) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < n; ++i) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// v1 record: checksum over type, opID, payload.
+void appendV1Record(const std::string& path, uint8_t type, uint64_t opID, const std::vector<uint8_t>& payload) {
+    TestRecordHeader h{static_cast<uint32_t>(payload.size()), type, {0, 0, 0}, opID, 0};
+    uint32_t c = fnv1a32(&h.type, 1);
+    c = fnv1a32(&h.opID, sizeof(h.opID), c);
+    h.checksum = fnv1a32(payload.data(), payload.size(), c);
+    appendBytes(path, &h, sizeof(h));
+    if (!payload.empty()) appendBytes(path, payload.data(), payload.size());
+}
+
+uint16_t walVersion(const std::string& path) {
+    TestWalHeader h{};
+    FILE* f = std::fopen(path.c_str(), "rb");
+    assert(f && std::fread(&h, sizeof(h), 1, f) == 1);
+    std::fclose(f);
+    return h.version;
+}
+
 off_t fileSize(const std::string& path) {
     struct stat st{};
     if (::stat(path.c_str(), &st) != 0) return -1;
@@ -34,12 +74,23 @@ void appendBytes(const std::string& path, const void* buf, size_t n) {
     ::close(fd);
 }
 
+// Segments are preallocated, so the log's end is not the file's end.
+void writeAt(const std::string& path, off_t at, const void* buf, size_t n) {
+    const int fd = ::open(path.c_str(), O_WRONLY);
+    assert(fd >= 0);
+    assert(::pwrite(fd, buf, n, at) == static_cast<ssize_t>(n));
+    ::close(fd);
+}
+
 void cleanup(const std::string& base, bool stringCol) {
     std::remove((base + ".mdb").c_str());
     std::remove((base + ".mdb.idx").c_str());
     std::remove((base + ".mdb.wal").c_str());
+    for (int slot = 1; slot < 16; ++slot)
+        std::remove((base + ".mdb.wal." + std::to_string(slot)).c_str());
     if (stringCol) std::remove((base + ".mdb.1.str").c_str());
     std::remove((base + ".mdb.2.str").c_str());
+    std::remove((base + ".mdb.0.hidx").c_str());
 }
 
 } // namespace
@@ -59,7 +110,7 @@ int main() {
             assert(row.size() == 2);
             assert(row[0] && row[0]->u32 == 7);
             assert(row[1] && row[1]->str == "alpha");
-            assert(fileSize(base + ".mdb.wal") == 8);
+            assert(t.walBytes() == uint64_t(kHeader));
         }
         cleanup(base, true);
     }
@@ -78,7 +129,7 @@ int main() {
             auto row = t.fetchTypedRow(0);
             assert(row.size() == 1);
             assert(!row[0]);
-            assert(fileSize(base + ".mdb.wal") == 8);
+            assert(t.walBytes() == uint64_t(kHeader));
         }
         cleanup(base, false);
     }
@@ -90,7 +141,7 @@ int main() {
             Table t(base + ".mdb", 4096, std::vector<ColType>{ColType::INT64, ColType::DOUBLE, ColType::STRING});
             t.insertTypedRow({ColValue(int64_t(-1234)), ColValue(9.25), ColValue(std::string("persisted"))});
             t.flushDurable();
-            assert(fileSize(base + ".mdb.wal") == 8);
+            assert(t.walBytes() == uint64_t(kHeader));
         }
         {
             Table t(base + ".mdb");
@@ -111,12 +162,12 @@ int main() {
             t.flushDurable();
         }
         const char junk[] = {'b', 'a', 'd', '!'};
-        appendBytes(base + ".mdb.wal", junk, sizeof(junk));
+        writeAt(base + ".mdb.wal", kHeader, junk, sizeof(junk));
         {
             Table t(base + ".mdb");
             auto row = t.fetchTypedRow(0);
             assert(row[0] && row[0]->u32 == 11);
-            assert(fileSize(base + ".mdb.wal") == 8);
+            assert(t.walBytes() == uint64_t(kHeader));
         }
         cleanup(base, false);
     }
@@ -130,17 +181,278 @@ int main() {
         }
         const TestRecordHeader bad{4, 2, {0, 0, 0}, 999, 0};
         const uint32_t rowID = 0;
-        appendBytes(base + ".mdb.wal", &bad, sizeof(bad));
-        appendBytes(base + ".mdb.wal", &rowID, sizeof(rowID));
+        writeAt(base + ".mdb.wal", kHeader + kInsertRecord, &bad, sizeof(bad));
+        writeAt(base + ".mdb.wal", kHeader + kInsertRecord + off_t(sizeof(bad)), &rowID, sizeof(rowID));
         {
             Table t(base + ".mdb");
             auto row = t.fetchTypedRow(0);
             assert(row[0] && row[0]->u32 == 55);
-            assert(fileSize(base + ".mdb.wal") == 8);
+            assert(t.walBytes() == uint64_t(kHeader));
+        }
+        cleanup(base, false);
+    }
+
+    {
+        // One autocommit record per row, written in a single append.
+        const std::string base = "/tmp/wal_autocommit";
+        cleanup(base, false);
+        {
+            Table t(base + ".mdb", 4096, std::vector<ColType>{ColType::UINT32});
+            t.insertTypedRow({ColValue(uint32_t(1))});
+            // Segment header + record header + varint rowID + varint value; no type tags
+            assert(t.walBytes() == uint64_t(kHeader + kInsertRecord));
+            t.insertTypedRow({ColValue(uint32_t(2))});
+            t.deleteRow(0);
+            assert(t.walBytes() == uint64_t(kHeader + 2 * kInsertRecord + off_t(sizeof(TestRecordHeader) + 4)));
+            assert(walVersion(base + ".mdb.wal") == 6);
+            assert(fileSize(base + ".mdb.wal") == off_t(Wal::kDefaultSegmentBytes));
+        }
+        {
+            Table t(base + ".mdb");
+            assert(!t.fetchTypedRow(0)[0]);
+            auto row = t.fetchTypedRow(1);
+            assert(row[0] && row[0]->u32 == 2);
+        }
+        cleanup(base, false);
+    }
+
+    {
+        // A version-1 log (separate insert and commit records) still replays,
+        // and the checkpoint after replay upgrades the header.
+        const std::string base = "/tmp/wal_v1_upgrade";
+        cleanup(base, false);
+        {
+            Table t(base + ".mdb", 4096, std::vector<ColType>{ColType::UINT32});
+            t.flushDurable();
+        }
+        const std::string walPath = base + ".mdb.wal";
+        const TestWalHeader v1{0x4D57414C, 1, 0};
+        FILE* f = std::fopen(walPath.c_str(), "wb");
+        std::fwrite(&v1, sizeof(v1), 1, f);
+        std::fclose(f);
+        std::vector<uint8_t> payload(8 + 8 + 4, 0);  // rowID 0, one UINT32 column = 77
+        payload[4] = 1;
+        payload[12] = 4;
+        payload[16] = 77;
+        appendV1Record(walPath, 1, 1, payload);
+        appendV1Record(walPath, 3, 1, {});
+        {
+            Table t(base + ".mdb");
+            auto row = t.fetchTypedRow(0);
+            assert(row[0] && row[0]->u32 == 77);
+            assert(walVersion(walPath) == 6);
+            assert(t.walBytes() == uint64_t(kHeader));
+        }
+        cleanup(base, false);
+    }
+
+    {
+        // opIDs continue across checkpoints via the header, without a scan.
+        const std::string base = "/tmp/wal_stream_opid";
+        cleanup(base, false);
+        const std::string walBase = base + ".mdb";
+        {
+            Wal wal(walBase);
+            wal.openOrCreate(true);
+            for (uint32_t i = 0; i < 3; ++i) wal.commitDelete(i);
+            wal.truncate();
+            assert(!wal.hasEntries());
+            assert(wal.appendDelete(9) == 4);
+            wal.appendCommit(4);
+        }
+        {
+            Wal wal(walBase);
+            wal.openOrCreate(false);
+            assert(wal.hasEntries());
+            bool threw = false;
+            try { wal.appendDelete(1); } catch (const std::runtime_error&) { threw = true; }
+            assert(threw);  // must replay first
+            uint32_t seen = 0;
+            assert(wal.replay([&](const Wal::Operation& op) { seen = op.rowID; }) == 1);
+            assert(seen == 9);
+            assert(wal.appendDelete(1) == 5);
+        }
+        cleanup(base, false);
+    }
+
+    {
+        // Replay cuts a torn tail, so records appended afterwards stay reachable.
+        const std::string base = "/tmp/wal_stream_tail";
+        cleanup(base, false);
+        const std::string walBase = base + ".mdb";
+        {
+            Wal wal(walBase);
+            wal.openOrCreate(true);
+            wal.commitDelete(1);
+        }
+        const char junk[] = {'t', 'o', 'r', 'n', '!', '!'};
+        writeAt(walBase + ".wal", kHeader + off_t(sizeof(TestRecordHeader) + 4), junk, sizeof(junk));
+        {
+            Wal wal(walBase);
+            wal.openOrCreate(false);
+            assert(wal.replay([](const Wal::Operation&) {}) == 1);
+            wal.commitDelete(2);
+        }
+        {
+            Wal wal(walBase);
+            wal.openOrCreate(false);
+            assert(wal.committedOperations().size() == 2);
         }
         cleanup(base, false);
     }
 
+    {
+        // Records larger than the replay window, mixed with many small ones.
+        const std::string base = "/tmp/wal_stream_large";
+        cleanup(base, true);
+        const std::string big(3 << 20, 'x');
+        {
+            Table t(base + ".mdb", 4096, std::vector<ColType>{ColType::UINT32, ColType::STRING});
+            for (uint32_t i = 0; i < 20000; ++i)
+                t.insertTypedRow({ColValue(i), ColValue(i == 777 ? big : std::string("s"))});
+        }
+        {
+            Table t(base + ".mdb");
+            assert(t.liveRows() == 20000);
+            assert(t.fetchTypedRow(777)[1]->str == big);
+            assert(t.fetchTypedRow(19999)[0]->u32 == 19999);
+            assert(t.walBytes() == uint64_t(kHeader));
+        }
+        cleanup(base, true);
+    }
+
+    {
+        // Small segments: the log rotates across files and replays in order,
+        // and after a checkpoint the files are recycled, not multiplied.
+        const std::string base = "/tmp/wal_segments";
+        cleanup(base, false);
+        const std::string walBase = base + ".mdb";
+        constexpr uint64_t kSegment = 4096;
+        {
+            Wal wal(walBase, kSegment);
+            wal.openOrCreate(true);
+            uint64_t lsn = wal.endLsn();
+            for (uint32_t i = 0; i < 600; ++i) {  // 24 bytes each, about four segments
+                wal.commitDelete(i);
+                assert(wal.endLsn() > lsn);
+                lsn = wal.endLsn();
+            }
+            assert(wal.segmentFiles() == 4);
+            assert(fileSize(walBase + ".wal.1") == off_t(kSegment));  // never extended
+        }
+        {
+            Wal wal(walBase, kSegment);
+            wal.openOrCreate(false);
+            uint32_t expected = 0;
+            assert(wal.replay([&](const Wal::Operation& op) { assert(op.rowID == expected++); }) == 600);
+            const uint64_t before = wal.endLsn();
+            wal.truncate();
+            assert(!wal.hasEntries() && wal.sizeBytes() == uint64_t(kHeader));
+            assert(wal.endLsn() > before);
+
+            for (uint32_t i = 0; i < 300; ++i) wal.commitDelete(1000 + i);
+            std::vector<Wal::Operation> batch(200);
+            for (uint32_t i = 0; i < 200; ++i) {
+                batch[i].kind = Wal::Operation::Kind::Delete;
+                batch[i].rowID = 2000 + i;
+            }
+            wal.commitBatch(batch);  // spans a segment boundary
+            wal.commitInsert(3000, {ColValue(std::string(10000, 'x'))});  // larger than a segment
+            assert(wal.segmentFiles() == 4);
+        }
+        {
+            // Records left in the recycled files from before the checkpoint
+            // are not replayed.
+            Wal wal(walBase, kSegment);
+            wal.openOrCreate(false);
+            const auto ops = wal.committedOperations();
+            assert(ops.size() == 501);
+            assert(ops.front().rowID == 1000 && ops[300].rowID == 2000 && ops[499].rowID == 2199);
+            assert(ops.back().rowID == 3000 && ops.back().values[0].str.size() == 10000);
+        }
+        cleanup(base, false);
+    }
+
+    {
+        // With the table's schema, values are logged packed, without type tags,
+        // and a transaction is one column-wise batch record, compressed here.
+        const std::string base = "/tmp/wal_packed";
+        cleanup(base, true);
+        const std::vector<ColType> types{ColType::INT64, ColType::STRING, ColType::DOUBLE};
+        {
+            Table t(base + ".mdb", 4096, types);
+            t.insertTypedRow({ColValue(int64_t(-3)), ColValue(std::string("neg")), ColValue(2.5)});
+            const uint64_t before = t.walBytes();
+            t.begin();
+            for (uint32_t i = 0; i < 1000; ++i)
+                t.insertTypedRow({ColValue(-int64_t(i) * 1000), ColValue("customer-" + std::to_string(i % 10)),
+                                  ColValue(double(i))});
+            t.deleteRow(0);
+            t.commit();
+            // Tagged per-op records for the same batch take about 78 KB.
+            assert(t.walBytes() - before < 8192);
+        }
+        {
+            // Read on its own, the log takes the schema from the table file.
+            Wal wal(base + ".mdb");
+            wal.openOrCreate(false);
+            const auto ops = wal.committedOperations();
+            assert(ops.size() == 1002);
+            assert(ops[0].values[0].i64 == -3 && ops[0].values[1].str == "neg" && ops[0].values[2].f64 == 2.5);
+            assert(ops[1].opID == 2 && ops[1].rowID == 1);
+            assert(ops.back().opID == 1002);
+            assert(ops.back().kind == Wal::Operation::Kind::Delete && ops.back().rowID == 0);
+        }
+        {
+            Table t(base + ".mdb");
+            t.setUseGPU(false);
+            assert(t.liveRows() == 1000);
+            assert(!t.fetchTypedRow(0)[0]);
+            auto row = t.fetchTypedRow(1000);
+            assert(row[0]->i64 == -999000 && row[1]->str == "customer-9" && row[2]->f64 == 999.0);
+        }
+        cleanup(base, true);
+    }
+
+    {
+        // Recovery applies runs of inserts in page-sized batches, each column
+        // on its own thread; deletes and a checkpointed prefix split the runs.
+        const std::string base = "/tmp/wal_batched_replay";
+        cleanup(base, true);
+        const auto text = [](uint32_t i) { return "name-" + std::to_string(i % 97); };
+        {
+            Table t(base + ".mdb", 4096,
+                    std::vector<ColType>{ColType::UINT32, ColType::INT64, ColType::STRING, ColType::DOUBLE});
+            t.setUseGPU(false);
+            t.createHashIndex(0);
+            for (uint32_t i = 0; i < 30000; ++i) {
+                t.insertTypedRow({ColValue(i), ColValue(-int64_t(i)), ColValue(text(i)), ColValue(i * 0.5)});
+                if (i == 1000) t.flushDurable();
+                if (i % 1000 == 999) t.deleteRow(i - 500);
+            }
+            t.begin();
+            for (uint32_t i = 30000; i < 30100; ++i)
+                t.insertTypedRow({ColValue(i), ColValue(-int64_t(i)), ColValue(text(i)), ColValue(i * 0.5)});
+            t.commit();
+        }
+        {
+            Table t(base + ".mdb");
+            t.setUseGPU(false);
+            assert(t.rowsRecorded() == 30100);
+            assert(t.liveRows() == 30100 - 30);
+            assert(t.scanEquals(0, 1499).empty());
+            for (uint32_t i : {0u, 1000u, 1001u, 4242u, 29999u, 30099u}) {
+                const auto row = t.fetchTypedRow(i);
+                assert(row[0]->u32 == i && row[1]->i64 == -int64_t(i));
+                assert(row[2]->str == text(i) && row[3]->f64 == i * 0.5);
+            }
+            assert(t.scanEqualsString(2, "name-5").size() == 311);
+            assert(t.scanEquals(0, 30050) == std::vector<uint32_t>{30050});
+            assert(t.walBytes() == uint64_t(kHeader));
+        }
+        cleanup(base, true);
+    }
+
     std::puts("test_wal: passed");
     return 0;
 }
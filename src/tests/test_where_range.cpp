@@ -1,6 +1,7 @@
 // tests/test_where_range.cpp
 #include "../Table.hpp"
 #include "../ValueTypes.hpp"
+#include "../Wal.hpp"
 #include <cassert>
 #include <iostream>
 #include <algorithm>
@@ -34,9 +35,35 @@ int main() {
     std::sort(got.begin(), got.end());
 
     assert(cpu == got);
+
+    // CPU: predicates evaluated inside the page walk, across deleted rows,
+    // reused slots and pages the zone maps skip (column 1 is ascending).
+    t.setUseGPU(false);
+    for (uint32_t i = 0; i < N; i += 3) t.deleteRow(i);
+    for (uint32_t i = N; i < N + 500; ++i)
+        t.insertRow({ static_cast<ValueType>(i % 200), static_cast<ValueType>(i) });
+    auto expect = [&](uint16_t col, ValueType lo, ValueType hi) {
+        std::vector<uint32_t> rows;
+        for (uint32_t rowID = 0; rowID < t.rowsRecorded(); ++rowID) {
+            auto r = t.fetchRow(rowID);
+            if (r[col] && *r[col] >= lo && *r[col] <= hi) rows.push_back(rowID);
+        }
+        return rows;
+    };
+    assert(t.whereBetween(0, 50, 120) == expect(0, 50, 120));
+    assert(t.whereBetween(1, 7000, 7100) == expect(1, 7000, 7100));
+    assert(t.whereBetween(1, N + 10, N + 20) == expect(1, N + 10, N + 20));
+    assert(t.whereBetween(1, 10, 5).empty());
+    assert(t.scanEquals(0, 77) == expect(0, 77, 77));
+    assert(t.scanEquals(1, 12345) == expect(1, 12345, 12345));
+    assert(t.scanEquals(1, 12).empty());
+    assert(t.scanEquals(0, 1000).empty());
     std::cout << "test_where_range: passed (zone-map prune + GPU)\n";
 
     unlink(tmpl);
     unlink((std::string(tmpl) + ".idx").c_str());
+    unlink((std::string(tmpl) + ".wal").c_str());
+    for (size_t slot = 1; slot < Wal::kMaxSegmentFiles; ++slot)
+        unlink((std::string(tmpl) + ".wal." + std::to_string(slot)).c_str());
     return 0;
 }
\ No newline at end of file